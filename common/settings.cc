@@ -42,6 +42,8 @@ std::string Settings::ToString() const {
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
   stream << "purge_persistent_cache: " << purge_persistent_cache << std::endl;
+  stream << "compact_persistent_cache: " << compact_persistent_cache
+         << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
   stream << "disable_dart_asserts: " << disable_dart_asserts << std::endl;
@@ -105,6 +105,42 @@ struct Settings {
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
   bool purge_persistent_cache = false;
+  // Rewrite the persistent cache at startup so it only holds the latest entry
+  // of each key. See |PersistentCache::Compact|.
+  bool compact_persistent_cache = false;
+  // Rasterize raster cache entries on worker threads instead of the raster
+  // thread. See |RasterCache::EnableAsyncRasterization|.
+  bool enable_async_raster_cache = false;
+  // The most bytes the raster cache keeps for entries that were not used in
+  // the last frame. See |RasterCache::max_bytes|.
+  size_t raster_cache_max_bytes = 32 * 1024 * 1024;
+  // Rasterize the frames of software surfaces in tiles on the concurrent
+  // workers instead of on the raster thread alone. See |TiledRasterizer|.
+  bool enable_tiled_software_rendering = false;
+  // How long the UI and IO threads may delay waking up for their timers so
+  // that timers due close together fire after a single wakeup. Timers are not
+  // delayed if zero. See |fml::MessageLoop::SetTimerSlack|.
+  std::chrono::microseconds timer_slack = {};
+  // Share the text blobs of identical runs of glyphs between paragraphs. See
+  // |txt::GlyphRunCache|.
+  bool enable_glyph_run_cache = false;
+  // Save the fallback fonts matched from the system fonts and their coverage
+  // in the caches directory, and reuse them in later runs. See
+  // |txt::FontFallbackIndex|.
+  bool enable_font_fallback_index = false;
+  // The directory of the hyphenation patterns that paragraphs are hyphenated
+  // with in the language of their locale. Paragraphs are not hyphenated if
+  // empty. See |txt::HyphenationPatterns|.
+  std::string hyphenation_patterns_path;
+  // The number of frames of animated images decoded ahead of the frame shown
+  // last, and the most bytes those frames may take up. Frames are only decoded
+  // when they are requested if the count is zero. See |MultiFrameCodec|.
+  size_t animated_image_decode_ahead_frame_count = 0;
+  size_t animated_image_decode_ahead_max_bytes = 16 * 1024 * 1024;
+  // The budget of the decoded image cache shared by the engines of the
+  // process. Images are decoded every time they are requested if it is zero.
+  // See |DecodedImageCache|.
+  size_t decoded_image_cache_max_bytes = 0;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool disable_dart_asserts = false;
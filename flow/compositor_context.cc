@@ -4,18 +4,27 @@
 
 #include "flutter/flow/compositor_context.h"
 
+#include <optional>
+#include <string>
+
 #include "flutter/flow/layers/layer_tree.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
 
-CompositorContext::CompositorContext(fml::Milliseconds frame_budget)
-    : raster_time_(frame_budget), ui_time_(frame_budget) {}
+CompositorContext::CompositorContext(fml::Milliseconds frame_budget,
+                                     size_t raster_cache_max_bytes)
+    : raster_cache_(RasterCache::kDefaultAccessThreshold,
+                    RasterCache::kDefaultPictureCacheLimitPerFrame,
+                    raster_cache_max_bytes),
+      raster_time_(frame_budget),
+      ui_time_(frame_budget) {}
 
 CompositorContext::~CompositorContext() = default;
 
 void CompositorContext::BeginFrame(ScopedFrame& frame,
                                    bool enable_instrumentation) {
+  raster_cache_.PublishAsyncResults();
   if (enable_instrumentation) {
     frame_count_.Increment();
     raster_time_.Start();
@@ -69,7 +78,8 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 
 RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
-    bool ignore_raster_cache) {
+    bool ignore_raster_cache,
+    FrameDamage* frame_damage) {
   TRACE_EVENT0("flutter", "CompositorContext::ScopedFrame::Raster");
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
@@ -85,6 +95,27 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kSkipAndRetryFrame) {
     return RasterStatus::kSkipAndRetry;
   }
+
+  std::optional<SkIRect> damage;
+  if (frame_damage) {
+    damage = ComputeDamage(layer_tree, frame_damage);
+    if (damage && damage->isEmpty()) {
+      TRACE_EVENT_INSTANT0("flutter", "no damage, skipping paint");
+      return RasterStatus::kSuccess;
+    }
+  }
+
+  // The damage is in device coordinates while the root canvas may already be
+  // transformed by the root surface transformation.
+  std::optional<SkAutoCanvasRestore> damage_clip;
+  if (canvas() && damage) {
+    damage_clip.emplace(canvas(), true);
+    const SkMatrix matrix = canvas()->getTotalMatrix();
+    canvas()->resetMatrix();
+    canvas()->clipRect(SkRect::Make(*damage));
+    canvas()->setMatrix(matrix);
+  }
+
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
   if (canvas()) {
@@ -104,6 +135,46 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   return RasterStatus::kSuccess;
 }
 
+std::optional<SkIRect> CompositorContext::ScopedFrame::ComputeDamage(
+    const LayerTree& layer_tree,
+    FrameDamage* frame_damage) {
+  TRACE_EVENT0("flutter", "CompositorContext::ScopedFrame::ComputeDamage");
+  frame_damage->frame_damage = std::nullopt;
+  frame_damage->buffer_damage = std::nullopt;
+
+  if (!canvas()) {
+    return std::nullopt;
+  }
+
+  const SkIRect frame_rect = SkIRect::MakeSize(canvas()->getBaseLayerSize());
+  DiffContext diff_context(SkRect::Make(frame_rect));
+  layer_tree.Diff(&diff_context, root_surface_transformation());
+  frame_damage->paint_regions = diff_context.TakePaintRegions();
+
+  // Layers painted by an external view embedder may end up in overlay
+  // surfaces the damage doesn't describe.
+  if (view_embedder_ || diff_context.has_full_damage() ||
+      !frame_damage->prior_paint_regions) {
+    return std::nullopt;
+  }
+
+  SkIRect damage = DiffContext::ComputeDamage(
+      *frame_damage->prior_paint_regions, frame_damage->paint_regions,
+      frame_rect);
+  frame_damage->frame_damage = damage;
+
+  SkIRect additional_damage = frame_damage->additional_damage;
+  if (additional_damage.intersect(frame_rect)) {
+    damage.join(additional_damage);
+  }
+  frame_damage->buffer_damage = damage;
+
+  TRACE_EVENT_INSTANT2("flutter", "FrameDamage", "width",
+                       std::to_string(damage.width()).c_str(), "height",
+                       std::to_string(damage.height()).c_str());
+  return damage;
+}
+
 void CompositorContext::OnGrContextCreated() {
   texture_registry_.OnGrContextCreated();
   raster_cache_.Clear();
@@ -6,8 +6,10 @@
 #define FLUTTER_FLOW_COMPOSITOR_CONTEXT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
@@ -48,6 +50,31 @@ enum class RasterStatus {
   kFailed
 };
 
+// Describes the partial repaint of a frame for surfaces whose framebuffer
+// retains the contents of a previously submitted frame.
+struct FrameDamage {
+  // The regions painted by the frame currently held by the framebuffer, or
+  // null if its contents are unknown. In that case the whole frame is painted.
+  const PaintRegionList* prior_paint_regions = nullptr;
+
+  // The area of the framebuffer that is out of date in addition to the
+  // difference between the prior frame and the new one, e.g. because the
+  // surface rotates between several buffers.
+  SkIRect additional_damage = SkIRect::MakeEmpty();
+
+  // Set by |ScopedFrame::Raster| to the regions painted by the new frame. They
+  // are the |prior_paint_regions| of the next frame.
+  PaintRegionList paint_regions;
+
+  // Set by |ScopedFrame::Raster| to the area of the new frame that differs
+  // from the prior one, or std::nullopt if the whole frame was painted.
+  std::optional<SkIRect> frame_damage;
+
+  // Set by |ScopedFrame::Raster| to the area of the framebuffer that was
+  // painted, or std::nullopt if the whole frame was painted.
+  std::optional<SkIRect> buffer_damage;
+};
+
 class CompositorContext {
  public:
   class ScopedFrame {
@@ -77,8 +104,11 @@ class CompositorContext {
 
     GrDirectContext* gr_context() const { return gr_context_; }
 
+    // If |frame_damage| is not null, only the part of the frame that changed
+    // since |FrameDamage::prior_paint_regions| is painted.
     virtual RasterStatus Raster(LayerTree& layer_tree,
-                                bool ignore_raster_cache);
+                                bool ignore_raster_cache,
+                                FrameDamage* frame_damage = nullptr);
 
    private:
     CompositorContext& context_;
@@ -90,10 +120,15 @@ class CompositorContext {
     const bool surface_supports_readback_;
     fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
 
+    std::optional<SkIRect> ComputeDamage(const LayerTree& layer_tree,
+                                         FrameDamage* frame_damage);
+
     FML_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
   };
 
-  CompositorContext(fml::Milliseconds frame_budget = fml::kDefaultFrameBudget);
+  CompositorContext(
+      fml::Milliseconds frame_budget = fml::kDefaultFrameBudget,
+      size_t raster_cache_max_bytes = RasterCache::kDefaultMaxBytes);
 
   virtual ~CompositorContext();
 
@@ -0,0 +1,226 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include <algorithm>
+
+namespace flutter {
+
+namespace {
+
+bool RegionLess(const PaintRegion& a, const PaintRegion& b) {
+  if (a.fingerprint != b.fingerprint) {
+    return a.fingerprint < b.fingerprint;
+  }
+  if (a.bounds.fLeft != b.bounds.fLeft) {
+    return a.bounds.fLeft < b.bounds.fLeft;
+  }
+  if (a.bounds.fTop != b.bounds.fTop) {
+    return a.bounds.fTop < b.bounds.fTop;
+  }
+  if (a.bounds.fRight != b.bounds.fRight) {
+    return a.bounds.fRight < b.bounds.fRight;
+  }
+  return a.bounds.fBottom < b.bounds.fBottom;
+}
+
+std::vector<const PaintRegion*> SortedStableRegions(
+    const PaintRegionList& regions,
+    SkRect* volatile_damage) {
+  std::vector<const PaintRegion*> result;
+  result.reserve(regions.size());
+  for (const auto& region : regions) {
+    if (region.is_volatile) {
+      volatile_damage->join(region.bounds);
+    } else {
+      result.push_back(&region);
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const PaintRegion* a, const PaintRegion* b) {
+              return RegionLess(*a, *b);
+            });
+  return result;
+}
+
+}  // namespace
+
+DiffContext::DiffContext(const SkRect& frame_rect)
+    : matrix_(SkMatrix::I()), clip_(frame_rect), fingerprint_(0) {}
+
+DiffContext::~DiffContext() = default;
+
+DiffContext::AutoSubtreeRestore::AutoSubtreeRestore(DiffContext* context)
+    : context_(context),
+      matrix_(context->matrix_),
+      clip_(context->clip_),
+      fingerprint_(context->fingerprint_) {}
+
+DiffContext::AutoSubtreeRestore::~AutoSubtreeRestore() {
+  context_->matrix_ = matrix_;
+  context_->clip_ = clip_;
+  context_->fingerprint_ = fingerprint_;
+}
+
+DiffContext::AutoGroup::AutoGroup(DiffContext* context, const SkRect& bounds)
+    : context_(context),
+      start_(context->regions_.size()),
+      device_bounds_(context->MapToDevice(bounds)) {}
+
+DiffContext::AutoGroup::~AutoGroup() {
+  auto& regions = context_->regions_;
+  if (regions.size() == start_) {
+    return;
+  }
+
+  PaintRegion group;
+  group.bounds = device_bounds_;
+  group.fingerprint = fml::HashCombine();
+  for (size_t i = start_; i < regions.size(); i++) {
+    const PaintRegion& region = regions[i];
+    fml::HashCombineSeed(group.fingerprint, region.fingerprint,
+                         region.bounds.fLeft, region.bounds.fTop,
+                         region.bounds.fRight, region.bounds.fBottom);
+    group.is_volatile = group.is_volatile || region.is_volatile;
+    if (region.reads_backdrop) {
+      group.reads_backdrop = true;
+      group.readback_bounds.join(region.readback_bounds);
+    }
+  }
+  regions.resize(start_);
+  if (!group.bounds.isEmpty()) {
+    regions.push_back(group);
+  }
+}
+
+void DiffContext::PushTransform(const SkMatrix& transform) {
+  matrix_.preConcat(transform);
+}
+
+void DiffContext::ClipRect(const SkRect& clip) {
+  if (!clip_.intersect(MapToDevice(clip))) {
+    clip_.setEmpty();
+  }
+}
+
+SkRect DiffContext::MapToDevice(const SkRect& bounds) const {
+  SkRect device_bounds = matrix_.mapRect(bounds);
+  if (!device_bounds.intersect(clip_)) {
+    device_bounds.setEmpty();
+  }
+  return device_bounds;
+}
+
+void DiffContext::AddPaintRegion(const SkRect& bounds, size_t content_id) {
+  PaintRegion region;
+  region.bounds = MapToDevice(bounds);
+  if (region.bounds.isEmpty()) {
+    return;
+  }
+  region.fingerprint = fingerprint_;
+  fml::HashCombineSeed(region.fingerprint, content_id);
+  for (int i = 0; i < 9; i++) {
+    fml::HashCombineSeed(region.fingerprint, matrix_.get(i));
+  }
+  regions_.push_back(region);
+}
+
+void DiffContext::AddVolatilePaintRegion(const SkRect& bounds) {
+  PaintRegion region;
+  region.bounds = MapToDevice(bounds);
+  if (region.bounds.isEmpty()) {
+    return;
+  }
+  region.fingerprint = 0;
+  region.is_volatile = true;
+  regions_.push_back(region);
+}
+
+void DiffContext::AddBackdropRegion(size_t content_id,
+                                    const SkImageFilter* filter) {
+  if (clip_.isEmpty()) {
+    return;
+  }
+  PaintRegion region;
+  region.bounds = clip_;
+  region.fingerprint = fingerprint_;
+  fml::HashCombineSeed(region.fingerprint, content_id);
+  region.reads_backdrop = true;
+  region.readback_bounds = clip_;
+  if (filter) {
+    // The filter may sample pixels outside of the area it draws to (e.g. a
+    // blur), so map the output bounds back to the input it depends on.
+    const SkIRect output_bounds = clip_.roundOut();
+    SkIRect input_bounds = filter->filterBounds(
+        output_bounds, matrix_, SkImageFilter::kReverse_MapDirection,
+        &output_bounds);
+    region.readback_bounds = SkRect::Make(input_bounds);
+  }
+  regions_.push_back(region);
+}
+
+SkIRect DiffContext::ComputeDamage(const PaintRegionList& old_regions,
+                                   const PaintRegionList& new_regions,
+                                   const SkIRect& frame_rect) {
+  SkRect damage = SkRect::MakeEmpty();
+  auto old_sorted = SortedStableRegions(old_regions, &damage);
+  auto new_sorted = SortedStableRegions(new_regions, &damage);
+
+  // Both lists are sorted, so regions present in only one of them can be
+  // found with a single merge pass.
+  size_t i = 0;
+  size_t j = 0;
+  while (i < old_sorted.size() && j < new_sorted.size()) {
+    const PaintRegion& old_region = *old_sorted[i];
+    const PaintRegion& new_region = *new_sorted[j];
+    if (RegionLess(old_region, new_region)) {
+      damage.join(old_region.bounds);
+      i++;
+    } else if (RegionLess(new_region, old_region)) {
+      damage.join(new_region.bounds);
+      j++;
+    } else {
+      i++;
+      j++;
+    }
+  }
+  for (; i < old_sorted.size(); i++) {
+    damage.join(old_sorted[i]->bounds);
+  }
+  for (; j < new_sorted.size(); j++) {
+    damage.join(new_sorted[j]->bounds);
+  }
+
+  // Regions reading the backdrop must be repainted entirely if anything they
+  // read from changed. Repainting them may in turn damage other backdrop
+  // readers, so iterate until the damage is stable.
+  bool expanded = !damage.isEmpty();
+  while (expanded) {
+    expanded = false;
+    for (const auto& region : new_regions) {
+      if (region.reads_backdrop &&
+          SkRect::Intersects(damage, region.readback_bounds) &&
+          !damage.contains(region.bounds)) {
+        damage.join(region.bounds);
+        expanded = true;
+      }
+    }
+  }
+
+  if (damage.isEmpty()) {
+    return SkIRect::MakeEmpty();
+  }
+
+  // Layers may snap their content to the pixel grid when painting (see
+  // |RasterCache::GetIntegralTransCTM|) and anti-aliasing may touch the pixels
+  // next to the paint bounds, so be generous by a pixel on each side.
+  SkIRect result = damage.roundOut().makeOutset(1, 1);
+  if (!result.intersect(frame_rect)) {
+    return SkIRect::MakeEmpty();
+  }
+  return result;
+}
+
+}  // namespace flutter
@@ -0,0 +1,151 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DIFF_CONTEXT_H_
+#define FLUTTER_FLOW_DIFF_CONTEXT_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkImageFilter.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
+
+namespace flutter {
+
+// A single contribution to the pixels of a frame, in device coordinates.
+//
+// Two frames are considered to produce the same pixels inside |bounds| if both
+// contain a region with equal |bounds| and |fingerprint|. The fingerprint
+// combines the identity of the painted content with every property of the
+// ancestor layers that can affect how that content ends up on the screen.
+struct PaintRegion {
+  SkRect bounds;
+  size_t fingerprint;
+
+  // Set for content that may change without the layer tree changing (e.g.
+  // external textures). Such regions are always considered damaged.
+  bool is_volatile = false;
+
+  // Set for regions whose pixels depend on what was painted below them (e.g.
+  // a backdrop filter). |readback_bounds| is the device area the region reads
+  // from; damage inside it invalidates the whole region.
+  bool reads_backdrop = false;
+  SkRect readback_bounds = SkRect::MakeEmpty();
+};
+
+using PaintRegionList = std::vector<PaintRegion>;
+
+// Collects the |PaintRegion|s of a prerolled layer tree so that they can be
+// compared with the ones of the previously rendered frame. See |Layer::Diff|.
+//
+// The context tracks the transform, clip and fingerprint accumulated from
+// the root of the tree. Layers modify this state while visiting their children
+// and use |AutoSubtreeRestore| to return it to the parent's state.
+class DiffContext {
+ public:
+  // |frame_rect| is the device space rectangle covered by the frame. All
+  // collected regions are clipped to it.
+  explicit DiffContext(const SkRect& frame_rect);
+
+  ~DiffContext();
+
+  class AutoSubtreeRestore {
+   public:
+    explicit AutoSubtreeRestore(DiffContext* context);
+    ~AutoSubtreeRestore();
+
+   private:
+    DiffContext* context_;
+    SkMatrix matrix_;
+    SkRect clip_;
+    size_t fingerprint_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoSubtreeRestore);
+  };
+
+  // Collapses all regions added while this object is alive into a single
+  // region covering |bounds| (in the coordinates current at construction).
+  //
+  // Layers whose effect on a pixel depends on the neighbouring pixels (e.g.
+  // image filters) use this so that any change to their subtree damages their
+  // whole output.
+  class AutoGroup {
+   public:
+    AutoGroup(DiffContext* context, const SkRect& bounds);
+    ~AutoGroup();
+
+   private:
+    DiffContext* context_;
+    size_t start_;
+    SkRect device_bounds_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoGroup);
+  };
+
+  void PushTransform(const SkMatrix& transform);
+
+  // Intersects the current clip with |clip| given in the current coordinates.
+  void ClipRect(const SkRect& clip);
+
+  // Mixes layer properties into the fingerprint of all regions subsequently
+  // added in the current subtree.
+  //
+  // Filters and shaders are mixed in by address rather than by their
+  // flattened contents, which would be too costly to compute on every frame.
+  // This relies on the layer tree that produced the prior paint regions
+  // being kept alive until they have been compared against the next frame
+  // (see |Rasterizer::last_layer_tree_|), so that an address can't be reused
+  // by a different object in the meantime.
+  template <class... Type>
+  void MixFingerprint(Type... args) {
+    fml::HashCombineSeed(fingerprint_, args...);
+  }
+
+  // Adds a region covering |bounds| (in the current coordinates) whose
+  // content is identified by |content_id|.
+  void AddPaintRegion(const SkRect& bounds, size_t content_id);
+
+  // Adds a region covering |bounds| that is considered damaged on every frame.
+  void AddVolatilePaintRegion(const SkRect& bounds);
+
+  // Adds a region covering the current clip whose pixels are computed from
+  // the backdrop through |filter|.
+  void AddBackdropRegion(size_t content_id, const SkImageFilter* filter);
+
+  // Requests a full repaint of the frame. Used by content that can't be
+  // tracked, such as platform views.
+  void MarkFullDamage() { full_damage_ = true; }
+
+  bool has_full_damage() const { return full_damage_; }
+
+  const SkMatrix& matrix() const { return matrix_; }
+
+  const SkRect& clip() const { return clip_; }
+
+  PaintRegionList TakePaintRegions() { return std::move(regions_); }
+
+  // Returns the device area that differs between two frames described by
+  // |old_regions| and |new_regions|, clipped to |frame_rect|.
+  static SkIRect ComputeDamage(const PaintRegionList& old_regions,
+                               const PaintRegionList& new_regions,
+                               const SkIRect& frame_rect);
+
+ private:
+  SkRect MapToDevice(const SkRect& bounds) const;
+
+  SkMatrix matrix_;
+  SkRect clip_;
+  size_t fingerprint_;
+  bool full_damage_ = false;
+  PaintRegionList regions_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DiffContext);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DIFF_CONTEXT_H_
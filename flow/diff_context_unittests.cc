@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/testing/layer_test.h"
+#include "flutter/flow/testing/mock_layer.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+const SkIRect kFrameRect = SkIRect::MakeWH(100, 100);
+
+}  // namespace
+
+class DiffContextTest : public LayerTest {
+ public:
+  PaintRegionList CollectRegions(Layer* root) {
+    root->Preroll(preroll_context(), SkMatrix());
+    DiffContext context(SkRect::Make(kFrameRect));
+    root->Diff(&context);
+    return context.TakePaintRegions();
+  }
+};
+
+TEST_F(DiffContextTest, IdenticalTreesHaveNoDamage) {
+  auto child = std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(10.0f, 10.0f, 20.0f, 20.0f)));
+  auto root = std::make_shared<ContainerLayer>();
+  root->Add(child);
+
+  auto regions = CollectRegions(root.get());
+  EXPECT_EQ(regions.size(), 1u);
+  EXPECT_TRUE(
+      DiffContext::ComputeDamage(regions, regions, kFrameRect).isEmpty());
+}
+
+TEST_F(DiffContextTest, ReplacedLayerIsDamaged) {
+  const SkPath path = SkPath().addRect(SkRect::MakeLTRB(10, 10, 20, 20));
+  auto stable_child = std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(50, 50, 60, 60)));
+
+  auto old_root = std::make_shared<ContainerLayer>();
+  old_root->Add(std::make_shared<MockLayer>(path));
+  old_root->Add(stable_child);
+  auto old_regions = CollectRegions(old_root.get());
+
+  auto new_root = std::make_shared<ContainerLayer>();
+  new_root->Add(std::make_shared<MockLayer>(path));
+  new_root->Add(stable_child);
+  auto new_regions = CollectRegions(new_root.get());
+
+  // The damage is outset by one pixel to account for pixel snapping.
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions, new_regions, kFrameRect),
+            SkIRect::MakeLTRB(9, 9, 21, 21));
+}
+
+TEST_F(DiffContextTest, OpacityChangeDamagesChildren) {
+  auto child = std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(10, 10, 20, 20)));
+
+  auto old_root = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  old_root->Add(child);
+  auto old_regions = CollectRegions(old_root.get());
+
+  auto same_root = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  same_root->Add(child);
+  auto same_regions = CollectRegions(same_root.get());
+  EXPECT_TRUE(DiffContext::ComputeDamage(old_regions, same_regions, kFrameRect)
+                  .isEmpty());
+
+  auto new_root = std::make_shared<OpacityLayer>(255, SkPoint::Make(0, 0));
+  new_root->Add(child);
+  auto new_regions = CollectRegions(new_root.get());
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions, new_regions, kFrameRect),
+            SkIRect::MakeLTRB(9, 9, 21, 21));
+}
+
+TEST_F(DiffContextTest, MovedChildDamagesOldAndNewBounds) {
+  auto child = std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeLTRB(10, 10, 20, 20)));
+
+  auto old_root = std::make_shared<TransformLayer>(SkMatrix::I());
+  old_root->Add(child);
+  auto old_regions = CollectRegions(old_root.get());
+
+  auto new_root = std::make_shared<TransformLayer>(SkMatrix::Translate(30, 0));
+  new_root->Add(child);
+  auto new_regions = CollectRegions(new_root.get());
+
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions, new_regions, kFrameRect),
+            SkIRect::MakeLTRB(9, 9, 51, 21));
+}
+
+TEST_F(DiffContextTest, DamageIsClippedToFrame) {
+  DiffContext old_context(SkRect::Make(kFrameRect));
+  old_context.AddPaintRegion(SkRect::MakeLTRB(-50, -50, 50, 50), 1);
+  DiffContext new_context(SkRect::Make(kFrameRect));
+  auto old_regions = old_context.TakePaintRegions();
+  EXPECT_EQ(old_regions[0].bounds, SkRect::MakeLTRB(0, 0, 50, 50));
+
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions,
+                                       new_context.TakePaintRegions(),
+                                       kFrameRect),
+            SkIRect::MakeLTRB(0, 0, 51, 51));
+}
+
+TEST_F(DiffContextTest, VolatileRegionIsAlwaysDamaged) {
+  DiffContext context(SkRect::Make(kFrameRect));
+  context.AddVolatilePaintRegion(SkRect::MakeLTRB(10, 10, 20, 20));
+  auto regions = context.TakePaintRegions();
+
+  EXPECT_EQ(DiffContext::ComputeDamage(regions, regions, kFrameRect),
+            SkIRect::MakeLTRB(9, 9, 21, 21));
+}
+
+TEST_F(DiffContextTest, GroupIsDamagedByAnyChange) {
+  auto make_regions = [](size_t child_id) {
+    DiffContext context(SkRect::Make(kFrameRect));
+    {
+      DiffContext::AutoGroup group(&context, SkRect::MakeLTRB(0, 0, 40, 40));
+      context.AddPaintRegion(SkRect::MakeLTRB(10, 10, 20, 20), child_id);
+    }
+    return context.TakePaintRegions();
+  };
+
+  auto old_regions = make_regions(1);
+  auto new_regions = make_regions(2);
+  EXPECT_EQ(old_regions.size(), 1u);
+  EXPECT_EQ(old_regions[0].bounds, SkRect::MakeLTRB(0, 0, 40, 40));
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions, new_regions, kFrameRect),
+            SkIRect::MakeLTRB(0, 0, 41, 41));
+}
+
+TEST_F(DiffContextTest, BackdropIsDamagedByChangesBelow) {
+  auto make_regions = [](size_t child_id) {
+    DiffContext context(SkRect::Make(kFrameRect));
+    context.AddPaintRegion(SkRect::MakeLTRB(10, 10, 20, 20), child_id);
+    {
+      DiffContext::AutoSubtreeRestore subtree(&context);
+      context.ClipRect(SkRect::MakeLTRB(0, 0, 50, 50));
+      context.AddBackdropRegion(1, nullptr);
+    }
+    return context.TakePaintRegions();
+  };
+
+  auto old_regions = make_regions(1);
+  EXPECT_TRUE(DiffContext::ComputeDamage(old_regions, make_regions(1),
+                                         kFrameRect)
+                  .isEmpty());
+  EXPECT_EQ(DiffContext::ComputeDamage(old_regions, make_regions(2),
+                                       kFrameRect),
+            SkIRect::MakeLTRB(0, 0, 51, 51));
+}
+
+}  // namespace testing
+}  // namespace flutter
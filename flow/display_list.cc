@@ -0,0 +1,1382 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkColorFilter.h"
+#include "third_party/skia/include/core/SkImageFilter.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flutter {
+
+namespace {
+
+// The index of the paint of operations that are drawn without one.
+constexpr uint32_t kNoPaint = std::numeric_limits<uint32_t>::max();
+
+// The bounds of draws that can't be culled.
+constexpr SkRect kUnbounded =
+    SkRect::MakeLTRB(-SK_ScalarInfinity,
+                     -SK_ScalarInfinity,
+                     SK_ScalarInfinity,
+                     SK_ScalarInfinity);
+
+// Operations are aligned to this in the storage of a display list, which is
+// enough for the pointers that they hold.
+constexpr size_t kOpAlignment = 8;
+
+#define FOR_EACH_DISPLAY_LIST_OP(V) \
+  V(Save)                           \
+  V(SaveLayer)                      \
+  V(Restore)                        \
+  V(Translate)                      \
+  V(Scale)                          \
+  V(Rotate)                         \
+  V(Skew)                           \
+  V(Concat)                         \
+  V(Concat44)                       \
+  V(SetMatrix)                      \
+  V(ClipRect)                       \
+  V(ClipRRect)                      \
+  V(ClipPath)                       \
+  V(DrawPaint)                      \
+  V(DrawColor)                      \
+  V(DrawLine)                       \
+  V(DrawRect)                       \
+  V(DrawOval)                       \
+  V(DrawCircle)                     \
+  V(DrawRRect)                      \
+  V(DrawDRRect)                     \
+  V(DrawArc)                        \
+  V(DrawPath)                       \
+  V(DrawPoints)                     \
+  V(DrawVertices)                   \
+  V(DrawImage)                      \
+  V(DrawImageRect)                  \
+  V(DrawImageNine)                  \
+  V(DrawAtlas)                      \
+  V(DrawPicture)                    \
+  V(DrawDisplayList)                \
+  V(DrawTextBlob)                   \
+  V(DrawShadow)
+
+enum class DisplayListOpType : uint32_t {
+#define DISPLAY_LIST_OP_TYPE(name) k##name,
+  FOR_EACH_DISPLAY_LIST_OP(DISPLAY_LIST_OP_TYPE)
+#undef DISPLAY_LIST_OP_TYPE
+};
+
+// The start of every operation in the storage of a display list. |size|
+// includes the data that follows the operation, like the points of
+// DrawPointsOp.
+struct DisplayListOp {
+  DisplayListOpType type;
+  uint32_t size;
+};
+
+// Plays back the operations of a display list to a canvas.
+class DisplayListRenderer {
+ public:
+  DisplayListRenderer(SkCanvas* canvas,
+                      const std::vector<SkPaint>& paints,
+                      const std::vector<SkPath>& paths,
+                      const std::vector<SkRect>& draw_bounds,
+                      const SkRect& bounds,
+                      SkScalar opacity)
+      : canvas_(canvas),
+        paints_(paints),
+        paths_(paths),
+        draw_bounds_(draw_bounds),
+        initial_matrix_(canvas->getTotalMatrix()),
+        cull_rect_(canvas->getLocalClipBounds()),
+        // Draws are only tested against the clip if some of them can be
+        // outside of it.
+        needs_culling_(!cull_rect_.contains(bounds)),
+        opacity_(opacity) {}
+
+  SkCanvas* canvas() const { return canvas_; }
+
+  const SkMatrix& initial_matrix() const { return initial_matrix_; }
+
+  const SkPath& path(uint32_t index) const { return paths_[index]; }
+
+  const SkPaint& paint(uint32_t index) {
+    if (opacity_ >= SK_Scalar1) {
+      return paints_[index];
+    }
+    opacity_paint_ = paints_[index];
+    opacity_paint_.setAlphaf(opacity_paint_.getAlphaf() * opacity_);
+    return opacity_paint_;
+  }
+
+  const SkPaint* optional_paint(uint32_t index) {
+    if (index != kNoPaint) {
+      return &paint(index);
+    }
+    if (opacity_ >= SK_Scalar1) {
+      return nullptr;
+    }
+    opacity_paint_ = SkPaint();
+    opacity_paint_.setAlphaf(opacity_);
+    return &opacity_paint_;
+  }
+
+  SkColor color(SkColor color) const {
+    if (opacity_ >= SK_Scalar1) {
+      return color;
+    }
+    return SkColorSetA(color,
+                       SkScalarRoundToInt(SkColorGetA(color) * opacity_));
+  }
+
+  template <typename Op>
+  void Render(const Op& op) {
+    if (Op::kIsDraw) {
+      const SkRect& bounds = draw_bounds_[draw_index_++];
+      // Inclusive, so that the draws with empty bounds, like horizontal
+      // hairlines, are kept when they touch the clip.
+      if (needs_culling_ && (bounds.fLeft > cull_rect_.fRight ||
+                             bounds.fRight < cull_rect_.fLeft ||
+                             bounds.fTop > cull_rect_.fBottom ||
+                             bounds.fBottom < cull_rect_.fTop)) {
+        return;
+      }
+    }
+    op.Render(*this);
+  }
+
+ private:
+  SkCanvas* const canvas_;
+  const std::vector<SkPaint>& paints_;
+  const std::vector<SkPath>& paths_;
+  const std::vector<SkRect>& draw_bounds_;
+  const SkMatrix initial_matrix_;
+  const SkRect cull_rect_;
+  const bool needs_culling_;
+  const SkScalar opacity_;
+  size_t draw_index_ = 0;
+  SkPaint opacity_paint_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListRenderer);
+};
+
+// The operations are plain structs that are copied into the storage of the
+// display list. They must not have padding between their fields, so that
+// display lists can be compared with memcmp. Objects are referenced by
+// pointer and kept alive by the display list, paths and paints by their
+// index.
+
+struct SaveOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kSave;
+  static constexpr bool kIsDraw = false;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->save();
+  }
+};
+
+struct SaveLayerOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kSaveLayer;
+  static constexpr bool kIsDraw = false;
+
+  SaveLayerOp(const SkImageFilter* backdrop,
+              const SkRect* bounds,
+              uint32_t paint,
+              SkCanvas::SaveLayerFlags flags)
+      : backdrop(backdrop),
+        bounds(bounds ? *bounds : SkRect::MakeEmpty()),
+        has_bounds(bounds != nullptr),
+        paint(paint),
+        flags(flags) {}
+
+  const SkImageFilter* backdrop;
+  SkRect bounds;
+  uint32_t has_bounds;
+  uint32_t paint;
+  SkCanvas::SaveLayerFlags flags;
+  uint32_t unused = 0;
+
+  void Render(DisplayListRenderer& renderer) const {
+    // The opacity is not applied to layers, see can_apply_group_opacity.
+    renderer.canvas()->saveLayer(SkCanvas::SaveLayerRec(
+        has_bounds ? &bounds : nullptr, renderer.optional_paint(paint),
+        backdrop, flags));
+  }
+};
+
+struct RestoreOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kRestore;
+  static constexpr bool kIsDraw = false;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->restore();
+  }
+};
+
+struct TranslateOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kTranslate;
+  static constexpr bool kIsDraw = false;
+
+  TranslateOp(SkScalar dx, SkScalar dy) : dx(dx), dy(dy) {}
+
+  SkScalar dx;
+  SkScalar dy;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->translate(dx, dy);
+  }
+};
+
+struct ScaleOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kScale;
+  static constexpr bool kIsDraw = false;
+
+  ScaleOp(SkScalar sx, SkScalar sy) : sx(sx), sy(sy) {}
+
+  SkScalar sx;
+  SkScalar sy;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->scale(sx, sy);
+  }
+};
+
+struct RotateOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kRotate;
+  static constexpr bool kIsDraw = false;
+
+  explicit RotateOp(SkScalar degrees) : degrees(degrees) {}
+
+  SkScalar degrees;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->rotate(degrees);
+  }
+};
+
+struct SkewOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kSkew;
+  static constexpr bool kIsDraw = false;
+
+  SkewOp(SkScalar sx, SkScalar sy) : sx(sx), sy(sy) {}
+
+  SkScalar sx;
+  SkScalar sy;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->skew(sx, sy);
+  }
+};
+
+// Matrices are stored as their values, as SkMatrix caches its type.
+struct ConcatOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kConcat;
+  static constexpr bool kIsDraw = false;
+
+  explicit ConcatOp(const SkMatrix& matrix) { matrix.get9(values); }
+
+  SkScalar values[9];
+
+  void Render(DisplayListRenderer& renderer) const {
+    SkMatrix matrix;
+    matrix.set9(values);
+    renderer.canvas()->concat(matrix);
+  }
+};
+
+struct Concat44Op final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kConcat44;
+  static constexpr bool kIsDraw = false;
+
+  explicit Concat44Op(const SkM44& matrix) { matrix.getColMajor(values); }
+
+  SkScalar values[16];
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->concat(SkM44::ColMajor(values));
+  }
+};
+
+struct SetMatrixOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kSetMatrix;
+  static constexpr bool kIsDraw = false;
+
+  explicit SetMatrixOp(const SkMatrix& matrix) { matrix.get9(values); }
+
+  SkScalar values[9];
+
+  void Render(DisplayListRenderer& renderer) const {
+    SkMatrix matrix;
+    matrix.set9(values);
+    renderer.canvas()->setMatrix(
+        SkMatrix::Concat(renderer.initial_matrix(), matrix));
+  }
+};
+
+struct ClipRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kClipRect;
+  static constexpr bool kIsDraw = false;
+
+  ClipRectOp(const SkRect& rect, SkClipOp clip_op, bool is_aa)
+      : rect(rect), clip_op(clip_op), is_aa(is_aa) {}
+
+  SkRect rect;
+  SkClipOp clip_op;
+  uint32_t is_aa;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->clipRect(rect, clip_op, is_aa);
+  }
+};
+
+struct ClipRRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kClipRRect;
+  static constexpr bool kIsDraw = false;
+
+  ClipRRectOp(const SkRRect& rrect, SkClipOp clip_op, bool is_aa)
+      : rrect(rrect), clip_op(clip_op), is_aa(is_aa) {}
+
+  SkRRect rrect;
+  SkClipOp clip_op;
+  uint32_t is_aa;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->clipRRect(rrect, clip_op, is_aa);
+  }
+};
+
+struct ClipPathOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kClipPath;
+  static constexpr bool kIsDraw = false;
+
+  ClipPathOp(uint32_t path, SkClipOp clip_op, bool is_aa)
+      : path(path), clip_op(clip_op), is_aa(is_aa) {}
+
+  uint32_t path;
+  SkClipOp clip_op;
+  uint32_t is_aa;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->clipPath(renderer.path(path), clip_op, is_aa);
+  }
+};
+
+struct DrawPaintOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPaint;
+  static constexpr bool kIsDraw = true;
+
+  explicit DrawPaintOp(uint32_t paint) : paint(paint) {}
+
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawPaint(renderer.paint(paint));
+  }
+};
+
+struct DrawColorOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawColor;
+  static constexpr bool kIsDraw = true;
+
+  DrawColorOp(SkColor color, SkBlendMode mode) : color(color), mode(mode) {}
+
+  SkColor color;
+  SkBlendMode mode;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawColor(renderer.color(color), mode);
+  }
+};
+
+struct DrawLineOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawLine;
+  static constexpr bool kIsDraw = true;
+
+  DrawLineOp(const SkPoint& p0, const SkPoint& p1, uint32_t paint)
+      : p0(p0), p1(p1), paint(paint) {}
+
+  SkPoint p0;
+  SkPoint p1;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawLine(p0, p1, renderer.paint(paint));
+  }
+};
+
+struct DrawRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawRect;
+  static constexpr bool kIsDraw = true;
+
+  DrawRectOp(const SkRect& rect, uint32_t paint) : rect(rect), paint(paint) {}
+
+  SkRect rect;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawRect(rect, renderer.paint(paint));
+  }
+};
+
+struct DrawOvalOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawOval;
+  static constexpr bool kIsDraw = true;
+
+  DrawOvalOp(const SkRect& bounds, uint32_t paint)
+      : bounds(bounds), paint(paint) {}
+
+  SkRect bounds;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawOval(bounds, renderer.paint(paint));
+  }
+};
+
+struct DrawCircleOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawCircle;
+  static constexpr bool kIsDraw = true;
+
+  DrawCircleOp(const SkPoint& center, SkScalar radius, uint32_t paint)
+      : center(center), radius(radius), paint(paint) {}
+
+  SkPoint center;
+  SkScalar radius;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawCircle(center, radius, renderer.paint(paint));
+  }
+};
+
+struct DrawRRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawRRect;
+  static constexpr bool kIsDraw = true;
+
+  DrawRRectOp(const SkRRect& rrect, uint32_t paint)
+      : rrect(rrect), paint(paint) {}
+
+  SkRRect rrect;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawRRect(rrect, renderer.paint(paint));
+  }
+};
+
+struct DrawDRRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawDRRect;
+  static constexpr bool kIsDraw = true;
+
+  DrawDRRectOp(const SkRRect& outer, const SkRRect& inner, uint32_t paint)
+      : outer(outer), inner(inner), paint(paint) {}
+
+  SkRRect outer;
+  SkRRect inner;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawDRRect(outer, inner, renderer.paint(paint));
+  }
+};
+
+struct DrawArcOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawArc;
+  static constexpr bool kIsDraw = true;
+
+  DrawArcOp(const SkRect& bounds,
+            SkScalar start_degrees,
+            SkScalar sweep_degrees,
+            bool use_center,
+            uint32_t paint)
+      : bounds(bounds),
+        start_degrees(start_degrees),
+        sweep_degrees(sweep_degrees),
+        use_center(use_center),
+        paint(paint) {}
+
+  SkRect bounds;
+  SkScalar start_degrees;
+  SkScalar sweep_degrees;
+  uint32_t use_center;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawArc(bounds, start_degrees, sweep_degrees,
+                               use_center, renderer.paint(paint));
+  }
+};
+
+struct DrawPathOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPath;
+  static constexpr bool kIsDraw = true;
+
+  DrawPathOp(uint32_t path, uint32_t paint) : path(path), paint(paint) {}
+
+  uint32_t path;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawPath(renderer.path(path), renderer.paint(paint));
+  }
+};
+
+// Followed by |count| points.
+struct DrawPointsOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPoints;
+  static constexpr bool kIsDraw = true;
+
+  DrawPointsOp(SkCanvas::PointMode mode, uint32_t count, uint32_t paint)
+      : mode(mode), count(count), paint(paint) {}
+
+  SkCanvas::PointMode mode;
+  uint32_t count;
+  uint32_t paint;
+
+  const SkPoint* points() const {
+    return reinterpret_cast<const SkPoint*>(this + 1);
+  }
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawPoints(mode, count, points(),
+                                  renderer.paint(paint));
+  }
+};
+
+struct DrawVerticesOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawVertices;
+  static constexpr bool kIsDraw = true;
+
+  DrawVerticesOp(const SkVertices* vertices, SkBlendMode mode, uint32_t paint)
+      : vertices(vertices), mode(mode), paint(paint) {}
+
+  const SkVertices* vertices;
+  SkBlendMode mode;
+  uint32_t paint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawVertices(vertices, mode, renderer.paint(paint));
+  }
+};
+
+struct DrawImageOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImage;
+  static constexpr bool kIsDraw = true;
+
+  DrawImageOp(const SkImage* image, const SkPoint& point, uint32_t paint)
+      : image(image), point(point), paint(paint), unused(0) {}
+
+  const SkImage* image;
+  SkPoint point;
+  uint32_t paint;
+  uint32_t unused;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawImage(image, point.fX, point.fY,
+                                 renderer.optional_paint(paint));
+  }
+};
+
+struct DrawImageRectOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImageRect;
+  static constexpr bool kIsDraw = true;
+
+  DrawImageRectOp(const SkImage* image,
+                  const SkRect& src,
+                  const SkRect& dst,
+                  uint32_t paint,
+                  SkCanvas::SrcRectConstraint constraint)
+      : image(image),
+        src(src),
+        dst(dst),
+        paint(paint),
+        constraint(constraint) {}
+
+  const SkImage* image;
+  SkRect src;
+  SkRect dst;
+  uint32_t paint;
+  SkCanvas::SrcRectConstraint constraint;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawImageRect(image, src, dst,
+                                     renderer.optional_paint(paint),
+                                     constraint);
+  }
+};
+
+struct DrawImageNineOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawImageNine;
+  static constexpr bool kIsDraw = true;
+
+  DrawImageNineOp(const SkImage* image,
+                  const SkIRect& center,
+                  const SkRect& dst,
+                  uint32_t paint)
+      : image(image), center(center), dst(dst), paint(paint), unused(0) {}
+
+  const SkImage* image;
+  SkIRect center;
+  SkRect dst;
+  uint32_t paint;
+  uint32_t unused;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawImageNine(image, center, dst,
+                                     renderer.optional_paint(paint));
+  }
+};
+
+// Followed by |count| transforms, |count| texture rects and, if |has_colors|,
+// |count| colors.
+struct DrawAtlasOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawAtlas;
+  static constexpr bool kIsDraw = true;
+
+  DrawAtlasOp(const SkImage* atlas,
+              uint32_t count,
+              SkBlendMode mode,
+              bool has_colors,
+              const SkRect* cull_rect,
+              uint32_t paint)
+      : atlas(atlas),
+        count(count),
+        mode(mode),
+        has_colors(has_colors),
+        has_cull_rect(cull_rect != nullptr),
+        cull_rect(cull_rect ? *cull_rect : SkRect::MakeEmpty()),
+        paint(paint),
+        unused(0) {}
+
+  const SkImage* atlas;
+  uint32_t count;
+  SkBlendMode mode;
+  uint32_t has_colors;
+  uint32_t has_cull_rect;
+  SkRect cull_rect;
+  uint32_t paint;
+  uint32_t unused;
+
+  SkRSXform* xforms() { return reinterpret_cast<SkRSXform*>(this + 1); }
+  const SkRSXform* xforms() const {
+    return reinterpret_cast<const SkRSXform*>(this + 1);
+  }
+  SkRect* tex() { return reinterpret_cast<SkRect*>(xforms() + count); }
+  const SkRect* tex() const {
+    return reinterpret_cast<const SkRect*>(xforms() + count);
+  }
+  SkColor* colors() { return reinterpret_cast<SkColor*>(tex() + count); }
+  const SkColor* colors() const {
+    return has_colors ? reinterpret_cast<const SkColor*>(tex() + count)
+                      : nullptr;
+  }
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawAtlas(atlas, xforms(), tex(), colors(), count,
+                                 mode, has_cull_rect ? &cull_rect : nullptr,
+                                 renderer.optional_paint(paint));
+  }
+};
+
+struct DrawPictureOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawPicture;
+  static constexpr bool kIsDraw = true;
+
+  DrawPictureOp(const SkPicture* picture,
+                const SkMatrix* matrix,
+                uint32_t paint)
+      : picture(picture), has_matrix(matrix != nullptr), paint(paint) {
+    (matrix ? *matrix : SkMatrix::I()).get9(values);
+  }
+
+  const SkPicture* picture;
+  uint32_t has_matrix;
+  uint32_t paint;
+  SkScalar values[9];
+  uint32_t unused = 0;
+
+  void Render(DisplayListRenderer& renderer) const {
+    SkMatrix matrix;
+    matrix.set9(values);
+    renderer.canvas()->drawPicture(picture, has_matrix ? &matrix : nullptr,
+                                   renderer.optional_paint(paint));
+  }
+};
+
+struct DrawDisplayListOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawDisplayList;
+  static constexpr bool kIsDraw = true;
+
+  explicit DrawDisplayListOp(const DisplayList* display_list)
+      : display_list(display_list) {}
+
+  const DisplayList* display_list;
+
+  void Render(DisplayListRenderer& renderer) const {
+    display_list->RenderTo(renderer.canvas());
+  }
+};
+
+struct DrawTextBlobOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawTextBlob;
+  static constexpr bool kIsDraw = true;
+
+  DrawTextBlobOp(const SkTextBlob* blob, SkScalar x, SkScalar y, uint32_t paint)
+      : blob(blob), x(x), y(y), paint(paint), unused(0) {}
+
+  const SkTextBlob* blob;
+  SkScalar x;
+  SkScalar y;
+  uint32_t paint;
+  uint32_t unused;
+
+  void Render(DisplayListRenderer& renderer) const {
+    renderer.canvas()->drawTextBlob(blob, x, y, renderer.paint(paint));
+  }
+};
+
+struct DrawShadowOp final : DisplayListOp {
+  static constexpr auto kType = DisplayListOpType::kDrawShadow;
+  static constexpr bool kIsDraw = true;
+
+  DrawShadowOp(uint32_t path,
+               SkColor color,
+               SkScalar elevation,
+               bool transparent_occluder,
+               SkScalar device_pixel_ratio)
+      : path(path),
+        color(color),
+        elevation(elevation),
+        transparent_occluder(transparent_occluder),
+        device_pixel_ratio(device_pixel_ratio) {}
+
+  uint32_t path;
+  SkColor color;
+  SkScalar elevation;
+  uint32_t transparent_occluder;
+  SkScalar device_pixel_ratio;
+
+  void Render(DisplayListRenderer& renderer) const {
+    PhysicalShapeLayer::DrawShadow(renderer.canvas(), renderer.path(path),
+                                   color, elevation, transparent_occluder,
+                                   device_pixel_ratio);
+  }
+};
+
+#define DISPLAY_LIST_OP_CHECK(name)                                      \
+  static_assert(std::is_trivially_destructible<name##Op>::value,        \
+                #name "Op must not need to be destroyed");               \
+  static_assert(alignof(name##Op) <= kOpAlignment,                       \
+                #name "Op must fit the alignment of the storage");
+FOR_EACH_DISPLAY_LIST_OP(DISPLAY_LIST_OP_CHECK)
+#undef DISPLAY_LIST_OP_CHECK
+
+size_t AlignOpSize(size_t size) {
+  return (size + kOpAlignment - 1) & ~(kOpAlignment - 1);
+}
+
+uint32_t NextDisplayListUniqueID() {
+  static std::atomic<uint32_t> next_id{1};
+  uint32_t id;
+  do {
+    id = next_id.fetch_add(1, std::memory_order_relaxed);
+  } while (id == 0);
+  return id;
+}
+
+void HashPaint(size_t& seed, const SkPaint& paint) {
+  fml::HashCombineSeed(
+      seed, paint.getColor(), paint.getStrokeWidth(), paint.getStrokeMiter(),
+      paint.getStyle(), paint.getStrokeCap(), paint.getStrokeJoin(),
+      paint.isAntiAlias(), paint.isDither(), paint.getFilterQuality(),
+      static_cast<int>(paint.getBlendMode()));
+  fml::HashCombineSeed(seed, paint.getShader(), paint.getColorFilter(),
+                       paint.getImageFilter(), paint.getMaskFilter(),
+                       paint.getPathEffect());
+}
+
+void HashPath(size_t& seed, const SkPath& path) {
+  // The frames of an animated path often have the same bounds and counts, so
+  // all of the data is hashed for them to be repainted.
+  std::vector<SkPoint> points(path.countPoints());
+  path.getPoints(points.data(), points.size());
+  std::vector<uint8_t> verbs(path.countVerbs());
+  path.getVerbs(verbs.data(), verbs.size());
+  fml::HashCombineSeed(
+      seed, static_cast<int>(path.getFillType()),
+      std::string_view(reinterpret_cast<const char*>(points.data()),
+                       points.size() * sizeof(SkPoint)),
+      std::string_view(reinterpret_cast<const char*>(verbs.data()),
+                       verbs.size()));
+  if (path.getSegmentMasks() & SkPath::kConic_SegmentMask) {
+    SkPath::Iter iter(path, false);
+    SkPoint segment_points[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(segment_points)) != SkPath::kDone_Verb) {
+      if (verb == SkPath::kConic_Verb) {
+        fml::HashCombineSeed(seed, iter.conicWeight());
+      }
+    }
+  }
+}
+
+}  // namespace
+
+DisplayList::DisplayList(std::vector<uint8_t> storage,
+                         std::vector<SkRect> draw_bounds,
+                         std::vector<SkPaint> paints,
+                         std::vector<SkPath> paths,
+                         std::vector<sk_sp<SkRefCnt>> refs,
+                         std::vector<sk_sp<SkTextBlob>> text_blobs,
+                         std::vector<sk_sp<SkVertices>> vertices,
+                         const SkRect& bounds,
+                         int op_count,
+                         bool can_apply_group_opacity)
+    : storage_(std::move(storage)),
+      draw_bounds_(std::move(draw_bounds)),
+      paints_(std::move(paints)),
+      paths_(std::move(paths)),
+      refs_(std::move(refs)),
+      text_blobs_(std::move(text_blobs)),
+      vertices_(std::move(vertices)),
+      bounds_(bounds),
+      unique_id_(NextDisplayListUniqueID()),
+      op_count_(op_count),
+      can_apply_group_opacity_(can_apply_group_opacity) {}
+
+DisplayList::~DisplayList() = default;
+
+void DisplayList::RenderTo(SkCanvas* canvas, SkScalar opacity) const {
+  FML_DCHECK(opacity >= SK_Scalar1 || can_apply_group_opacity_);
+  SkAutoCanvasRestore auto_restore(canvas, true);
+  DisplayListRenderer renderer(canvas, paints_, paths_, draw_bounds_, bounds_,
+                               opacity);
+  const uint8_t* ptr = storage_.data();
+  const uint8_t* end = ptr + storage_.size();
+  while (ptr < end) {
+    const auto* op = reinterpret_cast<const DisplayListOp*>(ptr);
+    switch (op->type) {
+#define DISPLAY_LIST_OP_RENDER(name)                       \
+  case DisplayListOpType::k##name:                         \
+    renderer.Render(*static_cast<const name##Op*>(op));    \
+    break;
+      FOR_EACH_DISPLAY_LIST_OP(DISPLAY_LIST_OP_RENDER)
+#undef DISPLAY_LIST_OP_RENDER
+    }
+    ptr += op->size;
+  }
+}
+
+sk_sp<SkPicture> DisplayList::ToSkPicture() const {
+  SkPictureRecorder recorder;
+  RenderTo(recorder.beginRecording(bounds_));
+  return recorder.finishRecordingAsPicture();
+}
+
+size_t DisplayList::bytes() const {
+  return sizeof(DisplayList) + storage_.capacity() +
+         draw_bounds_.capacity() * sizeof(SkRect) +
+         paints_.capacity() * sizeof(SkPaint) +
+         paths_.capacity() * sizeof(SkPath) +
+         refs_.capacity() * sizeof(sk_sp<SkRefCnt>) +
+         text_blobs_.capacity() * sizeof(sk_sp<SkTextBlob>) +
+         vertices_.capacity() * sizeof(sk_sp<SkVertices>);
+}
+
+bool DisplayList::Equals(const DisplayList& other) const {
+  if (this == &other) {
+    return true;
+  }
+  return storage_.size() == other.storage_.size() &&
+         memcmp(storage_.data(), other.storage_.data(), storage_.size()) ==
+             0 &&
+         paints_ == other.paints_ && paths_ == other.paths_;
+}
+
+size_t DisplayList::content_hash() const {
+  size_t hash = content_hash_.load(std::memory_order_relaxed);
+  if (hash != 0) {
+    return hash;
+  }
+  hash = fml::HashCombine(std::string_view(
+      reinterpret_cast<const char*>(storage_.data()), storage_.size()));
+  for (const SkPaint& paint : paints_) {
+    HashPaint(hash, paint);
+  }
+  for (const SkPath& path : paths_) {
+    HashPath(hash, path);
+  }
+  // Zero means that the hash was not computed yet.
+  if (hash == 0) {
+    hash = 1;
+  }
+  content_hash_.store(hash, std::memory_order_relaxed);
+  return hash;
+}
+
+DisplayListBuilder::DisplayListBuilder(const SkRect& bounds)
+    : cull_rect_(bounds) {
+  save_stack_.push_back({SkMatrix::I(), false});
+}
+
+DisplayListBuilder::~DisplayListBuilder() = default;
+
+template <typename Op, typename... Args>
+Op* DisplayListBuilder::Push(size_t extra_bytes, Args&&... args) {
+  const size_t size = AlignOpSize(sizeof(Op) + extra_bytes);
+  const size_t offset = storage_.size();
+  // Zero filled, so that the padding of operations is the same in all
+  // display lists.
+  storage_.resize(offset + size);
+  Op* op = new (storage_.data() + offset) Op(std::forward<Args>(args)...);
+  op->type = Op::kType;
+  op->size = static_cast<uint32_t>(size);
+  op_count_++;
+  return op;
+}
+
+uint32_t DisplayListBuilder::AddPaint(const SkPaint& paint) {
+  // Successive draws often use the same paint, e.g. text and the shapes of a
+  // widget, so only the last paint is compared.
+  if (paints_.empty() || !(paints_.back() == paint)) {
+    paints_.push_back(paint);
+  }
+  return static_cast<uint32_t>(paints_.size() - 1);
+}
+
+uint32_t DisplayListBuilder::AddOptionalPaint(const SkPaint* paint) {
+  return paint ? AddPaint(*paint) : kNoPaint;
+}
+
+uint32_t DisplayListBuilder::AddPath(const SkPath& path) {
+  paths_.push_back(path);
+  return static_cast<uint32_t>(paths_.size() - 1);
+}
+
+template <typename T>
+const T* DisplayListBuilder::AddRef(const T* object) {
+  if (object) {
+    refs_.push_back(sk_ref_sp(object));
+  }
+  return object;
+}
+
+template <>
+const SkTextBlob* DisplayListBuilder::AddRef(const SkTextBlob* blob) {
+  text_blobs_.push_back(sk_ref_sp(blob));
+  return blob;
+}
+
+template <>
+const SkVertices* DisplayListBuilder::AddRef(const SkVertices* vertices) {
+  vertices_.push_back(sk_ref_sp(vertices));
+  return vertices;
+}
+
+void DisplayListBuilder::AccumulateBounds(const SkRect& bounds,
+                                          const SkPaint* paint) {
+  if (!paint) {
+    AccumulateDeviceBounds(save_stack_.back().matrix.mapRect(bounds));
+    return;
+  }
+  if (!paint->canComputeFastBounds()) {
+    AccumulateUnbounded();
+    return;
+  }
+  SkRect storage;
+  AccumulateDeviceBounds(save_stack_.back().matrix.mapRect(
+      paint->computeFastBounds(bounds, &storage)));
+}
+
+void DisplayListBuilder::AccumulateStrokeBounds(const SkRect& bounds,
+                                                const SkPaint& paint) {
+  if (!paint.canComputeFastBounds()) {
+    AccumulateUnbounded();
+    return;
+  }
+  SkRect storage;
+  AccumulateDeviceBounds(save_stack_.back().matrix.mapRect(
+      paint.computeFastStrokeBounds(bounds, &storage)));
+}
+
+void DisplayListBuilder::AccumulateUnbounded() {
+  draw_bounds_.push_back(kUnbounded);
+  JoinContentBounds(cull_rect_);
+}
+
+void DisplayListBuilder::AccumulateDeviceBounds(const SkRect& device_bounds) {
+  if (save_stack_.back().is_unbounded ||
+      save_stack_.back().matrix.hasPerspective() || !device_bounds.isFinite()) {
+    AccumulateUnbounded();
+    return;
+  }
+  draw_bounds_.push_back(device_bounds);
+  JoinContentBounds(device_bounds);
+}
+
+void DisplayListBuilder::JoinContentBounds(const SkRect& bounds) {
+  if (has_content_) {
+    content_bounds_.joinPossiblyEmptyRect(bounds);
+  } else {
+    content_bounds_ = bounds;
+    has_content_ = true;
+  }
+}
+
+void DisplayListBuilder::CheckGroupOpacity(const SkPaint* paint) {
+  CheckGroupOpacity(!paint ||
+                    (paint->getBlendMode() == SkBlendMode::kSrcOver &&
+                     !paint->getColorFilter() && !paint->getImageFilter()));
+}
+
+void DisplayListBuilder::CheckGroupOpacity(bool compatible) {
+  draw_count_++;
+  group_opacity_compatible_ =
+      group_opacity_compatible_ && compatible && draw_count_ <= 1;
+}
+
+void DisplayListBuilder::save() {
+  Push<SaveOp>(0);
+  save_stack_.push_back(save_stack_.back());
+}
+
+void DisplayListBuilder::saveLayer(const SkRect* bounds,
+                                   const SkPaint* paint,
+                                   const SkImageFilter* backdrop,
+                                   SkCanvas::SaveLayerFlags flags) {
+  // The draws can't be culled if the layer moves them or draws outside of
+  // them when it is restored.
+  bool is_unbounded = save_stack_.back().is_unbounded || backdrop;
+  if (paint) {
+    const SkColorFilter* color_filter = paint->getColorFilter();
+    is_unbounded = is_unbounded || paint->getImageFilter() ||
+                   paint->getBlendMode() != SkBlendMode::kSrcOver ||
+                   (color_filter && color_filter->filterColor(
+                                        SK_ColorTRANSPARENT) !=
+                                        SK_ColorTRANSPARENT);
+  }
+  if (is_unbounded) {
+    JoinContentBounds(cull_rect_);
+  }
+  Push<SaveLayerOp>(0, AddRef(backdrop), bounds, AddOptionalPaint(paint),
+                    flags);
+  save_stack_.push_back({save_stack_.back().matrix, is_unbounded});
+  group_opacity_compatible_ = false;
+}
+
+void DisplayListBuilder::restore() {
+  if (save_stack_.size() <= 1) {
+    return;
+  }
+  Push<RestoreOp>(0);
+  save_stack_.pop_back();
+}
+
+void DisplayListBuilder::translate(SkScalar dx, SkScalar dy) {
+  Push<TranslateOp>(0, dx, dy);
+  save_stack_.back().matrix.preTranslate(dx, dy);
+}
+
+void DisplayListBuilder::scale(SkScalar sx, SkScalar sy) {
+  Push<ScaleOp>(0, sx, sy);
+  save_stack_.back().matrix.preScale(sx, sy);
+}
+
+void DisplayListBuilder::rotate(SkScalar degrees) {
+  Push<RotateOp>(0, degrees);
+  save_stack_.back().matrix.preRotate(degrees);
+}
+
+void DisplayListBuilder::skew(SkScalar sx, SkScalar sy) {
+  Push<SkewOp>(0, sx, sy);
+  save_stack_.back().matrix.preSkew(sx, sy);
+}
+
+void DisplayListBuilder::transform(const SkMatrix& matrix) {
+  Push<ConcatOp>(0, matrix);
+  save_stack_.back().matrix.preConcat(matrix);
+}
+
+void DisplayListBuilder::transform(const SkM44& matrix) {
+  Push<Concat44Op>(0, matrix);
+  // Draws are at z = 0, so the third row and column don't affect their
+  // bounds.
+  save_stack_.back().matrix.preConcat(matrix.asM33());
+}
+
+void DisplayListBuilder::setMatrix(const SkMatrix& matrix) {
+  Push<SetMatrixOp>(0, matrix);
+  save_stack_.back().matrix = matrix;
+}
+
+void DisplayListBuilder::clipRect(const SkRect& rect,
+                                  SkClipOp clip_op,
+                                  bool is_aa) {
+  Push<ClipRectOp>(0, rect, clip_op, is_aa);
+}
+
+void DisplayListBuilder::clipRRect(const SkRRect& rrect,
+                                   SkClipOp clip_op,
+                                   bool is_aa) {
+  Push<ClipRRectOp>(0, rrect, clip_op, is_aa);
+}
+
+void DisplayListBuilder::clipPath(const SkPath& path,
+                                  SkClipOp clip_op,
+                                  bool is_aa) {
+  Push<ClipPathOp>(0, AddPath(path), clip_op, is_aa);
+}
+
+void DisplayListBuilder::drawPaint(const SkPaint& paint) {
+  Push<DrawPaintOp>(0, AddPaint(paint));
+  AccumulateUnbounded();
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawColor(SkColor color, SkBlendMode mode) {
+  Push<DrawColorOp>(0, color, mode);
+  AccumulateUnbounded();
+  CheckGroupOpacity(mode == SkBlendMode::kSrcOver);
+}
+
+void DisplayListBuilder::drawLine(const SkPoint& p0,
+                                  const SkPoint& p1,
+                                  const SkPaint& paint) {
+  Push<DrawLineOp>(0, p0, p1, AddPaint(paint));
+  SkRect bounds;
+  bounds.set(p0, p1);
+  AccumulateStrokeBounds(bounds, paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawRect(const SkRect& rect, const SkPaint& paint) {
+  Push<DrawRectOp>(0, rect, AddPaint(paint));
+  AccumulateBounds(rect.makeSorted(), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawOval(const SkRect& bounds, const SkPaint& paint) {
+  Push<DrawOvalOp>(0, bounds, AddPaint(paint));
+  AccumulateBounds(bounds.makeSorted(), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawCircle(const SkPoint& center,
+                                    SkScalar radius,
+                                    const SkPaint& paint) {
+  Push<DrawCircleOp>(0, center, radius, AddPaint(paint));
+  AccumulateBounds(SkRect::MakeLTRB(center.fX - radius, center.fY - radius,
+                                    center.fX + radius, center.fY + radius)
+                       .makeSorted(),
+                   &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawRRect(const SkRRect& rrect,
+                                   const SkPaint& paint) {
+  Push<DrawRRectOp>(0, rrect, AddPaint(paint));
+  AccumulateBounds(rrect.getBounds(), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawDRRect(const SkRRect& outer,
+                                    const SkRRect& inner,
+                                    const SkPaint& paint) {
+  Push<DrawDRRectOp>(0, outer, inner, AddPaint(paint));
+  AccumulateBounds(outer.getBounds(), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawArc(const SkRect& bounds,
+                                 SkScalar start_degrees,
+                                 SkScalar sweep_degrees,
+                                 bool use_center,
+                                 const SkPaint& paint) {
+  Push<DrawArcOp>(0, bounds, start_degrees, sweep_degrees, use_center,
+                  AddPaint(paint));
+  AccumulateBounds(bounds.makeSorted(), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawPath(const SkPath& path, const SkPaint& paint) {
+  Push<DrawPathOp>(0, AddPath(path), AddPaint(paint));
+  if (path.isInverseFillType()) {
+    AccumulateUnbounded();
+  } else {
+    AccumulateBounds(path.getBounds(), &paint);
+  }
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawPoints(SkCanvas::PointMode mode,
+                                    size_t count,
+                                    const SkPoint points[],
+                                    const SkPaint& paint) {
+  if (count == 0) {
+    return;
+  }
+  auto* op = Push<DrawPointsOp>(count * sizeof(SkPoint), mode,
+                                static_cast<uint32_t>(count), AddPaint(paint));
+  memcpy(op + 1, points, count * sizeof(SkPoint));
+  SkRect bounds;
+  bounds.setBounds(points, static_cast<int>(count));
+  AccumulateStrokeBounds(bounds, paint);
+  // The lines of a polygon overlap where they join.
+  CheckGroupOpacity(false);
+}
+
+void DisplayListBuilder::drawVertices(const SkVertices* vertices,
+                                      SkBlendMode mode,
+                                      const SkPaint& paint) {
+  Push<DrawVerticesOp>(0, AddRef(vertices), mode, AddPaint(paint));
+  AccumulateBounds(vertices->bounds(), &paint);
+  // Triangles can overlap.
+  CheckGroupOpacity(false);
+}
+
+void DisplayListBuilder::drawImage(const SkImage* image,
+                                   const SkPoint& point,
+                                   const SkPaint* paint) {
+  Push<DrawImageOp>(0, AddRef(image), point, AddOptionalPaint(paint));
+  AccumulateBounds(
+      SkRect::MakeXYWH(point.fX, point.fY, image->width(), image->height()),
+      paint);
+  CheckGroupOpacity(paint);
+}
+
+void DisplayListBuilder::drawImageRect(const SkImage* image,
+                                       const SkRect& src,
+                                       const SkRect& dst,
+                                       const SkPaint* paint,
+                                       SkCanvas::SrcRectConstraint constraint) {
+  Push<DrawImageRectOp>(0, AddRef(image), src, dst, AddOptionalPaint(paint),
+                        constraint);
+  AccumulateBounds(dst.makeSorted(), paint);
+  CheckGroupOpacity(paint);
+}
+
+void DisplayListBuilder::drawImageNine(const SkImage* image,
+                                       const SkIRect& center,
+                                       const SkRect& dst,
+                                       const SkPaint* paint) {
+  Push<DrawImageNineOp>(0, AddRef(image), center, dst,
+                        AddOptionalPaint(paint));
+  AccumulateBounds(dst.makeSorted(), paint);
+  CheckGroupOpacity(paint);
+}
+
+void DisplayListBuilder::drawAtlas(const SkImage* atlas,
+                                   const SkRSXform xform[],
+                                   const SkRect tex[],
+                                   const SkColor colors[],
+                                   int count,
+                                   SkBlendMode mode,
+                                   const SkRect* cull_rect,
+                                   const SkPaint* paint) {
+  if (count <= 0) {
+    return;
+  }
+  const size_t extra_bytes =
+      count * (sizeof(SkRSXform) + sizeof(SkRect) +
+               (colors ? sizeof(SkColor) : 0));
+  auto* op = Push<DrawAtlasOp>(extra_bytes, AddRef(atlas),
+                               static_cast<uint32_t>(count), mode,
+                               colors != nullptr, cull_rect,
+                               AddOptionalPaint(paint));
+  memcpy(op->xforms(), xform, count * sizeof(SkRSXform));
+  memcpy(op->tex(), tex, count * sizeof(SkRect));
+  if (colors) {
+    memcpy(op->colors(), colors, count * sizeof(SkColor));
+  }
+  if (cull_rect) {
+    AccumulateBounds(*cull_rect, paint);
+  } else {
+    SkRect bounds = SkRect::MakeEmpty();
+    for (int i = 0; i < count; i++) {
+      SkPoint quad[4];
+      xform[i].toQuad(tex[i].width(), tex[i].height(), quad);
+      SkRect quad_bounds;
+      quad_bounds.setBounds(quad, 4);
+      bounds.joinPossiblyEmptyRect(quad_bounds);
+    }
+    AccumulateBounds(bounds, paint);
+  }
+  // Sprites can overlap.
+  CheckGroupOpacity(false);
+}
+
+void DisplayListBuilder::drawPicture(const SkPicture* picture,
+                                     const SkMatrix* matrix,
+                                     const SkPaint* paint) {
+  Push<DrawPictureOp>(0, AddRef(picture), matrix, AddOptionalPaint(paint));
+  op_count_ += picture->approximateOpCount();
+  SkRect bounds = picture->cullRect();
+  if (matrix) {
+    bounds = matrix->mapRect(bounds);
+  }
+  AccumulateBounds(bounds, paint);
+  CheckGroupOpacity(false);
+}
+
+void DisplayListBuilder::drawDisplayList(const DisplayList* display_list) {
+  Push<DrawDisplayListOp>(0, AddRef(display_list));
+  op_count_ += display_list->op_count();
+  AccumulateBounds(display_list->bounds(), nullptr);
+  CheckGroupOpacity(false);
+}
+
+void DisplayListBuilder::drawTextBlob(const SkTextBlob* blob,
+                                      SkScalar x,
+                                      SkScalar y,
+                                      const SkPaint& paint) {
+  Push<DrawTextBlobOp>(0, AddRef(blob), x, y, AddPaint(paint));
+  AccumulateBounds(blob->bounds().makeOffset(x, y), &paint);
+  CheckGroupOpacity(&paint);
+}
+
+void DisplayListBuilder::drawShadow(const SkPath& path,
+                                    SkColor color,
+                                    SkScalar elevation,
+                                    bool transparent_occluder,
+                                    SkScalar device_pixel_ratio) {
+  Push<DrawShadowOp>(0, AddPath(path), color, elevation, transparent_occluder,
+                     device_pixel_ratio);
+  AccumulateBounds(PhysicalShapeLayer::ComputeShadowBounds(
+                       path.getBounds(), elevation, device_pixel_ratio),
+                   nullptr);
+  CheckGroupOpacity(false);
+}
+
+sk_sp<DisplayList> DisplayListBuilder::Build() {
+  SkRect bounds = SkRect::MakeEmpty();
+  if (has_content_) {
+    // Not SkRect::intersect, which fails for empty rects, so that hairlines
+    // keep their bounds.
+    bounds = SkRect::MakeLTRB(
+        std::max(content_bounds_.fLeft, cull_rect_.fLeft),
+        std::max(content_bounds_.fTop, cull_rect_.fTop),
+        std::min(content_bounds_.fRight, cull_rect_.fRight),
+        std::min(content_bounds_.fBottom, cull_rect_.fBottom));
+    if (bounds.fLeft > bounds.fRight || bounds.fTop > bounds.fBottom) {
+      bounds.setEmpty();
+    }
+  }
+  return sk_sp<DisplayList>(new DisplayList(
+      std::move(storage_), std::move(draw_bounds_), std::move(paints_),
+      std::move(paths_), std::move(refs_), std::move(text_blobs_),
+      std::move(vertices_), bounds, op_count_,
+      group_opacity_compatible_ && draw_count_ <= 1));
+}
+
+}  // namespace flutter
@@ -0,0 +1,268 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkBlendMode.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkM44.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+#include "third_party/skia/include/core/SkVertices.h"
+
+namespace flutter {
+
+// A recording of drawing operations in an engine owned format. The framework
+// records display lists through Canvas and the raster thread draws them to
+// an SkCanvas.
+//
+// Compared to an SkPicture recorded with an R-tree, a display list is
+// recorded by copying each operation into a single buffer without going
+// through the virtual calls of a recording SkCanvas, and consecutive draws
+// with the same paint share it. Playback skips the draws outside of the clip
+// using bounds computed while recording. The operations can be compared
+// across frames, see Equals.
+//
+// Display lists are immutable, so they can be drawn on any thread.
+class DisplayList : public SkRefCnt {
+ public:
+  ~DisplayList() override;
+
+  // Draws the operations to |canvas|, skipping the draws outside of its
+  // clip. The alpha of every draw is multiplied by |opacity|, which must be
+  // 1 unless can_apply_group_opacity().
+  void RenderTo(SkCanvas* canvas, SkScalar opacity = SK_Scalar1) const;
+
+  // Records the operations into an SkPicture, for the Skia APIs that only
+  // take pictures (e.g. SkPictureImageFilter).
+  sk_sp<SkPicture> ToSkPicture() const;
+
+  // The bounds of the draws, limited to the bounds given to the builder.
+  const SkRect& bounds() const { return bounds_; }
+
+  // Unique among the display lists of the process, like
+  // SkPicture::uniqueID.
+  uint32_t unique_id() const { return unique_id_; }
+
+  // The number of operations, including those of nested display lists.
+  int op_count() const { return op_count_; }
+
+  // An estimate of the memory used by the display list, excluding the images
+  // and other objects that it references.
+  size_t bytes() const;
+
+  // Whether RenderTo can apply an opacity to the draws, which is the case if
+  // there is at most one draw, blending with source-over, without filters
+  // and outside of any saveLayer.
+  bool can_apply_group_opacity() const { return can_apply_group_opacity_; }
+
+  // Whether |other| has the same operations with the same paints. The
+  // images, text blobs and other objects that operations reference are
+  // compared by identity.
+  bool Equals(const DisplayList& other) const;
+
+  // A hash of the operations, which is equal for display lists that are
+  // Equals.
+  size_t content_hash() const;
+
+ private:
+  friend class DisplayListBuilder;
+
+  DisplayList(std::vector<uint8_t> storage,
+              std::vector<SkRect> draw_bounds,
+              std::vector<SkPaint> paints,
+              std::vector<SkPath> paths,
+              std::vector<sk_sp<SkRefCnt>> refs,
+              std::vector<sk_sp<SkTextBlob>> text_blobs,
+              std::vector<sk_sp<SkVertices>> vertices,
+              const SkRect& bounds,
+              int op_count,
+              bool can_apply_group_opacity);
+
+  // The operations, each starting with its type and size.
+  const std::vector<uint8_t> storage_;
+  // The bounds of each draw operation in order, in the coordinates of the
+  // display list.
+  const std::vector<SkRect> draw_bounds_;
+  const std::vector<SkPaint> paints_;
+  const std::vector<SkPath> paths_;
+  // Keep the objects alive that the operations reference by pointer.
+  const std::vector<sk_sp<SkRefCnt>> refs_;
+  const std::vector<sk_sp<SkTextBlob>> text_blobs_;
+  const std::vector<sk_sp<SkVertices>> vertices_;
+  const SkRect bounds_;
+  const uint32_t unique_id_;
+  const int op_count_;
+  const bool can_apply_group_opacity_;
+  // Computed on first use, zero until then.
+  mutable std::atomic<size_t> content_hash_{0};
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayList);
+};
+
+// Records a DisplayList. The methods match those of SkCanvas, which records
+// the same draws when the display list is rendered to it.
+class DisplayListBuilder {
+ public:
+  // |bounds| limits the draws, like the bounds given to
+  // SkPictureRecorder::beginRecording.
+  explicit DisplayListBuilder(const SkRect& bounds);
+
+  ~DisplayListBuilder();
+
+  void save();
+  void saveLayer(const SkRect* bounds,
+                 const SkPaint* paint,
+                 const SkImageFilter* backdrop = nullptr,
+                 SkCanvas::SaveLayerFlags flags = 0);
+  // Like SkCanvas::restore, this does nothing without a matching save.
+  void restore();
+  int getSaveCount() const { return static_cast<int>(save_stack_.size()); }
+
+  void translate(SkScalar dx, SkScalar dy);
+  void scale(SkScalar sx, SkScalar sy);
+  void rotate(SkScalar degrees);
+  void skew(SkScalar sx, SkScalar sy);
+  void transform(const SkMatrix& matrix);
+  void transform(const SkM44& matrix);
+  // Replaces the transform, relative to the one of the canvas that the
+  // display list is drawn to.
+  void setMatrix(const SkMatrix& matrix);
+
+  void clipRect(const SkRect& rect, SkClipOp clip_op, bool is_aa);
+  void clipRRect(const SkRRect& rrect, SkClipOp clip_op, bool is_aa);
+  void clipPath(const SkPath& path, SkClipOp clip_op, bool is_aa);
+
+  void drawPaint(const SkPaint& paint);
+  void drawColor(SkColor color, SkBlendMode mode);
+  void drawLine(const SkPoint& p0, const SkPoint& p1, const SkPaint& paint);
+  void drawRect(const SkRect& rect, const SkPaint& paint);
+  void drawOval(const SkRect& bounds, const SkPaint& paint);
+  void drawCircle(const SkPoint& center,
+                  SkScalar radius,
+                  const SkPaint& paint);
+  void drawRRect(const SkRRect& rrect, const SkPaint& paint);
+  void drawDRRect(const SkRRect& outer,
+                  const SkRRect& inner,
+                  const SkPaint& paint);
+  void drawArc(const SkRect& bounds,
+               SkScalar start_degrees,
+               SkScalar sweep_degrees,
+               bool use_center,
+               const SkPaint& paint);
+  void drawPath(const SkPath& path, const SkPaint& paint);
+  void drawPoints(SkCanvas::PointMode mode,
+                  size_t count,
+                  const SkPoint points[],
+                  const SkPaint& paint);
+  void drawVertices(const SkVertices* vertices,
+                    SkBlendMode mode,
+                    const SkPaint& paint);
+  void drawImage(const SkImage* image,
+                 const SkPoint& point,
+                 const SkPaint* paint);
+  void drawImageRect(const SkImage* image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkPaint* paint,
+                     SkCanvas::SrcRectConstraint constraint);
+  void drawImageNine(const SkImage* image,
+                     const SkIRect& center,
+                     const SkRect& dst,
+                     const SkPaint* paint);
+  void drawAtlas(const SkImage* atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkRect* cull_rect,
+                 const SkPaint* paint);
+  void drawPicture(const SkPicture* picture,
+                   const SkMatrix* matrix,
+                   const SkPaint* paint);
+  void drawDisplayList(const DisplayList* display_list);
+  void drawTextBlob(const SkTextBlob* blob,
+                    SkScalar x,
+                    SkScalar y,
+                    const SkPaint& paint);
+  // Draws the shadow of a physical shape, see PhysicalShapeLayer::DrawShadow.
+  void drawShadow(const SkPath& path,
+                  SkColor color,
+                  SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar device_pixel_ratio);
+
+  // Returns the display list of the recorded operations. The builder must not
+  // be used afterwards.
+  sk_sp<DisplayList> Build();
+
+ private:
+  struct SaveInfo {
+    SkMatrix matrix;
+    // Whether the draws can't be culled by their bounds, e.g. because they
+    // are in a saveLayer with an image filter that moves them.
+    bool is_unbounded;
+  };
+
+  // Appends an operation with |extra_bytes| of trailing data and returns it.
+  template <typename Op, typename... Args>
+  Op* Push(size_t extra_bytes, Args&&... args);
+
+  uint32_t AddPaint(const SkPaint& paint);
+  uint32_t AddOptionalPaint(const SkPaint* paint);
+  uint32_t AddPath(const SkPath& path);
+  // Returns |object| after keeping a reference to it.
+  template <typename T>
+  const T* AddRef(const T* object);
+
+  // Records the bounds of a draw. |bounds| is in the current coordinates and
+  // doesn't include the effects of the paint.
+  void AccumulateBounds(const SkRect& bounds, const SkPaint* paint);
+  void AccumulateStrokeBounds(const SkRect& bounds, const SkPaint& paint);
+  void AccumulateUnbounded();
+  void AccumulateDeviceBounds(const SkRect& device_bounds);
+  void JoinContentBounds(const SkRect& bounds);
+
+  // Notes a draw with |paint| for can_apply_group_opacity.
+  void CheckGroupOpacity(const SkPaint* paint);
+  void CheckGroupOpacity(bool compatible);
+
+  const SkRect cull_rect_;
+  std::vector<uint8_t> storage_;
+  std::vector<SkRect> draw_bounds_;
+  std::vector<SkPaint> paints_;
+  std::vector<SkPath> paths_;
+  std::vector<sk_sp<SkRefCnt>> refs_;
+  std::vector<sk_sp<SkTextBlob>> text_blobs_;
+  std::vector<sk_sp<SkVertices>> vertices_;
+  // The state of the current save, and the ones that restore goes back to.
+  std::vector<SaveInfo> save_stack_;
+  SkRect content_bounds_ = SkRect::MakeEmpty();
+  bool has_content_ = false;
+  int op_count_ = 0;
+  int draw_count_ = 0;
+  bool group_opacity_compatible_ = true;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListBuilder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_H_
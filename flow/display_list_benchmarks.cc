@@ -0,0 +1,160 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <functional>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/display_list.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kSize = 512;
+
+// Draws a grid of |count| cells, which alternate between a few paints like
+// the widgets of a list do.
+template <typename Canvas>
+void DrawGrid(Canvas* canvas,
+              int count,
+              const std::function<void(Canvas*, const SkRect&, int)>& draw) {
+  int columns = 1;
+  while (columns * columns < count) {
+    columns++;
+  }
+  const SkScalar cell_size = static_cast<SkScalar>(kSize) / columns;
+  for (int i = 0; i < count; i++) {
+    const SkRect cell =
+        SkRect::MakeXYWH((i % columns) * cell_size, (i / columns) * cell_size,
+                         cell_size, cell_size)
+            .makeInset(1, 1);
+    draw(canvas, cell, i);
+  }
+}
+
+SkPaint GetCellPaint(int index) {
+  static const SkColor kColors[] = {SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE};
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setColor(kColors[(index / 4) % 3]);
+  return paint;
+}
+
+void DrawCell(SkCanvas* canvas, const SkRect& cell, int index) {
+  SkPaint paint = GetCellPaint(index);
+  canvas->save();
+  canvas->translate(cell.x(), cell.y());
+  canvas->drawRect(SkRect::MakeWH(cell.width(), cell.height() / 2), paint);
+  canvas->drawCircle(cell.width() / 2, cell.height() * 3 / 4,
+                     cell.height() / 4, paint);
+  canvas->restore();
+}
+
+void DrawCell(DisplayListBuilder* builder, const SkRect& cell, int index) {
+  SkPaint paint = GetCellPaint(index);
+  builder->save();
+  builder->translate(cell.x(), cell.y());
+  builder->drawRect(SkRect::MakeWH(cell.width(), cell.height() / 2), paint);
+  builder->drawCircle(
+      SkPoint::Make(cell.width() / 2, cell.height() * 3 / 4),
+      cell.height() / 4, paint);
+  builder->restore();
+}
+
+sk_sp<SkPicture> RecordPicture(int count) {
+  SkRTreeFactory rtree_factory;
+  SkPictureRecorder recorder;
+  SkCanvas* canvas =
+      recorder.beginRecording(SkRect::MakeWH(kSize, kSize), &rtree_factory);
+  DrawGrid<SkCanvas>(canvas, count,
+                     [](SkCanvas* canvas, const SkRect& cell, int index) {
+                       DrawCell(canvas, cell, index);
+                     });
+  return recorder.finishRecordingAsPicture();
+}
+
+sk_sp<DisplayList> RecordDisplayList(int count) {
+  DisplayListBuilder builder(SkRect::MakeWH(kSize, kSize));
+  DrawGrid<DisplayListBuilder>(
+      &builder, count,
+      [](DisplayListBuilder* builder, const SkRect& cell, int index) {
+        DrawCell(builder, cell, index);
+      });
+  return builder.Build();
+}
+
+// A quarter of the canvas when |clipped|, like a partial repaint.
+sk_sp<SkSurface> MakeSurface(bool clipped) {
+  auto surface = SkSurface::MakeRasterN32Premul(kSize, kSize);
+  if (clipped) {
+    surface->getCanvas()->clipRect(SkRect::MakeWH(kSize / 2, kSize / 2));
+  }
+  return surface;
+}
+
+}  // namespace
+
+static void BM_SkPictureRecord(benchmark::State& state) {  // NOLINT
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(RecordPicture(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_DisplayListRecord(benchmark::State& state) {  // NOLINT
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(RecordDisplayList(state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SkPicturePlayback(benchmark::State& state) {  // NOLINT
+  auto picture = RecordPicture(state.range(0));
+  auto surface = MakeSurface(state.range(1));
+  SkCanvas* canvas = surface->getCanvas();
+
+  while (state.KeepRunning()) {
+    canvas->drawPicture(picture);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetLabel(state.range(1) ? "clipped" : "full");
+}
+
+static void BM_DisplayListPlayback(benchmark::State& state) {  // NOLINT
+  auto display_list = RecordDisplayList(state.range(0));
+  auto surface = MakeSurface(state.range(1));
+  SkCanvas* canvas = surface->getCanvas();
+
+  while (state.KeepRunning()) {
+    display_list->RenderTo(canvas);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetLabel(state.range(1) ? "clipped" : "full");
+}
+
+BENCHMARK(BM_SkPictureRecord)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_DisplayListRecord)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_SkPicturePlayback)
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({256, 0})
+    ->Args({256, 1})
+    ->Args({4096, 0})
+    ->Args({4096, 1})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DisplayListPlayback)
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({256, 0})
+    ->Args({256, 1})
+    ->Args({4096, 0})
+    ->Args({4096, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
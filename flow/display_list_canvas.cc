@@ -0,0 +1,286 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_canvas.h"
+
+#include "third_party/skia/include/core/SkDrawable.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRegion.h"
+
+namespace flutter {
+
+DisplayListCanvasRecorder::DisplayListCanvasRecorder(const SkRect& bounds)
+    : SkCanvasVirtualEnforcer<SkNoDrawCanvas>(bounds.roundOut()),
+      builder_(std::make_unique<DisplayListBuilder>(bounds)) {}
+
+DisplayListCanvasRecorder::~DisplayListCanvasRecorder() = default;
+
+sk_sp<DisplayList> DisplayListCanvasRecorder::Build() {
+  return builder_->Build();
+}
+
+void DisplayListCanvasRecorder::DrawAsPicture(
+    const std::function<void(SkCanvas*)>& draw) {
+  SkPictureRecorder recorder;
+  draw(recorder.beginRecording(getLocalClipBounds()));
+  builder_->drawPicture(recorder.finishRecordingAsPicture().get(), nullptr,
+                        nullptr);
+}
+
+void DisplayListCanvasRecorder::willSave() {
+  builder_->save();
+}
+
+SkCanvas::SaveLayerStrategy DisplayListCanvasRecorder::getSaveLayerStrategy(
+    const SaveLayerRec& rec) {
+  builder_->saveLayer(rec.fBounds, rec.fPaint, rec.fBackdrop,
+                      rec.fSaveLayerFlags);
+  return kNoLayer_SaveLayerStrategy;
+}
+
+bool DisplayListCanvasRecorder::onDoSaveBehind(const SkRect* bounds) {
+  return false;
+}
+
+void DisplayListCanvasRecorder::willRestore() {
+  builder_->restore();
+}
+
+void DisplayListCanvasRecorder::didConcat(const SkMatrix& matrix) {
+  builder_->transform(matrix);
+}
+
+void DisplayListCanvasRecorder::didConcat44(const SkM44& matrix) {
+  builder_->transform(matrix);
+}
+
+void DisplayListCanvasRecorder::didScale(SkScalar sx, SkScalar sy) {
+  builder_->scale(sx, sy);
+}
+
+void DisplayListCanvasRecorder::didTranslate(SkScalar dx, SkScalar dy) {
+  builder_->translate(dx, dy);
+}
+
+void DisplayListCanvasRecorder::didSetMatrix(const SkMatrix& matrix) {
+  builder_->setMatrix(matrix);
+}
+
+void DisplayListCanvasRecorder::onClipRect(const SkRect& rect,
+                                           SkClipOp op,
+                                           ClipEdgeStyle edge_style) {
+  builder_->clipRect(rect, op, edge_style == kSoft_ClipEdgeStyle);
+  SkCanvasVirtualEnforcer<SkNoDrawCanvas>::onClipRect(rect, op, edge_style);
+}
+
+void DisplayListCanvasRecorder::onClipRRect(const SkRRect& rrect,
+                                            SkClipOp op,
+                                            ClipEdgeStyle edge_style) {
+  builder_->clipRRect(rrect, op, edge_style == kSoft_ClipEdgeStyle);
+  SkCanvasVirtualEnforcer<SkNoDrawCanvas>::onClipRRect(rrect, op, edge_style);
+}
+
+void DisplayListCanvasRecorder::onClipPath(const SkPath& path,
+                                           SkClipOp op,
+                                           ClipEdgeStyle edge_style) {
+  builder_->clipPath(path, op, edge_style == kSoft_ClipEdgeStyle);
+  SkCanvasVirtualEnforcer<SkNoDrawCanvas>::onClipPath(path, op, edge_style);
+}
+
+void DisplayListCanvasRecorder::onClipRegion(const SkRegion& device_region,
+                                             SkClipOp op) {
+  // Regions are in device coordinates, but display lists only clip in the
+  // current ones.
+  SkPath path;
+  SkMatrix inverse;
+  if (device_region.getBoundaryPath(&path) &&
+      getTotalMatrix().invert(&inverse)) {
+    path.transform(inverse);
+    builder_->clipPath(path, op, false);
+  } else {
+    builder_->clipRect(SkRect::MakeEmpty(), SkClipOp::kIntersect, false);
+  }
+  SkCanvasVirtualEnforcer<SkNoDrawCanvas>::onClipRegion(device_region, op);
+}
+
+void DisplayListCanvasRecorder::onDrawPaint(const SkPaint& paint) {
+  builder_->drawPaint(paint);
+}
+
+void DisplayListCanvasRecorder::onDrawBehind(const SkPaint& paint) {
+  // Only the Android framework draws behind, which needs a saveBehind that
+  // onDoSaveBehind doesn't record, so this is the same as drawPaint.
+  builder_->drawPaint(paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRect(const SkRect& rect,
+                                           const SkPaint& paint) {
+  builder_->drawRect(rect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRRect(const SkRRect& rrect,
+                                            const SkPaint& paint) {
+  builder_->drawRRect(rrect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawDRRect(const SkRRect& outer,
+                                             const SkRRect& inner,
+                                             const SkPaint& paint) {
+  builder_->drawDRRect(outer, inner, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawOval(const SkRect& rect,
+                                           const SkPaint& paint) {
+  builder_->drawOval(rect, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawArc(const SkRect& rect,
+                                          SkScalar start_angle,
+                                          SkScalar sweep_angle,
+                                          bool use_center,
+                                          const SkPaint& paint) {
+  builder_->drawArc(rect, start_angle, sweep_angle, use_center, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawPath(const SkPath& path,
+                                           const SkPaint& paint) {
+  builder_->drawPath(path, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawRegion(const SkRegion& region,
+                                             const SkPaint& paint) {
+  SkPath path;
+  if (region.getBoundaryPath(&path)) {
+    builder_->drawPath(path, paint);
+  }
+}
+
+void DisplayListCanvasRecorder::onDrawPoints(PointMode mode,
+                                             size_t count,
+                                             const SkPoint pts[],
+                                             const SkPaint& paint) {
+  builder_->drawPoints(mode, count, pts, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawTextBlob(const SkTextBlob* blob,
+                                               SkScalar x,
+                                               SkScalar y,
+                                               const SkPaint& paint) {
+  builder_->drawTextBlob(blob, x, y, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawPatch(const SkPoint cubics[12],
+                                            const SkColor colors[4],
+                                            const SkPoint tex_coords[4],
+                                            SkBlendMode mode,
+                                            const SkPaint& paint) {
+  DrawAsPicture([&](SkCanvas* canvas) {
+    canvas->drawPatch(cubics, colors, tex_coords, mode, paint);
+  });
+}
+
+void DisplayListCanvasRecorder::onDrawImage(const SkImage* image,
+                                            SkScalar left,
+                                            SkScalar top,
+                                            const SkPaint* paint) {
+  builder_->drawImage(image, SkPoint::Make(left, top), paint);
+}
+
+void DisplayListCanvasRecorder::onDrawImageRect(
+    const SkImage* image,
+    const SkRect* src,
+    const SkRect& dst,
+    const SkPaint* paint,
+    SrcRectConstraint constraint) {
+  builder_->drawImageRect(image,
+                          src ? *src : SkRect::Make(image->bounds()), dst,
+                          paint, constraint);
+}
+
+void DisplayListCanvasRecorder::onDrawImageNine(const SkImage* image,
+                                                const SkIRect& center,
+                                                const SkRect& dst,
+                                                const SkPaint* paint) {
+  builder_->drawImageNine(image, center, dst, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawImageLattice(const SkImage* image,
+                                                   const Lattice& lattice,
+                                                   const SkRect& dst,
+                                                   const SkPaint* paint) {
+  DrawAsPicture([&](SkCanvas* canvas) {
+    canvas->drawImageLattice(image, lattice, dst, paint);
+  });
+}
+
+void DisplayListCanvasRecorder::onDrawVerticesObject(const SkVertices* vertices,
+                                                     SkBlendMode mode,
+                                                     const SkPaint& paint) {
+  builder_->drawVertices(vertices, mode, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawAtlas(const SkImage* atlas,
+                                            const SkRSXform xform[],
+                                            const SkRect tex[],
+                                            const SkColor colors[],
+                                            int count,
+                                            SkBlendMode mode,
+                                            const SkRect* cull_rect,
+                                            const SkPaint* paint) {
+  builder_->drawAtlas(atlas, xform, tex, colors, count, mode, cull_rect,
+                      paint);
+}
+
+void DisplayListCanvasRecorder::onDrawShadowRec(const SkPath& path,
+                                                const SkDrawShadowRec& rec) {
+  DrawAsPicture([&](SkCanvas* canvas) {
+    canvas->private_draw_shadow_rec(path, rec);
+  });
+}
+
+void DisplayListCanvasRecorder::onDrawPicture(const SkPicture* picture,
+                                              const SkMatrix* matrix,
+                                              const SkPaint* paint) {
+  builder_->drawPicture(picture, matrix, paint);
+}
+
+void DisplayListCanvasRecorder::onDrawDrawable(SkDrawable* drawable,
+                                               const SkMatrix* matrix) {
+  sk_sp<SkPicture> picture = drawable->newPictureSnapshot();
+  if (picture) {
+    builder_->drawPicture(picture.get(), matrix, nullptr);
+  }
+}
+
+void DisplayListCanvasRecorder::onDrawAnnotation(const SkRect& rect,
+                                                 const char key[],
+                                                 SkData* value) {
+  // Annotations are only used by document backends, which don't draw
+  // display lists.
+}
+
+void DisplayListCanvasRecorder::onDrawEdgeAAQuad(const SkRect& rect,
+                                                 const SkPoint clip[4],
+                                                 SkCanvas::QuadAAFlags aa,
+                                                 const SkColor4f& color,
+                                                 SkBlendMode mode) {
+  DrawAsPicture([&](SkCanvas* canvas) {
+    canvas->experimental_DrawEdgeAAQuad(rect, clip, aa, color, mode);
+  });
+}
+
+void DisplayListCanvasRecorder::onDrawEdgeAAImageSet(
+    const ImageSetEntry set[],
+    int count,
+    const SkPoint dst_clips[],
+    const SkMatrix pre_view_matrices[],
+    const SkPaint* paint,
+    SrcRectConstraint constraint) {
+  DrawAsPicture([&](SkCanvas* canvas) {
+    canvas->experimental_DrawEdgeAAImageSet(
+        set, count, dst_clips, pre_view_matrices, paint, constraint);
+  });
+}
+
+}  // namespace flutter
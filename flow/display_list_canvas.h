@@ -0,0 +1,203 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
+
+#include <functional>
+#include <memory>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkCanvasVirtualEnforcer.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+// An SkCanvas that records the calls made to it into a DisplayList, for the
+// code that draws to an SkCanvas, like paragraphs. The state of the canvas
+// is kept, so that it can be queried like that of a recording canvas.
+//
+// Calls can also be made to the builder directly, which skips the SkCanvas,
+// but the save, layer, transform and clip calls must go through the canvas
+// to keep its state in sync.
+//
+// The draws that display lists don't have an operation for, like
+// drawPatch, are recorded into an SkPicture that the display list draws.
+class DisplayListCanvasRecorder final
+    : public SkCanvasVirtualEnforcer<SkNoDrawCanvas> {
+ public:
+  explicit DisplayListCanvasRecorder(const SkRect& bounds);
+
+  ~DisplayListCanvasRecorder() override;
+
+  DisplayListBuilder* builder() { return builder_.get(); }
+
+  // Returns the display list of the calls made so far. The canvas must not
+  // be drawn to afterwards.
+  sk_sp<DisplayList> Build();
+
+ private:
+  std::unique_ptr<DisplayListBuilder> builder_;
+
+  void DrawAsPicture(const std::function<void(SkCanvas*)>& draw);
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void willSave() override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  bool onDoSaveBehind(const SkRect*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void willRestore() override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void didConcat(const SkMatrix&) override;
+  void didConcat44(const SkM44&) override;
+  void didScale(SkScalar, SkScalar) override;
+  void didTranslate(SkScalar, SkScalar) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void didSetMatrix(const SkMatrix&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawDRRect(const SkRRect&, const SkRRect&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawTextBlob(const SkTextBlob* blob,
+                      SkScalar x,
+                      SkScalar y,
+                      const SkPaint& paint) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawPatch(const SkPoint cubics[12],
+                   const SkColor colors[4],
+                   const SkPoint texCoords[4],
+                   SkBlendMode,
+                   const SkPaint& paint) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawPaint(const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawBehind(const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawPoints(PointMode,
+                    size_t count,
+                    const SkPoint pts[],
+                    const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawRect(const SkRect&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawRegion(const SkRegion&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawOval(const SkRect&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawArc(const SkRect&,
+                 SkScalar,
+                 SkScalar,
+                 bool,
+                 const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawRRect(const SkRRect&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawPath(const SkPath&, const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawImage(const SkImage*,
+                   SkScalar left,
+                   SkScalar top,
+                   const SkPaint*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawImageRect(const SkImage*,
+                       const SkRect* src,
+                       const SkRect& dst,
+                       const SkPaint*,
+                       SrcRectConstraint) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawImageLattice(const SkImage*,
+                          const Lattice&,
+                          const SkRect&,
+                          const SkPaint*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawImageNine(const SkImage*,
+                       const SkIRect& center,
+                       const SkRect& dst,
+                       const SkPaint*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawVerticesObject(const SkVertices*,
+                            SkBlendMode,
+                            const SkPaint&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawAtlas(const SkImage*,
+                   const SkRSXform[],
+                   const SkRect[],
+                   const SkColor[],
+                   int,
+                   SkBlendMode,
+                   const SkRect*,
+                   const SkPaint*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawShadowRec(const SkPath&, const SkDrawShadowRec&) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onClipRect(const SkRect&, SkClipOp, ClipEdgeStyle) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onClipRRect(const SkRRect&, SkClipOp, ClipEdgeStyle) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onClipPath(const SkPath&, SkClipOp, ClipEdgeStyle) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onClipRegion(const SkRegion&, SkClipOp) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawPicture(const SkPicture*,
+                     const SkMatrix*,
+                     const SkPaint*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawDrawable(SkDrawable*, const SkMatrix*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawAnnotation(const SkRect&, const char[], SkData*) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawEdgeAAQuad(const SkRect&,
+                        const SkPoint[4],
+                        SkCanvas::QuadAAFlags,
+                        const SkColor4f&,
+                        SkBlendMode) override;
+
+  // |SkCanvasVirtualEnforcer<SkNoDrawCanvas>|
+  void onDrawEdgeAAImageSet(const ImageSetEntry[],
+                            int count,
+                            const SkPoint[],
+                            const SkMatrix[],
+                            const SkPaint*,
+                            SrcRectConstraint) override;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListCanvasRecorder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_CANVAS_H_
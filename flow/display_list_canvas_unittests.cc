@@ -0,0 +1,91 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_canvas.h"
+
+#include <cstring>
+
+#include "flutter/testing/mock_canvas.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(DisplayListCanvasRecorder, RecordsTheCanvasCalls) {
+  const SkRect rect = SkRect::MakeXYWH(10, 10, 20, 20);
+  const SkPaint paint(SkColors::kRed);
+  DisplayListCanvasRecorder recorder(SkRect::MakeWH(64, 64));
+  recorder.save();
+  recorder.translate(5, 5);
+  recorder.drawRect(rect, paint);
+  recorder.restore();
+  auto display_list = recorder.Build();
+
+  EXPECT_EQ(display_list->bounds(), rect.makeOffset(5, 5));
+
+  MockCanvas canvas;
+  display_list->RenderTo(&canvas);
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::SaveData{2}},
+       MockCanvas::DrawCall{
+           2, MockCanvas::ConcatMatrixData{SkMatrix::Translate(5, 5)}},
+       MockCanvas::DrawCall{2, MockCanvas::DrawRectData{rect, paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(canvas.draw_calls(), expected_draw_calls);
+}
+
+TEST(DisplayListCanvasRecorder, KeepsTheCanvasStateInSyncWithTheBuilder) {
+  DisplayListCanvasRecorder recorder(SkRect::MakeWH(64, 64));
+  recorder.save();
+  recorder.translate(5, 5);
+  recorder.clipRect(SkRect::MakeWH(10, 10));
+
+  EXPECT_EQ(recorder.getSaveCount(), recorder.builder()->getSaveCount());
+  EXPECT_EQ(recorder.getTotalMatrix(), SkMatrix::Translate(5, 5));
+  EXPECT_EQ(recorder.getDeviceClipBounds(), SkIRect::MakeXYWH(5, 5, 10, 10));
+
+  recorder.restore();
+  EXPECT_EQ(recorder.getSaveCount(), recorder.builder()->getSaveCount());
+  EXPECT_TRUE(recorder.getTotalMatrix().isIdentity());
+}
+
+TEST(DisplayListCanvasRecorder, DrawsWithoutAnOperationAreRecordedAsPictures) {
+  DisplayListCanvasRecorder recorder(SkRect::MakeWH(64, 64));
+  const SkPoint cubics[12] = {
+      {10, 10}, {20, 0},  {30, 0},  {40, 10}, {50, 20}, {50, 30},
+      {40, 40}, {30, 50}, {20, 50}, {10, 40}, {0, 30},  {0, 20},
+  };
+  recorder.drawPatch(cubics, nullptr, nullptr, SkBlendMode::kModulate,
+                     SkPaint());
+  auto display_list = recorder.Build();
+
+  // The picture and the patch it draws.
+  EXPECT_EQ(display_list->op_count(), 2);
+  EXPECT_FALSE(display_list->bounds().isEmpty());
+  EXPECT_FALSE(display_list->can_apply_group_opacity());
+
+  auto expected = SkSurface::MakeRasterN32Premul(64, 64);
+  expected->getCanvas()->drawPatch(cubics, nullptr, nullptr,
+                                   SkBlendMode::kModulate, SkPaint());
+  auto actual = SkSurface::MakeRasterN32Premul(64, 64);
+  display_list->RenderTo(actual->getCanvas());
+
+  SkBitmap expected_bitmap;
+  expected_bitmap.allocN32Pixels(64, 64);
+  SkBitmap actual_bitmap;
+  actual_bitmap.allocN32Pixels(64, 64);
+  ASSERT_TRUE(expected->readPixels(expected_bitmap, 0, 0));
+  ASSERT_TRUE(actual->readPixels(actual_bitmap, 0, 0));
+  EXPECT_EQ(memcmp(expected_bitmap.getPixels(), actual_bitmap.getPixels(),
+                   expected_bitmap.computeByteSize()),
+            0);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,291 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list.h"
+
+#include <cstring>
+#include <functional>
+
+#include "flutter/testing/mock_canvas.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+namespace {
+
+constexpr int kWidth = 200;
+constexpr int kHeight = 150;
+
+// Records the same draws into a display list and an SkPicture.
+void DrawSample(const std::function<void(SkCanvas*)>& canvas_draw,
+                const std::function<void(DisplayListBuilder*)>& builder_draw,
+                sk_sp<SkPicture>* picture,
+                sk_sp<DisplayList>* display_list) {
+  SkPictureRecorder recorder;
+  canvas_draw(recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight)));
+  *picture = recorder.finishRecordingAsPicture();
+
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  builder_draw(&builder);
+  *display_list = builder.Build();
+}
+
+bool HaveSamePixels(SkSurface* a, SkSurface* b) {
+  SkBitmap a_bitmap;
+  a_bitmap.allocN32Pixels(a->width(), a->height());
+  SkBitmap b_bitmap;
+  b_bitmap.allocN32Pixels(b->width(), b->height());
+  if (!a->readPixels(a_bitmap, 0, 0) || !b->readPixels(b_bitmap, 0, 0)) {
+    return false;
+  }
+  return a_bitmap.computeByteSize() == b_bitmap.computeByteSize() &&
+         memcmp(a_bitmap.getPixels(), b_bitmap.getPixels(),
+                a_bitmap.computeByteSize()) == 0;
+}
+
+sk_sp<DisplayList> GetSampleDisplayList(SkColor color) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  SkPaint paint(SkColor4f::FromColor(color));
+  builder.drawRect(SkRect::MakeXYWH(10, 10, 80, 80), paint);
+  builder.drawCircle(SkPoint::Make(120, 60), 30, paint);
+  return builder.Build();
+}
+
+}  // namespace
+
+TEST(DisplayList, EmptyDisplayListHasEmptyBounds) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  auto display_list = builder.Build();
+
+  EXPECT_TRUE(display_list->bounds().isEmpty());
+  EXPECT_EQ(display_list->op_count(), 0);
+}
+
+TEST(DisplayList, BoundsCoverTheTransformedDraws) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  builder.save();
+  builder.translate(20, 30);
+  builder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+  builder.restore();
+  builder.drawRect(SkRect::MakeXYWH(5, 5, 10, 10), SkPaint());
+  auto display_list = builder.Build();
+
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(5, 5, 30, 40));
+  EXPECT_EQ(display_list->op_count(), 5);
+}
+
+TEST(DisplayList, BoundsIncludeTheStroke) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  SkPaint paint;
+  paint.setStyle(SkPaint::kStroke_Style);
+  paint.setStrokeWidth(4);
+  builder.drawRect(SkRect::MakeXYWH(10, 10, 20, 20), paint);
+  auto display_list = builder.Build();
+
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(8, 8, 32, 32));
+}
+
+TEST(DisplayList, BoundsAreLimitedToTheCullRect) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  builder.drawRect(SkRect::MakeXYWH(150, 100, 100, 100), SkPaint());
+  EXPECT_EQ(builder.Build()->bounds(),
+            SkRect::MakeLTRB(150, 100, kWidth, kHeight));
+
+  DisplayListBuilder unbounded_builder(SkRect::MakeWH(kWidth, kHeight));
+  unbounded_builder.drawPaint(SkPaint());
+  EXPECT_EQ(unbounded_builder.Build()->bounds(),
+            SkRect::MakeWH(kWidth, kHeight));
+}
+
+TEST(DisplayList, RendersLikeAnSkPicture) {
+  sk_sp<SkPicture> picture;
+  sk_sp<DisplayList> display_list;
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  SkPaint stroke_paint = paint;
+  stroke_paint.setStyle(SkPaint::kStroke_Style);
+  stroke_paint.setStrokeWidth(5);
+  SkPath path;
+  path.addOval(SkRect::MakeXYWH(100, 20, 60, 40));
+  SkRRect rrect = SkRRect::MakeRectXY(SkRect::MakeXYWH(20, 90, 80, 40), 8, 8);
+  DrawSample(
+      [&](SkCanvas* canvas) {
+        canvas->drawColor(SK_ColorWHITE);
+        canvas->save();
+        canvas->translate(10, 5);
+        canvas->rotate(15);
+        canvas->clipRect(SkRect::MakeWH(150, 100), true);
+        paint.setColor(SK_ColorRED);
+        canvas->drawRect(SkRect::MakeXYWH(10, 10, 80, 40), paint);
+        canvas->restore();
+        paint.setColor(SK_ColorBLUE);
+        canvas->drawPath(path, paint);
+        canvas->drawRRect(rrect, stroke_paint);
+        canvas->saveLayer(nullptr, nullptr);
+        canvas->drawLine(0, 0, kWidth, kHeight, stroke_paint);
+        canvas->restore();
+      },
+      [&](DisplayListBuilder* builder) {
+        builder->drawColor(SK_ColorWHITE, SkBlendMode::kSrcOver);
+        builder->save();
+        builder->translate(10, 5);
+        builder->rotate(15);
+        builder->clipRect(SkRect::MakeWH(150, 100), SkClipOp::kIntersect,
+                          true);
+        paint.setColor(SK_ColorRED);
+        builder->drawRect(SkRect::MakeXYWH(10, 10, 80, 40), paint);
+        builder->restore();
+        paint.setColor(SK_ColorBLUE);
+        builder->drawPath(path, paint);
+        builder->drawRRect(rrect, stroke_paint);
+        builder->saveLayer(nullptr, nullptr);
+        builder->drawLine(SkPoint::Make(0, 0), SkPoint::Make(kWidth, kHeight),
+                          stroke_paint);
+        builder->restore();
+      },
+      &picture, &display_list);
+
+  auto expected = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  expected->getCanvas()->drawPicture(picture);
+  auto actual = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  display_list->RenderTo(actual->getCanvas());
+
+  EXPECT_TRUE(HaveSamePixels(expected.get(), actual.get()));
+}
+
+TEST(DisplayList, DrawsOutsideOfTheClipAreSkipped) {
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  const SkRect visible_rect = SkRect::MakeXYWH(10, 10, 20, 20);
+  const SkRect hidden_rect = SkRect::MakeXYWH(100, 100, 20, 20);
+  builder.drawRect(visible_rect, SkPaint());
+  builder.drawRect(hidden_rect, SkPaint());
+  auto display_list = builder.Build();
+
+  // The mock canvas is 64x64.
+  MockCanvas canvas;
+  display_list->RenderTo(&canvas);
+
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::DrawRectData{visible_rect,
+                                                        SkPaint()}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(canvas.draw_calls(), expected_draw_calls);
+}
+
+TEST(DisplayList, EqualDrawsHaveEqualContentHashes) {
+  auto display_list = GetSampleDisplayList(SK_ColorRED);
+  auto same_display_list = GetSampleDisplayList(SK_ColorRED);
+  auto other_display_list = GetSampleDisplayList(SK_ColorBLUE);
+
+  EXPECT_NE(display_list->unique_id(), same_display_list->unique_id());
+  EXPECT_TRUE(display_list->Equals(*same_display_list));
+  EXPECT_EQ(display_list->content_hash(), same_display_list->content_hash());
+  EXPECT_FALSE(display_list->Equals(*other_display_list));
+  EXPECT_NE(display_list->content_hash(), other_display_list->content_hash());
+}
+
+TEST(DisplayList, PathsWithTheSameBoundsHaveDifferentContentHashes) {
+  auto make_display_list = [](const SkPath& path) {
+    DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+    builder.drawPath(path, SkPaint());
+    return builder.Build();
+  };
+  // Two frames of an animated path, with the same bounds and counts.
+  SkPath path;
+  path.moveTo(0, 0).lineTo(10, 0).lineTo(5, 5).lineTo(0, 10).close();
+  SkPath moved_path;
+  moved_path.moveTo(0, 0).lineTo(10, 0).lineTo(3, 7).lineTo(0, 10).close();
+  ASSERT_EQ(path.getBounds(), moved_path.getBounds());
+  EXPECT_NE(make_display_list(path)->content_hash(),
+            make_display_list(moved_path)->content_hash());
+
+  SkPath conic;
+  conic.moveTo(0, 0).conicTo(10, 0, 10, 10, 0.5f);
+  SkPath other_conic;
+  other_conic.moveTo(0, 0).conicTo(10, 0, 10, 10, 2.0f);
+  EXPECT_NE(make_display_list(conic)->content_hash(),
+            make_display_list(other_conic)->content_hash());
+  EXPECT_EQ(make_display_list(conic)->content_hash(),
+            make_display_list(conic)->content_hash());
+}
+
+TEST(DisplayList, OnlySingleSourceOverDrawsCanApplyGroupOpacity) {
+  const SkRect bounds = SkRect::MakeWH(20.0f, 20.0f);
+  const SkPaint paint = SkPaint(SkColors::kRed);
+
+  DisplayListBuilder builder(bounds);
+  builder.drawRect(bounds, paint);
+  EXPECT_TRUE(builder.Build()->can_apply_group_opacity());
+
+  // The second draw would be blended over the first one.
+  DisplayListBuilder overlapping_builder(bounds);
+  overlapping_builder.drawRect(bounds, paint);
+  overlapping_builder.drawOval(bounds, paint);
+  EXPECT_FALSE(overlapping_builder.Build()->can_apply_group_opacity());
+
+  SkPaint src_paint = paint;
+  src_paint.setBlendMode(SkBlendMode::kSrc);
+  DisplayListBuilder src_builder(bounds);
+  src_builder.drawRect(bounds, src_paint);
+  EXPECT_FALSE(src_builder.Build()->can_apply_group_opacity());
+
+  DisplayListBuilder layer_builder(bounds);
+  layer_builder.saveLayer(nullptr, nullptr);
+  layer_builder.drawRect(bounds, paint);
+  layer_builder.restore();
+  EXPECT_FALSE(layer_builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, GroupOpacityIsAppliedToThePaint) {
+  const SkRect bounds = SkRect::MakeWH(20.0f, 20.0f);
+  DisplayListBuilder builder(bounds);
+  builder.drawRect(bounds, SkPaint(SkColors::kRed));
+  auto display_list = builder.Build();
+
+  MockCanvas canvas;
+  display_list->RenderTo(&canvas, 0.5f);
+
+  SkPaint expected_paint(SkColors::kRed);
+  expected_paint.setAlphaf(0.5f);
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1,
+                            MockCanvas::DrawRectData{bounds, expected_paint}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(canvas.draw_calls(), expected_draw_calls);
+}
+
+TEST(DisplayList, NestedDisplayListsAreDrawn) {
+  auto inner = GetSampleDisplayList(SK_ColorRED);
+  DisplayListBuilder builder(SkRect::MakeWH(kWidth, kHeight));
+  builder.translate(5, 5);
+  builder.drawDisplayList(inner.get());
+  auto outer = builder.Build();
+
+  EXPECT_EQ(outer->bounds(), inner->bounds().makeOffset(5, 5));
+  EXPECT_EQ(outer->op_count(), inner->op_count() + 2);
+  EXPECT_FALSE(outer->can_apply_group_opacity());
+
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight));
+  canvas->translate(5, 5);
+  inner->RenderTo(canvas);
+  auto picture = recorder.finishRecordingAsPicture();
+
+  auto expected = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  expected->getCanvas()->drawPicture(picture);
+  auto actual = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  outer->RenderTo(actual->getCanvas());
+
+  EXPECT_TRUE(HaveSamePixels(expected.get(), actual.get()));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,524 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_tree_capture.h"
+
+#include "flutter/flow/display_list_canvas.h"
+#include "flutter/flow/layers/backdrop_filter_layer.h"
+#include "flutter/flow/layers/clip_path_layer.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/clip_rrect_layer.h"
+#include "flutter/flow/layers/color_filter_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
+#include "flutter/flow/layers/image_filter_layer.h"
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/performance_overlay_layer.h"
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/shader_mask_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkColorFilter.h"
+#include "third_party/skia/include/core/SkImageFilter.h"
+#include "third_party/skia/include/core/SkShader.h"
+
+namespace flutter {
+
+namespace {
+
+// "FLTC" in little endian.
+constexpr uint32_t kCaptureMagic = 0x43544c46;
+constexpr uint32_t kCaptureVersion = 1;
+
+bool IsValidClip(uint32_t clip) {
+  return clip <= static_cast<uint32_t>(Clip::antiAliasWithSaveLayer);
+}
+
+}  // namespace
+
+LayerTreeCaptureWriter::LayerTreeCaptureWriter(const SkSerialProcs& procs)
+    : procs_(procs) {
+  WriteUint32(kCaptureMagic);
+  WriteUint32(kCaptureVersion);
+}
+
+LayerTreeCaptureWriter::~LayerTreeCaptureWriter() = default;
+
+void LayerTreeCaptureWriter::WriteLayerTree(const LayerTree& layer_tree) {
+  TRACE_EVENT0("flutter", "LayerTreeCaptureWriter::WriteLayerTree");
+  WriteUint32(layer_tree.frame_size().width());
+  WriteUint32(layer_tree.frame_size().height());
+  WriteScalar(layer_tree.device_pixel_ratio());
+  WriteBool(layer_tree.root_layer() != nullptr);
+  if (layer_tree.root_layer()) {
+    layer_tree.root_layer()->Capture(this);
+  }
+  frame_count_++;
+}
+
+sk_sp<SkData> LayerTreeCaptureWriter::Finish() {
+  return stream_.detachAsData();
+}
+
+bool LayerTreeCaptureWriter::WriteLayerHeader(CapturedLayerType type,
+                                              const Layer* layer) {
+  const uint64_t id = layer->unique_id();
+  const bool is_new = written_layers_.insert(id).second;
+  WriteUint32(static_cast<uint32_t>(is_new ? type
+                                           : CapturedLayerType::kRetained));
+  stream_.write(&id, sizeof(id));
+  return is_new;
+}
+
+void LayerTreeCaptureWriter::WriteLayers(
+    const std::vector<std::shared_ptr<Layer>>& layers) {
+  WriteUint32(layers.size());
+  for (auto& layer : layers) {
+    layer->Capture(this);
+  }
+}
+
+void LayerTreeCaptureWriter::WriteBool(bool value) {
+  stream_.writeBool(value);
+}
+
+void LayerTreeCaptureWriter::WriteUint32(uint32_t value) {
+  stream_.write32(value);
+}
+
+void LayerTreeCaptureWriter::WriteScalar(SkScalar value) {
+  stream_.writeScalar(value);
+}
+
+void LayerTreeCaptureWriter::WritePoint(const SkPoint& point) {
+  WriteScalar(point.x());
+  WriteScalar(point.y());
+}
+
+void LayerTreeCaptureWriter::WriteRect(const SkRect& rect) {
+  WriteScalar(rect.left());
+  WriteScalar(rect.top());
+  WriteScalar(rect.right());
+  WriteScalar(rect.bottom());
+}
+
+void LayerTreeCaptureWriter::WriteRRect(const SkRRect& rrect) {
+  char buffer[SkRRect::kSizeInMemory];
+  rrect.writeToMemory(buffer);
+  stream_.write(buffer, sizeof(buffer));
+}
+
+void LayerTreeCaptureWriter::WriteMatrix(const SkMatrix& matrix) {
+  SkScalar values[9];
+  matrix.get9(values);
+  for (SkScalar value : values) {
+    WriteScalar(value);
+  }
+}
+
+void LayerTreeCaptureWriter::WritePath(const SkPath& path) {
+  sk_sp<SkData> data = SkData::MakeUninitialized(path.writeToMemory(nullptr));
+  path.writeToMemory(data->writable_data());
+  WriteData(data.get());
+}
+
+void LayerTreeCaptureWriter::WritePicture(const SkPicture& picture) {
+  auto [it, is_new] =
+      written_pictures_.emplace(picture.uniqueID(), written_pictures_.size());
+  WriteUint32(it->second);
+  if (is_new) {
+    WriteData(picture.serialize(&procs_).get());
+  }
+}
+
+void LayerTreeCaptureWriter::WriteDisplayList(
+    const DisplayList& display_list) {
+  auto it = written_display_lists_.find(display_list.unique_id());
+  if (it != written_display_lists_.end()) {
+    WriteUint32(it->second);
+    return;
+  }
+  sk_sp<SkPicture> picture = display_list.ToSkPicture();
+  written_display_lists_.emplace(display_list.unique_id(),
+                                 written_pictures_.size());
+  WritePicture(*picture);
+}
+
+void LayerTreeCaptureWriter::WriteFlattenable(
+    const SkFlattenable* flattenable) {
+  if (flattenable) {
+    WriteData(flattenable->serialize(&procs_).get());
+  } else {
+    WriteData(SkData::MakeEmpty().get());
+  }
+}
+
+void LayerTreeCaptureWriter::WriteData(const SkData* data) {
+  WriteUint32(data->size());
+  stream_.write(data->data(), data->size());
+}
+
+LayerTreeCaptureReader::LayerTreeCaptureReader(
+    sk_sp<SkData> capture,
+    fml::RefPtr<SkiaUnrefQueue> unref_queue)
+    : capture_(std::move(capture)),
+      unref_queue_(std::move(unref_queue)),
+      stream_(capture_) {}
+
+LayerTreeCaptureReader::~LayerTreeCaptureReader() = default;
+
+bool LayerTreeCaptureReader::ReadLayerTrees(
+    std::vector<std::unique_ptr<LayerTree>>* layer_trees) {
+  TRACE_EVENT0("flutter", "LayerTreeCaptureReader::ReadLayerTrees");
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  if (!ReadUint32(&magic) || !ReadUint32(&version) || magic != kCaptureMagic ||
+      version != kCaptureVersion) {
+    FML_LOG(ERROR) << "Not a layer tree capture of version "
+                   << kCaptureVersion << ".";
+    return false;
+  }
+
+  while (!stream_.isAtEnd()) {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    SkScalar device_pixel_ratio = 0;
+    bool has_root_layer = false;
+    if (!ReadUint32(&width) || !ReadUint32(&height) ||
+        !ReadScalar(&device_pixel_ratio) || !ReadBool(&has_root_layer)) {
+      FML_LOG(ERROR) << "Could not read the frame of a layer tree capture.";
+      return false;
+    }
+    auto layer_tree = std::make_unique<LayerTree>(
+        SkISize::Make(width, height), device_pixel_ratio);
+    if (has_root_layer) {
+      std::shared_ptr<Layer> root_layer;
+      if (!ReadLayer(&root_layer)) {
+        FML_LOG(ERROR) << "Could not read the layers of frame "
+                       << layer_trees->size() << " of a layer tree capture.";
+        return false;
+      }
+      layer_tree->set_root_layer(std::move(root_layer));
+    }
+    layer_trees->push_back(std::move(layer_tree));
+  }
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadLayer(std::shared_ptr<Layer>* layer) {
+  uint32_t type = 0;
+  uint64_t id = 0;
+  if (!ReadUint32(&type) || !ReadUint64(&id)) {
+    return false;
+  }
+
+  // Retained container layers are added to the scene with their preroll
+  // memoized, see SceneBuilder::addRetained.
+  if (static_cast<CapturedLayerType>(type) == CapturedLayerType::kRetained) {
+    auto found = layers_.find(id);
+    if (found == layers_.end()) {
+      return false;
+    }
+    *layer = found->second;
+    auto container = containers_.find(id);
+    if (container != containers_.end()) {
+      container->second->set_memoize_preroll(true);
+    }
+    return true;
+  }
+
+  std::shared_ptr<ContainerLayer> container;
+  switch (static_cast<CapturedLayerType>(type)) {
+    case CapturedLayerType::kUnsupported:
+      layer->reset();
+      break;
+    case CapturedLayerType::kContainer:
+      container = std::make_shared<ContainerLayer>();
+      break;
+    case CapturedLayerType::kTransform: {
+      SkMatrix transform;
+      if (!ReadMatrix(&transform)) {
+        return false;
+      }
+      container = std::make_shared<TransformLayer>(transform);
+      break;
+    }
+    case CapturedLayerType::kOpacity: {
+      uint32_t alpha = 0;
+      SkPoint offset;
+      if (!ReadUint32(&alpha) || alpha > SK_AlphaOPAQUE ||
+          !ReadPoint(&offset)) {
+        return false;
+      }
+      container =
+          std::make_shared<OpacityLayer>(static_cast<SkAlpha>(alpha), offset);
+      break;
+    }
+    case CapturedLayerType::kClipRect: {
+      SkRect clip_rect;
+      uint32_t clip = 0;
+      if (!ReadRect(&clip_rect) || !ReadUint32(&clip) || !IsValidClip(clip)) {
+        return false;
+      }
+      container = std::make_shared<ClipRectLayer>(clip_rect,
+                                                  static_cast<Clip>(clip));
+      break;
+    }
+    case CapturedLayerType::kClipRRect: {
+      SkRRect clip_rrect;
+      uint32_t clip = 0;
+      if (!ReadRRect(&clip_rrect) || !ReadUint32(&clip) ||
+          !IsValidClip(clip)) {
+        return false;
+      }
+      container = std::make_shared<ClipRRectLayer>(clip_rrect,
+                                                   static_cast<Clip>(clip));
+      break;
+    }
+    case CapturedLayerType::kClipPath: {
+      SkPath clip_path;
+      uint32_t clip = 0;
+      if (!ReadPath(&clip_path) || !ReadUint32(&clip) || !IsValidClip(clip)) {
+        return false;
+      }
+      container = std::make_shared<ClipPathLayer>(clip_path,
+                                                  static_cast<Clip>(clip));
+      break;
+    }
+    case CapturedLayerType::kColorFilter: {
+      sk_sp<SkColorFilter> filter;
+      if (!ReadFlattenable(SkFlattenable::kSkColorFilter_Type, &filter)) {
+        return false;
+      }
+      container = std::make_shared<ColorFilterLayer>(std::move(filter));
+      break;
+    }
+    case CapturedLayerType::kImageFilter: {
+      sk_sp<SkImageFilter> filter;
+      if (!ReadFlattenable(SkFlattenable::kSkImageFilter_Type, &filter)) {
+        return false;
+      }
+      container = std::make_shared<ImageFilterLayer>(std::move(filter));
+      break;
+    }
+    case CapturedLayerType::kShaderMask: {
+      sk_sp<SkShader> shader;
+      SkRect mask_rect;
+      uint32_t blend_mode = 0;
+      if (!ReadFlattenable(SkFlattenable::kSkShaderBase_Type, &shader) ||
+          !ReadRect(&mask_rect) || !ReadUint32(&blend_mode) ||
+          blend_mode > static_cast<uint32_t>(SkBlendMode::kLastMode)) {
+        return false;
+      }
+      container = std::make_shared<ShaderMaskLayer>(
+          std::move(shader), mask_rect, static_cast<SkBlendMode>(blend_mode));
+      break;
+    }
+    case CapturedLayerType::kBackdropFilter: {
+      sk_sp<SkImageFilter> filter;
+      if (!ReadFlattenable(SkFlattenable::kSkImageFilter_Type, &filter)) {
+        return false;
+      }
+      container = std::make_shared<BackdropFilterLayer>(std::move(filter));
+      break;
+    }
+    case CapturedLayerType::kPhysicalShape: {
+      uint32_t color = 0;
+      uint32_t shadow_color = 0;
+      SkScalar elevation = 0;
+      SkPath path;
+      uint32_t clip = 0;
+      if (!ReadUint32(&color) || !ReadUint32(&shadow_color) ||
+          !ReadScalar(&elevation) || !ReadPath(&path) || !ReadUint32(&clip) ||
+          !IsValidClip(clip)) {
+        return false;
+      }
+      container = std::make_shared<PhysicalShapeLayer>(
+          color, shadow_color, elevation, path, static_cast<Clip>(clip));
+      break;
+    }
+    case CapturedLayerType::kPicture: {
+      SkPoint offset;
+      sk_sp<SkPicture> picture;
+      bool is_complex = false;
+      bool will_change = false;
+      if (!ReadPoint(&offset) || !ReadPicture(&picture) ||
+          !ReadBool(&is_complex) || !ReadBool(&will_change)) {
+        return false;
+      }
+      *layer = std::make_shared<PictureLayer>(
+          offset, SkiaGPUObject<SkPicture>(std::move(picture), unref_queue_),
+          is_complex, will_change);
+      break;
+    }
+    case CapturedLayerType::kDisplayList: {
+      SkPoint offset;
+      sk_sp<DisplayList> display_list;
+      bool is_complex = false;
+      bool will_change = false;
+      if (!ReadPoint(&offset) || !ReadDisplayList(&display_list) ||
+          !ReadBool(&is_complex) || !ReadBool(&will_change)) {
+        return false;
+      }
+      *layer = std::make_shared<DisplayListLayer>(
+          offset,
+          SkiaGPUObject<DisplayList>(std::move(display_list), unref_queue_),
+          is_complex, will_change);
+      break;
+    }
+    case CapturedLayerType::kPerformanceOverlay: {
+      uint32_t options = 0;
+      if (!ReadUint32(&options)) {
+        return false;
+      }
+      *layer = std::make_shared<PerformanceOverlayLayer>(options);
+      break;
+    }
+    default:
+      return false;
+  }
+
+  if (container) {
+    if (!ReadLayers(container.get())) {
+      return false;
+    }
+    containers_[id] = container.get();
+    *layer = std::move(container);
+  }
+  layers_[id] = *layer;
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadLayers(ContainerLayer* parent) {
+  uint32_t count = 0;
+  if (!ReadUint32(&count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    std::shared_ptr<Layer> layer;
+    if (!ReadLayer(&layer)) {
+      return false;
+    }
+    if (layer) {
+      parent->Add(std::move(layer));
+    }
+  }
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadBool(bool* value) {
+  return stream_.readBool(value);
+}
+
+bool LayerTreeCaptureReader::ReadUint32(uint32_t* value) {
+  return stream_.readU32(value);
+}
+
+bool LayerTreeCaptureReader::ReadUint64(uint64_t* value) {
+  return stream_.read(value, sizeof(*value)) == sizeof(*value);
+}
+
+bool LayerTreeCaptureReader::ReadScalar(SkScalar* value) {
+  return stream_.readScalar(value);
+}
+
+bool LayerTreeCaptureReader::ReadPoint(SkPoint* point) {
+  SkScalar x = 0;
+  SkScalar y = 0;
+  if (!ReadScalar(&x) || !ReadScalar(&y)) {
+    return false;
+  }
+  point->set(x, y);
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadRect(SkRect* rect) {
+  SkScalar left = 0;
+  SkScalar top = 0;
+  SkScalar right = 0;
+  SkScalar bottom = 0;
+  if (!ReadScalar(&left) || !ReadScalar(&top) || !ReadScalar(&right) ||
+      !ReadScalar(&bottom)) {
+    return false;
+  }
+  rect->setLTRB(left, top, right, bottom);
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadRRect(SkRRect* rrect) {
+  char buffer[SkRRect::kSizeInMemory];
+  return stream_.read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+         rrect->readFromMemory(buffer, sizeof(buffer)) == sizeof(buffer);
+}
+
+bool LayerTreeCaptureReader::ReadMatrix(SkMatrix* matrix) {
+  SkScalar values[9];
+  for (SkScalar& value : values) {
+    if (!ReadScalar(&value)) {
+      return false;
+    }
+  }
+  matrix->set9(values);
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadPath(SkPath* path) {
+  sk_sp<SkData> data;
+  return ReadData(&data) &&
+         path->readFromMemory(data->data(), data->size()) != 0;
+}
+
+bool LayerTreeCaptureReader::ReadPicture(sk_sp<SkPicture>* picture) {
+  uint32_t index = 0;
+  if (!ReadUint32(&index)) {
+    return false;
+  }
+  if (index < pictures_.size()) {
+    *picture = pictures_[index];
+    return true;
+  }
+  sk_sp<SkData> data;
+  if (index != pictures_.size() || !ReadData(&data)) {
+    return false;
+  }
+  *picture = SkPicture::MakeFromData(data.get());
+  if (!*picture) {
+    return false;
+  }
+  pictures_.push_back(*picture);
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadDisplayList(
+    sk_sp<DisplayList>* display_list) {
+  sk_sp<SkPicture> picture;
+  if (!ReadPicture(&picture)) {
+    return false;
+  }
+  // Display lists that were shared when captured are shared when replayed,
+  // so that they share their raster cache entries.
+  sk_sp<DisplayList>& cached = display_lists_[picture.get()];
+  if (!cached) {
+    DisplayListCanvasRecorder recorder(picture->cullRect());
+    picture->playback(&recorder);
+    cached = recorder.Build();
+  }
+  *display_list = cached;
+  return true;
+}
+
+bool LayerTreeCaptureReader::ReadData(sk_sp<SkData>* data) {
+  uint32_t size = 0;
+  if (!ReadUint32(&size) ||
+      size > stream_.getLength() - stream_.getPosition()) {
+    return false;
+  }
+  *data = SkData::MakeUninitialized(size);
+  return stream_.read((*data)->writable_data(), size) == size;
+}
+
+}  // namespace flutter
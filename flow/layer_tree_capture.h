@@ -0,0 +1,176 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_LAYER_TREE_CAPTURE_H_
+#define FLUTTER_FLOW_LAYER_TREE_CAPTURE_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkFlattenable.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSerialProcs.h"
+#include "third_party/skia/include/core/SkStream.h"
+
+namespace flutter {
+
+class ContainerLayer;
+class Layer;
+class LayerTree;
+
+// The layers that a capture can hold. The values are part of the format.
+enum class CapturedLayerType : uint32_t {
+  // A layer that can't be replayed without the embedder, like a platform
+  // view or a texture. It is left out of the replayed tree.
+  kUnsupported = 0,
+  // A layer that was written before, in this frame or an earlier one.
+  kRetained = 1,
+  kContainer = 2,
+  kTransform = 3,
+  kOpacity = 4,
+  kClipRect = 5,
+  kClipRRect = 6,
+  kClipPath = 7,
+  kColorFilter = 8,
+  kImageFilter = 9,
+  kShaderMask = 10,
+  kBackdropFilter = 11,
+  kPhysicalShape = 12,
+  kPicture = 13,
+  kPerformanceOverlay = 14,
+  kDisplayList = 15,
+};
+
+// Serializes a sequence of layer trees, so that the raster performance of the
+// frames of an app can be measured without running it. Layers and pictures
+// that are retained from one frame to the next are only written once, so that
+// the replayed frames reuse them like the engine did.
+//
+// Layers write their properties in Layer::Capture, which LayerTreeCaptureReader
+// reads back in the same order.
+class LayerTreeCaptureWriter {
+ public:
+  // |procs| are used to serialize pictures and filters, e.g. to embed the
+  // typefaces that the pictures draw with.
+  explicit LayerTreeCaptureWriter(const SkSerialProcs& procs = SkSerialProcs());
+
+  ~LayerTreeCaptureWriter();
+
+  void WriteLayerTree(const LayerTree& layer_tree);
+
+  size_t frame_count() const { return frame_count_; }
+
+  // Returns the capture of the frames written so far.
+  sk_sp<SkData> Finish();
+
+  // Writes the type and identity of |layer|. Returns false if the layer was
+  // written before, in which case only a reference to it is written and the
+  // layer must not write its properties and children.
+  bool WriteLayerHeader(CapturedLayerType type, const Layer* layer);
+
+  void WriteLayers(const std::vector<std::shared_ptr<Layer>>& layers);
+  void WriteBool(bool value);
+  void WriteUint32(uint32_t value);
+  void WriteScalar(SkScalar value);
+  void WritePoint(const SkPoint& point);
+  void WriteRect(const SkRect& rect);
+  void WriteRRect(const SkRRect& rrect);
+  void WriteMatrix(const SkMatrix& matrix);
+  void WritePath(const SkPath& path);
+  void WritePicture(const SkPicture& picture);
+  // Writes a display list as the SkPicture that it records into.
+  void WriteDisplayList(const DisplayList& display_list);
+  // Writes a color filter, image filter or shader, which may be null.
+  void WriteFlattenable(const SkFlattenable* flattenable);
+
+ private:
+  void WriteData(const SkData* data);
+
+  const SkSerialProcs procs_;
+  SkDynamicMemoryWStream stream_;
+  size_t frame_count_ = 0;
+  std::unordered_set<uint64_t> written_layers_;
+  // The index of each written picture by its unique ID.
+  std::unordered_map<uint32_t, uint32_t> written_pictures_;
+  // The index of the picture of each written display list by its unique ID.
+  std::unordered_map<uint32_t, uint32_t> written_display_lists_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LayerTreeCaptureWriter);
+};
+
+// Reads the layer trees written by LayerTreeCaptureWriter.
+class LayerTreeCaptureReader {
+ public:
+  // The pictures of the read layers are released through |unref_queue|.
+  LayerTreeCaptureReader(sk_sp<SkData> capture,
+                         fml::RefPtr<SkiaUnrefQueue> unref_queue);
+
+  ~LayerTreeCaptureReader();
+
+  // Reads all frames of the capture. Returns false if the capture is
+  // malformed, in which case |layer_trees| only has the frames before the
+  // error.
+  bool ReadLayerTrees(std::vector<std::unique_ptr<LayerTree>>* layer_trees);
+
+ private:
+  // Reads a layer into |layer|, which is left null for unsupported layers.
+  bool ReadLayer(std::shared_ptr<Layer>* layer);
+  bool ReadLayers(ContainerLayer* parent);
+  bool ReadBool(bool* value);
+  bool ReadUint32(uint32_t* value);
+  bool ReadUint64(uint64_t* value);
+  bool ReadScalar(SkScalar* value);
+  bool ReadPoint(SkPoint* point);
+  bool ReadRect(SkRect* rect);
+  bool ReadRRect(SkRRect* rrect);
+  bool ReadMatrix(SkMatrix* matrix);
+  bool ReadPath(SkPath* path);
+  bool ReadPicture(sk_sp<SkPicture>* picture);
+  bool ReadDisplayList(sk_sp<DisplayList>* display_list);
+  bool ReadData(sk_sp<SkData>* data);
+
+  template <typename T>
+  bool ReadFlattenable(SkFlattenable::Type type, sk_sp<T>* flattenable) {
+    sk_sp<SkData> data;
+    if (!ReadData(&data)) {
+      return false;
+    }
+    if (data->isEmpty()) {
+      flattenable->reset();
+      return true;
+    }
+    *flattenable = sk_sp<T>(static_cast<T*>(
+        SkFlattenable::Deserialize(type, data->data(), data->size())
+            .release()));
+    return *flattenable != nullptr;
+  }
+
+  sk_sp<SkData> capture_;
+  fml::RefPtr<SkiaUnrefQueue> unref_queue_;
+  SkMemoryStream stream_;
+  // The layers read so far by their unique ID, which is null for the ones
+  // that are not supported.
+  std::unordered_map<uint64_t, std::shared_ptr<Layer>> layers_;
+  std::unordered_map<uint64_t, ContainerLayer*> containers_;
+  std::vector<sk_sp<SkPicture>> pictures_;
+  // The display lists recorded from the pictures read so far.
+  std::unordered_map<const SkPicture*, sk_sp<DisplayList>> display_lists_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LayerTreeCaptureReader);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_LAYER_TREE_CAPTURE_H_
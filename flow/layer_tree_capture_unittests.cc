@@ -0,0 +1,171 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_tree_capture.h"
+
+#include <cstring>
+
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+namespace {
+
+constexpr int kWidth = 200;
+constexpr int kHeight = 150;
+
+sk_sp<SkPicture> GetSamplePicture() {
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight));
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setColor(SK_ColorRED);
+  canvas->drawRect(SkRect::MakeXYWH(10, 10, 120, 40), paint);
+  paint.setColor(SK_ColorBLUE);
+  canvas->drawCircle(100, 90, 50, paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+std::shared_ptr<PictureLayer> MakePictureLayer(
+    sk_sp<SkPicture> picture,
+    const fml::RefPtr<SkiaUnrefQueue>& unref_queue) {
+  return std::make_shared<PictureLayer>(
+      SkPoint::Make(5, 5),
+      SkiaGPUObject<SkPicture>(std::move(picture), unref_queue), false, false);
+}
+
+std::unique_ptr<LayerTree> MakeLayerTree(std::shared_ptr<Layer> root_layer) {
+  auto layer_tree =
+      std::make_unique<LayerTree>(SkISize::Make(kWidth, kHeight), 2.0f);
+  layer_tree->set_root_layer(std::move(root_layer));
+  return layer_tree;
+}
+
+bool RoundTrip(const std::vector<const LayerTree*>& layer_trees,
+               const fml::RefPtr<SkiaUnrefQueue>& unref_queue,
+               std::vector<std::unique_ptr<LayerTree>>* read_layer_trees) {
+  LayerTreeCaptureWriter writer;
+  for (const LayerTree* layer_tree : layer_trees) {
+    writer.WriteLayerTree(*layer_tree);
+  }
+  EXPECT_EQ(writer.frame_count(), layer_trees.size());
+  LayerTreeCaptureReader reader(writer.Finish(), unref_queue);
+  return reader.ReadLayerTrees(read_layer_trees);
+}
+
+SkBitmap Rasterize(LayerTree& layer_tree) {
+  auto surface = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  CompositorContext compositor_context;
+  {
+    auto frame = compositor_context.AcquireFrame(
+        nullptr, surface->getCanvas(), nullptr, SkMatrix::I(), false, true,
+        nullptr);
+    frame->Raster(layer_tree, true);
+  }
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(kWidth, kHeight);
+  EXPECT_TRUE(surface->readPixels(bitmap, 0, 0));
+  return bitmap;
+}
+
+}  // namespace
+
+using LayerTreeCaptureTest = SkiaGPUObjectLayerTest;
+
+TEST_F(LayerTreeCaptureTest, ReplaysLikeTheCapturedLayerTree) {
+  auto root = std::make_shared<ContainerLayer>();
+  auto transform = std::make_shared<TransformLayer>(
+      SkMatrix::Translate(10, 5).preScale(0.8f, 1.2f));
+  auto clip = std::make_shared<ClipRectLayer>(SkRect::MakeWH(150, 100),
+                                              Clip::antiAlias);
+  auto opacity = std::make_shared<OpacityLayer>(128, SkPoint::Make(3, 4));
+  opacity->Add(MakePictureLayer(GetSamplePicture(), unref_queue()));
+  clip->Add(opacity);
+  transform->Add(clip);
+  root->Add(transform);
+  auto layer_tree = MakeLayerTree(root);
+
+  std::vector<std::unique_ptr<LayerTree>> read_layer_trees;
+  ASSERT_TRUE(RoundTrip({layer_tree.get()}, unref_queue(), &read_layer_trees));
+  ASSERT_EQ(read_layer_trees.size(), 1u);
+  LayerTree& read_layer_tree = *read_layer_trees[0];
+  EXPECT_EQ(read_layer_tree.frame_size(), SkISize::Make(kWidth, kHeight));
+  EXPECT_EQ(read_layer_tree.device_pixel_ratio(), 2.0f);
+  ASSERT_NE(read_layer_tree.root_layer(), nullptr);
+
+  SkBitmap expected = Rasterize(*layer_tree);
+  SkBitmap replayed = Rasterize(read_layer_tree);
+  ASSERT_EQ(expected.computeByteSize(), replayed.computeByteSize());
+  EXPECT_EQ(memcmp(expected.getPixels(), replayed.getPixels(),
+                   expected.computeByteSize()),
+            0);
+}
+
+TEST_F(LayerTreeCaptureTest, RetainedLayersAndPicturesAreShared) {
+  auto picture = GetSamplePicture();
+  auto retained = MakePictureLayer(picture, unref_queue());
+  auto first_root = std::make_shared<ContainerLayer>();
+  first_root->Add(retained);
+  first_root->Add(MakePictureLayer(picture, unref_queue()));
+  auto second_root = std::make_shared<ContainerLayer>();
+  second_root->Add(retained);
+  auto first = MakeLayerTree(first_root);
+  auto second = MakeLayerTree(second_root);
+
+  std::vector<std::unique_ptr<LayerTree>> read_layer_trees;
+  ASSERT_TRUE(RoundTrip({first.get(), second.get()}, unref_queue(),
+                        &read_layer_trees));
+  ASSERT_EQ(read_layer_trees.size(), 2u);
+
+  auto* read_first =
+      static_cast<ContainerLayer*>(read_layer_trees[0]->root_layer());
+  auto* read_second =
+      static_cast<ContainerLayer*>(read_layer_trees[1]->root_layer());
+  ASSERT_EQ(read_first->layers().size(), 2u);
+  ASSERT_EQ(read_second->layers().size(), 1u);
+  EXPECT_EQ(read_first->layers()[0], read_second->layers()[0]);
+
+  auto* retained_picture_layer =
+      static_cast<PictureLayer*>(read_first->layers()[0].get());
+  auto* other_picture_layer =
+      static_cast<PictureLayer*>(read_first->layers()[1].get());
+  EXPECT_NE(retained_picture_layer, other_picture_layer);
+  EXPECT_EQ(retained_picture_layer->picture(), other_picture_layer->picture());
+}
+
+TEST_F(LayerTreeCaptureTest, RejectsMalformedCaptures) {
+  std::vector<std::unique_ptr<LayerTree>> read_layer_trees;
+  LayerTreeCaptureReader empty_reader(SkData::MakeEmpty(), unref_queue());
+  EXPECT_FALSE(empty_reader.ReadLayerTrees(&read_layer_trees));
+
+  auto root = std::make_shared<ContainerLayer>();
+  root->Add(MakePictureLayer(GetSamplePicture(), unref_queue()));
+  auto layer_tree = MakeLayerTree(root);
+  LayerTreeCaptureWriter writer;
+  writer.WriteLayerTree(*layer_tree);
+  writer.WriteLayerTree(*layer_tree);
+  sk_sp<SkData> capture = writer.Finish();
+
+  LayerTreeCaptureReader truncated_reader(
+      SkData::MakeSubset(capture.get(), 0, capture->size() - 4),
+      unref_queue());
+  EXPECT_FALSE(truncated_reader.ReadLayerTrees(&read_layer_trees));
+  EXPECT_EQ(read_layer_trees.size(), 1u);
+}
+
+}  // namespace testing
+}  // namespace flutter
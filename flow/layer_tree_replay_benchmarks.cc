@@ -0,0 +1,231 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays the frames of a layer tree capture, as taken with the
+// _flutter.startLayerTreeCapture and _flutter.stopLayerTreeCapture service
+// protocol extensions, and reports the percentiles of their raster times:
+//
+//   flow_replay_benchmarks --capture=<path> [--benchmark_filter=...]
+//
+// Without a capture, a built-in one of a scrolling list is replayed, so that
+// the benchmark also runs with the other benchmarks on CI.
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_api.h"
+#include "flutter/flow/compositor_context.h"
+#include "flutter/flow/layer_tree_capture.h"
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/fml/backtrace.h"
+#include "flutter/fml/command_line.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/message_loop.h"
+#include "flutter/fml/time/time_point.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+#if defined(FLOW_REPLAY_ENABLE_GL)
+#include "flutter/testing/test_gl_surface.h"
+#endif  // FLOW_REPLAY_ENABLE_GL
+
+namespace flutter {
+
+namespace {
+
+std::vector<std::unique_ptr<LayerTree>>& GetCapturedLayerTrees() {
+  static std::vector<std::unique_ptr<LayerTree>> layer_trees;
+  return layer_trees;
+}
+
+// Captures the frames of a list that scrolls by a few pixels per frame, with
+// every other row translucent.
+sk_sp<SkData> MakeSampleCapture(
+    const fml::RefPtr<SkiaUnrefQueue>& unref_queue) {
+  constexpr int kWidth = 400;
+  constexpr int kHeight = 800;
+  constexpr int kRowHeight = 80;
+  constexpr int kFrameCount = 60;
+
+  SkPictureRecorder recorder;
+  SkCanvas* canvas =
+      recorder.beginRecording(SkRect::MakeWH(kWidth, kRowHeight));
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setColor(SK_ColorLTGRAY);
+  const SkRect card = SkRect::MakeXYWH(8, 4, kWidth - 16, kRowHeight - 8);
+  canvas->drawRRect(SkRRect::MakeRectXY(card, 8, 8), paint);
+  paint.setColor(SK_ColorBLUE);
+  canvas->drawCircle(kRowHeight / 2, kRowHeight / 2, kRowHeight / 3, paint);
+  paint.setColor(SK_ColorDKGRAY);
+  canvas->drawRect(SkRect::MakeXYWH(kRowHeight, 24, kWidth / 2, 12), paint);
+  canvas->drawRect(SkRect::MakeXYWH(kRowHeight, 44, kWidth / 3, 12), paint);
+  sk_sp<SkPicture> row = recorder.finishRecordingAsPicture();
+
+  LayerTreeCaptureWriter writer;
+  for (int frame = 0; frame < kFrameCount; frame++) {
+    auto list = std::make_shared<TransformLayer>(
+        SkMatrix::Translate(0, -4.0f * frame));
+    for (int y = 0; y < kHeight + kFrameCount * 4; y += kRowHeight) {
+      auto opacity = std::make_shared<OpacityLayer>(
+          (y / kRowHeight) % 2 ? 0xFF : 0xC0, SkPoint::Make(0, y));
+      opacity->Add(std::make_shared<PictureLayer>(
+          SkPoint::Make(0, 0), SkiaGPUObject<SkPicture>(row, unref_queue),
+          false, false));
+      list->Add(std::move(opacity));
+    }
+    LayerTree layer_tree(SkISize::Make(kWidth, kHeight), 2.0f);
+    layer_tree.set_root_layer(std::move(list));
+    writer.WriteLayerTree(layer_tree);
+  }
+  return writer.Finish();
+}
+
+// The size of a surface that all captured frames fit in.
+SkISize GetCapturedFramesSize() {
+  SkISize size = SkISize::MakeEmpty();
+  for (const auto& layer_tree : GetCapturedLayerTrees()) {
+    size.set(std::max(size.width(), layer_tree->frame_size().width()),
+             std::max(size.height(), layer_tree->frame_size().height()));
+  }
+  return size;
+}
+
+std::string FormatPercentiles(std::vector<double> frame_times) {
+  if (frame_times.empty()) {
+    return std::string();
+  }
+  std::sort(frame_times.begin(), frame_times.end());
+  std::ostringstream label;
+  label << std::fixed << std::setprecision(3);
+  for (size_t percentile : {50, 90, 99}) {
+    const size_t index =
+        std::min(frame_times.size() - 1, frame_times.size() * percentile / 100);
+    label << (percentile == 50 ? "" : " ") << "p" << percentile << "="
+          << frame_times[index] << "ms";
+  }
+  return label.str();
+}
+
+// Rasterizes the captured frames onto |surface| in the order they were
+// captured, starting over after the last one. Each iteration is one frame.
+// The raster cache is kept between frames, like the rasterizer does.
+void ReplayCapturedFrames(benchmark::State& state,
+                          SkSurface* surface,
+                          GrDirectContext* gr_context) {
+  const auto& layer_trees = GetCapturedLayerTrees();
+  CompositorContext compositor_context;
+  std::vector<double> frame_times;
+  size_t frame = 0;
+  while (state.KeepRunning()) {
+    LayerTree& layer_tree = *layer_trees[frame++ % layer_trees.size()];
+    const fml::TimePoint start = fml::TimePoint::Now();
+    {
+      auto scoped_frame = compositor_context.AcquireFrame(
+          gr_context, surface->getCanvas(), nullptr, SkMatrix::I(), false,
+          true, nullptr);
+      scoped_frame->Raster(layer_tree, false);
+    }
+    if (gr_context) {
+      // Wait for the GPU, so that the frame time covers the whole frame.
+      gr_context->flushAndSubmit(true);
+    }
+    frame_times.push_back((fml::TimePoint::Now() - start).ToMillisecondsF());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(FormatPercentiles(std::move(frame_times)));
+}
+
+}  // namespace
+
+static void BM_ReplaySoftware(benchmark::State& state) {  // NOLINT
+  const SkISize size = GetCapturedFramesSize();
+  if (size.isEmpty()) {
+    state.SkipWithError("No frames to replay, pass --capture=<path>.");
+    return;
+  }
+  auto surface = SkSurface::MakeRasterN32Premul(size.width(), size.height());
+  ReplayCapturedFrames(state, surface.get(), nullptr);
+}
+
+BENCHMARK(BM_ReplaySoftware)->Unit(benchmark::kMillisecond);
+
+#if defined(FLOW_REPLAY_ENABLE_GL)
+
+// Replays on a SwiftShader backed GL surface, so that the results are
+// comparable between machines, but not with the GPU of a device.
+static void BM_ReplaySwiftShaderGL(benchmark::State& state) {  // NOLINT
+  const SkISize size = GetCapturedFramesSize();
+  if (size.isEmpty()) {
+    state.SkipWithError("No frames to replay, pass --capture=<path>.");
+    return;
+  }
+  testing::TestGLSurface gl_surface(size);
+  if (!gl_surface.MakeCurrent()) {
+    state.SkipWithError("Could not make the GL context current.");
+    return;
+  }
+  auto gr_context = gl_surface.GetGrContext();
+  auto surface = gl_surface.GetOnscreenSurface();
+  if (!gr_context || !surface) {
+    state.SkipWithError("Could not create the GL surface.");
+    return;
+  }
+  ReplayCapturedFrames(state, surface.get(), gr_context.get());
+  gl_surface.ClearCurrent();
+}
+
+BENCHMARK(BM_ReplaySwiftShaderGL)->Unit(benchmark::kMillisecond);
+
+#endif  // FLOW_REPLAY_ENABLE_GL
+
+}  // namespace flutter
+
+int main(int argc, char** argv) {
+  fml::InstallCrashHandler();
+  benchmark::Initialize(&argc, argv);
+
+  const auto command_line = fml::CommandLineFromArgcArgv(argc, argv);
+  // The pictures of the replayed frames are released through an unref queue,
+  // like in the engine. Nothing runs the message loop, so it is drained once
+  // the frames are gone.
+  fml::MessageLoop::EnsureInitializedForCurrentThread();
+  auto unref_queue = fml::MakeRefCounted<flutter::SkiaUnrefQueue>(
+      fml::MessageLoop::GetCurrent().GetTaskRunner(), fml::TimeDelta::Zero());
+  std::string capture_path;
+  sk_sp<SkData> capture;
+  if (command_line.GetOptionValue("capture", &capture_path)) {
+    capture = SkData::MakeFromFileName(capture_path.c_str());
+    if (!capture) {
+      FML_LOG(ERROR) << "Could not read the capture at " << capture_path;
+      return 1;
+    }
+  } else {
+    capture_path = "the built-in sample";
+    capture = flutter::MakeSampleCapture(unref_queue);
+  }
+  bool read = flutter::LayerTreeCaptureReader(std::move(capture), unref_queue)
+                  .ReadLayerTrees(&flutter::GetCapturedLayerTrees());
+  if (!read) {
+    flutter::GetCapturedLayerTrees().clear();
+    unref_queue->Drain();
+    return 1;
+  }
+  FML_LOG(INFO) << "Replaying " << flutter::GetCapturedLayerTrees().size()
+                << " frames from " << capture_path;
+
+  ::benchmark::RunSpecifiedBenchmarks();
+  flutter::GetCapturedLayerTrees().clear();
+  unref_queue->Drain();
+  return 0;
+}
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/backdrop_filter_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 BackdropFilterLayer::BackdropFilterLayer(sk_sp<SkImageFilter> filter)
@@ -26,4 +28,17 @@ void BackdropFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void BackdropFilterLayer::Diff(DiffContext* context) const {
+  // The filtered backdrop covers the whole clip, not just the children.
+  context->AddBackdropRegion(fml::HashCombine(filter_.get()), filter_.get());
+  DiffChildren(context);
+}
+
+void BackdropFilterLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kBackdropFilter, this)) {
+    writer->WriteFlattenable(filter_.get());
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
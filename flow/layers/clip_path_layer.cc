@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_path_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 #include "lib/ui/scenic/cpp/commands.h"
@@ -36,6 +38,9 @@ void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
       set_paint_bounds(child_paint_bounds);
     }
     context->mutators_stack.Pop();
+    // A saveLayer for anti-aliasing the clip would blend the children first.
+    context->subtree_can_inherit_opacity =
+        children_can_inherit_opacity() && !UsesSaveLayer();
   }
   context->cull_rect = previous_cull_rect;
 }
@@ -75,4 +80,22 @@ void ClipPathLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipPathLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_path_.getBounds());
+  context->MixFingerprint(clip_behavior_, clip_path_.getGenerationID());
+  DiffChildren(context);
+}
+
+void ClipPathLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kClipPath, this)) {
+    writer->WritePath(clip_path_);
+    writer->WriteUint32(clip_behavior_);
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
@@ -16,6 +16,8 @@ class ClipPathLayer : public ContainerLayer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
 
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_rect_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ClipRectLayer::ClipRectLayer(const SkRect& clip_rect, Clip clip_behavior)
@@ -29,6 +31,9 @@ void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
       set_paint_bounds(child_paint_bounds);
     }
     context->mutators_stack.Pop();
+    // A saveLayer for anti-aliasing the clip would blend the children first.
+    context->subtree_can_inherit_opacity =
+        children_can_inherit_opacity() && !UsesSaveLayer();
   }
   context->cull_rect = previous_cull_rect;
 }
@@ -68,4 +73,22 @@ void ClipRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRectLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rect_);
+  context->MixFingerprint(clip_behavior_);
+  DiffChildren(context);
+}
+
+void ClipRectLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kClipRect, this)) {
+    writer->WriteRect(clip_rect_);
+    writer->WriteUint32(clip_behavior_);
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/clip_rrect_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ClipRRectLayer::ClipRRectLayer(const SkRRect& clip_rrect, Clip clip_behavior)
@@ -30,6 +32,9 @@ void ClipRRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
       set_paint_bounds(child_paint_bounds);
     }
     context->mutators_stack.Pop();
+    // A saveLayer for anti-aliasing the clip would blend the children first.
+    context->subtree_can_inherit_opacity =
+        children_can_inherit_opacity() && !UsesSaveLayer();
   }
   context->cull_rect = previous_cull_rect;
 }
@@ -69,4 +74,28 @@ void ClipRRectLayer::Paint(PaintContext& context) const {
   }
 }
 
+void ClipRRectLayer::Diff(DiffContext* context) const {
+  if (!children_inside_clip_) {
+    return;
+  }
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rrect_.getBounds());
+  const SkVector upper_left = clip_rrect_.radii(SkRRect::kUpperLeft_Corner);
+  const SkVector upper_right = clip_rrect_.radii(SkRRect::kUpperRight_Corner);
+  const SkVector lower_right = clip_rrect_.radii(SkRRect::kLowerRight_Corner);
+  const SkVector lower_left = clip_rrect_.radii(SkRRect::kLowerLeft_Corner);
+  context->MixFingerprint(clip_behavior_, upper_left.fX, upper_left.fY,
+                          upper_right.fX, upper_right.fY, lower_right.fX,
+                          lower_right.fY, lower_left.fX, lower_left.fY);
+  DiffChildren(context);
+}
+
+void ClipRRectLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kClipRRect, this)) {
+    writer->WriteRRect(clip_rrect_);
+    writer->WriteUint32(clip_behavior_);
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
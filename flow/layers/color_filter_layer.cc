@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/color_filter_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ColorFilterLayer::ColorFilterLayer(sk_sp<SkColorFilter> filter)
@@ -28,4 +30,17 @@ void ColorFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ColorFilterLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->MixFingerprint(filter_.get());
+  DiffChildren(context);
+}
+
+void ColorFilterLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kColorFilter, this)) {
+    writer->WriteFlattenable(filter_.get());
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
@@ -18,6 +18,8 @@ class ColorFilterLayer : public ContainerLayer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
 
  private:
   sk_sp<SkColorFilter> filter_;
@@ -6,12 +6,15 @@
 
 #include <optional>
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ContainerLayer::ContainerLayer() {}
 
 void ContainerLayer::Add(std::shared_ptr<Layer> layer) {
   layers_.emplace_back(std::move(layer));
+  preroll_memo_.reset();
 }
 
 void ContainerLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
@@ -20,6 +23,7 @@ void ContainerLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   SkRect child_paint_bounds = SkRect::MakeEmpty();
   PrerollChildren(context, matrix, &child_paint_bounds);
   set_paint_bounds(child_paint_bounds);
+  context->subtree_can_inherit_opacity = children_can_inherit_opacity();
 }
 
 void ContainerLayer::Paint(PaintContext& context) const {
@@ -28,6 +32,16 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ContainerLayer::Diff(DiffContext* context) const {
+  DiffChildren(context);
+}
+
+void ContainerLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kContainer, this)) {
+    writer->WriteLayers(layers());
+  }
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
@@ -42,25 +56,85 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
   // Platform views have no children, so context->has_platform_view should
   // always be false.
   FML_DCHECK(!context->has_platform_view);
+
+#if defined(LEGACY_FUCHSIA_EMBEDDER)
+  // Whether the children are system composited depends on the layers below
+  // them, which the memo does not track.
+  const bool memoize = false;
+#else
+  const bool memoize = memoize_preroll();
+#endif
+  std::vector<RasterCachePreparation>* parent_raster_cache_preparations =
+      context->raster_cache_preparations;
+  std::optional<PrerollMemo> memo;
+  if (!memoize) {
+    preroll_memo_.reset();
+  } else {
+    PrerollInputs inputs = GetPrerollInputs(context, child_matrix);
+    if (RestorePrerollMemo(context, inputs, child_paint_bounds)) {
+      // The children are the same as in the preroll that set
+      // children_can_inherit_opacity_.
+      context->subtree_can_inherit_opacity = false;
+      return;
+    }
+    memo.emplace();
+    memo->inputs = std::move(inputs);
+    memo->child_paint_bounds = SkRect::MakeEmpty();
+    context->raster_cache_preparations = &memo->raster_cache_preparations;
+  }
+
   bool child_has_platform_view = false;
+  bool children_can_inherit_opacity = !layers_.empty();
+  SkRect painted_bounds = SkRect::MakeEmpty();
   for (auto& layer : layers_) {
     // Reset context->has_platform_view to false so that layers aren't treated
     // as if they have a platform view based on one being previously found in a
     // sibling tree.
     context->has_platform_view = false;
+    context->subtree_can_inherit_opacity = false;
 
     layer->Preroll(context, child_matrix);
 
+    if (children_can_inherit_opacity) {
+      children_can_inherit_opacity =
+          context->subtree_can_inherit_opacity &&
+          !SkRect::Intersects(painted_bounds, layer->paint_bounds());
+      painted_bounds.join(layer->paint_bounds());
+    }
+
     if (layer->needs_system_composite()) {
       set_needs_system_composite(true);
     }
     child_paint_bounds->join(layer->paint_bounds());
+    if (memo) {
+      memo->child_paint_bounds.join(layer->paint_bounds());
+    }
 
     child_has_platform_view =
         child_has_platform_view || context->has_platform_view;
   }
 
   context->has_platform_view = child_has_platform_view;
+  context->subtree_can_inherit_opacity = false;
+  children_can_inherit_opacity_ = children_can_inherit_opacity;
+
+  if (memo) {
+    context->raster_cache_preparations = parent_raster_cache_preparations;
+    if (parent_raster_cache_preparations) {
+      parent_raster_cache_preparations->insert(
+          parent_raster_cache_preparations->end(),
+          memo->raster_cache_preparations.begin(),
+          memo->raster_cache_preparations.end());
+    }
+    if (child_has_platform_view) {
+      // The view embedder must see the platform views of every frame.
+      preroll_memo_.reset();
+    } else {
+      memo->surface_needs_readback = context->surface_needs_readback;
+      memo->is_opaque = context->is_opaque;
+      preroll_memo_ = std::move(memo);
+    }
+  }
 
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   if (child_layer_exists_below_) {
@@ -71,6 +145,78 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
 #endif
 }
 
+bool ContainerLayer::PrerollInputs::operator==(
+    const PrerollInputs& other) const {
+  return child_matrix == other.child_matrix && cull_rect == other.cull_rect &&
+         raster_cache == other.raster_cache &&
+         gr_context == other.gr_context &&
+         view_embedder == other.view_embedder &&
+         SkColorSpace::Equals(dst_color_space.get(),
+                              other.dst_color_space.get()) &&
+         frame_device_pixel_ratio == other.frame_device_pixel_ratio &&
+         checkerboard_offscreen_layers ==
+             other.checkerboard_offscreen_layers &&
+         surface_needs_readback == other.surface_needs_readback &&
+         is_opaque == other.is_opaque;
+}
+
+ContainerLayer::PrerollInputs ContainerLayer::GetPrerollInputs(
+    const PrerollContext* context,
+    const SkMatrix& child_matrix) {
+  return {
+      child_matrix,
+      context->cull_rect,
+      context->raster_cache,
+      context->gr_context,
+      context->view_embedder,
+      sk_ref_sp(context->dst_color_space),
+      context->frame_device_pixel_ratio,
+      context->checkerboard_offscreen_layers,
+      context->surface_needs_readback,
+      context->is_opaque,
+  };
+}
+
+bool ContainerLayer::RestorePrerollMemo(PrerollContext* context,
+                                        const PrerollInputs& inputs,
+                                        SkRect* child_paint_bounds) {
+  if (!preroll_memo_ || !(preroll_memo_->inputs == inputs)) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "ContainerLayer::RestorePrerollMemo");
+
+  // The children keep their cache entries in use, and the entries that are
+  // not rasterized yet count the access as they would have in a preroll.
+  for (const RasterCachePreparation& preparation :
+       preroll_memo_->raster_cache_preparations) {
+    if (preparation.layer) {
+      context->raster_cache->Prepare(context, preparation.layer,
+                                     preparation.matrix);
+    } else if (preparation.display_list) {
+      context->raster_cache->Prepare(
+          context->gr_context, preparation.display_list, preparation.matrix,
+          context->dst_color_space, preparation.is_complex,
+          preparation.will_change);
+    } else {
+      context->raster_cache->Prepare(
+          context->gr_context, preparation.picture, preparation.matrix,
+          context->dst_color_space, preparation.is_complex,
+          preparation.will_change);
+    }
+  }
+  if (context->raster_cache_preparations) {
+    context->raster_cache_preparations->insert(
+        context->raster_cache_preparations->end(),
+        preroll_memo_->raster_cache_preparations.begin(),
+        preroll_memo_->raster_cache_preparations.end());
+  }
+
+  child_paint_bounds->join(preroll_memo_->child_paint_bounds);
+  context->surface_needs_readback = preroll_memo_->surface_needs_readback;
+  context->is_opaque = preroll_memo_->is_opaque;
+  return true;
+}
+
 void ContainerLayer::PaintChildren(PaintContext& context) const {
   FML_DCHECK(needs_painting());
 
@@ -83,12 +229,24 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   }
 }
 
+void ContainerLayer::DiffChildren(DiffContext* context) const {
+  for (auto& layer : layers_) {
+    if (layer->needs_painting()) {
+      layer->Diff(context);
+    }
+  }
+}
+
 void ContainerLayer::TryToPrepareRasterCache(PrerollContext* context,
                                              Layer* layer,
                                              const SkMatrix& matrix) {
   if (!context->has_platform_view && context->raster_cache &&
       SkRect::Intersects(context->cull_rect, layer->paint_bounds())) {
     context->raster_cache->Prepare(context, layer, matrix);
+    if (context->raster_cache_preparations) {
+      context->raster_cache_preparations->push_back(
+          {layer, nullptr, matrix, false, false});
+    }
   }
 }
 
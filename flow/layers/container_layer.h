@@ -5,8 +5,11 @@
 #ifndef FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 
+#include <atomic>
+#include <optional>
 #include <vector>
 #include "flutter/flow/layers/layer.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
 
 namespace flutter {
 
@@ -18,6 +21,8 @@ class ContainerLayer : public Layer {
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   void CheckForChildLayerBelow(PrerollContext* context) override;
   void UpdateScene(SceneUpdateContext& context) override;
@@ -25,11 +30,35 @@ class ContainerLayer : public Layer {
 
   const std::vector<std::shared_ptr<Layer>>& layers() const { return layers_; }
 
+  // Retained layers are added to the scene again without changes, so the
+  // outputs of prerolling their children only change when the inputs do.
+  // When set, the children are only prerolled again if the matrix, the cull
+  // rect or another input of their preroll differs from the previous one.
+  // Subtrees with platform views are always prerolled.
+  //
+  // The UI thread may set this while the raster thread prerolls the layer, as
+  // retained layers are shared by the trees of both. Only the preroll touches
+  // the memo, and it drops the memo once memoizing is turned off.
+  void set_memoize_preroll(bool memoize_preroll) {
+    memoize_preroll_.store(memoize_preroll, std::memory_order_relaxed);
+  }
+  bool memoize_preroll() const {
+    return memoize_preroll_.load(std::memory_order_relaxed);
+  }
+
  protected:
   void PrerollChildren(PrerollContext* context,
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
   void PaintChildren(PaintContext& context) const;
+  void DiffChildren(DiffContext* context) const;
+
+  // Whether the children can be painted with an inherited opacity, as of the
+  // last PrerollChildren. That is the case if all of them can and their paint
+  // bounds do not overlap, so that no pixel is blended twice.
+  bool children_can_inherit_opacity() const {
+    return children_can_inherit_opacity_;
+  }
 
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   void UpdateSceneChildren(SceneUpdateContext& context);
@@ -50,7 +79,43 @@ class ContainerLayer : public Layer {
                                       const SkMatrix& matrix);
 
  private:
+  // The inputs of prerolling the children that their outputs depend on.
+  struct PrerollInputs {
+    SkMatrix child_matrix;
+    SkRect cull_rect;
+    RasterCache* raster_cache;
+    GrDirectContext* gr_context;
+    ExternalViewEmbedder* view_embedder;
+    sk_sp<SkColorSpace> dst_color_space;
+    float frame_device_pixel_ratio;
+    bool checkerboard_offscreen_layers;
+    bool surface_needs_readback;
+    bool is_opaque;
+
+    bool operator==(const PrerollInputs& other) const;
+  };
+
+  struct PrerollMemo {
+    PrerollInputs inputs;
+    SkRect child_paint_bounds;
+    bool surface_needs_readback;
+    bool is_opaque;
+    std::vector<RasterCachePreparation> raster_cache_preparations;
+  };
+
+  static PrerollInputs GetPrerollInputs(const PrerollContext* context,
+                                        const SkMatrix& child_matrix);
+
+  // Restores the outputs of the previous preroll of the children if it had
+  // the same inputs. Returns false if the children must be prerolled.
+  bool RestorePrerollMemo(PrerollContext* context,
+                          const PrerollInputs& inputs,
+                          SkRect* child_paint_bounds);
+
   std::vector<std::shared_ptr<Layer>> layers_;
+  std::atomic_bool memoize_preroll_ = false;
+  std::optional<PrerollMemo> preroll_memo_;
+  bool children_can_inherit_opacity_ = false;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/raster_cache.h"
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/message_loop.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kPicturesPerLevel = 4;
+
+sk_sp<SkPicture> GetSamplePicture() {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(20, 20));
+  SkPaint paint;
+  paint.setColor(SK_ColorRED);
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeXYWH(2, 2, 16, 16),
+                                          paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+// The pictures are released through an unref queue, like in the engine. The
+// benchmarks don't run the message loop, so they drain the queue themselves
+// once their layers are gone.
+fml::RefPtr<SkiaUnrefQueue> MakeUnrefQueue() {
+  fml::MessageLoop::EnsureInitializedForCurrentThread();
+  return fml::MakeRefCounted<SkiaUnrefQueue>(
+      fml::MessageLoop::GetCurrent().GetTaskRunner(), fml::TimeDelta::Zero());
+}
+
+// A chain of |depth| transforms, each of which has a few pictures next to the
+// transform below it, like the layers of a static part of an app.
+std::shared_ptr<ContainerLayer> MakeStaticTree(
+    int depth,
+    const sk_sp<SkPicture>& picture,
+    const fml::RefPtr<SkiaUnrefQueue>& unref_queue,
+    bool memoize_preroll) {
+  std::shared_ptr<ContainerLayer> root;
+  std::shared_ptr<ContainerLayer> parent;
+  for (int level = 0; level < depth; level++) {
+    auto layer = std::make_shared<TransformLayer>(SkMatrix::Translate(1, 2));
+    for (int i = 0; i < kPicturesPerLevel; i++) {
+      layer->Add(std::make_shared<PictureLayer>(
+          SkPoint::Make(i * 20, 0),
+          SkiaGPUObject<SkPicture>(picture, unref_queue), false, false));
+    }
+    if (parent) {
+      parent->Add(layer);
+    } else {
+      root = layer;
+    }
+    parent = layer;
+  }
+  root->set_memoize_preroll(memoize_preroll);
+  return root;
+}
+
+}  // namespace
+
+// Prerolls a frame whose root has an animated picture and a retained static
+// subtree of the depth of the first argument. The second argument enables the
+// preroll memoization of the retained subtree.
+static void BM_PrerollRetainedSubtree(benchmark::State& state) {  // NOLINT
+  auto picture = GetSamplePicture();
+  auto unref_queue = MakeUnrefQueue();
+  auto retained = MakeStaticTree(state.range(0), picture, unref_queue,
+                                 state.range(1) != 0);
+
+  RasterCache raster_cache;
+  MutatorsStack mutators_stack;
+  Stopwatch raster_time;
+  Stopwatch ui_time;
+  TextureRegistry texture_registry;
+  int frame = 0;
+  while (state.KeepRunning()) {
+    auto root = std::make_shared<ContainerLayer>();
+    root->Add(std::make_shared<PictureLayer>(
+        SkPoint::Make(frame++ % 100, 0),
+        SkiaGPUObject<SkPicture>(picture, unref_queue), false, false));
+    root->Add(retained);
+
+    PrerollContext context = {
+        &raster_cache,     // raster_cache
+        nullptr,           // gr_context
+        nullptr,           // view_embedder
+        mutators_stack,    // mutators_stack
+        nullptr,           // dst_color_space
+        kGiantRect,        // cull_rect
+        false,             // surface_needs_readback
+        raster_time,       // raster_time
+        ui_time,           // ui_time
+        texture_registry,  // texture_registry
+        false,             // checkerboard_offscreen_layers
+        1.0f,              // frame_device_pixel_ratio
+    };
+    root->Preroll(&context, SkMatrix::I());
+    raster_cache.SweepAfterFrame();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          kPicturesPerLevel);
+
+  retained.reset();
+  unref_queue->Drain();
+}
+
+BENCHMARK(BM_PrerollRetainedSubtree)
+    ->Args({16, 0})
+    ->Args({16, 1})
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({256, 0})
+    ->Args({256, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -4,8 +4,10 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include "flutter/flow/layers/picture_layer.h"
 #include "flutter/flow/testing/layer_test.h"
 #include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
 #include "flutter/fml/macros.h"
 #include "flutter/testing/mock_canvas.h"
 
@@ -13,6 +15,8 @@ namespace flutter {
 namespace testing {
 
 using ContainerLayerTest = LayerTest;
+// For the tests with picture layers, whose pictures need an unref queue.
+using ContainerLayerWithPicturesTest = SkiaGPUObjectLayerTest;
 
 #ifndef NDEBUG
 TEST_F(ContainerLayerTest, LayerWithParentHasPlatformView) {
@@ -268,5 +272,86 @@ TEST_F(ContainerLayerTest, MergedMultipleChildren) {
                                                child_path2, child_paint2}}}));
 }
 
+TEST_F(ContainerLayerTest, MemoizedPrerollSkipsUnchangedChildren) {
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  auto mock_layer = std::make_shared<MockLayer>(
+      child_path, SkPaint(), false, false, true /* fake_reads_surface */);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(mock_layer);
+  layer->set_memoize_preroll(true);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(mock_layer->preroll_count(), 1);
+  EXPECT_TRUE(preroll_context()->surface_needs_readback);
+
+  // The outputs of the skipped preroll are restored.
+  preroll_context()->surface_needs_readback = false;
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(mock_layer->preroll_count(), 1);
+  EXPECT_EQ(layer->paint_bounds(), child_path.getBounds());
+  EXPECT_TRUE(preroll_context()->surface_needs_readback);
+
+  // A different matrix or cull rect prerolls the children again.
+  preroll_context()->surface_needs_readback = false;
+  const SkMatrix transform = SkMatrix::Translate(4.0f, 4.0f);
+  layer->Preroll(preroll_context(), transform);
+  EXPECT_EQ(mock_layer->preroll_count(), 2);
+  EXPECT_EQ(mock_layer->parent_matrix(), transform);
+
+  preroll_context()->surface_needs_readback = false;
+  preroll_context()->cull_rect = SkRect::MakeWH(100.0f, 100.0f);
+  layer->Preroll(preroll_context(), transform);
+  EXPECT_EQ(mock_layer->preroll_count(), 3);
+  EXPECT_EQ(mock_layer->parent_cull_rect(), SkRect::MakeWH(100.0f, 100.0f));
+
+  layer->set_memoize_preroll(false);
+  layer->Preroll(preroll_context(), transform);
+  EXPECT_EQ(mock_layer->preroll_count(), 4);
+}
+
+TEST_F(ContainerLayerTest, MemoizedPrerollAlwaysPrerollsPlatformViews) {
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  auto mock_layer = std::make_shared<MockLayer>(
+      child_path, SkPaint(), true /* fake_has_platform_view */);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(mock_layer);
+  layer->set_memoize_preroll(true);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  preroll_context()->has_platform_view = false;
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(mock_layer->preroll_count(), 2);
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+}
+
+TEST_F(ContainerLayerWithPicturesTest,
+       MemoizedPrerollKeepsRasterCacheEntries) {
+  use_mock_raster_cache();
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  auto mock_layer = std::make_shared<MockLayer>(child_path);
+  auto picture_layer = std::make_shared<PictureLayer>(
+      SkPoint::Make(0.0f, 0.0f),
+      SkiaGPUObject<SkPicture>(
+          SkPicture::MakePlaceholder(SkRect::MakeWH(20.0f, 20.0f)),
+          unref_queue()),
+      true, false);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(mock_layer);
+  layer->Add(picture_layer);
+  layer->set_memoize_preroll(true);
+
+  for (int frame = 0; frame < 3; frame++) {
+    layer->Preroll(preroll_context(), SkMatrix());
+    raster_cache()->SweepAfterFrame();
+    // The skipped prerolls prepare the picture again, so that its entry is
+    // not swept as unused.
+    EXPECT_EQ(raster_cache()->GetPictureCachedEntriesCount(), 1u);
+  }
+  EXPECT_EQ(mock_layer->preroll_count(), 1);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layers/display_list_layer.h"
+
+#include "flutter/flow/layer_tree_capture.h"
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+DisplayListLayer::DisplayListLayer(const SkPoint& offset,
+                                   SkiaGPUObject<DisplayList> display_list,
+                                   bool is_complex,
+                                   bool will_change)
+    : offset_(offset),
+      display_list_(std::move(display_list)),
+      is_complex_(is_complex),
+      will_change_(will_change) {}
+
+void DisplayListLayer::Preroll(PrerollContext* context,
+                               const SkMatrix& matrix) {
+  TRACE_EVENT0("flutter", "DisplayListLayer::Preroll");
+
+#if defined(LEGACY_FUCHSIA_EMBEDDER)
+  CheckForChildLayerBelow(context);
+#endif
+
+  DisplayList* recording = display_list();
+
+  if (auto* cache = context->raster_cache) {
+    TRACE_EVENT0("flutter", "DisplayListLayer::RasterCache (Preroll)");
+
+    SkMatrix ctm = matrix;
+    ctm.postTranslate(offset_.x(), offset_.y());
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+    ctm = RasterCache::GetIntegralTransCTM(ctm);
+#endif
+    cache->Prepare(context->gr_context, recording, ctm,
+                   context->dst_color_space, is_complex_, will_change_);
+    if (context->raster_cache_preparations) {
+      context->raster_cache_preparations->push_back(
+          {nullptr, nullptr, ctm, is_complex_, will_change_, recording});
+    }
+  }
+
+  // Unlike the cull rect of a picture, the bounds only cover what the display
+  // list draws.
+  SkRect bounds = recording->bounds().makeOffset(offset_.x(), offset_.y());
+  set_paint_bounds(bounds);
+
+  context->subtree_can_inherit_opacity = recording->can_apply_group_opacity();
+}
+
+void DisplayListLayer::Paint(PaintContext& context) const {
+  TRACE_EVENT0("flutter", "DisplayListLayer::Paint");
+  FML_DCHECK(display_list_.get());
+  FML_DCHECK(needs_painting());
+
+  SkAutoCanvasRestore save(context.leaf_nodes_canvas, true);
+  context.leaf_nodes_canvas->translate(offset_.x(), offset_.y());
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  context.leaf_nodes_canvas->setMatrix(RasterCache::GetIntegralTransCTM(
+      context.leaf_nodes_canvas->getTotalMatrix()));
+#endif
+
+  const bool inherits_opacity = context.inherited_opacity < SK_Scalar1;
+  SkPaint opacity_paint;
+  opacity_paint.setAlphaf(context.inherited_opacity);
+  if (context.raster_cache &&
+      context.raster_cache->Draw(*display_list(), *context.leaf_nodes_canvas,
+                                 inherits_opacity ? &opacity_paint : nullptr)) {
+    TRACE_EVENT_INSTANT0("flutter", "raster cache hit");
+    return;
+  }
+  display_list()->RenderTo(context.leaf_nodes_canvas,
+                           context.inherited_opacity);
+}
+
+void DisplayListLayer::Diff(DiffContext* context) const {
+  // Display lists recorded again with the same operations, e.g. when an
+  // ancestor is rebuilt, don't need to be repainted.
+  context->AddPaintRegion(paint_bounds(), display_list()->content_hash());
+}
+
+void DisplayListLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kDisplayList, this)) {
+    writer->WritePoint(offset_);
+    writer->WriteDisplayList(*display_list());
+    writer->WriteBool(is_complex_);
+    writer->WriteBool(will_change_);
+  }
+}
+
+}  // namespace flutter
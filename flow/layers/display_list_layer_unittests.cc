@@ -0,0 +1,114 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#define FML_USED_ON_EMBEDDER
+
+#include "flutter/flow/layers/display_list_layer.h"
+
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "flutter/fml/macros.h"
+#include "flutter/testing/mock_canvas.h"
+
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+#include "flutter/flow/raster_cache.h"
+#endif
+
+namespace flutter {
+namespace testing {
+
+using DisplayListLayerTest = SkiaGPUObjectLayerTest;
+
+#ifndef NDEBUG
+TEST_F(DisplayListLayerTest, PaintBeforePrerollInvalidDisplayListDies) {
+  const SkPoint layer_offset = SkPoint::Make(0.0f, 0.0f);
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject<DisplayList>(), false, false);
+
+  EXPECT_DEATH_IF_SUPPORTED(layer->Paint(paint_context()),
+                            "display_list_\\.get\\(\\)");
+}
+
+TEST_F(DisplayListLayerTest, PaintingEmptyLayerDies) {
+  const SkPoint layer_offset = SkPoint::Make(0.0f, 0.0f);
+  DisplayListBuilder builder(SkRect::MakeWH(20.0f, 20.0f));
+  auto display_list = builder.Build();
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject(display_list, unref_queue()), false, false);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(layer->paint_bounds(), SkRect::MakeEmpty());
+  EXPECT_FALSE(layer->needs_painting());
+
+  EXPECT_DEATH_IF_SUPPORTED(layer->Paint(paint_context()),
+                            "needs_painting\\(\\)");
+}
+#endif
+
+TEST_F(DisplayListLayerTest, SimpleDisplayList) {
+  const SkPoint layer_offset = SkPoint::Make(1.5f, -0.5f);
+  const SkMatrix layer_offset_matrix =
+      SkMatrix::Translate(layer_offset.fX, layer_offset.fY);
+  const SkRect rect = SkRect::MakeLTRB(5.0f, 6.0f, 20.5f, 21.5f);
+  const SkPaint paint(SkColors::kRed);
+  DisplayListBuilder builder(SkRect::MakeWH(50.0f, 50.0f));
+  builder.drawRect(rect, paint);
+  auto display_list = builder.Build();
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject(display_list, unref_queue()), false, false);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  // Unlike a picture layer, the bounds are those of the draws rather than
+  // those given to the recorder.
+  EXPECT_EQ(layer->paint_bounds(),
+            rect.makeOffset(layer_offset.fX, layer_offset.fY));
+  EXPECT_EQ(layer->display_list(), display_list.get());
+  EXPECT_TRUE(layer->needs_painting());
+  EXPECT_TRUE(preroll_context()->subtree_can_inherit_opacity);
+
+  layer->Paint(paint_context());
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1,
+                            MockCanvas::ConcatMatrixData{layer_offset_matrix}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           1, MockCanvas::SetMatrixData{RasterCache::GetIntegralTransCTM(
+                  layer_offset_matrix)}},
+#endif
+       MockCanvas::DrawCall{1, MockCanvas::SaveData{2}},
+       MockCanvas::DrawCall{2, MockCanvas::DrawRectData{rect, paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
+TEST_F(DisplayListLayerTest, InheritedOpacityIsAppliedToTheDraw) {
+  const SkPoint layer_offset = SkPoint::Make(0.0f, 0.0f);
+  const SkRect rect = SkRect::MakeLTRB(5.0f, 6.0f, 20.5f, 21.5f);
+  DisplayListBuilder builder(SkRect::MakeWH(50.0f, 50.0f));
+  builder.drawRect(rect, SkPaint(SkColors::kRed));
+  auto layer = std::make_shared<DisplayListLayer>(
+      layer_offset, SkiaGPUObject(builder.Build(), unref_queue()), false,
+      false);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  paint_context().inherited_opacity = 0.5f;
+  layer->Paint(paint_context());
+
+  SkPaint expected_paint(SkColors::kRed);
+  expected_paint.setAlphaf(0.5f);
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{1, MockCanvas::SetMatrixData{SkMatrix()}},
+#endif
+       MockCanvas::DrawCall{1, MockCanvas::SaveData{2}},
+       MockCanvas::DrawCall{2, MockCanvas::DrawRectData{rect, expected_paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
+}  // namespace testing
+}  // namespace flutter
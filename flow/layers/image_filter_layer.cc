@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/image_filter_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ImageFilterLayer::ImageFilterLayer(sk_sp<SkImageFilter> filter)
@@ -92,4 +94,20 @@ void ImageFilterLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ImageFilterLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->MixFingerprint(filter_.get());
+  // A filter may move or spread the pixels of its children (e.g. a blur), so
+  // any change below it damages the whole filtered output.
+  DiffContext::AutoGroup group(context, paint_bounds());
+  DiffChildren(context);
+}
+
+void ImageFilterLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kImageFilter, this)) {
+    writer->WriteFlattenable(filter_.get());
+    writer->WriteLayers(GetChildContainer()->layers());
+  }
+}
+
 }  // namespace flutter
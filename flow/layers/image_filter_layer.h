@@ -18,6 +18,8 @@ class ImageFilterLayer : public MergedContainerLayer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
 
  private:
   // The ImageFilterLayer might cache the filtered output of this layer
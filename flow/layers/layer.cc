@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
 #include "flutter/flow/paint_utils.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
 
@@ -27,6 +28,14 @@ uint64_t Layer::NextUniqueID() {
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::Diff(DiffContext* context) const {
+  context->AddPaintRegion(paint_bounds(), unique_id());
+}
+
+void Layer::Capture(LayerTreeCaptureWriter* writer) const {
+  writer->WriteLayerHeader(CapturedLayerType::kUnsupported, this);
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
@@ -42,6 +43,23 @@ static constexpr SkRect kGiantRect = SkRect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
 // This should be an exact copy of the Clip enum in painting.dart.
 enum Clip { none, hardEdge, antiAlias, antiAliasWithSaveLayer };
 
+class Layer;
+class LayerTreeCaptureWriter;
+
+// A call to RasterCache::Prepare made during Preroll. A ContainerLayer that
+// skips prerolling its children repeats these calls, so that the children
+// keep their raster cache entries.
+struct RasterCachePreparation {
+  // The layer that was prepared, or null if |picture| or |display_list| was
+  // prepared.
+  Layer* layer;
+  SkPicture* picture;
+  SkMatrix matrix;
+  bool is_complex;
+  bool will_change;
+  DisplayList* display_list = nullptr;
+};
+
 struct PrerollContext {
   RasterCache* raster_cache;
   GrDirectContext* gr_context;
@@ -62,6 +80,16 @@ struct PrerollContext {
   // prescence of a platform view during Preroll.
   bool has_platform_view = false;
   bool is_opaque = true;
+
+  // Set by the Preroll of layers that can paint their content with the
+  // |PaintContext::inherited_opacity| of an OpacityLayer instead of in a
+  // saveLayer. ContainerLayer::PrerollChildren clears it before prerolling
+  // each child and after prerolling all of them.
+  bool subtree_can_inherit_opacity = false;
+
+  // Collects the raster cache preparations of the layers being prerolled when
+  // a ContainerLayer memoizes the preroll of its children.
+  std::vector<RasterCachePreparation>* raster_cache_preparations = nullptr;
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   // True if, during the traversal so far, we have seen a child_scene_layer.
   // Informs whether a layer needs to be system composited.
@@ -125,6 +153,12 @@ class Layer {
     const RasterCache* raster_cache;
     const bool checkerboard_offscreen_layers;
     const float frame_device_pixel_ratio;
+
+    // The opacity that an OpacityLayer passed on to the layers below it
+    // instead of painting them in a saveLayer. Only layers that set
+    // |PrerollContext::subtree_can_inherit_opacity| are painted with an
+    // opacity other than 1.
+    SkScalar inherited_opacity = SK_Scalar1;
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
@@ -155,6 +189,18 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // Adds the areas painted by this layer to |context| so that they can be
+  // compared with the previous frame to find the damaged part of the screen.
+  // Must be called after Preroll. The default implementation identifies the
+  // content of the whole paint bounds by the layer's unique_id(), which is
+  // always correct but treats recreated layers as changed.
+  virtual void Diff(DiffContext* context) const;
+
+  // Writes the properties and children of this layer to a capture of the
+  // frames of an app, see LayerTreeCaptureWriter. The default implementation
+  // writes the layer as one that can't be replayed.
+  virtual void Capture(LayerTreeCaptureWriter* writer) const;
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
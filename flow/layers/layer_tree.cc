@@ -122,6 +122,19 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
   }
 }
 
+void LayerTree::Diff(DiffContext* context,
+                     const SkMatrix& root_surface_transformation) const {
+  TRACE_EVENT0("flutter", "LayerTree::Diff");
+
+  if (!root_layer_ || !root_layer_->needs_painting()) {
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(root_surface_transformation);
+  root_layer_->Diff(context);
+}
+
 sk_sp<SkPicture> LayerTree::Flatten(const SkRect& bounds) {
   TRACE_EVENT0("flutter", "LayerTree::Flatten");
 
@@ -39,6 +39,11 @@ class LayerTree {
   void Paint(CompositorContext::ScopedFrame& frame,
              bool ignore_raster_cache = false) const;
 
+  // Collects the areas painted by the tree into |context| so that they can be
+  // compared with those of another frame. Must be called after Preroll.
+  void Diff(DiffContext* context,
+            const SkMatrix& root_surface_transformation) const;
+
   sk_sp<SkPicture> Flatten(const SkRect& bounds);
 
   Layer* root_layer() const { return root_layer_.get(); }
@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/opacity_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkPaint.h"
 
@@ -37,8 +38,10 @@ void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.Pop();
   context->is_opaque = parent_is_opaque;
 
-  {
-    set_paint_bounds(paint_bounds().makeOffset(offset_.fX, offset_.fY));
+  set_paint_bounds(paint_bounds().makeOffset(offset_.fX, offset_.fY));
+  // Children that take the opacity are painted directly, so there is neither
+  // a saveLayer nor a cache entry to save.
+  if (!children_can_inherit_opacity()) {
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     child_matrix = RasterCache::GetIntegralTransCTM(child_matrix);
 #endif
@@ -47,6 +50,9 @@ void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 
   // Restore cull_rect
   context->cull_rect = context->cull_rect.makeOffset(offset_.fX, offset_.fY);
+
+  // The opacity of this layer and an inherited one are multiplied either way.
+  context->subtree_can_inherit_opacity = true;
 }
 
 void OpacityLayer::Paint(PaintContext& context) const {
@@ -55,6 +61,9 @@ void OpacityLayer::Paint(PaintContext& context) const {
 
   SkPaint paint;
   paint.setAlpha(alpha_);
+  if (context.inherited_opacity < SK_Scalar1) {
+    paint.setAlphaf(paint.getAlphaf() * context.inherited_opacity);
+  }
 
   SkAutoCanvasRestore save(context.internal_nodes_canvas, true);
   context.internal_nodes_canvas->translate(offset_.fX, offset_.fY);
@@ -64,6 +73,15 @@ void OpacityLayer::Paint(PaintContext& context) const {
       context.leaf_nodes_canvas->getTotalMatrix()));
 #endif
 
+  const SkScalar inherited_opacity = context.inherited_opacity;
+  if (children_can_inherit_opacity()) {
+    TRACE_EVENT_INSTANT0("flutter", "children inherit opacity");
+    context.inherited_opacity = paint.getAlphaf();
+    PaintChildren(context);
+    context.inherited_opacity = inherited_opacity;
+    return;
+  }
+
   if (context.raster_cache &&
       context.raster_cache->Draw(GetCacheableChild(),
                                  *context.leaf_nodes_canvas, &paint)) {
@@ -85,7 +103,9 @@ void OpacityLayer::Paint(PaintContext& context) const {
 
   Layer::AutoSaveLayer save_layer =
       Layer::AutoSaveLayer::Create(context, saveLayerBounds, &paint);
+  context.inherited_opacity = SK_Scalar1;
   PaintChildren(context);
+  context.inherited_opacity = inherited_opacity;
 }
 
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
@@ -99,4 +119,19 @@ void OpacityLayer::UpdateScene(SceneUpdateContext& context) {
 
 #endif
 
+void OpacityLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(SkMatrix::Translate(offset_.fX, offset_.fY));
+  context->MixFingerprint(alpha_);
+  DiffChildren(context);
+}
+
+void OpacityLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kOpacity, this)) {
+    writer->WriteUint32(alpha_);
+    writer->WritePoint(offset_);
+    writer->WriteLayers(GetChildContainer()->layers());
+  }
+}
+
 }  // namespace flutter
@@ -0,0 +1,127 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/picture_layer.h"
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/message_loop.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kItemWidth = 400;
+constexpr int kItemHeight = 24;
+
+sk_sp<SkPicture> GetListItemPicture() {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(kItemWidth, kItemHeight));
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setColor(SK_ColorBLUE);
+  recorder.getRecordingCanvas()->drawRRect(
+      SkRRect::MakeRectXY(SkRect::MakeWH(kItemWidth, kItemHeight), 4, 4),
+      paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+// The pictures are released through an unref queue, like in the engine. The
+// benchmark doesn't run the message loop, so it drains the queue itself once
+// its layers are gone.
+fml::RefPtr<SkiaUnrefQueue> MakeUnrefQueue() {
+  fml::MessageLoop::EnsureInitializedForCurrentThread();
+  return fml::MakeRefCounted<SkiaUnrefQueue>(
+      fml::MessageLoop::GetCurrent().GetTaskRunner(), fml::TimeDelta::Zero());
+}
+
+}  // namespace
+
+// Prerolls and paints a list of items, each of which is a single draw, that
+// fades in through an OpacityLayer whose alpha changes every frame. The first
+// argument is the number of items. If the second argument is zero, the items
+// overlap by a pixel, so their opacity can't be inherited and they are
+// painted in a saveLayer. The raster cache is not used, like with the
+// software backend or while the children are not cached yet.
+static void BM_PaintFadingListItems(benchmark::State& state) {  // NOLINT
+  const int item_count = state.range(0);
+  const int item_spacing = state.range(1) != 0 ? kItemHeight : kItemHeight - 1;
+  auto picture = GetListItemPicture();
+  auto unref_queue = MakeUnrefQueue();
+  std::vector<std::shared_ptr<PictureLayer>> items;
+  for (int i = 0; i < item_count; i++) {
+    items.push_back(std::make_shared<PictureLayer>(
+        SkPoint::Make(0, i * item_spacing),
+        SkiaGPUObject<SkPicture>(picture, unref_queue), false, false));
+  }
+  auto surface =
+      SkSurface::MakeRasterN32Premul(kItemWidth, item_count * kItemHeight);
+
+  MutatorsStack mutators_stack;
+  Stopwatch raster_time;
+  Stopwatch ui_time;
+  TextureRegistry texture_registry;
+  int frame = 0;
+  while (state.KeepRunning()) {
+    auto layer = std::make_shared<OpacityLayer>(
+        static_cast<SkAlpha>(frame++ % 255), SkPoint::Make(0, 0));
+    for (auto& item : items) {
+      layer->Add(item);
+    }
+
+    PrerollContext preroll_context = {
+        nullptr,           // raster_cache
+        nullptr,           // gr_context
+        nullptr,           // view_embedder
+        mutators_stack,    // mutators_stack
+        nullptr,           // dst_color_space
+        kGiantRect,        // cull_rect
+        false,             // surface_needs_readback
+        raster_time,       // raster_time
+        ui_time,           // ui_time
+        texture_registry,  // texture_registry
+        false,             // checkerboard_offscreen_layers
+        1.0f,              // frame_device_pixel_ratio
+    };
+    layer->Preroll(&preroll_context, SkMatrix::I());
+
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->clear(SK_ColorWHITE);
+    Layer::PaintContext paint_context = {
+        canvas,            // internal_nodes_canvas
+        canvas,            // leaf_nodes_canvas
+        nullptr,           // gr_context
+        nullptr,           // view_embedder
+        raster_time,       // raster_time
+        ui_time,           // ui_time
+        texture_registry,  // texture_registry
+        nullptr,           // raster_cache
+        false,             // checkerboard_offscreen_layers
+        1.0f,              // frame_device_pixel_ratio
+    };
+    layer->Paint(paint_context);
+  }
+  state.SetItemsProcessed(state.iterations() * item_count);
+
+  items.clear();
+  unref_queue->Drain();
+}
+
+BENCHMARK(BM_PaintFadingListItems)
+    ->Args({8, 0})
+    ->Args({8, 1})
+    ->Args({32, 0})
+    ->Args({32, 1})
+    ->Args({128, 0})
+    ->Args({128, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -374,6 +374,167 @@ TEST_F(OpacityLayerTest, Nested) {
   EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
 }
 
+TEST_F(OpacityLayerTest, ChildrenInheritOpacity) {
+  const SkPath child1_path = SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f));
+  const SkPath child2_path =
+      SkPath().addRect(SkRect::MakeXYWH(10.0f, 0.0f, 5.0f, 5.0f));
+  const SkPoint layer_offset = SkPoint::Make(0.5f, 1.5f);
+  const SkMatrix initial_transform = SkMatrix::Translate(0.5f, 0.5f);
+  const SkMatrix layer_transform =
+      SkMatrix::Translate(layer_offset.fX, layer_offset.fY);
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  const SkMatrix integral_layer_transform = RasterCache::GetIntegralTransCTM(
+      SkMatrix::Concat(initial_transform, layer_transform));
+#endif
+  const SkPaint child1_paint = SkPaint(SkColors::kGreen);
+  const SkPaint child2_paint = SkPaint(SkColors::kBlue);
+  const SkAlpha alpha_half = 255 / 2;
+  auto mock_layer1 = std::make_shared<MockLayer>(child1_path, child1_paint);
+  auto mock_layer2 = std::make_shared<MockLayer>(child2_path, child2_paint);
+  mock_layer1->set_fake_opacity_compatible(true);
+  mock_layer2->set_fake_opacity_compatible(true);
+  auto layer = std::make_shared<OpacityLayer>(alpha_half, layer_offset);
+  layer->Add(mock_layer1);
+  layer->Add(mock_layer2);
+
+  layer->Preroll(preroll_context(), initial_transform);
+  EXPECT_TRUE(preroll_context()->subtree_can_inherit_opacity);
+
+  SkPaint opacity_paint;
+  opacity_paint.setAlpha(alpha_half);
+  SkPaint expected_child1_paint = child1_paint;
+  expected_child1_paint.setAlphaf(child1_paint.getAlphaf() *
+                                  opacity_paint.getAlphaf());
+  SkPaint expected_child2_paint = child2_paint;
+  expected_child2_paint.setAlphaf(child2_paint.getAlphaf() *
+                                  opacity_paint.getAlphaf());
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::ConcatMatrixData{layer_transform}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           1, MockCanvas::SetMatrixData{integral_layer_transform}},
+#endif
+       MockCanvas::DrawCall{
+           1, MockCanvas::DrawPathData{child1_path, expected_child1_paint}},
+       MockCanvas::DrawCall{
+           1, MockCanvas::DrawPathData{child2_path, expected_child2_paint}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  layer->Paint(paint_context());
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
+TEST_F(OpacityLayerTest, OverlappingChildrenDoNotInheritOpacity) {
+  const SkPath child1_path = SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f));
+  const SkPath child2_path =
+      SkPath().addRect(SkRect::MakeXYWH(3.0f, 0.0f, 5.0f, 5.0f));
+  const SkPoint layer_offset = SkPoint::Make(0.5f, 1.5f);
+  const SkMatrix initial_transform = SkMatrix::Translate(0.5f, 0.5f);
+  const SkMatrix layer_transform =
+      SkMatrix::Translate(layer_offset.fX, layer_offset.fY);
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  const SkMatrix integral_layer_transform = RasterCache::GetIntegralTransCTM(
+      SkMatrix::Concat(initial_transform, layer_transform));
+#endif
+  const SkPaint child1_paint = SkPaint(SkColors::kGreen);
+  const SkPaint child2_paint = SkPaint(SkColors::kBlue);
+  const SkAlpha alpha_half = 255 / 2;
+  auto mock_layer1 = std::make_shared<MockLayer>(child1_path, child1_paint);
+  auto mock_layer2 = std::make_shared<MockLayer>(child2_path, child2_paint);
+  mock_layer1->set_fake_opacity_compatible(true);
+  mock_layer2->set_fake_opacity_compatible(true);
+  auto layer = std::make_shared<OpacityLayer>(alpha_half, layer_offset);
+  layer->Add(mock_layer1);
+  layer->Add(mock_layer2);
+
+  layer->Preroll(preroll_context(), initial_transform);
+  // The layer itself can still pass its opacity on to the children.
+  EXPECT_TRUE(preroll_context()->subtree_can_inherit_opacity);
+
+  const SkPaint opacity_paint =
+      SkPaint(SkColor4f::FromColor(SkColorSetA(SK_ColorBLACK, alpha_half)));
+  SkRect opacity_bounds;
+  layer->paint_bounds()
+      .makeOffset(-layer_offset.fX, -layer_offset.fY)
+      .roundOut(&opacity_bounds);
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::ConcatMatrixData{layer_transform}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           1, MockCanvas::SetMatrixData{integral_layer_transform}},
+#endif
+       MockCanvas::DrawCall{
+           1, MockCanvas::SaveLayerData{opacity_bounds, opacity_paint, nullptr,
+                                        2}},
+       MockCanvas::DrawCall{
+           2, MockCanvas::DrawPathData{child1_path, child1_paint}},
+       MockCanvas::DrawCall{
+           2, MockCanvas::DrawPathData{child2_path, child2_paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  layer->Paint(paint_context());
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
+TEST_F(OpacityLayerTest, NestedLayersMultiplyInheritedOpacity) {
+  const SkPath child_path = SkPath().addRect(SkRect::MakeWH(5.0f, 6.0f));
+  const SkPoint layer1_offset = SkPoint::Make(0.5f, 1.5f);
+  const SkPoint layer2_offset = SkPoint::Make(2.5f, 0.5f);
+  const SkMatrix initial_transform = SkMatrix::Translate(0.5f, 0.5f);
+  const SkMatrix layer1_transform =
+      SkMatrix::Translate(layer1_offset.fX, layer1_offset.fY);
+  const SkMatrix layer2_transform =
+      SkMatrix::Translate(layer2_offset.fX, layer2_offset.fY);
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  const SkMatrix integral_layer1_transform = RasterCache::GetIntegralTransCTM(
+      SkMatrix::Concat(initial_transform, layer1_transform));
+  const SkMatrix integral_layer2_transform = RasterCache::GetIntegralTransCTM(
+      SkMatrix::Concat(SkMatrix::Concat(initial_transform, layer1_transform),
+                       layer2_transform));
+#endif
+  const SkPaint child_paint = SkPaint(SkColors::kRed);
+  const SkAlpha alpha1 = 155;
+  const SkAlpha alpha2 = 224;
+  auto mock_layer = std::make_shared<MockLayer>(child_path, child_paint);
+  mock_layer->set_fake_opacity_compatible(true);
+  auto layer1 = std::make_shared<OpacityLayer>(alpha1, layer1_offset);
+  auto layer2 = std::make_shared<OpacityLayer>(alpha2, layer2_offset);
+  layer2->Add(mock_layer);
+  layer1->Add(layer2);
+
+  layer1->Preroll(preroll_context(), initial_transform);
+
+  SkPaint opacity1_paint;
+  opacity1_paint.setAlpha(alpha1);
+  SkPaint opacity2_paint;
+  opacity2_paint.setAlpha(alpha2);
+  opacity2_paint.setAlphaf(opacity2_paint.getAlphaf() *
+                           opacity1_paint.getAlphaf());
+  SkPaint expected_child_paint = child_paint;
+  expected_child_paint.setAlphaf(child_paint.getAlphaf() *
+                                 opacity2_paint.getAlphaf());
+  auto expected_draw_calls = std::vector(
+      {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::ConcatMatrixData{layer1_transform}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           1, MockCanvas::SetMatrixData{integral_layer1_transform}},
+#endif
+       MockCanvas::DrawCall{1, MockCanvas::SaveData{2}},
+       MockCanvas::DrawCall{2, MockCanvas::ConcatMatrixData{layer2_transform}},
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+       MockCanvas::DrawCall{
+           2, MockCanvas::SetMatrixData{integral_layer2_transform}},
+#endif
+       MockCanvas::DrawCall{
+           2, MockCanvas::DrawPathData{child_path, expected_child_paint}},
+       MockCanvas::DrawCall{2, MockCanvas::RestoreData{1}},
+       MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}});
+  layer1->Paint(paint_context());
+  EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
+}
+
 TEST_F(OpacityLayerTest, Readback) {
   auto initial_transform = SkMatrix();
   auto layer = std::make_shared<OpacityLayer>(kOpaque_SkAlphaType, SkPoint());
@@ -7,6 +7,8 @@
 #include <string>
 
 #include "flutter/flow/layers/performance_overlay_layer.h"
+
+#include "flutter/flow/layer_tree_capture.h"
 #include "third_party/skia/include/core/SkFont.h"
 #include "third_party/skia/include/core/SkTextBlob.h"
 
@@ -98,4 +100,15 @@ void PerformanceOverlayLayer::Paint(PaintContext& context) const {
                      options_ & kDisplayEngineStatistics, "UI", font_path_);
 }
 
+void PerformanceOverlayLayer::Diff(DiffContext* context) const {
+  // The statistics are redrawn on every frame.
+  context->AddVolatilePaintRegion(paint_bounds());
+}
+
+void PerformanceOverlayLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kPerformanceOverlay, this)) {
+    writer->WriteUint32(options_);
+  }
+}
+
 }  // namespace flutter
@@ -30,6 +30,8 @@ class PerformanceOverlayLayer : public Layer {
                                    const char* font_path = nullptr);
 
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
 
  private:
   int options_;
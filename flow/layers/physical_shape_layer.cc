@@ -4,6 +4,7 @@
 
 #include "flutter/flow/layers/physical_shape_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
 #include "flutter/flow/paint_utils.h"
 #include "third_party/skia/include/utils/SkShadowUtils.h"
 
@@ -159,4 +160,26 @@ void PhysicalShapeLayer::DrawShadow(SkCanvas* canvas,
       dpr * kLightRadius, ambientColor, spotColor, flags);
 }
 
+void PhysicalShapeLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->MixFingerprint(color_, shadow_color_, elevation_,
+                          path_.getGenerationID(), clip_behavior_);
+  context->AddPaintRegion(paint_bounds(), fml::HashCombine());
+  if (clip_behavior_ != Clip::none) {
+    context->ClipRect(path_.getBounds());
+  }
+  DiffChildren(context);
+}
+
+void PhysicalShapeLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kPhysicalShape, this)) {
+    writer->WriteUint32(color_);
+    writer->WriteUint32(shadow_color_);
+    writer->WriteScalar(elevation_);
+    writer->WritePath(path_);
+    writer->WriteUint32(clip_behavior_);
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
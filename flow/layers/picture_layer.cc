@@ -4,10 +4,109 @@
 
 #include "flutter/flow/layers/picture_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
 #include "flutter/fml/logging.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+#include "third_party/skia/include/utils/SkPaintFilterCanvas.h"
 
 namespace flutter {
 
+namespace {
+
+// Pictures with more operations than this almost always draw more than once,
+// so they are not played back to check.
+constexpr int kMaxOpacityCheckOpCount = 8;
+
+// Plays back pictures without drawing to find the ones whose draws can take
+// an inherited opacity.
+class OpacityCompatibilityChecker final : public SkPaintFilterCanvas {
+ public:
+  explicit OpacityCompatibilityChecker(SkCanvas* no_draw_canvas)
+      : SkPaintFilterCanvas(no_draw_canvas) {}
+
+  bool is_compatible() const { return is_compatible_ && draw_count_ <= 1; }
+
+ protected:
+  bool onFilter(SkPaint& paint) const override {
+    draw_count_++;
+    if (paint.getBlendMode() != SkBlendMode::kSrcOver ||
+        paint.getColorFilter() || paint.getImageFilter()) {
+      is_compatible_ = false;
+    }
+    return false;
+  }
+
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    is_compatible_ = false;
+    return kNoLayer_SaveLayerStrategy;
+  }
+
+  void onDrawPicture(const SkPicture* picture,
+                     const SkMatrix* matrix,
+                     const SkPaint* paint) override {
+    is_compatible_ = false;
+  }
+
+  void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+    is_compatible_ = false;
+  }
+
+  // The lines of a polygon overlap where they join, like the triangles of
+  // vertices and the sprites of an atlas can. |DisplayListBuilder| rejects
+  // them for the same reason.
+  void onDrawPoints(PointMode mode,
+                    size_t count,
+                    const SkPoint pts[],
+                    const SkPaint& paint) override {
+    is_compatible_ = false;
+  }
+
+  void onDrawVerticesObject(const SkVertices* vertices,
+                            SkBlendMode mode,
+                            const SkPaint& paint) override {
+    is_compatible_ = false;
+  }
+
+  void onDrawAtlas(const SkImage* atlas,
+                   const SkRSXform xform[],
+                   const SkRect tex[],
+                   const SkColor colors[],
+                   int count,
+                   SkBlendMode mode,
+                   const SkRect* cull,
+                   const SkPaint* paint) override {
+    is_compatible_ = false;
+  }
+
+  // Shadows are drawn without a paint, so they never reach |onFilter|.
+  void onDrawShadowRec(const SkPath& path,
+                       const SkDrawShadowRec& rec) override {
+    is_compatible_ = false;
+  }
+
+ private:
+  mutable int draw_count_ = 0;
+  mutable bool is_compatible_ = true;
+};
+
+// Plays back pictures with the alpha of their paints modulated by an opacity.
+class OpacityPaintFilterCanvas final : public SkPaintFilterCanvas {
+ public:
+  OpacityPaintFilterCanvas(SkCanvas* canvas, SkScalar opacity)
+      : SkPaintFilterCanvas(canvas), opacity_(opacity) {}
+
+ protected:
+  bool onFilter(SkPaint& paint) const override {
+    paint.setAlphaf(paint.getAlphaf() * opacity_);
+    return true;
+  }
+
+ private:
+  const SkScalar opacity_;
+};
+
+}  // namespace
+
 PictureLayer::PictureLayer(const SkPoint& offset,
                            SkiaGPUObject<SkPicture> picture,
                            bool is_complex,
@@ -36,10 +135,19 @@ void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 #endif
     cache->Prepare(context->gr_context, sk_picture, ctm,
                    context->dst_color_space, is_complex_, will_change_);
+    if (context->raster_cache_preparations) {
+      context->raster_cache_preparations->push_back(
+          {nullptr, sk_picture, ctm, is_complex_, will_change_});
+    }
   }
 
   SkRect bounds = sk_picture->cullRect().makeOffset(offset_.x(), offset_.y());
   set_paint_bounds(bounds);
+
+  if (!can_inherit_opacity_) {
+    can_inherit_opacity_ = CanInheritOpacity(*sk_picture);
+  }
+  context->subtree_can_inherit_opacity = *can_inherit_opacity_;
 }
 
 void PictureLayer::Paint(PaintContext& context) const {
@@ -54,12 +162,45 @@ void PictureLayer::Paint(PaintContext& context) const {
       context.leaf_nodes_canvas->getTotalMatrix()));
 #endif
 
+  const bool inherits_opacity = context.inherited_opacity < SK_Scalar1;
+  SkPaint opacity_paint;
+  opacity_paint.setAlphaf(context.inherited_opacity);
   if (context.raster_cache &&
-      context.raster_cache->Draw(*picture(), *context.leaf_nodes_canvas)) {
+      context.raster_cache->Draw(*picture(), *context.leaf_nodes_canvas,
+                                 inherits_opacity ? &opacity_paint : nullptr)) {
     TRACE_EVENT_INSTANT0("flutter", "raster cache hit");
     return;
   }
+  if (inherits_opacity) {
+    OpacityPaintFilterCanvas canvas(context.leaf_nodes_canvas,
+                                    context.inherited_opacity);
+    picture()->playback(&canvas);
+    return;
+  }
   picture()->playback(context.leaf_nodes_canvas);
 }
 
+bool PictureLayer::CanInheritOpacity(const SkPicture& picture) {
+  if (picture.approximateOpCount() > kMaxOpacityCheckOpCount) {
+    return false;
+  }
+  SkNoDrawCanvas no_draw_canvas(picture.cullRect().roundOut());
+  OpacityCompatibilityChecker checker(&no_draw_canvas);
+  picture.playback(&checker);
+  return checker.is_compatible();
+}
+
+void PictureLayer::Diff(DiffContext* context) const {
+  context->AddPaintRegion(paint_bounds(), picture()->uniqueID());
+}
+
+void PictureLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kPicture, this)) {
+    writer->WritePoint(offset_);
+    writer->WritePicture(*picture());
+    writer->WriteBool(is_complex_);
+    writer->WriteBool(will_change_);
+  }
+}
+
 }  // namespace flutter
@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_LAYERS_PICTURE_LAYER_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/raster_cache.h"
@@ -25,6 +26,13 @@ class PictureLayer : public Layer {
   void Preroll(PrerollContext* frame, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
+  void Capture(LayerTreeCaptureWriter* writer) const override;
+
+  // Whether the picture can be drawn with an inherited opacity by modulating
+  // the alpha of its paints, which is the case if it has a single draw that
+  // blends with source-over and does not filter.
+  static bool CanInheritOpacity(const SkPicture& picture);
 
  private:
   SkPoint offset_;
@@ -33,6 +41,8 @@ class PictureLayer : public Layer {
   SkiaGPUObject<SkPicture> picture_;
   bool is_complex_ = false;
   bool will_change_ = false;
+  // The result of CanInheritOpacity, which only depends on the picture.
+  std::optional<bool> can_inherit_opacity_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(PictureLayer);
 };
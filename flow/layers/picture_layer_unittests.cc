@@ -10,6 +10,10 @@
 #include "flutter/fml/macros.h"
 #include "flutter/testing/mock_canvas.h"
 #include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/core/SkVertices.h"
 
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
 #include "flutter/flow/raster_cache.h"
@@ -98,5 +102,65 @@ TEST_F(PictureLayerTest, SimplePicture) {
   EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
 }
 
+TEST_F(PictureLayerTest, OnlySingleSourceOverDrawsCanInheritOpacity) {
+  const SkRect bounds = SkRect::MakeWH(20.0f, 20.0f);
+  const SkPaint paint = SkPaint(SkColors::kRed);
+  SkPictureRecorder recorder;
+
+  recorder.beginRecording(bounds)->drawRect(bounds, paint);
+  EXPECT_TRUE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+
+  // The second draw would be blended over the first one.
+  SkCanvas* canvas = recorder.beginRecording(bounds);
+  canvas->drawRect(bounds, paint);
+  canvas->drawOval(bounds, paint);
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+
+  SkPaint src_paint = paint;
+  src_paint.setBlendMode(SkBlendMode::kSrc);
+  recorder.beginRecording(bounds)->drawRect(bounds, src_paint);
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+
+  canvas = recorder.beginRecording(bounds);
+  canvas->saveLayer(nullptr, nullptr);
+  canvas->drawRect(bounds, paint);
+  canvas->restore();
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+}
+
+TEST_F(PictureLayerTest, SelfOverlappingDrawsCannotInheritOpacity) {
+  const SkRect bounds = SkRect::MakeWH(20.0f, 20.0f);
+  const SkPaint paint = SkPaint(SkColors::kRed);
+  SkPictureRecorder recorder;
+
+  const SkPoint points[] = {{0, 0}, {20, 20}, {0, 20}, {20, 0}};
+  recorder.beginRecording(bounds)->drawPoints(SkCanvas::kPolygon_PointMode, 4,
+                                              points, paint);
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+
+  sk_sp<SkVertices> vertices = SkVertices::MakeCopy(
+      SkVertices::kTriangles_VertexMode, 3, points, nullptr, nullptr);
+  recorder.beginRecording(bounds)->drawVertices(vertices, SkBlendMode::kSrcOver,
+                                                paint);
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+
+  sk_sp<SkImage> atlas =
+      SkSurface::MakeRasterN32Premul(10, 10)->makeImageSnapshot();
+  const SkRSXform xforms[] = {SkRSXform::Make(1, 0, 0, 0),
+                              SkRSXform::Make(1, 0, 5, 5)};
+  const SkRect tex[] = {SkRect::MakeWH(10, 10), SkRect::MakeWH(10, 10)};
+  recorder.beginRecording(bounds)->drawAtlas(atlas.get(), xforms, tex, nullptr,
+                                             2, SkBlendMode::kSrcOver, nullptr,
+                                             &paint);
+  EXPECT_FALSE(
+      PictureLayer::CanInheritOpacity(*recorder.finishRecordingAsPicture()));
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -54,4 +54,10 @@ void PlatformViewLayer::UpdateScene(SceneUpdateContext& context) {
 }
 #endif
 
+void PlatformViewLayer::Diff(DiffContext* context) const {
+  // Platform views are composited by the embedder, which also decides how the
+  // layers painted above them are split into overlays.
+  context->MarkFullDamage();
+}
+
 }  // namespace flutter
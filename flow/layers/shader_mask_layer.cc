@@ -4,6 +4,8 @@
 
 #include "flutter/flow/layers/shader_mask_layer.h"
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 ShaderMaskLayer::ShaderMaskLayer(sk_sp<SkShader> shader,
@@ -37,4 +39,21 @@ void ShaderMaskLayer::Paint(PaintContext& context) const {
       SkRect::MakeWH(mask_rect_.width(), mask_rect_.height()), paint);
 }
 
+void ShaderMaskLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->MixFingerprint(shader_.get(), blend_mode_, mask_rect_.fLeft,
+                          mask_rect_.fTop, mask_rect_.fRight,
+                          mask_rect_.fBottom);
+  DiffChildren(context);
+}
+
+void ShaderMaskLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kShaderMask, this)) {
+    writer->WriteFlattenable(shader_.get());
+    writer->WriteRect(mask_rect_);
+    writer->WriteUint32(static_cast<uint32_t>(blend_mode_));
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
@@ -43,4 +43,15 @@ void TextureLayer::Paint(PaintContext& context) const {
                  context.gr_context, filter_quality_);
 }
 
+void TextureLayer::Diff(DiffContext* context) const {
+  if (!freeze_) {
+    // The texture can produce a new frame at any time without the layer tree
+    // changing.
+    context->AddVolatilePaintRegion(paint_bounds());
+    return;
+  }
+  context->AddPaintRegion(paint_bounds(),
+                          fml::HashCombine(texture_id_, filter_quality_));
+}
+
 }  // namespace flutter
@@ -22,6 +22,7 @@ class TextureLayer : public Layer {
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
+  void Diff(DiffContext* context) const override;
 
  private:
   SkPoint offset_;
@@ -6,6 +6,8 @@
 
 #include <optional>
 
+#include "flutter/flow/layer_tree_capture.h"
+
 namespace flutter {
 
 TransformLayer::TransformLayer(const SkMatrix& transform)
@@ -47,6 +49,7 @@ void TransformLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 
   transform_.mapRect(&child_paint_bounds);
   set_paint_bounds(child_paint_bounds);
+  context->subtree_can_inherit_opacity = children_can_inherit_opacity();
 
   context->cull_rect = previous_cull_rect;
   context->mutators_stack.Pop();
@@ -78,4 +81,17 @@ void TransformLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void TransformLayer::Diff(DiffContext* context) const {
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(transform_);
+  DiffChildren(context);
+}
+
+void TransformLayer::Capture(LayerTreeCaptureWriter* writer) const {
+  if (writer->WriteLayerHeader(CapturedLayerType::kTransform, this)) {
+    writer->WriteMatrix(transform_);
+    writer->WriteLayers(layers());
+  }
+}
+
 }  // namespace flutter
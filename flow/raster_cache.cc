@@ -4,6 +4,8 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
@@ -11,13 +13,121 @@
 #include "flutter/fml/logging.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkDrawable.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkShader.h"
 #include "third_party/skia/include/core/SkSurface.h"
 #include "third_party/skia/include/gpu/GrDirectContext.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+#include "third_party/skia/include/utils/SkPaintFilterCanvas.h"
 
 namespace flutter {
 
+namespace {
+
+// Looks for images backed by textures in what is drawn to it, including
+// images drawn through image shaders and nested pictures.
+class TextureBackedImageFinder final : public SkPaintFilterCanvas {
+ public:
+  explicit TextureBackedImageFinder(SkCanvas* no_draw_canvas)
+      : SkPaintFilterCanvas(no_draw_canvas) {}
+
+  bool found() const { return found_; }
+
+ protected:
+  bool onFilter(SkPaint& paint) const override {
+    if (paint.getShader()) {
+      Check(paint.getShader()->isAImage(nullptr, nullptr));
+    }
+    return false;
+  }
+
+  void onDrawImage(const SkImage* image,
+                   SkScalar left,
+                   SkScalar top,
+                   const SkPaint* paint) override {
+    Check(image);
+  }
+
+  void onDrawImageRect(const SkImage* image,
+                       const SkRect* src,
+                       const SkRect& dst,
+                       const SkPaint* paint,
+                       SrcRectConstraint constraint) override {
+    Check(image);
+  }
+
+  void onDrawImageLattice(const SkImage* image,
+                          const Lattice& lattice,
+                          const SkRect& dst,
+                          const SkPaint* paint) override {
+    Check(image);
+  }
+
+  void onDrawImageNine(const SkImage* image,
+                       const SkIRect& center,
+                       const SkRect& dst,
+                       const SkPaint* paint) override {
+    Check(image);
+  }
+
+  void onDrawAtlas(const SkImage* atlas,
+                   const SkRSXform xform[],
+                   const SkRect tex[],
+                   const SkColor colors[],
+                   int count,
+                   SkBlendMode mode,
+                   const SkRect* cull,
+                   const SkPaint* paint) override {
+    Check(atlas);
+  }
+
+  void onDrawEdgeAAImageSet(const ImageSetEntry set[],
+                            int count,
+                            const SkPoint dst_clips[],
+                            const SkMatrix pre_view_matrices[],
+                            const SkPaint* paint,
+                            SrcRectConstraint constraint) override {
+    for (int i = 0; i < count; i++) {
+      Check(set[i].fImage.get());
+    }
+  }
+
+  void onDrawPicture(const SkPicture* picture,
+                     const SkMatrix* matrix,
+                     const SkPaint* paint) override {
+    picture->playback(this);
+  }
+
+  void onDrawDrawable(SkDrawable* drawable, const SkMatrix* matrix) override {
+    drawable->draw(this, matrix);
+  }
+
+ private:
+  void Check(const SkImage* image) const {
+    if (image && image->isTextureBacked()) {
+      found_ = true;
+    }
+  }
+
+  mutable bool found_ = false;
+};
+
+// Whether |draw_function| draws images backed by textures. The workers
+// rasterize without a GPU context, so they can't read those, e.g. the images
+// decoded into textures of the resource context.
+bool DrawsTextureBackedImages(
+    const SkRect& bounds,
+    const std::function<void(SkCanvas*)>& draw_function) {
+  SkNoDrawCanvas no_draw_canvas(bounds.roundOut());
+  TextureBackedImageFinder finder(&no_draw_canvas);
+  draw_function(&finder);
+  return finder.found();
+}
+
+}  // namespace
+
 RasterCacheResult::RasterCacheResult(sk_sp<SkImage> image,
                                      const SkRect& logical_rect)
     : image_(std::move(image)), logical_rect_(logical_rect) {}
@@ -35,9 +145,11 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
 }
 
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t picture_cache_limit_per_frame)
+                         size_t picture_cache_limit_per_frame,
+                         size_t max_bytes)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
+      max_bytes_(max_bytes),
       checkerboard_images_(false) {}
 
 static bool CanRasterizePicture(SkPicture* picture) {
@@ -86,8 +198,28 @@ static bool IsPictureWorthRasterizing(SkPicture* picture,
   return picture->approximateOpCount() > 5;
 }
 
+static bool IsDisplayListWorthRasterizing(DisplayList* display_list,
+                                          bool will_change,
+                                          bool is_complex) {
+  if (will_change || display_list == nullptr) {
+    return false;
+  }
+
+  const SkRect& bounds = display_list->bounds();
+  if (bounds.isEmpty() || !bounds.isFinite()) {
+    return false;
+  }
+
+  if (is_complex) {
+    return true;
+  }
+
+  // The same heuristic as for pictures.
+  return display_list->op_count() > 5;
+}
+
 /// @note Procedure doesn't copy all closures.
-static std::unique_ptr<RasterCacheResult> Rasterize(
+static sk_sp<SkImage> RasterizeImage(
     GrDirectContext* context,
     const SkMatrix& ctm,
     SkColorSpace* dst_color_space,
@@ -119,8 +251,24 @@ static std::unique_ptr<RasterCacheResult> Rasterize(
     DrawCheckerboard(canvas, logical_rect);
   }
 
-  return std::make_unique<RasterCacheResult>(surface->makeImageSnapshot(),
-                                             logical_rect);
+  return surface->makeImageSnapshot();
+}
+
+/// @note Procedure doesn't copy all closures.
+static std::unique_ptr<RasterCacheResult> Rasterize(
+    GrDirectContext* context,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    bool checkerboard,
+    const SkRect& logical_rect,
+    const std::function<void(SkCanvas*)>& draw_function) {
+  sk_sp<SkImage> image = RasterizeImage(context, ctm, dst_color_space,
+                                        checkerboard, logical_rect,
+                                        draw_function);
+  if (!image) {
+    return nullptr;
+  }
+  return std::make_unique<RasterCacheResult>(std::move(image), logical_rect);
 }
 
 std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
@@ -134,13 +282,24 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
                    [=](SkCanvas* canvas) { canvas->drawPicture(picture); });
 }
 
+std::unique_ptr<RasterCacheResult> RasterCache::RasterizeDisplayList(
+    DisplayList* display_list,
+    GrDirectContext* context,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    bool checkerboard) const {
+  return Rasterize(
+      context, ctm, dst_color_space, checkerboard, display_list->bounds(),
+      [=](SkCanvas* canvas) { display_list->RenderTo(canvas); });
+}
+
 void RasterCache::Prepare(PrerollContext* context,
                           Layer* layer,
                           const SkMatrix& ctm) {
   LayerRasterCacheKey cache_key(layer->unique_id(), ctm);
   Entry& entry = layer_cache_[cache_key];
   entry.access_count++;
-  entry.used_this_frame = true;
+  MarkUsed(entry);
   if (!entry.image) {
     entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
   }
@@ -186,7 +345,10 @@ bool RasterCache::Prepare(GrDirectContext* context,
   if (access_threshold_ == 0) {
     return false;
   }
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+  // Rasterizing off the raster thread doesn't add to the frame time, so there
+  // is no need to spread the work across frames.
+  if (!async_state_ &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
     return false;
   }
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
@@ -212,30 +374,233 @@ bool RasterCache::Prepare(GrDirectContext* context,
     return false;
   }
 
+  if (!entry.image && async_state_ && !entry.needs_gpu_context) {
+    if (!entry.async_pending) {
+      auto draw_function = [picture = sk_ref_sp(picture)](SkCanvas* canvas) {
+        canvas->drawPicture(picture);
+      };
+      entry.needs_gpu_context =
+          DrawsTextureBackedImages(picture->cullRect(), draw_function);
+      if (!entry.needs_gpu_context) {
+        RasterizeAsync(cache_key, false, picture->cullRect(),
+                       transformation_matrix, dst_color_space,
+                       std::move(draw_function));
+        entry.async_pending = true;
+      }
+    }
+    if (!entry.needs_gpu_context) {
+      // The picture is drawn directly until a later frame publishes the
+      // result.
+      return false;
+    }
+  }
+
   if (!entry.image) {
+    if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+      return false;
+    }
     entry.image = RasterizePicture(picture, context, transformation_matrix,
                                    dst_color_space, checkerboard_images_);
+    entry.last_used_frame = frame_count_;
     picture_cached_this_frame_++;
   }
   return true;
 }
 
-bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
+bool RasterCache::Prepare(GrDirectContext* context,
+                          DisplayList* display_list,
+                          const SkMatrix& transformation_matrix,
+                          SkColorSpace* dst_color_space,
+                          bool is_complex,
+                          bool will_change) {
+  if (access_threshold_ == 0) {
+    return false;
+  }
+  if (!async_state_ &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+    return false;
+  }
+  if (!IsDisplayListWorthRasterizing(display_list, will_change, is_complex)) {
+    return false;
+  }
+
+  const MatrixDecomposition matrix(transformation_matrix);
+  if (!matrix.IsValid()) {
+    return false;
+  }
+
+  DisplayListRasterCacheKey cache_key(display_list->unique_id(),
+                                      transformation_matrix);
+  Entry& entry = display_list_cache_[cache_key];
+  if (entry.access_count < access_threshold_) {
+    return false;
+  }
+
+  if (!entry.image && async_state_ && !entry.needs_gpu_context) {
+    if (!entry.async_pending) {
+      auto draw_function = [display_list =
+                                sk_ref_sp(display_list)](SkCanvas* canvas) {
+        display_list->RenderTo(canvas);
+      };
+      entry.needs_gpu_context =
+          DrawsTextureBackedImages(display_list->bounds(), draw_function);
+      if (!entry.needs_gpu_context) {
+        RasterizeAsync(cache_key, true, display_list->bounds(),
+                       transformation_matrix, dst_color_space,
+                       std::move(draw_function));
+        entry.async_pending = true;
+      }
+    }
+    if (!entry.needs_gpu_context) {
+      return false;
+    }
+  }
+
+  if (!entry.image) {
+    if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+      return false;
+    }
+    entry.image = RasterizeDisplayList(display_list, context,
+                                       transformation_matrix, dst_color_space,
+                                       checkerboard_images_);
+    entry.last_used_frame = frame_count_;
+    picture_cached_this_frame_++;
+  }
+  return true;
+}
+
+void RasterCache::EnableAsyncRasterization(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    fml::RefPtr<fml::TaskRunner> upload_task_runner,
+    ImageUploader upload) {
+  FML_DCHECK(worker_task_runner);
+  async_state_ = std::make_shared<AsyncState>();
+  async_state_->worker_task_runner = std::move(worker_task_runner);
+  async_state_->upload_task_runner = std::move(upload_task_runner);
+  async_state_->upload = std::move(upload);
+  InvalidateAsyncRasterizations();
+}
+
+void RasterCache::RasterizeAsync(
+    const PictureRasterCacheKey& cache_key,
+    bool is_display_list,
+    const SkRect& logical_rect,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    std::function<void(SkCanvas*)> draw_function) {
+  TRACE_EVENT0("flutter", "RasterCache::RasterizeAsync");
+  auto publish = [state = async_state_, cache_key, is_display_list,
+                  generation = async_generation_,
+                  logical_rect](sk_sp<SkImage> image) {
+    std::scoped_lock lock(state->mutex);
+    state->results.push_back(
+        {cache_key, is_display_list, generation,
+         image ? std::make_unique<RasterCacheResult>(std::move(image),
+                                                     logical_rect)
+               : nullptr});
+  };
+
+  auto rasterize = [state = async_state_, logical_rect, ctm,
+                    dst_color_space = sk_ref_sp(dst_color_space),
+                    checkerboard = checkerboard_images_,
+                    draw_function = std::move(draw_function), publish]() {
+    // Workers rasterize on the CPU since they have no GPU context.
+    sk_sp<SkImage> image =
+        RasterizeImage(nullptr, ctm, dst_color_space.get(), checkerboard,
+                       logical_rect, draw_function);
+    if (!image || !state->upload_task_runner) {
+      publish(std::move(image));
+      return;
+    }
+    state->upload_task_runner->PostTask([state, image, publish]() {
+      TRACE_EVENT0("flutter", "RasterCacheUpload");
+      publish(state->upload ? state->upload(image) : image);
+    });
+  };
+
+  async_state_->worker_task_runner->PostTask(rasterize);
+}
+
+void RasterCache::PublishAsyncResults() {
+  if (!async_state_) {
+    return;
+  }
+
+  std::vector<AsyncResult> results;
+  {
+    std::scoped_lock lock(async_state_->mutex);
+    results.swap(async_state_->results);
+  }
+
+  for (auto& result : results) {
+    if (result.generation != async_generation_) {
+      // Started before the cache was cleared.
+      continue;
+    }
+    auto& cache = result.is_display_list ? display_list_cache_ : picture_cache_;
+    auto it = cache.find(result.cache_key);
+    if (it == cache.end()) {
+      continue;
+    }
+    Entry& entry = it->second;
+    entry.async_pending = false;
+    if (!entry.image) {
+      entry.image = std::move(result.image);
+    }
+  }
+}
+
+void RasterCache::InvalidateAsyncRasterizations() {
+  // Results of the rasterizations in flight are dropped when published.
+  async_generation_++;
+}
+
+bool RasterCache::Draw(const SkPicture& picture,
+                       SkCanvas& canvas,
+                       const SkPaint* paint) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
   auto it = picture_cache_.find(cache_key);
   if (it == picture_cache_.end()) {
+    metrics_.miss_count++;
     return false;
   }
 
   Entry& entry = it->second;
   entry.access_count++;
-  entry.used_this_frame = true;
+  MarkUsed(entry);
+
+  if (entry.image) {
+    entry.image->draw(canvas, paint);
+    metrics_.hit_count++;
+    return true;
+  }
+
+  metrics_.miss_count++;
+  return false;
+}
+
+bool RasterCache::Draw(const DisplayList& display_list,
+                       SkCanvas& canvas,
+                       const SkPaint* paint) const {
+  DisplayListRasterCacheKey cache_key(display_list.unique_id(),
+                                      canvas.getTotalMatrix());
+  auto it = display_list_cache_.find(cache_key);
+  if (it == display_list_cache_.end()) {
+    metrics_.miss_count++;
+    return false;
+  }
+
+  Entry& entry = it->second;
+  entry.access_count++;
+  MarkUsed(entry);
 
   if (entry.image) {
-    entry.image->draw(canvas, nullptr);
+    entry.image->draw(canvas, paint);
+    metrics_.hit_count++;
     return true;
   }
 
+  metrics_.miss_count++;
   return false;
 }
 
@@ -245,35 +610,127 @@ bool RasterCache::Draw(const Layer* layer,
   LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix());
   auto it = layer_cache_.find(cache_key);
   if (it == layer_cache_.end()) {
+    metrics_.miss_count++;
     return false;
   }
 
   Entry& entry = it->second;
   entry.access_count++;
-  entry.used_this_frame = true;
+  MarkUsed(entry);
 
   if (entry.image) {
     entry.image->draw(canvas, paint);
+    metrics_.hit_count++;
     return true;
   }
 
+  metrics_.miss_count++;
   return false;
 }
 
+void RasterCache::MarkUsed(Entry& entry) const {
+  entry.used_this_frame = true;
+  entry.last_used_frame = frame_count_;
+}
+
 void RasterCache::SweepAfterFrame() {
-  SweepOneCacheAfterFrame(picture_cache_);
-  SweepOneCacheAfterFrame(layer_cache_);
+  std::vector<PictureRasterCacheKey::Map<Entry>::iterator> unused_pictures;
+  std::vector<DisplayListRasterCacheKey::Map<Entry>::iterator>
+      unused_display_lists;
+  std::vector<LayerRasterCacheKey::Map<Entry>::iterator> unused_layers;
+  SweepOneCacheAfterFrame(picture_cache_, &unused_pictures);
+  SweepOneCacheAfterFrame(display_list_cache_, &unused_display_lists);
+  SweepOneCacheAfterFrame(layer_cache_, &unused_layers);
+  EvictToBudget(unused_pictures, unused_display_lists, unused_layers);
   picture_cached_this_frame_ = 0;
+  frame_count_++;
+  TraceStatsToTimeline();
+}
+
+void RasterCache::EvictToBudget(
+    std::vector<PictureRasterCacheKey::Map<Entry>::iterator>& pictures,
+    std::vector<DisplayListRasterCacheKey::Map<Entry>::iterator>&
+        display_lists,
+    std::vector<LayerRasterCacheKey::Map<Entry>::iterator>& layers) {
+  if (pictures.empty() && display_lists.empty() && layers.empty()) {
+    return;
+  }
+  size_t cache_bytes =
+      EstimatePictureCacheByteSize() + EstimateLayerCacheByteSize();
+  if (cache_bytes <= max_bytes_) {
+    return;
+  }
+
+  auto least_recently_used_first = [](const auto& a, const auto& b) {
+    return a->second.last_used_frame < b->second.last_used_frame;
+  };
+  std::sort(pictures.begin(), pictures.end(), least_recently_used_first);
+  std::sort(display_lists.begin(), display_lists.end(),
+            least_recently_used_first);
+  std::sort(layers.begin(), layers.end(), least_recently_used_first);
+
+  // The frame the next candidate of |candidates| was last used in.
+  auto next_frame = [](const auto& candidates, size_t index) {
+    return index < candidates.size()
+               ? candidates[index]->second.last_used_frame
+               : std::numeric_limits<size_t>::max();
+  };
+
+  // Erasing from an unordered_map only invalidates iterators to the erased
+  // element, so the remaining candidates stay valid.
+  size_t picture_index = 0;
+  size_t display_list_index = 0;
+  size_t layer_index = 0;
+  while (cache_bytes > max_bytes_ &&
+         (picture_index < pictures.size() ||
+          display_list_index < display_lists.size() ||
+          layer_index < layers.size())) {
+    const size_t picture_frame = next_frame(pictures, picture_index);
+    const size_t display_list_frame =
+        next_frame(display_lists, display_list_index);
+    const size_t layer_frame = next_frame(layers, layer_index);
+    if (picture_index < pictures.size() &&
+        picture_frame <= display_list_frame && picture_frame <= layer_frame) {
+      auto it = pictures[picture_index++];
+      cache_bytes -= it->second.image->image_bytes();
+      picture_cache_.erase(it);
+    } else if (display_list_index < display_lists.size() &&
+               display_list_frame <= layer_frame) {
+      auto it = display_lists[display_list_index++];
+      cache_bytes -= it->second.image->image_bytes();
+      display_list_cache_.erase(it);
+    } else {
+      auto it = layers[layer_index++];
+      cache_bytes -= it->second.image->image_bytes();
+      layer_cache_.erase(it);
+    }
+    metrics_.eviction_count++;
+  }
+}
+
+void RasterCache::EvictUnusedEntries() {
+  // Entries used in the frame that was last drawn are likely to be needed for
+  // the next one as well, so only drop the ones used before that.
+  const size_t oldest_kept_frame = frame_count_ > 0 ? frame_count_ - 1 : 0;
+  metrics_.eviction_count +=
+      EvictOneCacheBefore(picture_cache_, oldest_kept_frame);
+  metrics_.eviction_count +=
+      EvictOneCacheBefore(display_list_cache_, oldest_kept_frame);
+  metrics_.eviction_count +=
+      EvictOneCacheBefore(layer_cache_, oldest_kept_frame);
   TraceStatsToTimeline();
 }
 
 void RasterCache::Clear() {
   picture_cache_.clear();
+  display_list_cache_.clear();
   layer_cache_.clear();
+  InvalidateAsyncRasterizations();
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
-  return layer_cache_.size() + picture_cache_.size();
+  return layer_cache_.size() + picture_cache_.size() +
+         display_list_cache_.size();
 }
 
 size_t RasterCache::GetLayerCachedEntriesCount() const {
@@ -281,7 +738,7 @@ size_t RasterCache::GetLayerCachedEntriesCount() const {
 }
 
 size_t RasterCache::GetPictureCachedEntriesCount() const {
-  return picture_cache_.size();
+  return picture_cache_.size() + display_list_cache_.size();
 }
 
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
@@ -296,15 +753,23 @@ void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   Clear();
 }
 
-void RasterCache::TraceStatsToTimeline() const {
+void RasterCache::TraceStatsToTimeline() {
 #if !FLUTTER_RELEASE
   constexpr double kMegaBytes = (1 << 20);
   FML_TRACE_COUNTER("flutter", "RasterCache", reinterpret_cast<int64_t>(this),
                     "LayerCount", layer_cache_.size(), "LayerMBytes",
                     EstimateLayerCacheByteSize() / kMegaBytes, "PictureCount",
-                    picture_cache_.size(), "PictureMBytes",
+                    GetPictureCachedEntriesCount(), "PictureMBytes",
                     EstimatePictureCacheByteSize() / kMegaBytes);
 
+  // The accesses are reported per traced interval (usually a frame) rather
+  // than as running totals so that hit rate drops stand out on the timeline.
+  FML_TRACE_COUNTER(
+      "flutter", "RasterCacheAccesses", reinterpret_cast<int64_t>(this),
+      "Hits", metrics_.hit_count - last_traced_metrics_.hit_count, "Misses",
+      metrics_.miss_count - last_traced_metrics_.miss_count, "Evictions",
+      metrics_.eviction_count - last_traced_metrics_.eviction_count);
+  last_traced_metrics_ = metrics_;
 #endif  // !FLUTTER_RELEASE
 }
 
@@ -325,6 +790,11 @@ size_t RasterCache::EstimatePictureCacheByteSize() const {
       picture_cache_bytes += item.second.image->image_bytes();
     }
   }
+  for (const auto& item : display_list_cache_) {
+    if (item.second.image) {
+      picture_cache_bytes += item.second.image->image_bytes();
+    }
+  }
   return picture_cache_bytes;
 }
 
@@ -5,12 +5,18 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
+#include "flutter/flow/display_list.h"
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -47,9 +53,29 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // The default number of times a picture or layer must be prepared before it
+  // is cached.
+  static constexpr size_t kDefaultAccessThreshold = 3;
+
+  // The default number of bytes that the cache may keep for entries that were
+  // not used in the last frame. Entries that are used in a frame are always
+  // kept, so the cache may grow beyond this while they are on screen.
+  static constexpr size_t kDefaultMaxBytes = 32 << 20;
+
+  struct Metrics {
+    // The number of |Draw| calls that found a cached image.
+    size_t hit_count = 0;
+    // The number of |Draw| calls that didn't find a cached image.
+    size_t miss_count = 0;
+    // The number of cached images dropped to stay within the byte budget or
+    // in response to memory pressure.
+    size_t eviction_count = 0;
+  };
+
   explicit RasterCache(
-      size_t access_threshold = 3,
-      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
+      size_t access_threshold = kDefaultAccessThreshold,
+      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame,
+      size_t max_bytes = kDefaultMaxBytes);
 
   virtual ~RasterCache() = default;
 
@@ -75,6 +101,28 @@ class RasterCache {
       SkColorSpace* dst_color_space,
       bool checkerboard) const;
 
+  /**
+   * @brief Rasterize a display list and produce a RasterCacheResult
+   * to be stored in the cache.
+   *
+   * @param display_list the DisplayList to be cached.
+   * @param context the GrDirectContext used for rendering.
+   * @param ctm the transformation matrix used for rendering.
+   * @param dst_color_space the destination color space that the cached
+   *        rendering will be drawn into
+   * @param checkerboard a flag indicating whether or not a checkerboard
+   *        pattern should be rendered into the cached image for debug
+   *        analysis
+   * @return a RasterCacheResult that can draw the rendered display list into
+   *         the destination using a simple image blit
+   */
+  virtual std::unique_ptr<RasterCacheResult> RasterizeDisplayList(
+      DisplayList* display_list,
+      GrDirectContext* context,
+      const SkMatrix& ctm,
+      SkColorSpace* dst_color_space,
+      bool checkerboard) const;
+
   /**
    * @brief Rasterize an engine Layer and produce a RasterCacheResult
    * to be stored in the cache.
@@ -132,6 +180,10 @@ class RasterCache {
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
   //    (See also kDefaultPictureCacheLimitPerFrame.)
+  //
+  // When asynchronous rasterization is enabled, the cache is instead populated
+  // off the raster thread and this only returns true once a previous frame's
+  // rasterization has been published.
   bool Prepare(GrDirectContext* context,
                SkPicture* picture,
                const SkMatrix& transformation_matrix,
@@ -139,12 +191,59 @@ class RasterCache {
                bool is_complex,
                bool will_change);
 
+  // Like the above, for the display lists that the framework records.
+  bool Prepare(GrDirectContext* context,
+               DisplayList* display_list,
+               const SkMatrix& transformation_matrix,
+               SkColorSpace* dst_color_space,
+               bool is_complex,
+               bool will_change);
+
+  // Turns a CPU backed image rasterized by a worker into the image that is
+  // stored in the cache.
+  using ImageUploader = std::function<sk_sp<SkImage>(sk_sp<SkImage>)>;
+
+  /**
+   * @brief Rasterize pictures away from the raster thread.
+   *
+   * Pictures that qualify for caching are rasterized into CPU backed images on
+   * |worker_task_runner|. If |upload_task_runner| is set, |upload| is then
+   * called on it with each image, e.g. to upload it to a texture using a
+   * resource context that shares its textures with the onscreen one. The
+   * results are published by |PublishAsyncResults| when a later frame begins,
+   * so populating the cache never delays the frame that requested it.
+   *
+   * Layers, and pictures that draw images backed by textures, are still
+   * rasterized synchronously since painting them may need the onscreen
+   * context.
+   */
+  void EnableAsyncRasterization(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      fml::RefPtr<fml::TaskRunner> upload_task_runner = nullptr,
+      ImageUploader upload = nullptr);
+
+  // Moves the images rasterized asynchronously since the last call into the
+  // cache. Called at the beginning of each frame.
+  void PublishAsyncResults();
+
   void Prepare(PrerollContext* context, Layer* layer, const SkMatrix& ctm);
 
   // Find the raster cache for the picture and draw it to the canvas.
   //
+  // Addional paint can be given to change how the raster cache is drawn (e.g.,
+  // draw the raster cache with an inherited opacity).
+  //
   // Return true if it's found and drawn.
-  bool Draw(const SkPicture& picture, SkCanvas& canvas) const;
+  bool Draw(const SkPicture& picture,
+            SkCanvas& canvas,
+            const SkPaint* paint = nullptr) const;
+
+  // Find the raster cache for the display list and draw it to the canvas.
+  //
+  // Return true if it's found and drawn.
+  bool Draw(const DisplayList& display_list,
+            SkCanvas& canvas,
+            const SkPaint* paint = nullptr) const;
 
   // Find the raster cache for the layer and draw it to the canvas.
   //
@@ -156,8 +255,15 @@ class RasterCache {
             SkCanvas& canvas,
             SkPaint* paint = nullptr) const;
 
+  // Drops the entries that were not used in the frame that just ended. Unused
+  // entries holding an image are kept, least recently used first, as long as
+  // the cache stays within its byte budget.
   void SweepAfterFrame();
 
+  // Drops every entry that was not used in the current or the last frame,
+  // regardless of the byte budget. Called when the system is low on memory.
+  void EvictUnusedEntries();
+
   void Clear();
 
   void SetCheckboardCacheImages(bool checkerboard);
@@ -166,11 +272,12 @@ class RasterCache {
 
   size_t GetLayerCachedEntriesCount() const;
 
+  // Includes the entries of display lists.
   size_t GetPictureCachedEntriesCount() const;
 
   /**
-   * @brief Estimate how much memory is used by picture raster cache entries in
-   * bytes.
+   * @brief Estimate how much memory is used by picture and display list raster
+   * cache entries in bytes.
    *
    * Only SkImage's memory usage is counted as other objects are often much
    * smaller compared to SkImage. SkImageInfo::computeMinByteSize is used to
@@ -188,21 +295,59 @@ class RasterCache {
    */
   size_t EstimateLayerCacheByteSize() const;
 
+  size_t max_bytes() const { return max_bytes_; }
+
+  // Counters accumulated since the cache was created.
+  const Metrics& metrics() const { return metrics_; }
+
  private:
   struct Entry {
     bool used_this_frame = false;
+    // Whether an asynchronous rasterization of the entry is in flight.
+    bool async_pending = false;
+    // Whether the entry draws images backed by textures. It is then
+    // rasterized on the raster thread even if asynchronous rasterization is
+    // enabled.
+    bool needs_gpu_context = false;
+    size_t last_used_frame = 0;
     size_t access_count = 0;
     std::unique_ptr<RasterCacheResult> image;
   };
 
+  struct AsyncResult {
+    PictureRasterCacheKey cache_key;
+    // Whether |cache_key| is a DisplayListRasterCacheKey.
+    bool is_display_list;
+    size_t generation;
+    std::unique_ptr<RasterCacheResult> image;
+  };
+
+  // Shared with the rasterization tasks so that they can safely outlive the
+  // cache.
+  struct AsyncState {
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner;
+    fml::RefPtr<fml::TaskRunner> upload_task_runner;
+    ImageUploader upload;
+    std::mutex mutex;
+    std::vector<AsyncResult> results;
+  };
+
+  // Removes the entries that were not used this frame and hold no image, and
+  // collects the unused entries holding an image into |unused|.
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
+  static void SweepOneCacheAfterFrame(
+      Cache& cache,
+      std::vector<typename Cache::iterator>* unused) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
       Entry& entry = it->second;
       if (!entry.used_this_frame) {
-        dead.push_back(it);
+        if (entry.image) {
+          unused->push_back(it);
+        } else if (!entry.async_pending) {
+          dead.push_back(it);
+        }
       }
       entry.used_this_frame = false;
     }
@@ -212,14 +357,58 @@ class RasterCache {
     }
   }
 
+  // Removes the entries last used before |frame| and returns the number of
+  // images dropped.
+  template <class Cache>
+  static size_t EvictOneCacheBefore(Cache& cache, size_t frame) {
+    size_t evicted = 0;
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (it->second.last_used_frame < frame) {
+        evicted += it->second.image ? 1 : 0;
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return evicted;
+  }
+
+  void MarkUsed(Entry& entry) const;
+
+  // Rasterizes |draw_function| on a worker. It must own what it draws since
+  // it runs after the frame.
+  void RasterizeAsync(const PictureRasterCacheKey& cache_key,
+                      bool is_display_list,
+                      const SkRect& logical_rect,
+                      const SkMatrix& ctm,
+                      SkColorSpace* dst_color_space,
+                      std::function<void(SkCanvas*)> draw_function);
+
+  void InvalidateAsyncRasterizations();
+
+  void EvictToBudget(
+      std::vector<PictureRasterCacheKey::Map<Entry>::iterator>& pictures,
+      std::vector<DisplayListRasterCacheKey::Map<Entry>::iterator>&
+          display_lists,
+      std::vector<LayerRasterCacheKey::Map<Entry>::iterator>& layers);
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
+  const size_t max_bytes_;
   size_t picture_cached_this_frame_ = 0;
+  size_t frame_count_ = 0;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
+  mutable DisplayListRasterCacheKey::Map<Entry> display_list_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
+  mutable Metrics metrics_;
+  Metrics last_traced_metrics_;
   bool checkerboard_images_;
+  std::shared_ptr<AsyncState> async_state_;
+  // Incremented whenever the cache is cleared so that the asynchronous
+  // rasterizations in flight at that time are not published.
+  size_t async_generation_ = 0;
 
-  void TraceStatsToTimeline() const;
+  void TraceStatsToTimeline();
 
   FML_DISALLOW_COPY_AND_ASSIGN(RasterCache);
 };
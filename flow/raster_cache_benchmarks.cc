@@ -0,0 +1,99 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/raster_cache.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flutter {
+
+namespace {
+
+sk_sp<SkPicture> GetSamplePicture() {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(20, 20));
+  SkPaint paint;
+  paint.setColor(SK_ColorRED);
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeXYWH(2, 2, 16, 16),
+                                          paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+// The matrices a picture is drawn with during a zoom animation.
+std::vector<SkMatrix> GetScaleVariants(int count) {
+  std::vector<SkMatrix> matrices;
+  for (int i = 0; i < count; i++) {
+    const SkScalar scale = 1 + i * 0.01f;
+    matrices.push_back(SkMatrix::Scale(scale, scale));
+  }
+  return matrices;
+}
+
+// Fills a cache with an image of |picture| for each of |matrices|.
+void PopulateCache(RasterCache& cache,
+                   SkPicture* picture,
+                   const std::vector<SkMatrix>& matrices) {
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  SkCanvas canvas;
+  // The first frame only counts the accesses, the second one rasterizes.
+  for (int frame = 0; frame < 2; frame++) {
+    for (const SkMatrix& matrix : matrices) {
+      cache.Prepare(nullptr, picture, matrix, srgb.get(), true, false);
+      canvas.setMatrix(matrix);
+      cache.Draw(*picture, canvas);
+    }
+    cache.SweepAfterFrame();
+  }
+  FML_CHECK(cache.GetPictureCachedEntriesCount() == matrices.size());
+}
+
+}  // namespace
+
+static void BM_RasterCachePrepareScaleVariants(
+    benchmark::State& state) {  // NOLINT
+  const auto matrices = GetScaleVariants(state.range(0));
+  auto picture = GetSamplePicture();
+  RasterCache cache(1, matrices.size());
+  PopulateCache(cache, picture.get(), matrices);
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  while (state.KeepRunning()) {
+    for (const SkMatrix& matrix : matrices) {
+      benchmark::DoNotOptimize(cache.Prepare(nullptr, picture.get(), matrix,
+                                             srgb.get(), true, false));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * matrices.size());
+}
+
+static void BM_RasterCacheDrawScaleVariants(
+    benchmark::State& state) {  // NOLINT
+  const auto matrices = GetScaleVariants(state.range(0));
+  auto picture = GetSamplePicture();
+  RasterCache cache(1, matrices.size());
+  PopulateCache(cache, picture.get(), matrices);
+  SkCanvas canvas;
+
+  while (state.KeepRunning()) {
+    for (const SkMatrix& matrix : matrices) {
+      canvas.setMatrix(matrix);
+      benchmark::DoNotOptimize(cache.Draw(*picture, canvas));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * matrices.size());
+}
+
+BENCHMARK(BM_RasterCachePrepareScaleVariants)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
+BENCHMARK(BM_RasterCacheDrawScaleVariants)->RangeMultiplier(4)->Range(1, 256);
+
+}  // namespace flutter
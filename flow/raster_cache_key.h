@@ -7,6 +7,7 @@
 
 #include <unordered_map>
 #include "flutter/flow/matrix_decomposition.h"
+#include "flutter/fml/hash_combine.h"
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -15,16 +16,34 @@ template <typename ID>
 class RasterCacheKey {
  public:
   RasterCacheKey(ID id, const SkMatrix& ctm) : id_(id), matrix_(ctm) {
+#ifdef SUPPORT_FRACTIONAL_TRANSLATION
+    // The content is rasterized at the fractional part of the translation.
+    matrix_[SkMatrix::kMTransX] = SkScalarFraction(ctm.getTranslateX());
+    matrix_[SkMatrix::kMTransY] = SkScalarFraction(ctm.getTranslateY());
+#else
+    // Translations are snapped to whole pixels, see
+    // RasterCache::GetIntegralTransCTM, so only their integral part is left.
     matrix_[SkMatrix::kMTransX] = 0;
     matrix_[SkMatrix::kMTransY] = 0;
+#endif
   }
 
   ID id() const { return id_; }
   const SkMatrix& matrix() const { return matrix_; }
 
+  // The matrix is part of the hash so that the variants of the same content
+  // cached at different scales (e.g. during a zoom animation) don't all end
+  // up in the same bucket.
   struct Hash {
-    uint32_t operator()(RasterCacheKey const& key) const {
-      return std::hash<ID>()(key.id_);
+    std::size_t operator()(RasterCacheKey const& key) const {
+      std::size_t seed = fml::HashCombine(key.id_);
+      for (int i = 0; i < 9; i++) {
+        // |Equal| compares the components as floats, where 0 == -0, so both
+        // zeros must hash the same.
+        const SkScalar value = key.matrix_[i];
+        fml::HashCombineSeed(seed, value == 0 ? 0.0f : value);
+      }
+      return seed;
     }
   };
 
@@ -41,16 +60,17 @@ class RasterCacheKey {
  private:
   ID id_;
 
-  // ctm where only fractional (0-1) translations are preserved:
-  //   matrix_ = ctm;
-  //   matrix_[SkMatrix::kMTransX] = SkScalarFraction(ctm.getTranslateX());
-  //   matrix_[SkMatrix::kMTransY] = SkScalarFraction(ctm.getTranslateY());
+  // ctm where only fractional (0-1) translations are preserved, or none
+  // without SUPPORT_FRACTIONAL_TRANSLATION.
   SkMatrix matrix_;
 };
 
 // The ID is the uint32_t picture uniqueID
 using PictureRasterCacheKey = RasterCacheKey<uint32_t>;
 
+// The ID is the uint32_t display list unique_id
+using DisplayListRasterCacheKey = RasterCacheKey<uint32_t>;
+
 class Layer;
 
 // The ID is the uint64_t layer unique_id
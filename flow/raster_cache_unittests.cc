@@ -4,11 +4,15 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
 
 namespace flutter {
 namespace testing {
@@ -24,6 +28,13 @@ sk_sp<SkPicture> GetSamplePicture() {
   return recorder.finishRecordingAsPicture();
 }
 
+// Waits for the tasks posted to a single worker loop so far to complete.
+void WaitForWorker(const std::shared_ptr<fml::ConcurrentTaskRunner>& worker) {
+  fml::AutoResetWaitableEvent latch;
+  worker->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+}
+
 }  // namespace
 
 TEST(RasterCache, SimpleInitialization) {
@@ -105,7 +116,9 @@ TEST(RasterCache, PictureCacheLimitPerFrameIsRespectedWhenZero) {
 
 TEST(RasterCache, SweepsRemoveUnusedFrames) {
   size_t threshold = 1;
-  flutter::RasterCache cache(threshold);
+  size_t max_bytes = 0;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureCacheLimitPerFrame, max_bytes);
 
   SkMatrix matrix = SkMatrix::I();
 
@@ -132,6 +145,291 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, SweepsKeepUnusedEntriesWithinBudget) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // Extra frames without a Get image access.
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.metrics().eviction_count, 0u);
+}
+
+TEST(RasterCache, SweepsEvictLeastRecentlyUsedEntriesOverBudget) {
+  // The sample picture is rasterized into a 150x100 N32 image.
+  const size_t image_bytes = 150 * 100 * 4;
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureCacheLimitPerFrame,
+      2 * image_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  auto picture3 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  auto prepare_and_draw = [&](SkPicture* picture) {
+    cache.Prepare(NULL, picture, matrix, srgb.get(), true, false);
+    return cache.Draw(*picture, dummy_canvas);
+  };
+
+  ASSERT_FALSE(prepare_and_draw(picture1.get()));
+  ASSERT_FALSE(prepare_and_draw(picture2.get()));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(prepare_and_draw(picture1.get()));
+  ASSERT_TRUE(prepare_and_draw(picture2.get()));
+  cache.SweepAfterFrame();
+
+  // picture1 is no longer used, but still fits in the budget.
+  ASSERT_TRUE(prepare_and_draw(picture2.get()));
+  ASSERT_FALSE(prepare_and_draw(picture3.get()));
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2 * image_bytes);
+  ASSERT_EQ(cache.metrics().eviction_count, 0u);
+
+  // Caching picture3 exceeds the budget, so the least recently used picture1
+  // is evicted.
+  ASSERT_TRUE(prepare_and_draw(picture3.get()));
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2 * image_bytes);
+  ASSERT_EQ(cache.metrics().eviction_count, 1u);
+
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture3, dummy_canvas));
+}
+
+TEST(RasterCache, EvictUnusedEntriesDropsEntriesNotUsedInLastFrame) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto old_picture = GetSamplePicture();
+  auto recent_picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  auto prepare_and_draw = [&](SkPicture* picture) {
+    cache.Prepare(NULL, picture, matrix, srgb.get(), true, false);
+    return cache.Draw(*picture, dummy_canvas);
+  };
+
+  ASSERT_FALSE(prepare_and_draw(old_picture.get()));
+  ASSERT_FALSE(prepare_and_draw(recent_picture.get()));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(prepare_and_draw(old_picture.get()));
+  ASSERT_TRUE(prepare_and_draw(recent_picture.get()));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(prepare_and_draw(recent_picture.get()));
+  cache.SweepAfterFrame();
+
+  cache.EvictUnusedEntries();
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 1u);
+  ASSERT_EQ(cache.metrics().eviction_count, 1u);
+  ASSERT_FALSE(cache.Draw(*old_picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*recent_picture, dummy_canvas));
+}
+
+TEST(RasterCache, MetricsCountHitsAndMisses) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+  auto unknown_picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*unknown_picture, dummy_canvas));
+  ASSERT_EQ(cache.metrics().hit_count, 0u);
+  ASSERT_EQ(cache.metrics().miss_count, 2u);
+
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.metrics().hit_count, 2u);
+  ASSERT_EQ(cache.metrics().miss_count, 2u);
+}
+
+TEST(RasterCache, AsyncRasterizationPublishesInLaterFrame) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto worker = loop->GetTaskRunner();
+  cache.EnableAsyncRasterization(worker);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The threshold is reached, but the picture is rasterized by the worker.
+  cache.PublishAsyncResults();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  WaitForWorker(worker);
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+
+  cache.PublishAsyncResults();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, AsyncRasterizationIsNotPublishedAfterClear) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto worker = loop->GetTaskRunner();
+  cache.EnableAsyncRasterization(worker);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.Clear();
+
+  WaitForWorker(worker);
+  cache.PublishAsyncResults();
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 0u);
+}
+
+TEST(RasterCache, AsyncRasterizationSkipsTextureBackedImages) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  cache.EnableAsyncRasterization(loop->GetTaskRunner());
+
+  sk_sp<GrDirectContext> gr_context = GrDirectContext::MakeMock(nullptr);
+  auto surface = SkSurface::MakeRenderTarget(
+      gr_context.get(), SkBudgeted::kNo, SkImageInfo::MakeN32Premul(10, 10));
+  ASSERT_NE(surface, nullptr);
+  sk_sp<SkImage> texture_image = surface->makeImageSnapshot();
+  ASSERT_TRUE(texture_image->isTextureBacked());
+
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(150, 100));
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeXYWH(10, 10, 80, 80),
+                                          SkPaint());
+  recorder.getRecordingCanvas()->drawImage(texture_image, 20, 20);
+  auto picture = recorder.finishRecordingAsPicture();
+
+  SkMatrix matrix = SkMatrix::I();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.Prepare(gr_context.get(), picture.get(), matrix,
+                             srgb.get(), true, false));
+  cache.SweepAfterFrame();
+
+  // The workers can't read the texture, so the picture is rasterized in the
+  // frame that reaches the threshold, like without asynchronous rasterization.
+  cache.PublishAsyncResults();
+  ASSERT_TRUE(cache.Prepare(gr_context.get(), picture.get(), matrix,
+                            srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, KeyHashIncludesMatrix) {
+  PictureRasterCacheKey::Hash hash;
+  PictureRasterCacheKey key(1, SkMatrix::I());
+
+  EXPECT_NE(hash(key), hash(PictureRasterCacheKey(1, SkMatrix::Scale(2, 2))));
+  EXPECT_NE(hash(key), hash(PictureRasterCacheKey(2, SkMatrix::I())));
+}
+
+TEST(RasterCache, EqualKeysHaveEqualHashes) {
+  PictureRasterCacheKey::Hash hash;
+  PictureRasterCacheKey::Equal equal;
+
+  // Integral translations are dropped from the key.
+  PictureRasterCacheKey key(1, SkMatrix::Translate(3, 4));
+  PictureRasterCacheKey translated_key(1, SkMatrix::Translate(10, 20));
+  EXPECT_TRUE(equal(key, translated_key));
+  EXPECT_EQ(hash(key), hash(translated_key));
+
+  PictureRasterCacheKey positive_zero_key(
+      1, SkMatrix::MakeAll(1, 0, 0, 0, 1, 0, 0, 0, 1));
+  PictureRasterCacheKey negative_zero_key(
+      1, SkMatrix::MakeAll(1, -0.0f, 0, -0.0f, 1, 0, 0, 0, 1));
+  EXPECT_TRUE(equal(positive_zero_key, negative_zero_key));
+  EXPECT_EQ(hash(positive_zero_key), hash(negative_zero_key));
+}
+
+TEST(RasterCache, KeyKeepsFractionalTranslation) {
+  PictureRasterCacheKey::Hash hash;
+  PictureRasterCacheKey::Equal equal;
+
+  PictureRasterCacheKey key(1, SkMatrix::Translate(3.5, 4.25));
+  PictureRasterCacheKey translated_key(1, SkMatrix::Translate(10.5, 20.25));
+  EXPECT_TRUE(equal(key, translated_key));
+  EXPECT_EQ(hash(key), hash(translated_key));
+
+  PictureRasterCacheKey integral_key(1, SkMatrix::Translate(3, 4));
+#ifdef SUPPORT_FRACTIONAL_TRANSLATION
+  EXPECT_FALSE(equal(key, integral_key));
+#else
+  EXPECT_TRUE(equal(key, integral_key));
+#endif
+}
+
 // Construct a cache result whose device target rectangle rounds out to be one
 // pixel wider than the cached image.  Verify that it can be drawn without
 // triggering any assertions.
@@ -22,4 +22,7 @@ bool Surface::ClearRenderContext() {
   return false;
 }
 
+void Surface::EnableTiledRasterization(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {}
+
 }  // namespace flutter
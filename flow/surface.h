@@ -10,6 +10,7 @@
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/gl_context_switch.h"
 #include "flutter/flow/surface_frame.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 
 namespace flutter {
@@ -35,6 +36,12 @@ class Surface {
 
   virtual bool ClearRenderContext();
 
+  // Lets surfaces that rasterize their frames in software split the
+  // rasterization across the workers of |worker_task_runner|. Other surfaces
+  // ignore it.
+  virtual void EnableTiledRasterization(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner);
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Surface);
 };
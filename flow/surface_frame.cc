@@ -50,6 +50,9 @@ bool SurfaceFrame::IsSubmitted() const {
 }
 
 SkCanvas* SurfaceFrame::SkiaCanvas() {
+  if (canvas_ != nullptr) {
+    return canvas_;
+  }
   return surface_ != nullptr ? surface_->getCanvas() : nullptr;
 }
 
@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_SURFACE_FRAME_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -21,6 +22,28 @@ class SurfaceFrame {
   using SubmitCallback =
       std::function<bool(const SurfaceFrame& surface_frame, SkCanvas* canvas)>;
 
+  // Information about the framebuffer the frame renders into, provided by the
+  // surface.
+  struct FramebufferInfo {
+    // The area of the framebuffer that does not hold the pixels of the last
+    // submitted frame, or std::nullopt if the framebuffer contents are
+    // unknown. Surfaces that set this allow the rasterizer to only repaint
+    // the part of the frame that changed.
+    std::optional<SkIRect> existing_damage;
+  };
+
+  // Information about the submitted frame, set by the rasterizer before
+  // calling |Submit|. Surfaces may use it to present partial updates.
+  struct SubmitInfo {
+    // The area of the frame that differs from the last submitted frame, or
+    // std::nullopt if it is unknown.
+    std::optional<SkIRect> frame_damage;
+
+    // The area of the framebuffer that was painted, or std::nullopt if the
+    // whole framebuffer was painted.
+    std::optional<SkIRect> buffer_damage;
+  };
+
   SurfaceFrame(sk_sp<SkSurface> surface,
                bool supports_readback,
                const SubmitCallback& submit_callback);
@@ -40,12 +63,32 @@ class SurfaceFrame {
 
   sk_sp<SkSurface> SkiaSurface() const;
 
+  // Makes |SkiaCanvas| return |canvas| instead of the canvas of the surface,
+  // e.g. for surfaces that record frames before rasterizing them. The canvas
+  // must outlive the frame.
+  void set_canvas(SkCanvas* canvas) { canvas_ = canvas; }
+
   bool supports_readback() { return supports_readback_; }
 
+  const FramebufferInfo& framebuffer_info() const { return framebuffer_info_; }
+
+  void set_framebuffer_info(const FramebufferInfo& framebuffer_info) {
+    framebuffer_info_ = framebuffer_info;
+  }
+
+  const SubmitInfo& submit_info() const { return submit_info_; }
+
+  void set_submit_info(const SubmitInfo& submit_info) {
+    submit_info_ = submit_info;
+  }
+
  private:
   bool submitted_ = false;
   sk_sp<SkSurface> surface_;
+  SkCanvas* canvas_ = nullptr;
   bool supports_readback_;
+  FramebufferInfo framebuffer_info_;
+  SubmitInfo submit_info_;
   SubmitCallback submit_callback_;
   std::unique_ptr<GLContextResult> context_result_;
 
@@ -23,6 +23,7 @@ void MockLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   parent_matrix_ = matrix;
   parent_cull_rect_ = context->cull_rect;
   parent_has_platform_view_ = context->has_platform_view;
+  preroll_count_++;
 
   context->has_platform_view = fake_has_platform_view_;
   set_paint_bounds(fake_paint_path_.getBounds());
@@ -30,11 +31,18 @@ void MockLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   if (fake_reads_surface_) {
     context->surface_needs_readback = true;
   }
+  context->subtree_can_inherit_opacity = fake_opacity_compatible_;
 }
 
 void MockLayer::Paint(PaintContext& context) const {
   FML_DCHECK(needs_painting());
 
+  if (context.inherited_opacity < SK_Scalar1) {
+    SkPaint paint = fake_paint_;
+    paint.setAlphaf(paint.getAlphaf() * context.inherited_opacity);
+    context.leaf_nodes_canvas->drawPath(fake_paint_path_, paint);
+    return;
+  }
   context.leaf_nodes_canvas->drawPath(fake_paint_path_, fake_paint_);
 }
 
@@ -0,0 +1,151 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_rasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+
+namespace {
+
+// Plays back pictures without drawing to find the layers that read the pixels
+// drawn before them.
+class BackdropReadDetector final : public SkNoDrawCanvas {
+ public:
+  explicit BackdropReadDetector(const SkIRect& bounds)
+      : SkNoDrawCanvas(bounds) {}
+
+  bool reads_backdrop() const { return reads_backdrop_; }
+
+ protected:
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    if (rec.fBackdrop ||
+        (rec.fSaveLayerFlags & kInitWithPrevious_SaveLayerFlag)) {
+      reads_backdrop_ = true;
+    }
+    return kNoLayer_SaveLayerStrategy;
+  }
+
+ private:
+  bool reads_backdrop_ = false;
+};
+
+// The tiles of a frame. Helper tasks that only start after the calling thread
+// finished the last tile still hold on to it, so it is reference counted.
+struct TileQueue {
+  TileQueue(sk_sp<SkPicture> picture,
+            const SkPixmap& pixmap,
+            const SkSurfaceProps& props,
+            std::vector<SkIRect> tiles)
+      : picture(std::move(picture)),
+        pixmap(pixmap),
+        props(props),
+        tiles(std::move(tiles)),
+        done(this->tiles.size()) {}
+
+  // Rasterizes tiles until none are left.
+  void Drain() {
+    for (size_t index = next_tile++; index < tiles.size();
+         index = next_tile++) {
+      const SkIRect& tile = tiles[index];
+      std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+          pixmap.info().makeWH(tile.width(), tile.height()),
+          pixmap.writable_addr(tile.x(), tile.y()), pixmap.rowBytes(),
+          &props);
+      if (canvas) {
+        canvas->translate(-tile.x(), -tile.y());
+        picture->playback(canvas.get());
+      }
+      done.CountDown();
+    }
+  }
+
+  const sk_sp<SkPicture> picture;
+  const SkPixmap pixmap;
+  const SkSurfaceProps props;
+  const std::vector<SkIRect> tiles;
+  std::atomic_size_t next_tile{0};
+  fml::CountDownLatch done;
+};
+
+}  // namespace
+
+TiledRasterizer::TiledRasterizer(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    int tile_size)
+    : worker_task_runner_(std::move(worker_task_runner)),
+      tile_size_(tile_size) {
+  FML_DCHECK(worker_task_runner_);
+  FML_DCHECK(tile_size_ > 0);
+}
+
+TiledRasterizer::~TiledRasterizer() = default;
+
+bool TiledRasterizer::Rasterize(const SkPicture& picture,
+                                SkSurface* surface,
+                                std::optional<SkIRect> bounds) const {
+  TRACE_EVENT0("flutter", "TiledRasterizer::Rasterize");
+
+  if (ReadsBackdrop(picture)) {
+    return false;
+  }
+
+  // The tiles write the pixels without going through the canvas of the
+  // surface, so it has to copy them first if an image snapshot shares them.
+  surface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+  SkPixmap pixmap;
+  if (!surface->peekPixels(&pixmap)) {
+    return false;
+  }
+
+  SkIRect area = pixmap.bounds();
+  if (area.isEmpty() || (bounds && !area.intersect(*bounds))) {
+    return true;
+  }
+
+  std::vector<SkIRect> tiles;
+  for (int y = area.top(); y < area.bottom(); y += tile_size_) {
+    for (int x = area.left(); x < area.right(); x += tile_size_) {
+      tiles.push_back(SkIRect::MakeLTRB(x, y,
+                                        std::min(x + tile_size_, area.right()),
+                                        std::min(y + tile_size_,
+                                                 area.bottom())));
+    }
+  }
+
+  auto queue = std::make_shared<TileQueue>(sk_ref_sp(&picture), pixmap,
+                                           surface->props(), std::move(tiles));
+
+  // The calling thread rasterizes tiles as well, so it does not wait for
+  // workers that are busy with other tasks to pick up the helpers.
+  const size_t helper_count =
+      std::min<size_t>(queue->tiles.size() - 1,
+                       std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  for (size_t i = 0; i < helper_count; i++) {
+    worker_task_runner_->PostTask([queue]() { queue->Drain(); },
+                                  fml::ConcurrentTaskPriority::kHigh);
+  }
+  queue->Drain();
+  queue->done.Wait();
+  return true;
+}
+
+bool TiledRasterizer::ReadsBackdrop(const SkPicture& picture) {
+  BackdropReadDetector detector(picture.cullRect().roundOut());
+  picture.playback(&detector);
+  return detector.reads_backdrop();
+}
+
+}  // namespace flutter
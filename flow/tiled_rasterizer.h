@@ -0,0 +1,59 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_TILED_RASTERIZER_H_
+#define FLUTTER_FLOW_TILED_RASTERIZER_H_
+
+#include <memory>
+#include <optional>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+// Rasterizes recorded frames into surfaces backed by CPU memory by splitting
+// the surface into tiles that are played back on the concurrent workers. Each
+// tile only draws the operations that the bounding box hierarchy of the
+// picture finds in its bounds, so the frame time of complex frames scales
+// with the number of cores.
+class TiledRasterizer {
+ public:
+  static constexpr int kDefaultTileSize = 256;
+
+  explicit TiledRasterizer(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      int tile_size = kDefaultTileSize);
+
+  ~TiledRasterizer();
+
+  // Draws |picture| into the pixels of |surface| that are within |bounds|, or
+  // all of them if |bounds| is not set. The calling thread rasterizes tiles
+  // too and returns once all of them are done.
+  //
+  // Returns false without drawing if the pixels of |surface| cannot be
+  // accessed or if the picture reads back the pixels of the surface, which
+  // can't be split into tiles. The picture should then be drawn into the
+  // canvas of the surface instead.
+  bool Rasterize(const SkPicture& picture,
+                 SkSurface* surface,
+                 std::optional<SkIRect> bounds = std::nullopt) const;
+
+  // Whether the picture has layers that filter or start from what was drawn
+  // before them, like backdrop filters.
+  static bool ReadsBackdrop(const SkPicture& picture);
+
+ private:
+  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  const int tile_size_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledRasterizer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_TILED_RASTERIZER_H_
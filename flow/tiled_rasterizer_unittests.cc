@@ -0,0 +1,111 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_rasterizer.h"
+
+#include <cstring>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+namespace flutter {
+namespace testing {
+namespace {
+
+constexpr int kWidth = 300;
+constexpr int kHeight = 200;
+constexpr int kTileSize = 64;
+
+sk_sp<SkPicture> GetSamplePicture() {
+  SkPictureRecorder recorder;
+  SkRTreeFactory rtree_factory;
+  SkCanvas* canvas =
+      recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight), &rtree_factory);
+  canvas->clear(SK_ColorWHITE);
+  SkPaint paint;
+  paint.setAntiAlias(true);
+  paint.setColor(SK_ColorRED);
+  canvas->drawRect(SkRect::MakeXYWH(10, 10, 250, 40), paint);
+  paint.setColor(SK_ColorBLUE);
+  canvas->drawCircle(150, 120, 70, paint);
+  paint.setColor(SK_ColorGREEN);
+  paint.setStyle(SkPaint::kStroke_Style);
+  paint.setStrokeWidth(5);
+  canvas->drawLine(0, 0, kWidth, kHeight, paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+bool HaveSamePixels(SkSurface* a, SkSurface* b) {
+  SkBitmap a_bitmap;
+  a_bitmap.allocN32Pixels(a->width(), a->height());
+  SkBitmap b_bitmap;
+  b_bitmap.allocN32Pixels(b->width(), b->height());
+  if (!a->readPixels(a_bitmap, 0, 0) || !b->readPixels(b_bitmap, 0, 0)) {
+    return false;
+  }
+  return a_bitmap.computeByteSize() == b_bitmap.computeByteSize() &&
+         memcmp(a_bitmap.getPixels(), b_bitmap.getPixels(),
+                a_bitmap.computeByteSize()) == 0;
+}
+
+}  // namespace
+
+TEST(TiledRasterizer, RasterizesLikeTheSurfaceCanvas) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  TiledRasterizer rasterizer(loop->GetTaskRunner(), kTileSize);
+  auto picture = GetSamplePicture();
+
+  auto expected = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  expected->getCanvas()->drawPicture(picture);
+  auto tiled = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  ASSERT_TRUE(rasterizer.Rasterize(*picture, tiled.get()));
+
+  EXPECT_TRUE(HaveSamePixels(expected.get(), tiled.get()));
+}
+
+TEST(TiledRasterizer, OnlyRasterizesWithinBounds) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  TiledRasterizer rasterizer(loop->GetTaskRunner(), kTileSize);
+  auto picture = GetSamplePicture();
+
+  auto surface = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  surface->getCanvas()->clear(SK_ColorBLACK);
+  ASSERT_TRUE(rasterizer.Rasterize(*picture, surface.get(),
+                                   SkIRect::MakeXYWH(100, 60, 100, 100)));
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(kWidth, kHeight);
+  ASSERT_TRUE(surface->readPixels(bitmap, 0, 0));
+  EXPECT_EQ(bitmap.getColor(20, 20), SK_ColorBLACK);
+  EXPECT_EQ(bitmap.getColor(150, 120), SK_ColorBLUE);
+  EXPECT_EQ(bitmap.getColor(250, 190), SK_ColorBLACK);
+}
+
+TEST(TiledRasterizer, DoesNotSplitPicturesThatReadTheBackdrop) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  TiledRasterizer rasterizer(loop->GetTaskRunner(), kTileSize);
+
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(kWidth, kHeight));
+  canvas->drawPicture(GetSamplePicture());
+  auto blur = SkImageFilters::Blur(8, 8, nullptr);
+  canvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, blur.get(), 0));
+  canvas->restore();
+  auto picture = recorder.finishRecordingAsPicture();
+
+  EXPECT_FALSE(TiledRasterizer::ReadsBackdrop(*GetSamplePicture()));
+  EXPECT_TRUE(TiledRasterizer::ReadsBackdrop(*picture));
+
+  auto surface = SkSurface::MakeRasterN32Premul(kWidth, kHeight);
+  EXPECT_FALSE(rasterizer.Rasterize(*picture, surface.get()));
+}
+
+}  // namespace testing
+}  // namespace flutter
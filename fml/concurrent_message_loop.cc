@@ -19,11 +19,15 @@ std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
 
 ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  for (size_t i = 0; i < worker_count_; ++i) {
+    worker_queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.flutter.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      WorkerMain(i);
     });
   }
 
@@ -47,68 +51,152 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+size_t ConcurrentMessageLoop::GetCurrentWorkerIndex() const {
+  const auto thread_id = std::this_thread::get_id();
+  for (size_t i = 0; i < worker_thread_ids_.size(); ++i) {
+    if (worker_thread_ids_[i] == thread_id) {
+      return i;
+    }
+  }
+  return worker_count_;
+}
+
+void ConcurrentMessageLoop::PostTask(const fml::closure& task,
+                                     ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
-  // Don't just drop tasks on the floor in case of shutdown.
-  if (shutdown_) {
-    FML_DLOG(WARNING)
-        << "Tried to post a task to shutdown concurrent message "
-           "loop. The task will be executed on the callers thread.";
-    lock.unlock();
-    task();
-    return;
+  // Workers keep the tasks they post for themselves as these often operate on
+  // data that is still in the caches of the worker's core.
+  size_t worker_index = GetCurrentWorkerIndex();
+  if (worker_index == worker_count_) {
+    worker_index = next_worker_.fetch_add(1) % worker_count_;
   }
 
-  tasks_.push(task);
+  {
+    WorkerQueue& queue = *worker_queues_[worker_index];
+    std::unique_lock lock(queue.mutex);
+
+    // Don't just drop tasks on the floor in case of shutdown. |Terminate| sets
+    // the flag with the lock of every queue held, so the task is either queued
+    // before the shutdown or run here.
+    if (shutdown_) {
+      lock.unlock();
+      FML_DLOG(WARNING)
+          << "Tried to post a task to shutdown concurrent message "
+             "loop. The task will be executed on the callers thread.";
+      task();
+      return;
+    }
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+    // The counters are incremented before the task is visible so that they
+    // never underflow when another worker takes the task right away.
+    pending_tasks_.fetch_add(1);
+    if (priority == ConcurrentTaskPriority::kHigh) {
+      pending_high_priority_tasks_.fetch_add(1);
+      queue.high_priority_tasks.push_back(task);
+    } else {
+      queue.tasks.push_back(task);
+    }
+  }
 
-  tasks_condition_.notify_one();
+  // Idle workers register themselves with the wake mutex held before checking
+  // for pending tasks. So either the worker sees the task posted above or the
+  // idle worker is seen here. In the latter case, acquiring the mutex makes
+  // sure the worker is waiting on the condition variable before it is
+  // notified.
+  if (idle_workers_ > 0) {
+    { std::scoped_lock lock(wake_mutex_); }
+    wake_condition_.notify_one();
+  }
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
-  while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
-    });
-
-    // Shutdown cannot be read with the task mutex unlocked.
-    bool shutdown_now = shutdown_;
-    fml::closure task;
-    std::vector<fml::closure> thread_tasks;
+fml::closure ConcurrentMessageLoop::PopTask(WorkerQueue& queue,
+                                            ConcurrentTaskPriority priority) {
+  const bool high_priority = priority == ConcurrentTaskPriority::kHigh;
+  fml::closure task;
+  {
+    std::scoped_lock lock(queue.mutex);
+    auto& tasks = high_priority ? queue.high_priority_tasks : queue.tasks;
+    if (tasks.empty()) {
+      return nullptr;
+    }
+    task = std::move(tasks.front());
+    tasks.pop_front();
+  }
+  if (high_priority) {
+    pending_high_priority_tasks_.fetch_sub(1);
+  }
+  pending_tasks_.fetch_sub(1);
+  return task;
+}
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+fml::closure ConcurrentMessageLoop::TakeTask(size_t worker_index) {
+  // The worker's own queue is checked first, then the queues of the other
+  // workers starting with its neighbour so that thieves spread out.
+  if (pending_high_priority_tasks_ > 0) {
+    for (size_t i = 0; i < worker_count_; ++i) {
+      auto& queue = *worker_queues_[(worker_index + i) % worker_count_];
+      if (auto task = PopTask(queue, ConcurrentTaskPriority::kHigh)) {
+        return task;
+      }
     }
+  }
 
-    if (HasThreadTasksLocked()) {
-      thread_tasks = GetThreadTasksLocked();
-      FML_DCHECK(!HasThreadTasksLocked());
+  if (pending_tasks_ > 0) {
+    for (size_t i = 0; i < worker_count_; ++i) {
+      auto& queue = *worker_queues_[(worker_index + i) % worker_count_];
+      if (auto task = PopTask(queue, ConcurrentTaskPriority::kNormal)) {
+        return task;
+      }
     }
+  }
 
-    // Don't hold onto the mutex while tasks are being executed as they could
-    // themselves try to post more tasks to the message loop.
-    lock.unlock();
+  return nullptr;
+}
 
-    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
-    // Execute the primary task we woke up for.
-    if (task) {
-      task();
+void ConcurrentMessageLoop::WorkerMain(size_t worker_index) {
+  WorkerQueue& queue = *worker_queues_[worker_index];
+  while (true) {
+    fml::closure task;
+    if (!shutdown_) {
+      task = TakeTask(worker_index);
     }
 
-    // Execute any thread tasks.
-    for (const auto& thread_task : thread_tasks) {
-      thread_task();
+    // Go to sleep only if there is nothing else to do.
+    bool shutdown_now = shutdown_;
+    std::vector<fml::closure> thread_tasks;
+    if (!task || shutdown_now || queue.has_thread_tasks) {
+      std::unique_lock lock(wake_mutex_);
+      if (!task) {
+        idle_workers_.fetch_add(1);
+        wake_condition_.wait(lock, [&]() {
+          return pending_tasks_ > 0 || shutdown_ || HasThreadTasksLocked();
+        });
+        idle_workers_.fetch_sub(1);
+      }
+
+      // Shutdown cannot be read with the wake mutex unlocked.
+      shutdown_now = shutdown_;
+
+      if (HasThreadTasksLocked()) {
+        thread_tasks = GetThreadTasksLocked();
+        FML_DCHECK(!HasThreadTasksLocked());
+      }
+      queue.has_thread_tasks = false;
+    }
+
+    if (task || !thread_tasks.empty()) {
+      TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
+      if (task) {
+        task();
+      }
+
+      // Execute any thread tasks.
+      for (const auto& thread_task : thread_tasks) {
+        thread_task();
+      }
     }
 
     if (shutdown_now) {
@@ -118,9 +206,15 @@ void ConcurrentMessageLoop::WorkerMain() {
 }
 
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
+  // Posters check the flag with the lock of the queue they post to held.
+  std::vector<std::unique_lock<std::mutex>> queue_locks;
+  queue_locks.reserve(worker_count_);
+  for (auto& queue : worker_queues_) {
+    queue_locks.emplace_back(queue->mutex);
+  }
+  std::scoped_lock lock(wake_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  wake_condition_.notify_all();
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,11 +222,12 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  std::scoped_lock lock(wake_mutex_);
+  for (size_t i = 0; i < worker_count_; ++i) {
+    thread_tasks_[worker_thread_ids_[i]].emplace_back(task);
+    worker_queues_[i]->has_thread_tasks = true;
   }
-  tasks_condition_.notify_all();
+  wake_condition_.notify_all();
 }
 
 bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
@@ -154,13 +249,14 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(const fml::closure& task,
+                                    ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(task, priority);
     return;
   }
 
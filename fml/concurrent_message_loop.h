@@ -5,10 +5,13 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <map>
-#include <queue>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
@@ -17,6 +20,22 @@ namespace fml {
 
 class ConcurrentTaskRunner;
 
+// A hint for the order in which the workers of a |ConcurrentMessageLoop| pick
+// up pending tasks. Pending high priority tasks are always taken before normal
+// priority ones, so latency sensitive work (e.g. shader compilation) does not
+// wait behind long running bulk work (e.g. image decoding).
+enum class ConcurrentTaskPriority {
+  kNormal,
+  kHigh,
+};
+
+// A pool of worker threads that run tasks without thread affinity.
+//
+// Each worker has its own task queues. Tasks posted from outside of the pool
+// are distributed between the workers in a round robin fashion and tasks
+// posted by a worker are added to its own queues. Workers run their own tasks
+// in the order they were posted and steal the oldest tasks of other workers
+// once they run out, so no single lock is shared by all posters and workers.
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
@@ -36,20 +55,49 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<fml::closure> high_priority_tasks;
+    std::deque<fml::closure> tasks;
+    // Set when |PostTaskToAllWorkers| added tasks for this worker.
+    std::atomic_bool has_thread_tasks = false;
+  };
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
   std::vector<std::thread::id> worker_thread_ids_;
+  std::atomic_size_t next_worker_ = 0;
+
+  // The number of tasks in all worker queues. Incremented before a task is
+  // added to a queue and decremented after it is removed.
+  std::atomic_size_t pending_tasks_ = 0;
+  std::atomic_size_t pending_high_priority_tasks_ = 0;
+
+  // Only used to put idle workers to sleep and to wake them up.
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  std::atomic_size_t idle_workers_ = 0;
   std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  // Set with the mutexes of all worker queues and |wake_mutex_| held.
+  std::atomic_bool shutdown_ = false;
 
   ConcurrentMessageLoop(size_t worker_count);
 
-  void WorkerMain();
+  void WorkerMain(size_t worker_index);
+
+  void PostTask(const fml::closure& task, ConcurrentTaskPriority priority);
+
+  // Returns the index of the worker running on the current thread or
+  // |worker_count_| if called from outside of the pool.
+  size_t GetCurrentWorkerIndex() const;
+
+  // Takes the next task for the given worker, stealing from the other workers
+  // if its own queues are empty. Returns an empty closure if there are no
+  // pending tasks.
+  fml::closure TakeTask(size_t worker_index);
 
-  void PostTask(const fml::closure& task);
+  fml::closure PopTask(WorkerQueue& queue, ConcurrentTaskPriority priority);
 
   bool HasThreadTasksLocked() const;
 
@@ -64,7 +112,9 @@ class ConcurrentTaskRunner {
 
   ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task);
+  void PostTask(
+      const fml::closure& task,
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
 
  private:
   friend ConcurrentMessageLoop;
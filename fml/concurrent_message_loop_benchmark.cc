@@ -0,0 +1,169 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace fml {
+namespace benchmarking {
+
+namespace {
+
+// The previous design of |ConcurrentMessageLoop|, kept as a baseline: all
+// workers share a single queue guarded by one mutex and condition variable.
+class SingleQueueLoop {
+ public:
+  explicit SingleQueueLoop(size_t worker_count) {
+    for (size_t i = 0; i < worker_count; ++i) {
+      workers_.emplace_back([this]() { WorkerMain(); });
+    }
+  }
+
+  ~SingleQueueLoop() {
+    {
+      std::scoped_lock lock(tasks_mutex_);
+      shutdown_ = true;
+    }
+    tasks_condition_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void PostTask(const fml::closure& task) {
+    std::unique_lock lock(tasks_mutex_);
+    tasks_.push(task);
+    lock.unlock();
+    tasks_condition_.notify_one();
+  }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex tasks_mutex_;
+  std::condition_variable tasks_condition_;
+  std::queue<fml::closure> tasks_;
+  bool shutdown_ = false;
+
+  void WorkerMain() {
+    while (true) {
+      std::unique_lock lock(tasks_mutex_);
+      tasks_condition_.wait(lock,
+                            [&]() { return !tasks_.empty() || shutdown_; });
+      if (shutdown_) {
+        return;
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop();
+      lock.unlock();
+      task();
+    }
+  }
+};
+
+class WorkStealingLoop {
+ public:
+  explicit WorkStealingLoop(size_t worker_count)
+      : loop_(ConcurrentMessageLoop::Create(worker_count)),
+        task_runner_(loop_->GetTaskRunner()) {}
+
+  void PostTask(const fml::closure& task) { task_runner_->PostTask(task); }
+
+ private:
+  std::shared_ptr<ConcurrentMessageLoop> loop_;
+  std::shared_ptr<ConcurrentTaskRunner> task_runner_;
+};
+
+constexpr size_t kTasksPerIteration = 1000;
+
+// Spins for roughly |nanoseconds| to simulate a small unit of work.
+void DoWork(int64_t nanoseconds) {
+  const auto end = TimePoint::Now() + TimeDelta::FromNanoseconds(nanoseconds);
+  while (TimePoint::Now() < end) {
+  }
+}
+
+}  // namespace
+
+// Measures the throughput of a worker pool and the latency between posting a
+// task and the task starting to run. The first argument is the number of
+// workers, the second one the number of threads posting tasks. Each task
+// performs a microsecond of work.
+template <class Loop>
+static void BM_ConcurrentLoopPostTask(benchmark::State& state) {  // NOLINT
+  const size_t num_workers = state.range(0);
+  const size_t num_posters = state.range(1);
+  Loop loop(num_workers);
+
+  std::vector<TimeDelta> latencies;
+  latencies.reserve(kTasksPerIteration * 16);
+
+  while (state.KeepRunning()) {
+    const size_t num_tasks = kTasksPerIteration * num_posters;
+    std::vector<TimeDelta> iteration_latencies(num_tasks);
+    CountDownLatch tasks_done(num_tasks);
+    std::vector<std::thread> posters;
+    for (size_t i = 0; i < num_posters; ++i) {
+      posters.emplace_back([&, i]() {
+        for (size_t j = 0; j < kTasksPerIteration; ++j) {
+          const size_t index = i * kTasksPerIteration + j;
+          const auto posted = TimePoint::Now();
+          loop.PostTask([&, index, posted]() {
+            iteration_latencies[index] = TimePoint::Now() - posted;
+            DoWork(1000);
+            tasks_done.CountDown();
+          });
+        }
+      });
+    }
+    for (auto& poster : posters) {
+      poster.join();
+    }
+    tasks_done.Wait();
+
+    state.PauseTiming();
+    latencies.insert(latencies.end(), iteration_latencies.begin(),
+                     iteration_latencies.end());
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration *
+                          num_posters);
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile_us = [&latencies](double percentile) {
+      const size_t index = (latencies.size() - 1) * percentile;
+      return latencies[index].ToMicrosecondsF();
+    };
+    state.counters["p50_us"] = percentile_us(0.5);
+    state.counters["p99_us"] = percentile_us(0.99);
+  }
+}
+
+static void ConcurrentLoopArguments(
+    benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"workers", "posters"});
+  const size_t max_workers =
+      std::max<size_t>(std::thread::hardware_concurrency(), 2);
+  for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+    benchmark->Args({static_cast<int64_t>(workers), 1});
+    benchmark->Args({static_cast<int64_t>(workers), 4});
+  }
+  benchmark->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(BM_ConcurrentLoopPostTask, SingleQueueLoop)
+    ->Apply(ConcurrentLoopArguments);
+BENCHMARK_TEMPLATE(BM_ConcurrentLoopPostTask, WorkStealingLoop)
+    ->Apply(ConcurrentLoopArguments);
+
+}  // namespace benchmarking
+}  // namespace fml
@@ -90,6 +90,12 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
                      const char* file_name,
                      const Mapping& mapping);
 
+/// Renames the file at `old_path` to `new_path`, both relative to
+/// `base_directory`, replacing any file at `new_path`.
+bool RenameFile(const fml::UniqueFD& base_directory,
+                const char* old_path,
+                const char* new_path);
+
 /// Signature of a callback on a file in `directory` with `filename` (relative
 /// to `directory`). The returned bool should be false if and only if further
 /// traversal should be stopped. For example, a file-search visitor may return
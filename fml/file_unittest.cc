@@ -253,6 +253,25 @@ TEST(FileTest, AtomicWriteTest) {
   ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "precious_data"));
 }
 
+TEST(FileTest, RenameReplacesExistingFiles) {
+  fml::ScopedTemporaryDirectory dir;
+
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), "new_data",
+                                   fml::DataMapping(std::string("new"))));
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), "precious_data",
+                                   fml::DataMapping(std::string("old"))));
+
+  ASSERT_TRUE(fml::RenameFile(dir.fd(), "new_data", "precious_data"));
+  ASSERT_FALSE(fml::FileExists(dir.fd(), "new_data"));
+  ASSERT_EQ("new",
+            ReadStringFromFile(fml::OpenFile(dir.fd(), "precious_data", false,
+                                             fml::FilePermission::kRead)));
+  ASSERT_FALSE(fml::RenameFile(dir.fd(), "new_data", "precious_data"));
+
+  // Cleanup.
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "precious_data"));
+}
+
 TEST(FileTest, EmptyMappingTest) {
   fml::ScopedTemporaryDirectory dir;
 
@@ -73,6 +73,10 @@ void MessageLoop::RunExpiredTasksNow() {
   loop_->RunExpiredTasksNow();
 }
 
+void MessageLoop::SetTimerSlack(fml::TimeDelta slack) {
+  loop_->SetTimerSlack(slack);
+}
+
 TaskQueueId MessageLoop::GetCurrentTaskQueueId() {
   auto* loop = tls_message_loop.get();
   FML_CHECK(loop != nullptr)
@@ -7,6 +7,7 @@
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
 
 namespace fml {
 
@@ -34,6 +35,12 @@ class MessageLoop {
   // instead of dedicating a thread to the message loop.
   void RunExpiredTasksNow();
 
+  // Allows the loop to delay the wakeups for delayed tasks by up to |slack| so
+  // that tasks due within the same window run after a single wakeup. Tasks that
+  // are already due are not delayed. Only the timerfd backed loops of Linux and
+  // Android coalesce their wakeups, other platforms ignore the slack.
+  void SetTimerSlack(fml::TimeDelta slack);
+
   static void EnsureInitializedForCurrentThread();
 
   static bool IsInitializedForCurrentThread();
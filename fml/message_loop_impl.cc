@@ -46,7 +46,8 @@ fml::RefPtr<MessageLoopImpl> MessageLoopImpl::Create() {
 MessageLoopImpl::MessageLoopImpl()
     : task_queue_(MessageLoopTaskQueues::GetInstance()),
       queue_id_(task_queue_->CreateTaskQueue()),
-      terminated_(false) {
+      terminated_(false),
+      timer_slack_nanos_(0) {
   task_queue_->SetWakeable(queue_id_, this);
 }
 
@@ -121,11 +122,10 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
 
   const auto now = fml::TimePoint::Now();
-  fml::closure invocation;
-  do {
-    invocation = task_queue_->GetNextTaskToRun(queue_id_, now);
+  if (type == FlushType::kSingle) {
+    fml::closure invocation = task_queue_->GetNextTaskToRun(queue_id_, now);
     if (!invocation) {
-      break;
+      return;
     }
     invocation();
     std::vector<fml::closure> observers =
@@ -133,10 +133,30 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
     for (const auto& observer : observers) {
       observer();
     }
-    if (type == FlushType::kSingle) {
+    return;
+  }
+
+  // Take all the tasks that are due at once instead of going back to the task
+  // queues for every task.
+  TaskBatch batch;
+  while (true) {
+    task_queue_->GetTasksToRun(queue_id_, now, batch);
+    if (batch.tasks.empty()) {
       break;
     }
-  } while (invocation);
+    for (size_t i = 0; i < batch.tasks.size(); ++i) {
+      if (i > 0 && !task_queue_->IsBatchCurrent(queue_id_, batch)) {
+        // The last task merged or unmerged this queue or changed its
+        // observers. The remaining tasks may no longer belong to this loop.
+        task_queue_->ReturnTasks(queue_id_, batch, i);
+        break;
+      }
+      batch.tasks[i].GetTask()();
+      for (const auto& observer : batch.observers) {
+        observer();
+      }
+    }
+  }
 }
 
 void MessageLoopImpl::RunExpiredTasksNow() {
@@ -151,4 +171,25 @@ TaskQueueId MessageLoopImpl::GetTaskQueueId() const {
   return queue_id_;
 }
 
+void MessageLoopImpl::SetTimerSlack(fml::TimeDelta slack) {
+  timer_slack_nanos_ = std::max<int64_t>(slack.ToNanoseconds(), 0);
+}
+
+fml::TimePoint MessageLoopImpl::GetCoalescedWakeTime(
+    fml::TimePoint time_point) const {
+  const int64_t slack = timer_slack_nanos_;
+  if (slack == 0 || time_point == fml::TimePoint::Max() ||
+      time_point <= fml::TimePoint::Now()) {
+    return time_point;
+  }
+
+  // Round up to a multiple of the slack. All tasks due in the same window,
+  // including those of other loops using the same slack, then fire together
+  // instead of each causing its own wakeup.
+  const int64_t nanos = time_point.ToEpochDelta().ToNanoseconds();
+  const int64_t coalesced = (nanos + slack - 1) / slack * slack;
+  return fml::TimePoint::FromEpochDelta(
+      fml::TimeDelta::FromNanoseconds(coalesced));
+}
+
 }  // namespace fml
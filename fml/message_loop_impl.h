@@ -46,6 +46,9 @@ class MessageLoopImpl : public Wakeable,
 
   virtual TaskQueueId GetTaskQueueId() const;
 
+  // See |MessageLoop::SetTimerSlack|.
+  void SetTimerSlack(fml::TimeDelta slack);
+
  protected:
   // Exposed for the embedder shell which allows clients to poll for events
   // instead of dedicating a thread to the message loop.
@@ -58,11 +61,17 @@ class MessageLoopImpl : public Wakeable,
  protected:
   MessageLoopImpl();
 
+  // Rounds |time_point| up to a multiple of the timer slack, so that the
+  // wakeups of all tasks due in the same window coincide. Used by the loops
+  // whose |WakeUp| arms a timer that supports it.
+  fml::TimePoint GetCoalescedWakeTime(fml::TimePoint time_point) const;
+
  private:
   fml::RefPtr<MessageLoopTaskQueues> task_queue_;
   TaskQueueId queue_id_;
 
   std::atomic_bool terminated_;
+  std::atomic<int64_t> timer_slack_nanos_;
 
   void FlushTasks(FlushType type);
 
@@ -8,10 +8,53 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop_impl.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace fml {
 
+// Holds the lock of a queue entry and, if the queue is merged, the lock of the
+// entry it is merged with.
+class MessageLoopTaskQueues::MergedQueuesLock {
+ public:
+  MergedQueuesLock(const MessageLoopTaskQueues& queues, TaskQueueId queue_id) {
+    TaskQueueEntry* entry = queues.GetEntry(queue_id);
+    while (true) {
+      std::unique_lock entry_lock(entry->mutex);
+      const TaskQueueId peer = MergedWith(*entry);
+      if (peer == _kUnmerged) {
+        // Merging needs this lock, so the queue stays unmerged while held.
+        entry_lock_ = std::move(entry_lock);
+        return;
+      }
+      TaskQueueEntry* peer_entry = queues.GetEntry(peer);
+      entry_lock.unlock();
+
+      // Lock both entries without risking a lock order inversion with a
+      // thread doing the same from the peer.
+      std::unique_lock first(entry->mutex, std::defer_lock);
+      std::unique_lock second(peer_entry->mutex, std::defer_lock);
+      std::lock(first, second);
+      if (MergedWith(*entry) == peer) {
+        entry_lock_ = std::move(first);
+        peer_lock_ = std::move(second);
+        return;
+      }
+      // The queue was merged or unmerged while unlocked, try again.
+    }
+  }
+
+ private:
+  static TaskQueueId MergedWith(const TaskQueueEntry& entry) {
+    return entry.owner_of != _kUnmerged ? entry.owner_of : entry.subsumed_by;
+  }
+
+  std::unique_lock<std::mutex> entry_lock_;
+  std::unique_lock<std::mutex> peer_lock_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MergedQueuesLock);
+};
+
 std::mutex MessageLoopTaskQueues::creation_mutex_;
 
 const size_t TaskQueueId::kUnmerged = ULONG_MAX;
@@ -19,12 +62,21 @@ const size_t TaskQueueId::kUnmerged = ULONG_MAX;
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::instance_;
 
 TaskQueueEntry::TaskQueueEntry()
-    : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
+    : owner_of(_kUnmerged), subsumed_by(_kUnmerged), generation(0) {
   wakeable = NULL;
   task_observers = TaskObservers();
   delayed_tasks = DelayedTaskQueue();
 }
 
+void TaskQueueEntry::Reset() {
+  wakeable = NULL;
+  task_observers = TaskObservers();
+  delayed_tasks = DelayedTaskQueue();
+  owner_of = _kUnmerged;
+  subsumed_by = _kUnmerged;
+  ++generation;
+}
+
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
   std::scoped_lock creation(creation_mutex_);
   if (!instance_) {
@@ -34,46 +86,85 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  std::lock_guard guard(queue_mutex_);
+  std::lock_guard guard(queue_creation_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
+  if (task_queue_id_counter_ % kEntriesPerChunk == 0) {
+    AddEntryChunkLocked();
+  }
   ++task_queue_id_counter_;
-  queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
   return loop_id;
 }
 
+void MessageLoopTaskQueues::AddEntryChunkLocked() {
+  const size_t chunk_index = entry_chunks_.size();
+  entry_chunks_.push_back(
+      std::make_unique<TaskQueueEntry[]>(kEntriesPerChunk));
+
+  if (chunk_index == chunk_table_size_) {
+    const size_t size = std::max<size_t>(2 * chunk_table_size_, 16);
+    auto table = std::make_unique<std::atomic<TaskQueueEntry*>[]>(size);
+    const auto* old_table = chunk_table_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < size; ++i) {
+      table[i].store(i < chunk_table_size_
+                         ? old_table[i].load(std::memory_order_relaxed)
+                         : nullptr,
+                     std::memory_order_relaxed);
+    }
+    chunk_table_.store(table.get(), std::memory_order_release);
+    chunk_table_size_ = size;
+    chunk_tables_.push_back(std::move(table));
+  }
+
+  chunk_table_.load(std::memory_order_relaxed)[chunk_index].store(
+      entry_chunks_.back().get(), std::memory_order_release);
+}
+
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : chunk_table_(nullptr),
+      chunk_table_size_(0),
+      task_queue_id_counter_(0),
+      order_(0) {}
 
 MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
 
+TaskQueueEntry* MessageLoopTaskQueues::GetEntry(TaskQueueId queue_id) const {
+  const size_t id = static_cast<size_t>(queue_id);
+  const auto* table = chunk_table_.load(std::memory_order_acquire);
+  FML_DCHECK(table) << "Unknown task queue.";
+  TaskQueueEntry* chunk =
+      table[id / kEntriesPerChunk].load(std::memory_order_acquire);
+  FML_DCHECK(chunk) << "Unknown task queue.";
+  return &chunk[id % kEntriesPerChunk];
+}
+
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
+  MergedQueuesLock queues_lock(*this, queue_id);
+  auto* queue_entry = GetEntry(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entries_.erase(queue_id);
+  queue_entry->Reset();
   if (subsumed != _kUnmerged) {
-    queue_entries_.erase(subsumed);
+    GetEntry(subsumed)->Reset();
   }
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
+  MergedQueuesLock queues_lock(*this, queue_id);
+  auto* queue_entry = GetEntry(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
   queue_entry->delayed_tasks = {};
   if (subsumed != _kUnmerged) {
-    queue_entries_.at(subsumed)->delayed_tasks = {};
+    GetEntry(subsumed)->delayed_tasks = {};
   }
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
                                          const fml::closure& task,
                                          fml::TimePoint target_time) {
-  std::lock_guard guard(queue_mutex_);
+  MergedQueuesLock queues_lock(*this, queue_id);
   size_t order = order_++;
-  const auto& queue_entry = queue_entries_.at(queue_id);
+  auto* queue_entry = GetEntry(queue_id);
   queue_entry->delayed_tasks.push({order, task, target_time});
   TaskQueueId loop_to_wake = queue_id;
   if (queue_entry->subsumed_by != _kUnmerged) {
@@ -83,13 +174,13 @@ void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  MergedQueuesLock queues_lock(*this, queue_id);
   return HasPendingTasksUnlocked(queue_id);
 }
 
 fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
                                                      fml::TimePoint from_time) {
-  std::lock_guard guard(queue_mutex_);
+  MergedQueuesLock queues_lock(*this, queue_id);
   if (!HasPendingTasksUnlocked(queue_id)) {
     return nullptr;
   }
@@ -106,20 +197,93 @@ fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
     return nullptr;
   }
   fml::closure invocation = top.GetTask();
-  queue_entries_.at(top_queue)->delayed_tasks.pop();
+  GetEntry(top_queue)->delayed_tasks.pop();
   return invocation;
 }
 
+void MessageLoopTaskQueues::GetTasksToRun(TaskQueueId queue_id,
+                                          fml::TimePoint from_time,
+                                          TaskBatch& batch) {
+  batch.tasks.clear();
+  batch.observers.clear();
+
+  MergedQueuesLock queues_lock(*this, queue_id);
+  auto* queue_entry = GetEntry(queue_id);
+  batch.generation = queue_entry->generation;
+  if (!HasPendingTasksUnlocked(queue_id)) {
+    return;
+  }
+
+  const TaskQueueId subsumed = queue_entry->owner_of;
+  if (subsumed == _kUnmerged) {
+    auto& delayed_tasks = queue_entry->delayed_tasks;
+    while (!delayed_tasks.empty() &&
+           delayed_tasks.top().GetTargetTime() <= from_time) {
+      batch.tasks.push_back(delayed_tasks.top());
+      delayed_tasks.pop();
+    }
+  } else {
+    TaskQueueId top_queue = _kUnmerged;
+    const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
+    if (top.GetTargetTime() <= from_time) {
+      batch.tasks.push_back(top);
+      GetEntry(top_queue)->delayed_tasks.pop();
+    }
+  }
+
+  if (!HasPendingTasksUnlocked(queue_id)) {
+    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
+  } else {
+    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
+  }
+
+  if (batch.tasks.empty()) {
+    return;
+  }
+
+  for (const auto& observer : queue_entry->task_observers) {
+    batch.observers.push_back(observer.second);
+  }
+  if (subsumed != _kUnmerged) {
+    for (const auto& observer : GetEntry(subsumed)->task_observers) {
+      batch.observers.push_back(observer.second);
+    }
+  }
+}
+
+bool MessageLoopTaskQueues::IsBatchCurrent(TaskQueueId queue_id,
+                                           const TaskBatch& batch) const {
+  return GetEntry(queue_id)->generation == batch.generation;
+}
+
+void MessageLoopTaskQueues::ReturnTasks(TaskQueueId queue_id,
+                                        const TaskBatch& batch,
+                                        size_t first_task) {
+  if (first_task >= batch.tasks.size()) {
+    return;
+  }
+  MergedQueuesLock queues_lock(*this, queue_id);
+  auto* queue_entry = GetEntry(queue_id);
+  for (size_t i = first_task; i < batch.tasks.size(); ++i) {
+    queue_entry->delayed_tasks.push(batch.tasks[i]);
+  }
+  TaskQueueId loop_to_wake = queue_id;
+  if (queue_entry->subsumed_by != _kUnmerged) {
+    loop_to_wake = queue_entry->subsumed_by;
+  }
+  WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
+}
+
 void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
                                            fml::TimePoint time) const {
-  if (queue_entries_.at(queue_id)->wakeable) {
-    queue_entries_.at(queue_id)->wakeable->WakeUp(time);
+  if (GetEntry(queue_id)->wakeable) {
+    GetEntry(queue_id)->wakeable->WakeUp(time);
   }
 }
 
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
+  MergedQueuesLock queues_lock(*this, queue_id);
+  auto* queue_entry = GetEntry(queue_id);
   if (queue_entry->subsumed_by != _kUnmerged) {
     return 0;
   }
@@ -129,7 +293,7 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 
   TaskQueueId subsumed = queue_entry->owner_of;
   if (subsumed != _kUnmerged) {
-    const auto& subsumed_entry = queue_entries_.at(subsumed);
+    const auto* subsumed_entry = GetEntry(subsumed);
     total_tasks += subsumed_entry->delayed_tasks.size();
   }
   return total_tasks;
@@ -138,33 +302,37 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
-  queue_entries_.at(queue_id)->task_observers[key] = callback;
+  auto* queue_entry = GetEntry(queue_id);
+  std::scoped_lock entry_lock(queue_entry->mutex);
+  queue_entry->task_observers[key] = callback;
+  ++queue_entry->generation;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_observers.erase(key);
+  auto* queue_entry = GetEntry(queue_id);
+  std::scoped_lock entry_lock(queue_entry->mutex);
+  queue_entry->task_observers.erase(key);
+  ++queue_entry->generation;
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  MergedQueuesLock queues_lock(*this, queue_id);
   std::vector<fml::closure> observers;
 
-  if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
+  if (GetEntry(queue_id)->subsumed_by != _kUnmerged) {
     return observers;
   }
 
-  for (const auto& observer : queue_entries_.at(queue_id)->task_observers) {
+  for (const auto& observer : GetEntry(queue_id)->task_observers) {
     observers.push_back(observer.second);
   }
 
-  TaskQueueId subsumed = queue_entries_.at(queue_id)->owner_of;
+  TaskQueueId subsumed = GetEntry(queue_id)->owner_of;
   if (subsumed != _kUnmerged) {
-    for (const auto& observer : queue_entries_.at(subsumed)->task_observers) {
+    for (const auto& observer : GetEntry(subsumed)->task_observers) {
       observers.push_back(observer.second);
     }
   }
@@ -174,19 +342,19 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
-  FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
-      << "Wakeable can only be set once.";
-  queue_entries_.at(queue_id)->wakeable = wakeable;
+  auto* queue_entry = GetEntry(queue_id);
+  std::scoped_lock entry_lock(queue_entry->mutex);
+  FML_CHECK(!queue_entry->wakeable) << "Wakeable can only be set once.";
+  queue_entry->wakeable = wakeable;
 }
 
 bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
-  auto& owner_entry = queue_entries_.at(owner);
-  auto& subsumed_entry = queue_entries_.at(subsumed);
+  auto* owner_entry = GetEntry(owner);
+  auto* subsumed_entry = GetEntry(subsumed);
+  std::scoped_lock entries_lock(owner_entry->mutex, subsumed_entry->mutex);
 
   if (owner_entry->owner_of == subsumed) {
     return true;
@@ -204,6 +372,8 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 
   owner_entry->owner_of = subsumed;
   subsumed_entry->subsumed_by = owner;
+  ++owner_entry->generation;
+  ++subsumed_entry->generation;
 
   if (HasPendingTasksUnlocked(owner)) {
     WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
@@ -213,15 +383,17 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& owner_entry = queue_entries_.at(owner);
+  MergedQueuesLock queues_lock(*this, owner);
+  auto* owner_entry = GetEntry(owner);
   const TaskQueueId subsumed = owner_entry->owner_of;
   if (subsumed == _kUnmerged) {
     return false;
   }
 
-  queue_entries_.at(subsumed)->subsumed_by = _kUnmerged;
+  GetEntry(subsumed)->subsumed_by = _kUnmerged;
   owner_entry->owner_of = _kUnmerged;
+  ++GetEntry(subsumed)->generation;
+  ++owner_entry->generation;
 
   if (HasPendingTasksUnlocked(owner)) {
     WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
@@ -236,15 +408,16 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
-  return subsumed == queue_entries_.at(owner)->owner_of;
+  auto* owner_entry = GetEntry(owner);
+  std::scoped_lock entry_lock(owner_entry->mutex);
+  return subsumed == owner_entry->owner_of;
 }
 
 // Subsumed queues will never have pending tasks.
 // Owning queues will consider both their and their subsumed tasks.
 bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     TaskQueueId queue_id) const {
-  const auto& entry = queue_entries_.at(queue_id);
+  const auto* entry = GetEntry(queue_id);
   bool is_subsumed = entry->subsumed_by != _kUnmerged;
   if (is_subsumed) {
     return false;
@@ -259,7 +432,7 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     // this is not an owner and queue is empty.
     return false;
   } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+    return !GetEntry(subsumed)->delayed_tasks.empty();
   }
 }
 
@@ -273,7 +446,7 @@ const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
     TaskQueueId owner,
     TaskQueueId& top_queue_id) const {
   FML_DCHECK(HasPendingTasksUnlocked(owner));
-  const auto& entry = queue_entries_.at(owner);
+  const auto* entry = GetEntry(owner);
   const TaskQueueId subsumed = entry->owner_of;
   if (subsumed == _kUnmerged) {
     top_queue_id = owner;
@@ -281,7 +454,7 @@ const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
   }
 
   const auto& owner_tasks = entry->delayed_tasks;
-  const auto& subsumed_tasks = queue_entries_.at(subsumed)->delayed_tasks;
+  const auto& subsumed_tasks = GetEntry(subsumed)->delayed_tasks;
 
   // we are owning another task queue
   const bool subsumed_has_task = !subsumed_tasks.empty();
@@ -299,7 +472,7 @@ const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
   } else {
     top_queue_id = subsumed;
   }
-  return queue_entries_.at(top_queue_id)->delayed_tasks.top();
+  return GetEntry(top_queue_id)->delayed_tasks.top();
 }
 
 }  // namespace fml
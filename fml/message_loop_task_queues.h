@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -13,7 +15,6 @@
 #include "flutter/fml/delayed_task.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
-#include "flutter/fml/synchronization/shared_mutex.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -48,12 +49,32 @@ class TaskQueueEntry {
   TaskQueueId owner_of;
   TaskQueueId subsumed_by;
 
+  // Guards all of the above. The merge state of two queues is only changed
+  // while holding the mutexes of both entries.
+  std::mutex mutex;
+
+  // Incremented whenever the merge state or the observers of the queue
+  // change. See |MessageLoopTaskQueues::IsBatchCurrent|.
+  std::atomic_size_t generation;
+
   TaskQueueEntry();
 
+  // Releases the tasks and observers of a disposed queue.
+  void Reset();
+
  private:
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(TaskQueueEntry);
 };
 
+// The tasks taken from a queue by |MessageLoopTaskQueues::GetTasksToRun|.
+struct TaskBatch {
+  // In the order in which they must be run.
+  std::vector<DelayedTask> tasks;
+  // To be notified after each of the tasks has run.
+  std::vector<fml::closure> observers;
+  size_t generation = 0;
+};
+
 enum class FlushType {
   kSingle,
   kAll,
@@ -62,6 +83,14 @@ enum class FlushType {
 // This class keeps track of all the tasks and observers that
 // need to be run on it's MessageLoopImpl. This also wakes up the
 // loop at the required times.
+//
+// Each queue has its own lock so that threads working with different queues
+// don't contend with each other. Operations on a merged queue lock both the
+// owner and the subsumed queue. Queues are looked up without locking: their
+// entries live in chunks that are only ever appended to, and the entry of a
+// disposed queue is emptied but not freed. Queue ids are never reused, so a
+// stale id reaches the empty entry of its disposed queue and not another
+// queue.
 class MessageLoopTaskQueues
     : public fml::RefCountedThreadSafe<MessageLoopTaskQueues> {
  public:
@@ -87,6 +116,27 @@ class MessageLoopTaskQueues
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
+  // Replaces the contents of |batch| with the tasks of |queue_id| that are due
+  // at |from_time| and the observers to notify after running them. This takes
+  // the lock of the queue once instead of once per task.
+  //
+  // A merged queue yields at most one task as its merge state may change while
+  // the task runs.
+  void GetTasksToRun(TaskQueueId queue_id,
+                     fml::TimePoint from_time,
+                     TaskBatch& batch);
+
+  // Returns false if the queue has been merged, unmerged or had its observers
+  // changed since |batch| was taken. The remaining tasks of the batch must then
+  // be handed back with |ReturnTasks|.
+  bool IsBatchCurrent(TaskQueueId queue_id, const TaskBatch& batch) const;
+
+  // Puts the tasks of |batch| from |first_task| on back into |queue_id|,
+  // keeping their original order.
+  void ReturnTasks(TaskQueueId queue_id,
+                   const TaskBatch& batch,
+                   size_t first_task);
+
   // Observers methods.
 
   void AddTaskObserver(TaskQueueId queue_id,
@@ -110,7 +160,7 @@ class MessageLoopTaskQueues
   //  3. Each task queue can only be merged and subsumed once.
   //
   //  Methods currently aware of the merged state of the queues:
-  //  HasPendingTasks, GetNextTaskToRun, GetNumPendingTasks
+  //  HasPendingTasks, GetNextTaskToRun, GetTasksToRun, GetNumPendingTasks
 
   // This method returns false if either the owner or subsumed has already been
   // merged with something else.
@@ -124,6 +174,7 @@ class MessageLoopTaskQueues
 
  private:
   class MergedQueuesRunner;
+  class MergedQueuesLock;
 
   MessageLoopTaskQueues();
 
@@ -138,11 +189,27 @@ class MessageLoopTaskQueues
 
   fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
 
+  TaskQueueEntry* GetEntry(TaskQueueId queue_id) const;
+
+  void AddEntryChunkLocked();
+
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
-  std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
+  static constexpr size_t kEntriesPerChunk = 64;
+
+  // Guards the creation of queues and the storage of their entries.
+  std::mutex queue_creation_mutex_;
+
+  // Owns the entries of the queues, |kEntriesPerChunk| per chunk.
+  std::vector<std::unique_ptr<TaskQueueEntry[]>> entry_chunks_;
+
+  // Maps the chunk index of a queue id to its chunk for |GetEntry|. Growing
+  // the table publishes a larger copy of it. The replaced tables are kept in
+  // |chunk_tables_| as lookups don't lock and may still be reading them.
+  std::atomic<std::atomic<TaskQueueEntry*>*> chunk_table_;
+  size_t chunk_table_size_;
+  std::vector<std::unique_ptr<std::atomic<TaskQueueEntry*>[]>> chunk_tables_;
 
   size_t task_queue_id_counter_;
 
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <thread>
@@ -64,5 +65,87 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Measures the throughput and latency of |RegisterTask| with several producer
+// threads. The first argument is the number of producers. If the second
+// argument is 1, all producers post to the same queue, otherwise each posts to
+// its own queue.
+static void BM_MultiProducerRegisterTask(benchmark::State& state) {  // NOLINT
+  const int num_producers = state.range(0);
+  const bool shared_queue = state.range(1) == 1;
+  const int num_tasks_per_producer = 1000;
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  const fml::TimePoint past = fml::TimePoint::Now();
+
+  std::vector<fml::TimeDelta> latencies;
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::vector<TaskQueueId> queue_ids;
+    for (int i = 0; i < (shared_queue ? 1 : num_producers); i++) {
+      queue_ids.push_back(task_queues->CreateTaskQueue());
+    }
+    std::vector<std::vector<fml::TimeDelta>> producer_latencies(num_producers);
+    CountDownLatch producers_ready(num_producers);
+    CountDownLatch start(1);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_producers; i++) {
+      const TaskQueueId queue_id = queue_ids[shared_queue ? 0 : i];
+      auto& thread_latencies = producer_latencies[i];
+      threads.emplace_back([&, queue_id]() {
+        thread_latencies.reserve(num_tasks_per_producer);
+        producers_ready.CountDown();
+        start.Wait();
+        for (int j = 0; j < num_tasks_per_producer; j++) {
+          const auto begin = fml::TimePoint::Now();
+          task_queues->RegisterTask(
+              queue_id, [] {}, past);
+          thread_latencies.push_back(fml::TimePoint::Now() - begin);
+        }
+      });
+    }
+    producers_ready.Wait();
+    state.ResumeTiming();
+
+    start.CountDown();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    state.PauseTiming();
+    for (const auto& thread_latencies : producer_latencies) {
+      latencies.insert(latencies.end(), thread_latencies.begin(),
+                       thread_latencies.end());
+    }
+    for (auto queue_id : queue_ids) {
+      task_queues->Dispose(queue_id);
+    }
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_producers *
+                          num_tasks_per_producer);
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile_ns = [&latencies](double percentile) {
+      const size_t index = (latencies.size() - 1) * percentile;
+      return static_cast<double>(latencies[index].ToNanoseconds());
+    };
+    state.counters["p50_ns"] = percentile_ns(0.5);
+    state.counters["p99_ns"] = percentile_ns(0.99);
+    state.counters["p999_ns"] = percentile_ns(0.999);
+  }
+}
+
+BENCHMARK(BM_MultiProducerRegisterTask)
+    ->ArgNames({"producers", "shared_queue"})
+    ->Args({1, 0})
+    ->Args({2, 0})
+    ->Args({4, 0})
+    ->Args({8, 0})
+    ->Args({2, 1})
+    ->Args({4, 1})
+    ->Args({8, 1})
+    ->UseRealTime();
+
 }  // namespace benchmarking
 }  // namespace fml
@@ -257,5 +257,38 @@ TEST(MessageLoopTaskQueueMergeUnmerge,
   latch.Wait();
 }
 
+TEST(MessageLoopTaskQueueMergeUnmerge, MergedQueueBatchesHaveOneTask) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  auto queue_id_1 = task_queue->CreateTaskQueue();
+  auto queue_id_2 = task_queue->CreateTaskQueue();
+
+  const auto now = fml::TimePoint::Now();
+  task_queue->RegisterTask(
+      queue_id_1, []() {}, now);
+  task_queue->RegisterTask(
+      queue_id_1, []() {}, now);
+  task_queue->RegisterTask(
+      queue_id_2, []() {}, now);
+
+  fml::TaskBatch batch;
+  task_queue->GetTasksToRun(queue_id_1, now, batch);
+  ASSERT_EQ(2u, batch.tasks.size());
+  task_queue->ReturnTasks(queue_id_1, batch, 0);
+
+  task_queue->Merge(queue_id_1, queue_id_2);
+  ASSERT_FALSE(task_queue->IsBatchCurrent(queue_id_1, batch));
+
+  task_queue->GetTasksToRun(queue_id_2, now, batch);
+  ASSERT_EQ(0u, batch.tasks.size());
+
+  for (int i = 0; i < 3; i++) {
+    task_queue->GetTasksToRun(queue_id_1, now, batch);
+    ASSERT_EQ(1u, batch.tasks.size());
+  }
+  task_queue->GetTasksToRun(queue_id_1, now, batch);
+  ASSERT_EQ(0u, batch.tasks.size());
+}
+
 }  // namespace testing
 }  // namespace fml
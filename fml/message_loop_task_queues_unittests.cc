@@ -184,6 +184,39 @@ TEST(MessageLoopTaskQueue, QueueDoNotOwnItself) {
   ASSERT_FALSE(task_queue->Owns(queue_id, queue_id));
 }
 
+TEST(MessageLoopTaskQueue, DisposedQueueIdsAreNotReused) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  task_queue->RegisterTask(
+      queue_id, [] {}, fml::TimePoint::Max());
+  task_queue->Dispose(queue_id);
+
+  auto new_id = task_queue->CreateTaskQueue();
+  ASSERT_NE(static_cast<size_t>(new_id), static_cast<size_t>(queue_id));
+  ASSERT_FALSE(task_queue->HasPendingTasks(queue_id));
+  ASSERT_FALSE(task_queue->HasPendingTasks(new_id));
+  task_queue->Dispose(new_id);
+}
+
+TEST(MessageLoopTaskQueue, EarlierQueuesOutliveTheGrowthOfEntries) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto first_id = task_queue->CreateTaskQueue();
+  task_queue->RegisterTask(
+      first_id, [] {}, fml::TimePoint::Max());
+
+  std::vector<TaskQueueId> queue_ids;
+  for (int i = 0; i < 64 * 64; i++) {
+    queue_ids.push_back(task_queue->CreateTaskQueue());
+  }
+  ASSERT_TRUE(task_queue->HasPendingTasks(first_id));
+  ASSERT_FALSE(task_queue->HasPendingTasks(queue_ids.back()));
+
+  for (auto queue_id : queue_ids) {
+    task_queue->Dispose(queue_id);
+  }
+  task_queue->Dispose(first_id);
+}
+
 // TODO(chunhtai): This unit-test is flaky and sometimes fails asynchronizely
 // after the test has finished.
 // https://github.com/flutter/flutter/issues/43858
@@ -282,5 +315,60 @@ TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   ASSERT_EQ(time1, wakes[2]);
 }
 
+TEST(MessageLoopTaskQueue, GetTasksToRunReturnsDueTasksInOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(2); }, now);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(1); },
+      now - fml::TimeDelta::FromMilliseconds(1));
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(3); }, now);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(4); }, fml::TimePoint::Max());
+  task_queue->AddTaskObserver(queue_id, 1, []() {});
+
+  fml::TaskBatch batch;
+  task_queue->GetTasksToRun(queue_id, now, batch);
+  ASSERT_EQ(batch.tasks.size(), 3u);
+  ASSERT_EQ(batch.observers.size(), 1u);
+  for (const auto& task : batch.tasks) {
+    task.GetTask()();
+  }
+  ASSERT_EQ(order, (std::vector<int>{1, 2, 3}));
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 1u);
+}
+
+TEST(MessageLoopTaskQueue, ReturnedTasksKeepTheirOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  std::vector<int> order;
+  const auto now = fml::TimePoint::Now();
+  for (int i = 0; i < 4; i++) {
+    task_queue->RegisterTask(
+        queue_id, [&order, i]() { order.push_back(i); }, now);
+  }
+
+  fml::TaskBatch batch;
+  task_queue->GetTasksToRun(queue_id, now, batch);
+  ASSERT_EQ(batch.tasks.size(), 4u);
+  batch.tasks[0].GetTask()();
+  task_queue->AddTaskObserver(queue_id, 1, []() {});
+  ASSERT_FALSE(task_queue->IsBatchCurrent(queue_id, batch));
+  task_queue->ReturnTasks(queue_id, batch, 1);
+
+  task_queue->GetTasksToRun(queue_id, now, batch);
+  ASSERT_TRUE(task_queue->IsBatchCurrent(queue_id, batch));
+  ASSERT_EQ(batch.observers.size(), 1u);
+  for (const auto& task : batch.tasks) {
+    task.GetTask()();
+  }
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+}
+
 }  // namespace testing
 }  // namespace fml
@@ -5,6 +5,7 @@
 #define FML_USED_ON_EMBEDDER
 
 #include <iostream>
+#include <set>
 #include <thread>
 
 #include "flutter/fml/build_config.h"
@@ -197,6 +198,49 @@ TEST(MessageLoop, TIMESENSITIVE(SingleDelayedTaskForTime)) {
   ASSERT_TRUE(checked);
 }
 
+#if OS_LINUX
+TEST(MessageLoop, TIMESENSITIVE(TimerSlackCoalescesDelayedTasks)) {
+  int checked = 0;
+  std::thread thread([&checked]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    const auto slack = fml::TimeDelta::FromMilliseconds(100);
+    loop.SetTimerSlack(slack);
+
+    // Find a window boundary far enough in the future for two tasks to be
+    // due before it.
+    const int64_t slack_nanos = slack.ToNanoseconds();
+    const int64_t now_nanos =
+        fml::TimePoint::Now().ToEpochDelta().ToNanoseconds();
+    int64_t boundary_nanos = (now_nanos / slack_nanos + 1) * slack_nanos;
+    if (boundary_nanos - now_nanos < slack_nanos / 2) {
+      boundary_nanos += slack_nanos;
+    }
+    const auto boundary = fml::TimePoint::FromEpochDelta(
+        fml::TimeDelta::FromNanoseconds(boundary_nanos));
+
+    // Both tasks are delayed until the end of the window.
+    auto task_runner = loop.GetTaskRunner();
+    task_runner->PostTaskForTime(
+        [boundary, &checked]() {
+          ASSERT_GE(fml::TimePoint::Now(), boundary);
+          checked++;
+        },
+        boundary - fml::TimeDelta::FromMilliseconds(20));
+    task_runner->PostTaskForTime(
+        [boundary, &checked]() {
+          ASSERT_GE(fml::TimePoint::Now(), boundary);
+          checked++;
+          fml::MessageLoop::GetCurrent().Terminate();
+        },
+        boundary - fml::TimeDelta::FromMilliseconds(10));
+    loop.Run();
+  });
+  thread.join();
+  ASSERT_EQ(checked, 2);
+}
+#endif  // OS_LINUX
+
 TEST(MessageLoop, TIMESENSITIVE(MultipleDelayedTasksWithIncreasingDeltas)) {
   const auto count = 10;
   int checked = false;
@@ -315,3 +359,83 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsHighPriorityTasksFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent blocker;
+  fml::CountDownLatch latch(3);
+  std::vector<int> order;
+  // Keep the only worker busy while the other tasks are posted.
+  task_runner->PostTask([&]() {
+    blocker.Wait();
+    latch.CountDown();
+  });
+  task_runner->PostTask([&]() {
+    order.push_back(1);
+    latch.CountDown();
+  });
+  task_runner->PostTask(
+      [&]() {
+        order.push_back(2);
+        latch.CountDown();
+      },
+      fml::ConcurrentTaskPriority::kHigh);
+  blocker.Signal();
+  latch.Wait();
+  ASSERT_EQ(order, (std::vector<int>{2, 1}));
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksOfOneWorkerInOrder) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+  const int kCount = 100;
+  fml::CountDownLatch latch(kCount);
+  std::vector<int> order;
+  for (int i = 0; i < kCount; ++i) {
+    task_runner->PostTask([&, i]() {
+      order.push_back(i);
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  ASSERT_EQ(order.size(), static_cast<size_t>(kCount));
+  for (int i = 0; i < kCount; ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopWorkersStealTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent stolen;
+  fml::AutoResetWaitableEvent done;
+  // Tasks posted by a worker are queued for that worker. The inner task can
+  // only run if the other worker steals it because the posting worker is
+  // blocked until it does.
+  task_runner->PostTask([&]() {
+    const auto poster = std::this_thread::get_id();
+    task_runner->PostTask([&, poster]() {
+      EXPECT_NE(std::this_thread::get_id(), poster);
+      stolen.Signal();
+    });
+    stolen.Wait();
+    done.Signal();
+  });
+  done.Wait();
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPostedToAllWorkers) {
+  const size_t kWorkerCount = 4;
+  auto loop = fml::ConcurrentMessageLoop::Create(kWorkerCount);
+  fml::CountDownLatch latch(kWorkerCount);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    std::scoped_lock lock(thread_ids_mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), kWorkerCount);
+}
@@ -80,7 +80,7 @@ void MessageLoopLinux::Terminate() {
 
 // |fml::MessageLoopImpl|
 void MessageLoopLinux::WakeUp(fml::TimePoint time_point) {
-  bool result = TimerRearm(timer_fd_.get(), time_point);
+  bool result = TimerRearm(timer_fd_.get(), GetCoalescedWakeTime(time_point));
   FML_DCHECK(result);
 }
 
@@ -230,6 +230,20 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
                     base_directory.get(), file_name) == 0;
 }
 
+bool RenameFile(const fml::UniqueFD& base_directory,
+                const char* old_path,
+                const char* new_path) {
+  if (old_path == nullptr || new_path == nullptr) {
+    return false;
+  }
+  int code = ::renameat(base_directory.get(), old_path, base_directory.get(),
+                        new_path);
+  if (code != 0) {
+    FML_DLOG(ERROR) << strerror(errno);
+  }
+  return code == 0;
+}
+
 bool VisitFiles(const fml::UniqueFD& directory, const FileVisitor& visitor) {
   fml::UniqueFD dup_fd(dup(directory.get()));
   if (!dup_fd.is_valid()) {
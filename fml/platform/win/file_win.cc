@@ -406,6 +406,23 @@ bool WriteAtomically(const fml::UniqueFD& base_directory,
   return true;
 }
 
+bool RenameFile(const fml::UniqueFD& base_directory,
+                const char* old_path,
+                const char* new_path) {
+  if (old_path == nullptr || new_path == nullptr) {
+    return false;
+  }
+  if (!::MoveFileEx(
+          StringToWideString(GetAbsolutePath(base_directory, old_path)).c_str(),
+          StringToWideString(GetAbsolutePath(base_directory, new_path)).c_str(),
+          MOVEFILE_REPLACE_EXISTING)) {
+    FML_DLOG(ERROR) << "Could not rename file: '" << old_path << "' to '"
+                    << new_path << "'. " << GetLastErrorMessage();
+    return false;
+  }
+  return true;
+}
+
 bool VisitFiles(const fml::UniqueFD& directory, const FileVisitor& visitor) {
   std::string search_pattern = GetFullHandlePath(directory) + "\\*";
   WIN32_FIND_DATA find_file_data;
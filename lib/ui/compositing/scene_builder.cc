@@ -10,13 +10,13 @@
 #include "flutter/flow/layers/clip_rrect_layer.h"
 #include "flutter/flow/layers/color_filter_layer.h"
 #include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
 #include "flutter/flow/layers/image_filter_layer.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/layers/opacity_layer.h"
 #include "flutter/flow/layers/performance_overlay_layer.h"
 #include "flutter/flow/layers/physical_shape_layer.h"
-#include "flutter/flow/layers/picture_layer.h"
 #include "flutter/flow/layers/platform_view_layer.h"
 #include "flutter/flow/layers/shader_mask_layer.h"
 #include "flutter/flow/layers/texture_layer.h"
@@ -204,6 +204,9 @@ void SceneBuilder::pushPhysicalShape(Dart_Handle layer_handle,
 }
 
 void SceneBuilder::addRetained(fml::RefPtr<EngineLayer> retainedLayer) {
+  // The retained subtree has not changed since it was last added, so its
+  // preroll only has to be repeated if it is prerolled differently.
+  retainedLayer->Layer()->set_memoize_preroll(true);
   AddLayer(retainedLayer->Layer());
 }
 
@@ -216,11 +219,9 @@ void SceneBuilder::addPicture(double dx,
                               Picture* picture,
                               int hints) {
   SkPoint offset = SkPoint::Make(dx, dy);
-  SkRect pictureRect = picture->picture()->cullRect();
-  pictureRect.offset(offset.x(), offset.y());
-  auto layer = std::make_unique<flutter::PictureLayer>(
-      offset, UIDartState::CreateGPUObject(picture->picture()), !!(hints & 1),
-      !!(hints & 2));
+  auto layer = std::make_unique<flutter::DisplayListLayer>(
+      offset, UIDartState::CreateGPUObject(picture->display_list()),
+      !!(hints & 1), !!(hints & 2));
   AddLayer(std::move(layer));
 }
 
@@ -43,6 +43,17 @@ void frameCallback(FrameInfo info) {
   print('called back');
 }
 
+@pragma('vm:entry-point')
+void notifyingFrameCallback(FrameInfo info) {
+  if (info == null) {
+    _notifyFrame(0, 0);
+  } else {
+    _notifyFrame(info.image.width, info.duration.inMilliseconds);
+  }
+}
+
+void _notifyFrame(int width, int durationMillis) native 'NotifyFrame';
+
 @pragma('vm:entry-point')
 void messageCallback(dynamic data) {}
 
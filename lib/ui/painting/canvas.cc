@@ -7,7 +7,6 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
-#include "flutter/flow/layers/physical_shape_layer.h"
 #include "flutter/lib/ui/painting/image.h"
 #include "flutter/lib/ui/painting/matrix.h"
 #include "flutter/lib/ui/ui_dart_state.h"
@@ -88,7 +87,7 @@ fml::RefPtr<Canvas> Canvas::Create(PictureRecorder* recorder,
   return canvas;
 }
 
-Canvas::Canvas(SkCanvas* canvas) : canvas_(canvas) {}
+Canvas::Canvas(DisplayListCanvasRecorder* canvas) : canvas_(canvas) {}
 
 Canvas::~Canvas() {}
 
@@ -205,7 +204,7 @@ void Canvas::drawColor(SkColor color, SkBlendMode blend_mode) {
   if (!canvas_) {
     return;
   }
-  canvas_->drawColor(color, blend_mode);
+  builder()->drawColor(color, blend_mode);
 }
 
 void Canvas::drawLine(double x1,
@@ -217,14 +216,15 @@ void Canvas::drawLine(double x1,
   if (!canvas_) {
     return;
   }
-  canvas_->drawLine(x1, y1, x2, y2, *paint.paint());
+  builder()->drawLine(SkPoint::Make(x1, y1), SkPoint::Make(x2, y2),
+                      *paint.paint());
 }
 
 void Canvas::drawPaint(const Paint& paint, const PaintData& paint_data) {
   if (!canvas_) {
     return;
   }
-  canvas_->drawPaint(*paint.paint());
+  builder()->drawPaint(*paint.paint());
 }
 
 void Canvas::drawRect(double left,
@@ -236,7 +236,8 @@ void Canvas::drawRect(double left,
   if (!canvas_) {
     return;
   }
-  canvas_->drawRect(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
+  builder()->drawRect(SkRect::MakeLTRB(left, top, right, bottom),
+                      *paint.paint());
 }
 
 void Canvas::drawRRect(const RRect& rrect,
@@ -245,7 +246,7 @@ void Canvas::drawRRect(const RRect& rrect,
   if (!canvas_) {
     return;
   }
-  canvas_->drawRRect(rrect.sk_rrect, *paint.paint());
+  builder()->drawRRect(rrect.sk_rrect, *paint.paint());
 }
 
 void Canvas::drawDRRect(const RRect& outer,
@@ -255,7 +256,7 @@ void Canvas::drawDRRect(const RRect& outer,
   if (!canvas_) {
     return;
   }
-  canvas_->drawDRRect(outer.sk_rrect, inner.sk_rrect, *paint.paint());
+  builder()->drawDRRect(outer.sk_rrect, inner.sk_rrect, *paint.paint());
 }
 
 void Canvas::drawOval(double left,
@@ -267,7 +268,8 @@ void Canvas::drawOval(double left,
   if (!canvas_) {
     return;
   }
-  canvas_->drawOval(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
+  builder()->drawOval(SkRect::MakeLTRB(left, top, right, bottom),
+                      *paint.paint());
 }
 
 void Canvas::drawCircle(double x,
@@ -278,7 +280,7 @@ void Canvas::drawCircle(double x,
   if (!canvas_) {
     return;
   }
-  canvas_->drawCircle(x, y, radius, *paint.paint());
+  builder()->drawCircle(SkPoint::Make(x, y), radius, *paint.paint());
 }
 
 void Canvas::drawArc(double left,
@@ -293,9 +295,9 @@ void Canvas::drawArc(double left,
   if (!canvas_) {
     return;
   }
-  canvas_->drawArc(SkRect::MakeLTRB(left, top, right, bottom),
-                   startAngle * 180.0 / M_PI, sweepAngle * 180.0 / M_PI,
-                   useCenter, *paint.paint());
+  builder()->drawArc(SkRect::MakeLTRB(left, top, right, bottom),
+                      startAngle * 180.0 / M_PI, sweepAngle * 180.0 / M_PI,
+                      useCenter, *paint.paint());
 }
 
 void Canvas::drawPath(const CanvasPath* path,
@@ -309,7 +311,7 @@ void Canvas::drawPath(const CanvasPath* path,
         ToDart("Canvas.drawPath called with non-genuine Path."));
     return;
   }
-  canvas_->drawPath(path->path(), *paint.paint());
+  builder()->drawPath(path->path(), *paint.paint());
 }
 
 void Canvas::drawImage(const CanvasImage* image,
@@ -325,7 +327,8 @@ void Canvas::drawImage(const CanvasImage* image,
         ToDart("Canvas.drawImage called with non-genuine Image."));
     return;
   }
-  canvas_->drawImage(image->image(), x, y, paint.paint());
+  builder()->drawImage(image->image().get(), SkPoint::Make(x, y),
+                       paint.paint());
 }
 
 void Canvas::drawImageRect(const CanvasImage* image,
@@ -349,8 +352,8 @@ void Canvas::drawImageRect(const CanvasImage* image,
   }
   SkRect src = SkRect::MakeLTRB(src_left, src_top, src_right, src_bottom);
   SkRect dst = SkRect::MakeLTRB(dst_left, dst_top, dst_right, dst_bottom);
-  canvas_->drawImageRect(image->image(), src, dst, paint.paint(),
-                         SkCanvas::kFast_SrcRectConstraint);
+  builder()->drawImageRect(image->image().get(), src, dst, paint.paint(),
+                           SkCanvas::kFast_SrcRectConstraint);
 }
 
 void Canvas::drawImageNine(const CanvasImage* image,
@@ -377,7 +380,7 @@ void Canvas::drawImageNine(const CanvasImage* image,
   SkIRect icenter;
   center.round(&icenter);
   SkRect dst = SkRect::MakeLTRB(dst_left, dst_top, dst_right, dst_bottom);
-  canvas_->drawImageNine(image->image(), icenter, dst, paint.paint());
+  builder()->drawImageNine(image->image().get(), icenter, dst, paint.paint());
 }
 
 void Canvas::drawPicture(Picture* picture) {
@@ -389,7 +392,7 @@ void Canvas::drawPicture(Picture* picture) {
         ToDart("Canvas.drawPicture called with non-genuine Picture."));
     return;
   }
-  canvas_->drawPicture(picture->picture().get());
+  builder()->drawDisplayList(picture->display_list().get());
 }
 
 void Canvas::drawPoints(const Paint& paint,
@@ -403,10 +406,10 @@ void Canvas::drawPoints(const Paint& paint,
   static_assert(sizeof(SkPoint) == sizeof(float) * 2,
                 "SkPoint doesn't use floats.");
 
-  canvas_->drawPoints(point_mode,
-                      points.num_elements() / 2,  // SkPoints have two floats.
-                      reinterpret_cast<const SkPoint*>(points.data()),
-                      *paint.paint());
+  builder()->drawPoints(point_mode,
+                        points.num_elements() / 2,  // SkPoints have two floats.
+                        reinterpret_cast<const SkPoint*>(points.data()),
+                        *paint.paint());
 }
 
 void Canvas::drawVertices(const Vertices* vertices,
@@ -421,7 +424,8 @@ void Canvas::drawVertices(const Vertices* vertices,
         ToDart("Canvas.drawVertices called with non-genuine Vertices."));
     return;
   }
-  canvas_->drawVertices(vertices->vertices(), blend_mode, *paint.paint());
+  builder()->drawVertices(vertices->vertices().get(), blend_mode,
+                          *paint.paint());
 }
 
 void Canvas::drawAtlas(const Paint& paint,
@@ -449,7 +453,7 @@ void Canvas::drawAtlas(const Paint& paint,
   static_assert(sizeof(SkRect) == sizeof(float) * 4,
                 "SkRect doesn't use floats.");
 
-  canvas_->drawAtlas(
+  builder()->drawAtlas(
       skImage.get(), reinterpret_cast<const SkRSXform*>(transforms.data()),
       reinterpret_cast<const SkRect*>(rects.data()),
       reinterpret_cast<const SkColor*>(colors.data()),
@@ -462,6 +466,9 @@ void Canvas::drawShadow(const CanvasPath* path,
                         SkColor color,
                         double elevation,
                         bool transparentOccluder) {
+  if (!canvas_) {
+    return;
+  }
   if (!path) {
     Dart_ThrowException(
         ToDart("Canvas.drawShader called with non-genuine Path."));
@@ -472,8 +479,8 @@ void Canvas::drawShadow(const CanvasPath* path,
                      ->window()
                      ->viewport_metrics()
                      .device_pixel_ratio;
-  flutter::PhysicalShapeLayer::DrawShadow(canvas_, path->path(), color,
-                                          elevation, transparentOccluder, dpr);
+  builder()->drawShadow(path->path(), color, elevation, transparentOccluder,
+                        dpr);
 }
 
 void Canvas::Invalidate() {
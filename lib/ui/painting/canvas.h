@@ -170,12 +170,17 @@ class Canvas : public RefCountedDartWrappable<Canvas> {
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
 
  private:
-  explicit Canvas(SkCanvas* canvas);
+  explicit Canvas(DisplayListCanvasRecorder* canvas);
 
-  // The SkCanvas is supplied by a call to SkPictureRecorder::beginRecording,
+  // Draws are recorded straight into the builder, while the save, layer,
+  // transform and clip calls go through the canvas to keep its state in sync
+  // for the draws that need an SkCanvas, like paragraphs.
+  DisplayListBuilder* builder() const { return canvas_->builder(); }
+
+  // The canvas is supplied by a call to PictureRecorder::BeginRecording,
   // which does not transfer ownership.  For this reason, we hold a raw
   // pointer and manually set to null in Clear.
-  SkCanvas* canvas_;
+  DisplayListCanvasRecorder* canvas_;
 };
 
 }  // namespace flutter
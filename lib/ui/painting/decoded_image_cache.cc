@@ -0,0 +1,170 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <string_view>
+#include <utility>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  return content_hash == other.content_hash &&
+         content_size == other.content_size &&
+         target_width == other.target_width &&
+         target_height == other.target_height && width == other.width &&
+         height == other.height && color_type == other.color_type &&
+         row_bytes == other.row_bytes;
+}
+
+size_t DecodedImageCache::KeyHash::operator()(const Key& key) const {
+  return fml::HashCombine(key.content_hash, key.content_size, key.target_width,
+                          key.target_height, key.width, key.height,
+                          static_cast<int>(key.color_type), key.row_bytes);
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() = default;
+
+std::shared_ptr<DecodedImageCache> DecodedImageCache::GetProcessCache() {
+  static std::shared_ptr<DecodedImageCache> cache =
+      std::make_shared<DecodedImageCache>(0);
+  return cache;
+}
+
+DecodedImageCache::Key DecodedImageCache::MakeKey(
+    const ImageDescriptor& descriptor,
+    uint32_t target_width,
+    uint32_t target_height) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::MakeKey");
+  Key key;
+  sk_sp<SkData> data = descriptor.data();
+  if (data) {
+    key.content_hash = std::hash<std::string_view>()(std::string_view(
+        static_cast<const char*>(data->data()), data->size()));
+    key.content_size = data->size();
+  }
+  key.target_width = target_width;
+  key.target_height = target_height;
+  // The info of compressed data is derived from the data itself, but the info
+  // of decompressed data is supplied alongside the pixels.
+  if (!descriptor.is_compressed()) {
+    key.width = descriptor.width();
+    key.height = descriptor.height();
+    key.color_type = descriptor.image_info().colorType();
+    key.row_bytes = descriptor.row_bytes();
+  }
+  return key;
+}
+
+sk_sp<SkImage> DecodedImageCache::Get(const Key& key,
+                                      const sk_sp<SkData>& data) {
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    return nullptr;
+  }
+  EntryList::iterator entry = found->second;
+  if (entry->data != data && !entry->data->equals(data.get())) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  return entry->image;
+}
+
+void DecodedImageCache::Put(const Key& key,
+                            sk_sp<SkData> data,
+                            sk_sp<SkImage> image) {
+  if (!data || !image || image->isTextureBacked()) {
+    return;
+  }
+  const size_t bytes =
+      image->imageInfo().computeMinByteSize() + data->size() + sizeof(Entry);
+
+  std::scoped_lock lock(mutex_);
+  if (bytes > max_bytes_) {
+    return;
+  }
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    // Replaces the image of colliding data, or one decoded concurrently.
+    bytes_ -= found->second->bytes;
+    entries_.erase(found->second);
+    index_.erase(found);
+  }
+  entries_.push_front({key, std::move(data), std::move(image), bytes});
+  index_[key] = entries_.begin();
+  bytes_ += bytes;
+  EvictLocked();
+  TraceBytesLocked();
+}
+
+void DecodedImageCache::SetMaxBytes(size_t max_bytes) {
+  std::scoped_lock lock(mutex_);
+  max_bytes_ = max_bytes;
+  EvictLocked();
+  TraceBytesLocked();
+}
+
+size_t DecodedImageCache::GetMaxBytes() const {
+  std::scoped_lock lock(mutex_);
+  return max_bytes_;
+}
+
+size_t DecodedImageCache::GetAllocationSize() const {
+  std::scoped_lock lock(mutex_);
+  return bytes_;
+}
+
+size_t DecodedImageCache::TakeUnreportedBytes() {
+  std::scoped_lock lock(mutex_);
+  const size_t unreported =
+      bytes_ > reported_bytes_ ? bytes_ - reported_bytes_ : 0;
+  reported_bytes_ += unreported;
+  return unreported;
+}
+
+void DecodedImageCache::ReturnReportedBytes(size_t bytes) {
+  std::scoped_lock lock(mutex_);
+  FML_DCHECK(bytes <= reported_bytes_);
+  reported_bytes_ -= bytes;
+}
+
+size_t DecodedImageCache::GetImageCount() const {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+void DecodedImageCache::Clear() {
+  std::scoped_lock lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  bytes_ = 0;
+  TraceBytesLocked();
+}
+
+void DecodedImageCache::EvictLocked() {
+  while (bytes_ > max_bytes_ && !entries_.empty()) {
+    const Entry& entry = entries_.back();
+    bytes_ -= entry.bytes;
+    index_.erase(entry.key);
+    entries_.pop_back();
+  }
+}
+
+void DecodedImageCache::TraceBytesLocked() const {
+#if !FLUTTER_RELEASE
+  constexpr double kMegaBytes = (1 << 20);
+  FML_TRACE_COUNTER("flutter", "DecodedImageCache",
+                    reinterpret_cast<int64_t>(this), "ImageCount",
+                    entries_.size(), "MBytes", bytes_ / kMegaBytes);
+#endif  // !FLUTTER_RELEASE
+}
+
+}  // namespace flutter
@@ -0,0 +1,125 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/painting/image_descriptor.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+
+namespace flutter {
+
+// Keeps the raster images decoded from the data of image descriptors, so that
+// decoding the same bytes at the same target size again skips decompressing
+// and resizing them. Only the texture upload is repeated, since textures
+// belong to the resource context of a single engine.
+//
+// Images are evicted in least recently used order once they take up more than
+// the byte budget of the cache. The cache may be used from any thread.
+class DecodedImageCache {
+ public:
+  // Identifies the decoded image of some image data at a target size.
+  struct Key {
+    // The hash and size of the image data.
+    size_t content_hash = 0;
+    size_t content_size = 0;
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+    // The layout of the pixels of decompressed image data.
+    int width = 0;
+    int height = 0;
+    SkColorType color_type = kUnknown_SkColorType;
+    size_t row_bytes = 0;
+
+    bool operator==(const Key& other) const;
+  };
+
+  explicit DecodedImageCache(size_t max_bytes);
+
+  ~DecodedImageCache();
+
+  // The cache shared by the engines, and so the isolates, of the process. Its
+  // budget is zero, which disables it, until one is set.
+  static std::shared_ptr<DecodedImageCache> GetProcessCache();
+
+  // Hashes the data of the descriptor, which is as slow as copying it. Call
+  // this on a worker thread.
+  static Key MakeKey(const ImageDescriptor& descriptor,
+                     uint32_t target_width,
+                     uint32_t target_height);
+
+  // Returns the image decoded from |data| for the key, or null if it is not
+  // cached.
+  sk_sp<SkImage> Get(const Key& key, const sk_sp<SkData>& data);
+
+  // Caches the raster |image| decoded from |data|. The data is kept alive and
+  // compared on lookups, so that colliding hashes never return the image of
+  // different bytes.
+  void Put(const Key& key, sk_sp<SkData> data, sk_sp<SkImage> image);
+
+  // Evicts images until the remaining ones fit into |max_bytes|.
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t GetMaxBytes() const;
+
+  // The bytes of the cached images and the data they were decoded from.
+  size_t GetAllocationSize() const;
+
+  // Hands the bytes of the cache that no live image reports yet to the caller,
+  // which reports them as part of the allocation size of an image until it
+  // returns them. The Dart heap then sees the bytes of the cache once, however
+  // many images are decoded from an entry. Images created after an eviction
+  // only take what is left.
+  size_t TakeUnreportedBytes();
+
+  // Returns bytes from |TakeUnreportedBytes| once their image is disposed or
+  // destroyed.
+  void ReturnReportedBytes(size_t bytes);
+
+  size_t GetImageCount() const;
+
+  void Clear();
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    sk_sp<SkData> data;
+    sk_sp<SkImage> image;
+    size_t bytes;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  mutable std::mutex mutex_;
+  size_t max_bytes_;
+  size_t bytes_ = 0;
+  // The bytes that live images report for the cache.
+  size_t reported_bytes_ = 0;
+  // Ordered from the most to the least recently used image.
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+
+  // Evicts the least recently used images until the cache fits its budget.
+  void EvictLocked();
+
+  void TraceBytesLocked() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
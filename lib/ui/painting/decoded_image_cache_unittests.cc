@@ -0,0 +1,127 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr int kImageSize = 16;
+
+sk_sp<SkImage> MakeImage(SkColor color) {
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kImageSize, kImageSize);
+  surface->getCanvas()->clear(color);
+  return surface->makeImageSnapshot();
+}
+
+sk_sp<SkData> MakeData(char fill) {
+  sk_sp<SkData> data = SkData::MakeUninitialized(64);
+  memset(data->writable_data(), fill, data->size());
+  return data;
+}
+
+DecodedImageCache::Key MakeKey(size_t content_hash, uint32_t target_width) {
+  DecodedImageCache::Key key;
+  key.content_hash = content_hash;
+  key.content_size = 64;
+  key.target_width = target_width;
+  key.target_height = target_width;
+  return key;
+}
+
+// The bytes a single cached image and its data take up.
+size_t GetEntryBytes() {
+  DecodedImageCache cache(1 << 20);
+  cache.Put(MakeKey(1, 0), MakeData('a'), MakeImage(SK_ColorRED));
+  return cache.GetAllocationSize();
+}
+
+}  // namespace
+
+TEST(DecodedImageCacheTest, ReturnsImagesDecodedFromEqualData) {
+  DecodedImageCache cache(1 << 20);
+  sk_sp<SkImage> image = MakeImage(SK_ColorRED);
+  cache.Put(MakeKey(1, 0), MakeData('a'), image);
+  EXPECT_EQ(cache.GetImageCount(), 1u);
+  EXPECT_GT(cache.GetAllocationSize(),
+            image->imageInfo().computeMinByteSize());
+
+  // Equal data in a different buffer, like an asset loaded again.
+  EXPECT_EQ(cache.Get(MakeKey(1, 0), MakeData('a')), image);
+  // The same data at another target size.
+  EXPECT_EQ(cache.Get(MakeKey(1, 8), MakeData('a')), nullptr);
+}
+
+TEST(DecodedImageCacheTest, IgnoresDataWithCollidingHashes) {
+  DecodedImageCache cache(1 << 20);
+  cache.Put(MakeKey(1, 0), MakeData('a'), MakeImage(SK_ColorRED));
+  EXPECT_EQ(cache.Get(MakeKey(1, 0), MakeData('b')), nullptr);
+
+  sk_sp<SkImage> image = MakeImage(SK_ColorBLUE);
+  cache.Put(MakeKey(1, 0), MakeData('b'), image);
+  EXPECT_EQ(cache.GetImageCount(), 1u);
+  EXPECT_EQ(cache.Get(MakeKey(1, 0), MakeData('b')), image);
+  EXPECT_EQ(cache.Get(MakeKey(1, 0), MakeData('a')), nullptr);
+}
+
+TEST(DecodedImageCacheTest, EvictsTheLeastRecentlyUsedImages) {
+  DecodedImageCache cache(GetEntryBytes() * 2);
+  cache.Put(MakeKey(1, 0), MakeData('a'), MakeImage(SK_ColorRED));
+  cache.Put(MakeKey(2, 0), MakeData('b'), MakeImage(SK_ColorGREEN));
+  // Uses the first image, so that the second one is evicted next.
+  EXPECT_NE(cache.Get(MakeKey(1, 0), MakeData('a')), nullptr);
+  cache.Put(MakeKey(3, 0), MakeData('c'), MakeImage(SK_ColorBLUE));
+
+  EXPECT_EQ(cache.GetImageCount(), 2u);
+  EXPECT_NE(cache.Get(MakeKey(1, 0), MakeData('a')), nullptr);
+  EXPECT_EQ(cache.Get(MakeKey(2, 0), MakeData('b')), nullptr);
+  EXPECT_NE(cache.Get(MakeKey(3, 0), MakeData('c')), nullptr);
+
+  cache.SetMaxBytes(GetEntryBytes());
+  EXPECT_EQ(cache.GetImageCount(), 1u);
+  EXPECT_EQ(cache.GetAllocationSize(), GetEntryBytes());
+  EXPECT_NE(cache.Get(MakeKey(3, 0), MakeData('c')), nullptr);
+}
+
+TEST(DecodedImageCacheTest, ReportsTheCachedBytesOnce) {
+  DecodedImageCache cache(GetEntryBytes() * 2);
+  cache.Put(MakeKey(1, 0), MakeData('a'), MakeImage(SK_ColorRED));
+
+  // Images decoded from the same entry.
+  const size_t first_bytes = cache.TakeUnreportedBytes();
+  EXPECT_EQ(first_bytes, GetEntryBytes());
+  EXPECT_EQ(cache.TakeUnreportedBytes(), 0u);
+
+  cache.Put(MakeKey(2, 0), MakeData('b'), MakeImage(SK_ColorGREEN));
+  const size_t second_bytes = cache.TakeUnreportedBytes();
+  EXPECT_EQ(second_bytes, GetEntryBytes());
+
+  // Evicted bytes are not handed out again.
+  cache.SetMaxBytes(GetEntryBytes());
+  cache.ReturnReportedBytes(first_bytes);
+  EXPECT_EQ(cache.TakeUnreportedBytes(), 0u);
+  cache.ReturnReportedBytes(second_bytes);
+  EXPECT_EQ(cache.TakeUnreportedBytes(), GetEntryBytes());
+}
+
+TEST(DecodedImageCacheTest, DoesNotCacheWithoutABudget) {
+  DecodedImageCache cache(0);
+  cache.Put(MakeKey(1, 0), MakeData('a'), MakeImage(SK_ColorRED));
+  EXPECT_EQ(cache.GetImageCount(), 0u);
+  EXPECT_EQ(cache.GetAllocationSize(), 0u);
+  EXPECT_EQ(cache.Get(MakeKey(1, 0), MakeData('a')), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
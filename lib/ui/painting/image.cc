@@ -4,6 +4,7 @@
 
 #include "flutter/lib/ui/painting/image.h"
 
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_encoding.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_args.h"
@@ -30,7 +31,9 @@ void CanvasImage::RegisterNatives(tonic::DartLibraryNatives* natives) {
 
 CanvasImage::CanvasImage() = default;
 
-CanvasImage::~CanvasImage() = default;
+CanvasImage::~CanvasImage() {
+  ReturnCacheBytes();
+}
 
 Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
   return EncodeImage(this, format, callback);
@@ -39,18 +42,34 @@ Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
 void CanvasImage::dispose() {
   auto hint_freed_delegate = UIDartState::Current()->GetHintFreedDelegate();
   if (hint_freed_delegate) {
-    hint_freed_delegate->HintFreed(GetAllocationSize());
+    // The cache still holds the bytes reported for it.
+    hint_freed_delegate->HintFreed(GetAllocationSize() - cache_bytes_);
   }
   image_.reset();
+  ReturnCacheBytes();
   ClearDartWrapper();
 }
 
+void CanvasImage::ReportCacheBytes(std::shared_ptr<DecodedImageCache> cache) {
+  ReturnCacheBytes();
+  cache_ = std::move(cache);
+  cache_bytes_ = cache_ ? cache_->TakeUnreportedBytes() : 0;
+}
+
+void CanvasImage::ReturnCacheBytes() {
+  if (cache_) {
+    cache_->ReturnReportedBytes(cache_bytes_);
+    cache_ = nullptr;
+    cache_bytes_ = 0;
+  }
+}
+
 size_t CanvasImage::GetAllocationSize() const {
   if (auto image = image_.get()) {
     const auto& info = image->imageInfo();
     const auto kMipmapOverhead = 4.0 / 3.0;
     const size_t image_byte_size = info.computeMinByteSize() * kMipmapOverhead;
-    return image_byte_size + sizeof(this);
+    return image_byte_size + cache_bytes_ + sizeof(this);
   } else {
     return sizeof(CanvasImage);
   }
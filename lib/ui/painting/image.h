@@ -16,6 +16,8 @@ class DartLibraryNatives;
 
 namespace flutter {
 
+class DecodedImageCache;
+
 class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   DEFINE_WRAPPERTYPEINFO();
   FML_FRIEND_MAKE_REF_COUNTED(CanvasImage);
@@ -39,6 +41,10 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
     image_ = std::move(image);
   }
 
+  // Makes the image report the bytes of |cache| that no other live image
+  // reports. See |DecodedImageCache::TakeUnreportedBytes|.
+  void ReportCacheBytes(std::shared_ptr<DecodedImageCache> cache);
+
   size_t GetAllocationSize() const override;
 
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
@@ -47,6 +53,10 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   CanvasImage();
 
   flutter::SkiaGPUObject<SkImage> image_;
+  std::shared_ptr<DecodedImageCache> cache_;
+  size_t cache_bytes_ = 0;
+
+  void ReturnCacheBytes();
 };
 
 }  // namespace flutter
@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/lib/ui/painting/pixel_conversion.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 
 namespace flutter {
@@ -43,6 +44,23 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return image->makeRasterImage();
   }
 
+  // Halve large images with the vectorized box filter first, so that Skia's
+  // bilinear filter only scales them the rest of the way.
+  SkPixmap pixmap;
+  SkBitmap halved_bitmap;
+  if (image->peekPixels(&pixmap) &&
+      DownscalePixmapByHalves(pixmap, resized_dimensions, &halved_bitmap)) {
+    halved_bitmap.setImmutable();
+    image = SkImage::MakeFromBitmap(halved_bitmap);
+    if (!image) {
+      FML_LOG(ERROR) << "Could not create an image from a halved bitmap.";
+      return nullptr;
+    }
+    if (image->dimensions() == resized_dimensions) {
+      return image;
+    }
+  }
+
   const auto scaled_image_info =
       image->imageInfo().makeDimensions(resized_dimensions);
 
@@ -88,7 +106,20 @@ static sk_sp<SkImage> ImageFromDecompressedData(
   }
 
   if (!target_width && !target_height) {
-    // No resizing requested. Just rasterize the image.
+    // No resizing requested. Premultiply unpremultiplied pixels here, where it
+    // is vectorized, instead of while they are uploaded.
+    SkPixmap pixmap;
+    SkBitmap premultiplied;
+    if (descriptor->image_info().alphaType() == kUnpremul_SkAlphaType &&
+        image->peekPixels(&pixmap) &&
+        premultiplied.tryAllocPixels(pixmap.info()
+                                         .makeColorType(kN32_SkColorType)
+                                         .makeAlphaType(kPremul_SkAlphaType)) &&
+        ConvertPixmap(pixmap, premultiplied.pixmap())) {
+      premultiplied.setImmutable();
+      return SkImage::MakeFromBitmap(premultiplied);
+    }
+    // Just rasterize the image.
     return image->makeRasterImage();
   }
 
@@ -243,27 +274,43 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
   }
 
   concurrent_task_runner_->PostTask(
-      fml::MakeCopyable([descriptor,                              //
-                         io_manager = io_manager_,                //
-                         io_runner = runners_.GetIOTaskRunner(),  //
-                         result,                                  //
-                         target_width = target_width,             //
-                         target_height = target_height,           //
-                         flow = std::move(flow)                   //
+      fml::MakeCopyable([descriptor,                                  //
+                         io_manager = io_manager_,                    //
+                         io_runner = runners_.GetIOTaskRunner(),      //
+                         decoded_image_cache = decoded_image_cache_,  //
+                         result,                                      //
+                         target_width = target_width,                 //
+                         target_height = target_height,               //
+                         flow = std::move(flow)                       //
   ]() mutable {
-        // Step 1: Decompress the image.
+        // Step 1: Decompress the image, unless the same data has been
+        // decompressed at the same size before.
         // On Worker.
 
-        auto decompressed =
-            descriptor->is_compressed()
-                ? ImageFromCompressedData(std::move(descriptor),  //
-                                          target_width,           //
-                                          target_height,          //
-                                          flow)
-                : ImageFromDecompressedData(std::move(descriptor),  //
+        sk_sp<SkImage> decompressed;
+        DecodedImageCache::Key cache_key;
+        sk_sp<SkData> data = descriptor->data();
+        if (decoded_image_cache) {
+          cache_key = DecodedImageCache::MakeKey(*descriptor, target_width,
+                                                 target_height);
+          decompressed = decoded_image_cache->Get(cache_key, data);
+        }
+
+        if (!decompressed) {
+          decompressed =
+              descriptor->is_compressed()
+                  ? ImageFromCompressedData(std::move(descriptor),  //
                                             target_width,           //
                                             target_height,          //
-                                            flow);
+                                            flow)
+                  : ImageFromDecompressedData(std::move(descriptor),  //
+                                              target_width,           //
+                                              target_height,          //
+                                              flow);
+          if (decompressed && decoded_image_cache) {
+            decoded_image_cache->Put(cache_key, std::move(data), decompressed);
+          }
+        }
 
         if (!decompressed) {
           FML_LOG(ERROR) << "Could not decompress image.";
@@ -310,4 +357,26 @@ fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
 }
 
+void ImageDecoder::SetFrameDecodeAhead(size_t frame_count, size_t max_bytes) {
+  frame_decode_ahead_count_ = frame_count;
+  frame_decode_ahead_max_bytes_ = max_bytes;
+}
+
+size_t ImageDecoder::GetFrameDecodeAheadCount() const {
+  return frame_decode_ahead_count_;
+}
+
+size_t ImageDecoder::GetFrameDecodeAheadMaxBytes() const {
+  return frame_decode_ahead_max_bytes_;
+}
+
+void ImageDecoder::SetDecodedImageCache(
+    std::shared_ptr<DecodedImageCache> cache) {
+  decoded_image_cache_ = std::move(cache);
+}
+
+std::shared_ptr<DecodedImageCache> ImageDecoder::GetDecodedImageCache() const {
+  return decoded_image_cache_;
+}
+
 }  // namespace flutter
@@ -15,6 +15,7 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_descriptor.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -52,10 +53,29 @@ class ImageDecoder {
 
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
+  // Configures the codecs of animated images created afterwards to decode up
+  // to |frame_count| frames ahead of the frame requested last, taking up at
+  // most |max_bytes|. See |MultiFrameCodec|.
+  void SetFrameDecodeAhead(size_t frame_count, size_t max_bytes);
+
+  size_t GetFrameDecodeAheadCount() const;
+
+  size_t GetFrameDecodeAheadMaxBytes() const;
+
+  // Reuses the images decoded from the same data at the same target size
+  // before, instead of decoding them again. The cache may be shared with other
+  // decoders. Images are always decoded if there is no cache.
+  void SetDecodedImageCache(std::shared_ptr<DecodedImageCache> cache);
+
+  std::shared_ptr<DecodedImageCache> GetDecodedImageCache() const;
+
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  size_t frame_decode_ahead_count_ = 0;
+  size_t frame_decode_ahead_max_bytes_ = 0;
+  std::shared_ptr<DecodedImageCache> decoded_image_cache_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
@@ -2,8 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
@@ -16,6 +19,7 @@
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
 #include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/tonic/converter/dart_converter.h"
 
 namespace flutter {
 namespace testing {
@@ -683,5 +687,99 @@ TEST_F(ImageDecoderFixtureTest,
   latch.Wait();
 }
 
+TEST_F(ImageDecoderFixtureTest, MultiFrameCodecDecodesFramesAhead) {
+  auto settings = CreateSettingsForFixture();
+  auto vm_ref = DartVMRef::Create(settings);
+
+  auto gif_mapping = OpenFixtureAsSkData("hello_loop_2.gif");
+  ASSERT_TRUE(gif_mapping);
+
+  auto gif_codec = std::shared_ptr<SkCodecImageGenerator>(
+      static_cast<SkCodecImageGenerator*>(
+          SkCodecImageGenerator::MakeFromEncodedCodec(gif_mapping).release()));
+  ASSERT_TRUE(gif_codec);
+  const int frame_count = gif_codec->getFrameCount();
+  ASSERT_GT(frame_count, 1);
+  const int width = gif_codec->getInfo().width();
+
+  // Request every frame twice, so that frames decoded ahead of time wrap
+  // around to the start of the animation.
+  const size_t requested_frames = frame_count * 2;
+  std::vector<int> durations;
+  for (size_t i = 0; i < requested_frames; i++) {
+    SkCodec::FrameInfo frame_info{0};
+    ASSERT_TRUE(gif_codec->getFrameInfo(i % frame_count, &frame_info));
+    durations.push_back(frame_info.fDuration);
+  }
+
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<TestIOManager> io_manager;
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+    latch.Signal();
+  });
+  latch.Wait();
+
+  std::vector<int> notified_durations;
+  fml::CountDownLatch frames_latch(requested_frames);
+  auto nativeNotifyFrame = [&](Dart_NativeArguments args) {
+    Dart_Handle exception = nullptr;
+    EXPECT_EQ(tonic::DartConverter<int>::FromArguments(args, 0, exception),
+              width);
+    notified_durations.push_back(
+        tonic::DartConverter<int>::FromArguments(args, 1, exception));
+    frames_latch.CountDown();
+  };
+  AddNativeCallback("NotifyFrame", CREATE_NATIVE_ENTRY(nativeNotifyFrame));
+
+  auto isolate =
+      RunDartCodeInIsolate(vm_ref, settings, runners, "main", {},
+                           GetFixturesPath(), io_manager->GetWeakIOManager());
+
+  fml::RefPtr<MultiFrameCodec> codec;
+  runners.GetUITaskRunner()->PostTask([&]() {
+    EXPECT_TRUE(isolate->RunInIsolateScope([&]() -> bool {
+      Dart_Handle closure = Dart_GetField(
+          Dart_RootLibrary(),
+          Dart_NewStringFromCString("notifyingFrameCallback"));
+      if (Dart_IsError(closure) || !Dart_IsClosure(closure)) {
+        return false;
+      }
+      // The cap only leaves room for a single frame decoded ahead of time.
+      codec = fml::MakeRefCounted<MultiFrameCodec>(
+          gif_codec, frame_count, gif_codec->getInfo().computeMinByteSize());
+      for (size_t i = 0; i < requested_frames; i++) {
+        codec->getNextFrame(closure);
+      }
+      return true;
+    }));
+    latch.Signal();
+  });
+  latch.Wait();
+  frames_latch.Wait();
+
+  EXPECT_EQ(notified_durations, durations);
+
+  runners.GetUITaskRunner()->PostTask([&]() {
+    codec = nullptr;
+    latch.Signal();
+  });
+  latch.Wait();
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -163,7 +163,16 @@ void ImageDescriptor::instantiateCodec(Dart_Handle codec_handle,
         static_cast<fml::RefPtr<ImageDescriptor>>(this), target_width,
         target_height);
   } else {
-    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(generator_);
+    size_t decode_ahead_frame_count = 0;
+    size_t decode_ahead_max_bytes = 0;
+    fml::WeakPtr<ImageDecoder> decoder =
+        UIDartState::Current()->GetImageDecoder();
+    if (decoder) {
+      decode_ahead_frame_count = decoder->GetFrameDecodeAheadCount();
+      decode_ahead_max_bytes = decoder->GetFrameDecodeAheadMaxBytes();
+    }
+    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(
+        generator_, decode_ahead_frame_count, decode_ahead_max_bytes);
   }
   ui_codec->AssociateWithDartWrapper(codec_handle);
 }
@@ -36,7 +36,7 @@ class ImageDisposeTest : public ShellTest {
     latch->Signal();
   }
 
-  sk_sp<SkPicture> current_picture_;
+  sk_sp<DisplayList> current_picture_;
   sk_sp<SkImage> current_image_;
 };
 
@@ -45,9 +45,9 @@ TEST_F(ImageDisposeTest, ImageReleasedAfterFrame) {
     CanvasImage* image = GetNativePeer<CanvasImage>(args, 0);
     Picture* picture = GetNativePeer<Picture>(args, 1);
     ASSERT_FALSE(image->image()->unique());
-    ASSERT_FALSE(picture->picture()->unique());
+    ASSERT_FALSE(picture->display_list()->unique());
     current_image_ = image->image();
-    current_picture_ = picture->picture();
+    current_picture_ = picture->display_list();
 
     Dart_NewFinalizableHandle(Dart_GetNativeArgument(args, 1),
                               &picture_finalizer_latch_, 0, &picture_finalizer);
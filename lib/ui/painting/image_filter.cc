@@ -49,7 +49,7 @@ void ImageFilter::initImage(CanvasImage* image) {
 }
 
 void ImageFilter::initPicture(Picture* picture) {
-  filter_ = SkPictureImageFilter::Make(picture->picture());
+  filter_ = SkPictureImageFilter::Make(picture->display_list()->ToSkPicture());
 }
 
 void ImageFilter::initBlur(double sigma_x, double sigma_y) {
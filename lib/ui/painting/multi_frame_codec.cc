@@ -4,23 +4,39 @@
 
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
+#include <utility>
+
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/pixel_conversion.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 
 namespace flutter {
 
+// The most frame buffers a codec keeps for reuse. Decoding a frame needs at
+// most one buffer besides the last required frame.
+static constexpr size_t kMaxFrameBuffers = 2;
+
 MultiFrameCodec::MultiFrameCodec(
-    std::shared_ptr<SkCodecImageGenerator> generator)
-    : state_(new State(std::move(generator))) {}
+    std::shared_ptr<SkCodecImageGenerator> generator,
+    size_t decode_ahead_frame_count,
+    size_t decode_ahead_max_bytes)
+    : state_(new State(std::move(generator),
+                       decode_ahead_frame_count,
+                       decode_ahead_max_bytes)) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::shared_ptr<SkCodecImageGenerator> generator)
+MultiFrameCodec::State::State(std::shared_ptr<SkCodecImageGenerator> generator,
+                              size_t decodeAheadFrameCount,
+                              size_t decodeAheadMaxBytes)
     : generator_(std::move(generator)),
       frameCount_(generator_->getFrameCount()),
       repetitionCount_(generator_->getRepetitionCount()),
+      decodeAheadFrameCount_(decodeAheadFrameCount),
+      decodeAheadMaxBytes_(decodeAheadMaxBytes),
       nextFrameIndex_(0) {}
 
 static void InvokeNextFrameCallback(
@@ -43,6 +59,8 @@ static void InvokeNextFrameCallback(
 
 // Copied the source bitmap to the destination. If this cannot occur due to
 // running out of memory or the image info not being compatible, returns false.
+// The pixels of the destination are reused if it already has the info of the
+// copy. Pixels are copied with the vectorized conversions when they can be.
 static bool CopyToBitmap(SkBitmap* dst,
                          SkColorType dstColorType,
                          const SkBitmap& src) {
@@ -51,8 +69,13 @@ static bool CopyToBitmap(SkBitmap* dst,
     return false;
   }
 
-  SkBitmap tmpDst;
   SkImageInfo dstInfo = srcPM.info().makeColorType(dstColorType);
+  SkPixmap dstPM;
+  if (dst->info() == dstInfo && dst->peekPixels(&dstPM)) {
+    return ConvertPixmap(srcPM, dstPM) || srcPM.readPixels(dstPM);
+  }
+
+  SkBitmap tmpDst;
   if (!tmpDst.setInfo(dstInfo)) {
     return false;
   }
@@ -61,12 +84,11 @@ static bool CopyToBitmap(SkBitmap* dst,
     return false;
   }
 
-  SkPixmap dstPM;
   if (!tmpDst.peekPixels(&dstPM)) {
     return false;
   }
 
-  if (!srcPM.readPixels(dstPM)) {
+  if (!ConvertPixmap(srcPM, dstPM) && !srcPM.readPixels(dstPM)) {
     return false;
   }
 
@@ -74,15 +96,30 @@ static bool CopyToBitmap(SkBitmap* dst,
   return true;
 }
 
+SkBitmap MultiFrameCodec::State::AcquireFrameBuffer(const SkImageInfo& info) {
+  for (const SkBitmap& buffer : frameBuffers_) {
+    // A buffer referenced only by the pool is neither the last required frame
+    // nor shared with an image.
+    if (buffer.pixelRef()->unique() && buffer.info() == info) {
+      return buffer;
+    }
+  }
+  SkBitmap bitmap;
+  bitmap.allocPixels(info);
+  if (frameBuffers_.size() < kMaxFrameBuffers) {
+    frameBuffers_.push_back(bitmap);
+  }
+  return bitmap;
+}
+
 sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
     fml::WeakPtr<GrDirectContext> resourceContext) {
-  SkBitmap bitmap = SkBitmap();
   SkImageInfo info = generator_->getInfo().makeColorType(kN32_SkColorType);
   if (info.alphaType() == kUnpremul_SkAlphaType) {
     SkImageInfo updated = info.makeAlphaType(kPremul_SkAlphaType);
     info = updated;
   }
-  bitmap.allocPixels(info);
+  SkBitmap bitmap = AcquireFrameBuffer(info);
 
   SkCodec::Options options;
   options.fFrameIndex = nextFrameIndex_;
@@ -128,33 +165,93 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
   } else {
     // Defer decoding until time of draw later on the raster thread. Can happen
     // when GL operations are currently forbidden such as in the background
-    // on iOS.
+    // on iOS. The bitmap is mutable, so the image copies its pixels and the
+    // buffer can be reused for the next frame.
     return SkImage::MakeFromBitmap(bitmap);
   }
 }
 
+MultiFrameCodec::State::DecodedFrame MultiFrameCodec::State::DecodeNextFrame(
+    fml::WeakPtr<GrDirectContext> resourceContext,
+    fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue) {
+  DecodedFrame frame;
+  sk_sp<SkImage> skImage = GetNextFrameImage(std::move(resourceContext));
+  if (skImage) {
+    frame.bytes = skImage->imageInfo().computeMinByteSize();
+    frame.image = {std::move(skImage), std::move(unref_queue)};
+    SkCodec::FrameInfo skFrameInfo{0};
+    generator_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
+    frame.duration = skFrameInfo.fDuration;
+  }
+  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  return frame;
+}
+
+void MultiFrameCodec::State::ScheduleDecodeAhead(
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
+    fml::WeakPtr<IOManager> io_manager) {
+  if (decodeAheadPending_ || decodedFrames_.size() >= decodeAheadFrameCount_) {
+    return;
+  }
+  // Only decode the next frame if it fits under the cap.
+  const size_t frameBytes = generator_->getInfo().computeMinByteSize();
+  if (decodedFramesBytes_ + frameBytes > decodeAheadMaxBytes_) {
+    return;
+  }
+
+  // Frames are decoded one per task, so that the requests for frames from Dart
+  // are not held up behind a long run of decodes.
+  decodeAheadPending_ = true;
+  io_task_runner->PostTask([weak_state = weak_from_this(), io_task_runner,
+                            io_manager = std::move(io_manager)]() mutable {
+    auto state = weak_state.lock();
+    if (!state) {
+      return;
+    }
+    state->decodeAheadPending_ = false;
+    if (!io_manager) {
+      return;
+    }
+    TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeAhead");
+    DecodedFrame frame = state->DecodeNextFrame(
+        io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue());
+    state->decodedFramesBytes_ += frame.bytes;
+    state->decodedFrames_.push_back(std::move(frame));
+    state->ScheduleDecodeAhead(std::move(io_task_runner),
+                               std::move(io_manager));
+  });
+}
+
 void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
-    fml::WeakPtr<GrDirectContext> resourceContext,
-    fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
+    fml::WeakPtr<IOManager> io_manager,
     size_t trace_id) {
+  DecodedFrame frame;
+  if (decodedFrames_.empty()) {
+    frame = DecodeNextFrame(io_manager->GetResourceContext(),
+                            io_manager->GetSkiaUnrefQueue());
+  } else {
+    frame = std::move(decodedFrames_.front());
+    decodedFrames_.pop_front();
+    decodedFramesBytes_ -= frame.bytes;
+  }
+
   fml::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
-  if (skImage) {
+  if (frame.image.get()) {
     fml::RefPtr<CanvasImage> image = CanvasImage::Create();
-    image->set_image({skImage, std::move(unref_queue)});
-    SkCodec::FrameInfo skFrameInfo{0};
-    generator_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
+    image->set_image(std::move(frame.image));
     frameInfo =
-        fml::MakeRefCounted<FrameInfo>(std::move(image), skFrameInfo.fDuration);
+        fml::MakeRefCounted<FrameInfo>(std::move(image), frame.duration);
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable(
       [callback = std::move(callback), frameInfo, trace_id]() mutable {
         InvokeNextFrameCallback(frameInfo, std::move(callback), trace_id);
       }));
+
+  ScheduleDecodeAhead(std::move(io_task_runner), std::move(io_manager));
 }
 
 Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
@@ -174,6 +271,7 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
            tonic::DartState::Current(), callback_handle),
        weak_state = std::weak_ptr<MultiFrameCodec::State>(state_), trace_id,
        ui_task_runner = task_runners.GetUITaskRunner(),
+       io_task_runner = task_runners.GetIOTaskRunner(),
        io_manager = dart_state->GetIOManager()]() mutable {
         auto state = weak_state.lock();
         if (!state) {
@@ -183,8 +281,7 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
         }
         state->GetNextFrameAndInvokeCallback(
             std::move(callback), std::move(ui_task_runner),
-            io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue(),
-            trace_id);
+            std::move(io_task_runner), std::move(io_manager), trace_id);
       }));
 
   return Dart_Null();
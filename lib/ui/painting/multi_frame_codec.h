@@ -5,6 +5,11 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "flutter/flow/skia_gpu_object.h"
 #include "flutter/fml/macros.h"
 #include "flutter/lib/ui/painting/codec.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
@@ -13,7 +18,13 @@ namespace flutter {
 
 class MultiFrameCodec : public Codec {
  public:
-  MultiFrameCodec(std::shared_ptr<SkCodecImageGenerator> generator);
+  // Frames are decoded on the IO task runner when Dart asks for them. If
+  // |decode_ahead_frame_count| is not zero, up to that many of the following
+  // frames are decoded on the IO task runner as soon as a frame has been
+  // handed to Dart, as long as they take up at most |decode_ahead_max_bytes|.
+  MultiFrameCodec(std::shared_ptr<SkCodecImageGenerator> generator,
+                  size_t decode_ahead_frame_count = 0,
+                  size_t decode_ahead_max_bytes = 0);
 
   ~MultiFrameCodec() override;
 
@@ -36,12 +47,24 @@ class MultiFrameCodec : public Codec {
   // Instead, the MultiFrameCodec creates this object when it is constructed,
   // shares it with the IO task runner's decoding work, and sets the live_
   // member to false when it is destructed.
-  struct State {
-    State(std::shared_ptr<SkCodecImageGenerator> generator);
+  struct State : public std::enable_shared_from_this<State> {
+    State(std::shared_ptr<SkCodecImageGenerator> generator,
+          size_t decodeAheadFrameCount,
+          size_t decodeAheadMaxBytes);
+
+    // A frame decoded ahead of the request for it. The image is null if the
+    // frame could not be decoded.
+    struct DecodedFrame {
+      SkiaGPUObject<SkImage> image;
+      int duration = 0;
+      size_t bytes = 0;
+    };
 
     const std::shared_ptr<SkCodecImageGenerator> generator_;
     const int frameCount_;
     const int repetitionCount_;
+    const size_t decodeAheadFrameCount_;
+    const size_t decodeAheadMaxBytes_;
 
     // The non-const members and functions below here are only read or written
     // to on the IO thread. They are not safe to access or write on the UI
@@ -53,14 +76,37 @@ class MultiFrameCodec : public Codec {
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
 
+    // The bitmaps that frames are decoded into, recycled once the image of
+    // the frame has been made from them and they are not the last required
+    // frame.
+    std::vector<SkBitmap> frameBuffers_;
+
+    // The frames following the last frame handed to Dart, in order.
+    std::deque<DecodedFrame> decodedFrames_;
+    size_t decodedFramesBytes_ = 0;
+    bool decodeAheadPending_ = false;
+
     sk_sp<SkImage> GetNextFrameImage(
         fml::WeakPtr<GrDirectContext> resourceContext);
 
+    // Decodes the frame at |nextFrameIndex_| and advances to the next one.
+    DecodedFrame DecodeNextFrame(
+        fml::WeakPtr<GrDirectContext> resourceContext,
+        fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue);
+
+    // Returns a bitmap of |info| whose pixels are not referenced elsewhere.
+    SkBitmap AcquireFrameBuffer(const SkImageInfo& info);
+
+    // Posts a task decoding the next frame ahead of time to the IO task runner
+    // unless enough frames have been decoded already.
+    void ScheduleDecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner,
+                             fml::WeakPtr<IOManager> io_manager);
+
     void GetNextFrameAndInvokeCallback(
         std::unique_ptr<DartPersistentValue> callback,
         fml::RefPtr<fml::TaskRunner> ui_task_runner,
-        fml::WeakPtr<GrDirectContext> resourceContext,
-        fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
+        fml::RefPtr<fml::TaskRunner> io_task_runner,
+        fml::WeakPtr<IOManager> io_manager,
         size_t trace_id);
   };
 
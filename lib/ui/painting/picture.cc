@@ -30,36 +30,37 @@ DART_BIND_ALL(Picture, FOR_EACH_BINDING)
 
 fml::RefPtr<Picture> Picture::Create(
     Dart_Handle dart_handle,
-    flutter::SkiaGPUObject<SkPicture> picture) {
-  auto canvas_picture = fml::MakeRefCounted<Picture>(std::move(picture));
+    flutter::SkiaGPUObject<DisplayList> display_list) {
+  auto canvas_picture = fml::MakeRefCounted<Picture>(std::move(display_list));
 
   canvas_picture->AssociateWithDartWrapper(dart_handle);
   return canvas_picture;
 }
 
-Picture::Picture(flutter::SkiaGPUObject<SkPicture> picture)
-    : picture_(std::move(picture)) {}
+Picture::Picture(flutter::SkiaGPUObject<DisplayList> display_list)
+    : display_list_(std::move(display_list)) {}
 
 Picture::~Picture() = default;
 
 Dart_Handle Picture::toImage(uint32_t width,
                              uint32_t height,
                              Dart_Handle raw_image_callback) {
-  if (!picture_.get()) {
+  if (!display_list_.get()) {
     return tonic::ToDart("Picture is null");
   }
 
-  return RasterizeToImage(picture_.get(), width, height, raw_image_callback);
+  return RasterizeToImage(display_list_.get(), width, height,
+                          raw_image_callback);
 }
 
 void Picture::dispose() {
-  picture_.reset();
+  display_list_.reset();
   ClearDartWrapper();
 }
 
 size_t Picture::GetAllocationSize() const {
-  if (auto picture = picture_.get()) {
-    return picture->approximateBytesUsed() + sizeof(Picture);
+  if (auto display_list = display_list_.get()) {
+    return display_list->bytes() + sizeof(Picture);
   } else {
     return sizeof(Picture);
   }
@@ -69,6 +70,29 @@ Dart_Handle Picture::RasterizeToImage(sk_sp<SkPicture> picture,
                                       uint32_t width,
                                       uint32_t height,
                                       Dart_Handle raw_image_callback) {
+  return DoRasterizeToImage(
+      [picture = std::move(picture)](SkCanvas* canvas) {
+        canvas->drawPicture(picture);
+      },
+      width, height, raw_image_callback);
+}
+
+Dart_Handle Picture::RasterizeToImage(sk_sp<DisplayList> display_list,
+                                      uint32_t width,
+                                      uint32_t height,
+                                      Dart_Handle raw_image_callback) {
+  return DoRasterizeToImage(
+      [display_list = std::move(display_list)](SkCanvas* canvas) {
+        display_list->RenderTo(canvas);
+      },
+      width, height, raw_image_callback);
+}
+
+Dart_Handle Picture::DoRasterizeToImage(
+    std::function<void(SkCanvas*)> draw_callback,
+    uint32_t width,
+    uint32_t height,
+    Dart_Handle raw_image_callback) {
   if (Dart_IsNull(raw_image_callback) || !Dart_IsClosure(raw_image_callback)) {
     return tonic::ToDart("Image callback was invalid");
   }
@@ -122,9 +146,10 @@ Dart_Handle Picture::RasterizeToImage(sk_sp<SkPicture> picture,
   // Kick things off on the raster rask runner.
   fml::TaskRunner::RunNowOrPostTask(
       raster_task_runner,
-      [ui_task_runner, snapshot_delegate, picture, picture_bounds, ui_task] {
-        sk_sp<SkImage> raster_image =
-            snapshot_delegate->MakeRasterSnapshot(picture, picture_bounds);
+      [ui_task_runner, snapshot_delegate, draw_callback, picture_bounds,
+       ui_task] {
+        sk_sp<SkImage> raster_image = snapshot_delegate->MakeRasterSnapshot(
+            draw_callback, picture_bounds);
 
         fml::TaskRunner::RunNowOrPostTask(
             ui_task_runner,
@@ -5,6 +5,9 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PICTURE_H_
 #define FLUTTER_LIB_UI_PAINTING_PICTURE_H_
 
+#include <functional>
+
+#include "flutter/flow/display_list.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/lib/ui/dart_wrapper.h"
 #include "flutter/lib/ui/painting/image.h"
@@ -24,10 +27,11 @@ class Picture : public RefCountedDartWrappable<Picture> {
 
  public:
   ~Picture() override;
-  static fml::RefPtr<Picture> Create(Dart_Handle dart_handle,
-                                     flutter::SkiaGPUObject<SkPicture> picture);
+  static fml::RefPtr<Picture> Create(
+      Dart_Handle dart_handle,
+      flutter::SkiaGPUObject<DisplayList> display_list);
 
-  sk_sp<SkPicture> picture() const { return picture_.get(); }
+  sk_sp<DisplayList> display_list() const { return display_list_.get(); }
 
   Dart_Handle toImage(uint32_t width,
                       uint32_t height,
@@ -44,10 +48,21 @@ class Picture : public RefCountedDartWrappable<Picture> {
                                       uint32_t height,
                                       Dart_Handle raw_image_callback);
 
+  static Dart_Handle RasterizeToImage(sk_sp<DisplayList> display_list,
+                                      uint32_t width,
+                                      uint32_t height,
+                                      Dart_Handle raw_image_callback);
+
  private:
-  Picture(flutter::SkiaGPUObject<SkPicture> picture);
+  Picture(flutter::SkiaGPUObject<DisplayList> display_list);
+
+  static Dart_Handle DoRasterizeToImage(
+      std::function<void(SkCanvas*)> draw_callback,
+      uint32_t width,
+      uint32_t height,
+      Dart_Handle raw_image_callback);
 
-  flutter::SkiaGPUObject<SkPicture> picture_;
+  flutter::SkiaGPUObject<DisplayList> display_list_;
 };
 
 }  // namespace flutter
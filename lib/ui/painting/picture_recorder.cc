@@ -38,8 +38,9 @@ PictureRecorder::PictureRecorder() {}
 
 PictureRecorder::~PictureRecorder() {}
 
-SkCanvas* PictureRecorder::BeginRecording(SkRect bounds) {
-  return picture_recorder_.beginRecording(bounds, &rtree_factory_);
+DisplayListCanvasRecorder* PictureRecorder::BeginRecording(SkRect bounds) {
+  recorder_ = std::make_unique<DisplayListCanvasRecorder>(bounds);
+  return recorder_.get();
 }
 
 fml::RefPtr<Picture> PictureRecorder::endRecording(Dart_Handle dart_picture) {
@@ -48,10 +49,10 @@ fml::RefPtr<Picture> PictureRecorder::endRecording(Dart_Handle dart_picture) {
   }
 
   fml::RefPtr<Picture> picture = Picture::Create(
-      dart_picture, UIDartState::CreateGPUObject(
-                        picture_recorder_.finishRecordingAsPicture()));
+      dart_picture, UIDartState::CreateGPUObject(recorder_->Build()));
 
   canvas_->Invalidate();
+  recorder_.reset();
   canvas_ = nullptr;
   ClearDartWrapper();
   return picture;
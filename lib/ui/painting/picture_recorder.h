@@ -5,8 +5,10 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PICTURE_RECORDER_H_
 #define FLUTTER_LIB_UI_PAINTING_PICTURE_RECORDER_H_
 
+#include <memory>
+
+#include "flutter/flow/display_list_canvas.h"
 #include "flutter/lib/ui/dart_wrapper.h"
-#include "third_party/skia/include/core/SkPictureRecorder.h"
 
 namespace tonic {
 class DartLibraryNatives;
@@ -25,7 +27,7 @@ class PictureRecorder : public RefCountedDartWrappable<PictureRecorder> {
 
   ~PictureRecorder() override;
 
-  SkCanvas* BeginRecording(SkRect bounds);
+  DisplayListCanvasRecorder* BeginRecording(SkRect bounds);
   fml::RefPtr<Picture> endRecording(Dart_Handle dart_picture);
 
   void set_canvas(fml::RefPtr<Canvas> canvas) { canvas_ = std::move(canvas); }
@@ -35,8 +37,7 @@ class PictureRecorder : public RefCountedDartWrappable<PictureRecorder> {
  private:
   PictureRecorder();
 
-  SkRTreeFactory rtree_factory_;
-  SkPictureRecorder picture_recorder_;
+  std::unique_ptr<DisplayListCanvasRecorder> recorder_;
   fml::RefPtr<Canvas> canvas_;
 };
 
@@ -0,0 +1,391 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/pixel_conversion.h"
+
+#include <cstring>
+#include <utility>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_CONVERSION_NEON 1
+#include <arm_neon.h>
+#elif defined(ARCH_CPU_X86_64) && defined(__GNUC__) && !defined(OS_WIN)
+// The AVX2 kernels are compiled for AVX2 regardless of the target of the rest
+// of the engine, and only called once the processor is known to support it.
+#define PIXEL_CONVERSION_AVX2 1
+#include <immintrin.h>
+#define PIXEL_CONVERSION_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace flutter {
+
+namespace {
+
+// Computes round(color * alpha / 255) without dividing.
+inline uint8_t MultiplyAlpha(uint32_t color, uint32_t alpha) {
+  const uint32_t product = color * alpha + 128;
+  return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+inline uint8_t Average(uint8_t a, uint8_t b) {
+  return static_cast<uint8_t>((a + b + 1) >> 1);
+}
+
+void ConvertRowPortable(const uint8_t* src,
+                        uint8_t* dst,
+                        int width,
+                        PixelConversion conversion) {
+  for (int x = 0; x < width; x++, src += 4, dst += 4) {
+    uint8_t r = src[0];
+    uint8_t g = src[1];
+    uint8_t b = src[2];
+    const uint8_t a = src[3];
+    if (conversion.premultiply) {
+      r = MultiplyAlpha(r, a);
+      g = MultiplyAlpha(g, a);
+      b = MultiplyAlpha(b, a);
+    }
+    if (conversion.swap_red_blue) {
+      std::swap(r, b);
+    }
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+    dst[3] = a;
+  }
+}
+
+// Averages the columns of two rows first and then the pairs of averaged
+// pixels, which is the order the vectorized kernels average them in.
+void HalveRowPortable(const uint8_t* row0,
+                      const uint8_t* row1,
+                      uint8_t* dst,
+                      int dst_width) {
+  for (int x = 0; x < dst_width; x++, row0 += 8, row1 += 8, dst += 4) {
+    for (int c = 0; c < 4; c++) {
+      dst[c] = Average(Average(row0[c], row1[c]),
+                       Average(row0[c + 4], row1[c + 4]));
+    }
+  }
+}
+
+#if defined(PIXEL_CONVERSION_AVX2)
+
+// Premultiplies the pixels of |pixels|, whose channels have been widened to 16
+// bits.
+PIXEL_CONVERSION_TARGET_AVX2 inline __m256i MultiplyAlphaAVX2(__m256i pixels) {
+  // Broadcasts the alpha of each pixel to its channels, but keeps multiplying
+  // alpha itself by 255, which leaves it unchanged.
+  __m256i alpha = _mm256_shufflehi_epi16(
+      _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm256_blend_epi16(alpha, _mm256_set1_epi16(255), 0x88);
+  const __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha),
+                                           _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(
+      _mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+}
+
+PIXEL_CONVERSION_TARGET_AVX2 void ConvertRowAVX2(const uint8_t* src,
+                                                 uint8_t* dst,
+                                                 int width,
+                                                 PixelConversion conversion) {
+  const __m256i swap_red_blue =
+      _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,  //
+                       2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  const __m256i zero = _mm256_setzero_si256();
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+    if (conversion.premultiply) {
+      pixels = _mm256_packus_epi16(
+          MultiplyAlphaAVX2(_mm256_unpacklo_epi8(pixels, zero)),
+          MultiplyAlphaAVX2(_mm256_unpackhi_epi8(pixels, zero)));
+    }
+    if (conversion.swap_red_blue) {
+      pixels = _mm256_shuffle_epi8(pixels, swap_red_blue);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), pixels);
+  }
+  ConvertRowPortable(src + x * 4, dst + x * 4, width - x, conversion);
+}
+
+PIXEL_CONVERSION_TARGET_AVX2 void HalveRowAVX2(const uint8_t* row0,
+                                               const uint8_t* row1,
+                                               uint8_t* dst,
+                                               int dst_width) {
+  int x = 0;
+  for (; x + 8 <= dst_width; x += 8) {
+    const uint8_t* src0 = row0 + x * 8;
+    const uint8_t* src1 = row1 + x * 8;
+    // The averaged columns of the first and last 8 source pixels.
+    const __m256 first = _mm256_castsi256_ps(_mm256_avg_epu8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src0)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1))));
+    const __m256 last = _mm256_castsi256_ps(_mm256_avg_epu8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src0 + 32)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + 32))));
+    // Shuffling works within 128-bit lanes, which leaves the pairs of pixels
+    // ordered 0 1 4 5 2 3 6 7 until they are permuted.
+    const __m256i even = _mm256_castps_si256(
+        _mm256_shuffle_ps(first, last, _MM_SHUFFLE(2, 0, 2, 0)));
+    const __m256i odd = _mm256_castps_si256(
+        _mm256_shuffle_ps(first, last, _MM_SHUFFLE(3, 1, 3, 1)));
+    const __m256i halved = _mm256_permute4x64_epi64(
+        _mm256_avg_epu8(even, odd), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), halved);
+  }
+  HalveRowPortable(row0 + x * 8, row1 + x * 8, dst + x * 4, dst_width - x);
+}
+
+#endif  // PIXEL_CONVERSION_AVX2
+
+#if defined(PIXEL_CONVERSION_NEON)
+
+inline uint8x8_t MultiplyAlphaNEON(uint8x8_t color, uint8x8_t alpha) {
+  // Rounding shifts compute the same (p + 128 + ((p + 128) >> 8)) >> 8 as the
+  // portable kernel.
+  const uint16x8_t product = vmull_u8(color, alpha);
+  return vrshrn_n_u16(vrsraq_n_u16(product, product, 8), 8);
+}
+
+inline uint8x16_t MultiplyAlphaNEON(uint8x16_t color, uint8x16_t alpha) {
+  return vcombine_u8(
+      MultiplyAlphaNEON(vget_low_u8(color), vget_low_u8(alpha)),
+      MultiplyAlphaNEON(vget_high_u8(color), vget_high_u8(alpha)));
+}
+
+void ConvertRowNEON(const uint8_t* src,
+                    uint8_t* dst,
+                    int width,
+                    PixelConversion conversion) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    // Loads the channels of 16 pixels into separate registers.
+    uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+    if (conversion.premultiply) {
+      pixels.val[0] = MultiplyAlphaNEON(pixels.val[0], pixels.val[3]);
+      pixels.val[1] = MultiplyAlphaNEON(pixels.val[1], pixels.val[3]);
+      pixels.val[2] = MultiplyAlphaNEON(pixels.val[2], pixels.val[3]);
+    }
+    if (conversion.swap_red_blue) {
+      std::swap(pixels.val[0], pixels.val[2]);
+    }
+    vst4q_u8(dst + x * 4, pixels);
+  }
+  ConvertRowPortable(src + x * 4, dst + x * 4, width - x, conversion);
+}
+
+void HalveRowNEON(const uint8_t* row0,
+                  const uint8_t* row1,
+                  uint8_t* dst,
+                  int dst_width) {
+  int x = 0;
+  for (; x + 4 <= dst_width; x += 4) {
+    // Loads the even and odd pixels of 8 source pixels into separate
+    // registers.
+    const uint32x4x2_t src0 =
+        vld2q_u32(reinterpret_cast<const uint32_t*>(row0 + x * 8));
+    const uint32x4x2_t src1 =
+        vld2q_u32(reinterpret_cast<const uint32_t*>(row1 + x * 8));
+    const uint8x16_t even = vrhaddq_u8(vreinterpretq_u8_u32(src0.val[0]),
+                                       vreinterpretq_u8_u32(src1.val[0]));
+    const uint8x16_t odd = vrhaddq_u8(vreinterpretq_u8_u32(src0.val[1]),
+                                      vreinterpretq_u8_u32(src1.val[1]));
+    vst1q_u8(dst + x * 4, vrhaddq_u8(even, odd));
+  }
+  HalveRowPortable(row0 + x * 8, row1 + x * 8, dst + x * 4, dst_width - x);
+}
+
+#endif  // PIXEL_CONVERSION_NEON
+
+using ConvertRowProc = void (*)(const uint8_t*, uint8_t*, int, PixelConversion);
+using HalveRowProc = void (*)(const uint8_t*, const uint8_t*, uint8_t*, int);
+
+// Kernels of instruction sets this build does not have fall back to the
+// portable ones.
+ConvertRowProc GetConvertRowProc(PixelISA isa) {
+  switch (isa) {
+#if defined(PIXEL_CONVERSION_AVX2)
+    case PixelISA::kAVX2:
+      return ConvertRowAVX2;
+#endif  // PIXEL_CONVERSION_AVX2
+#if defined(PIXEL_CONVERSION_NEON)
+    case PixelISA::kNEON:
+      return ConvertRowNEON;
+#endif  // PIXEL_CONVERSION_NEON
+    default:
+      return ConvertRowPortable;
+  }
+}
+
+HalveRowProc GetHalveRowProc(PixelISA isa) {
+  switch (isa) {
+#if defined(PIXEL_CONVERSION_AVX2)
+    case PixelISA::kAVX2:
+      return HalveRowAVX2;
+#endif  // PIXEL_CONVERSION_AVX2
+#if defined(PIXEL_CONVERSION_NEON)
+    case PixelISA::kNEON:
+      return HalveRowNEON;
+#endif  // PIXEL_CONVERSION_NEON
+    default:
+      return HalveRowPortable;
+  }
+}
+
+PixelISA DetectPixelISA() {
+#if defined(PIXEL_CONVERSION_NEON)
+  return PixelISA::kNEON;
+#elif defined(PIXEL_CONVERSION_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return PixelISA::kAVX2;
+  }
+  return PixelISA::kPortable;
+#else
+  return PixelISA::kPortable;
+#endif
+}
+
+bool Is8888(SkColorType color_type) {
+  return color_type == kRGBA_8888_SkColorType ||
+         color_type == kBGRA_8888_SkColorType;
+}
+
+bool IsConvertible(const SkPixmap& pixmap) {
+  return pixmap.addr() != nullptr && Is8888(pixmap.colorType()) &&
+         (pixmap.alphaType() == kOpaque_SkAlphaType ||
+          pixmap.alphaType() == kPremul_SkAlphaType ||
+          pixmap.alphaType() == kUnpremul_SkAlphaType);
+}
+
+}  // namespace
+
+PixelISA GetSupportedPixelISA() {
+  static const PixelISA isa = DetectPixelISA();
+  return isa;
+}
+
+void ConvertPixels(const uint8_t* src,
+                   size_t src_row_bytes,
+                   uint8_t* dst,
+                   size_t dst_row_bytes,
+                   int width,
+                   int height,
+                   PixelConversion conversion,
+                   PixelISA isa) {
+  if (!conversion.swap_red_blue && !conversion.premultiply) {
+    if (src != dst) {
+      for (int y = 0; y < height; y++) {
+        memcpy(dst + y * dst_row_bytes, src + y * src_row_bytes, width * 4);
+      }
+    }
+    return;
+  }
+  const ConvertRowProc convert_row = GetConvertRowProc(isa);
+  for (int y = 0; y < height; y++) {
+    convert_row(src + y * src_row_bytes, dst + y * dst_row_bytes, width,
+                conversion);
+  }
+}
+
+void HalvePixels(const uint8_t* src,
+                 size_t src_row_bytes,
+                 int src_width,
+                 int src_height,
+                 uint8_t* dst,
+                 size_t dst_row_bytes,
+                 PixelISA isa) {
+  const HalveRowProc halve_row = GetHalveRowProc(isa);
+  const int dst_width = src_width / 2;
+  const int dst_height = src_height / 2;
+  for (int y = 0; y < dst_height; y++) {
+    const uint8_t* row0 = src + 2 * y * src_row_bytes;
+    halve_row(row0, row0 + src_row_bytes, dst + y * dst_row_bytes, dst_width);
+  }
+}
+
+bool ConvertPixmap(const SkPixmap& src, const SkPixmap& dst) {
+  if (!IsConvertible(src) || !IsConvertible(dst) ||
+      src.dimensions() != dst.dimensions() ||
+      !SkColorSpace::Equals(src.colorSpace(), dst.colorSpace())) {
+    return false;
+  }
+
+  PixelConversion conversion;
+  conversion.swap_red_blue = src.colorType() != dst.colorType();
+  switch (dst.alphaType()) {
+    case kOpaque_SkAlphaType:
+      if (src.alphaType() != kOpaque_SkAlphaType) {
+        return false;
+      }
+      break;
+    case kPremul_SkAlphaType:
+      conversion.premultiply = src.alphaType() == kUnpremul_SkAlphaType;
+      break;
+    default:
+      // Unpremultiplying is left to Skia.
+      if (src.alphaType() == kPremul_SkAlphaType) {
+        return false;
+      }
+      break;
+  }
+
+  ConvertPixels(static_cast<const uint8_t*>(src.addr()), src.rowBytes(),
+                static_cast<uint8_t*>(dst.writable_addr()), dst.rowBytes(),
+                src.width(), src.height(), conversion);
+  return true;
+}
+
+bool DownscalePixmapByHalves(const SkPixmap& src,
+                             const SkISize& dimensions,
+                             SkBitmap* result) {
+  FML_DCHECK(result);
+  if (dimensions.isEmpty() || src.width() < dimensions.width() * 2 ||
+      src.height() < dimensions.height() * 2 || !IsConvertible(src)) {
+    return false;
+  }
+
+  // Averaging pixels is only correct once they are premultiplied.
+  SkPixmap current = src;
+  SkBitmap converted;
+  if (src.colorType() != kN32_SkColorType ||
+      src.alphaType() == kUnpremul_SkAlphaType) {
+    const SkAlphaType alpha_type = src.alphaType() == kOpaque_SkAlphaType
+                                       ? kOpaque_SkAlphaType
+                                       : kPremul_SkAlphaType;
+    if (!converted.tryAllocPixels(src.info()
+                                      .makeColorType(kN32_SkColorType)
+                                      .makeAlphaType(alpha_type)) ||
+        !ConvertPixmap(src, converted.pixmap())) {
+      return false;
+    }
+    current = converted.pixmap();
+  }
+
+  SkBitmap halved;
+  while (current.width() >= dimensions.width() * 2 &&
+         current.height() >= dimensions.height() * 2) {
+    SkBitmap next;
+    if (!next.tryAllocPixels(
+            current.info().makeWH(current.width() / 2, current.height() / 2))) {
+      return false;
+    }
+    HalvePixels(static_cast<const uint8_t*>(current.addr()), current.rowBytes(),
+                current.width(), current.height(),
+                static_cast<uint8_t*>(next.getPixels()), next.rowBytes());
+    halved = std::move(next);
+    current = halved.pixmap();
+  }
+  *result = std::move(halved);
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,76 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PIXEL_CONVERSION_H_
+#define FLUTTER_LIB_UI_PAINTING_PIXEL_CONVERSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flutter {
+
+// The instruction sets the pixel conversions can be run with. Every set
+// produces the same pixels.
+enum class PixelISA {
+  kPortable,
+  // x86-64 processors that support AVX2, detected at runtime.
+  kAVX2,
+  // ARM processors, which the engine requires to support NEON.
+  kNEON,
+};
+
+// The fastest instruction set supported by the processor the engine runs on.
+PixelISA GetSupportedPixelISA();
+
+struct PixelConversion {
+  // Swaps the red and blue channels, converting RGBA to BGRA and vice versa.
+  bool swap_red_blue = false;
+  // Multiplies the color channels by alpha.
+  bool premultiply = false;
+};
+
+// Converts |height| rows of |width| 8-bit RGBA or BGRA pixels. The
+// destination rows may be the source rows.
+void ConvertPixels(const uint8_t* src,
+                   size_t src_row_bytes,
+                   uint8_t* dst,
+                   size_t dst_row_bytes,
+                   int width,
+                   int height,
+                   PixelConversion conversion,
+                   PixelISA isa = GetSupportedPixelISA());
+
+// Halves the width and height of premultiplied 8-bit RGBA or BGRA pixels by
+// averaging blocks of 2x2 pixels. The odd last column and row of the source
+// are dropped.
+void HalvePixels(const uint8_t* src,
+                 size_t src_row_bytes,
+                 int src_width,
+                 int src_height,
+                 uint8_t* dst,
+                 size_t dst_row_bytes,
+                 PixelISA isa = GetSupportedPixelISA());
+
+// Copies the pixels of |src| into |dst| with |ConvertPixels| if both are 8-bit
+// RGBA or BGRA pixels of the same dimensions and color space, and the
+// conversion does not unpremultiply them. Returns false, without touching
+// |dst|, for other pixels, which should be converted by Skia instead.
+bool ConvertPixmap(const SkPixmap& src, const SkPixmap& dst);
+
+// Downscales |src| by halves while it is at least twice as large as
+// |dimensions|, into premultiplied pixels of the native color type. Skia then
+// only has to scale the result the rest of the way, and the box filter keeps
+// large downscales from aliasing. Returns false if |src| is less than twice as
+// large as |dimensions| or not in a format |ConvertPixmap| handles.
+bool DownscalePixmapByHalves(const SkPixmap& src,
+                             const SkISize& dimensions,
+                             SkBitmap* result);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PIXEL_CONVERSION_H_
@@ -0,0 +1,102 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/lib/ui/painting/pixel_conversion.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr int kSourceSize = 2048;
+constexpr int kResizedSize = 300;
+
+// Unpremultiplied RGBA pixels, like those of decodeImageFromPixels.
+SkBitmap MakeSourceBitmap() {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::Make(kSourceSize, kSourceSize,
+                                       kRGBA_8888_SkColorType,
+                                       kUnpremul_SkAlphaType));
+  uint8_t* pixels = static_cast<uint8_t*>(bitmap.getPixels());
+  for (size_t i = 0; i < bitmap.computeByteSize(); i++) {
+    pixels[i] = static_cast<uint8_t>(i * 7 + i / 4096);
+  }
+  return bitmap;
+}
+
+SkBitmap MakeN32PremulBitmap(int size) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::MakeN32Premul(size, size));
+  return bitmap;
+}
+
+}  // namespace
+
+// The conversion of unpremultiplied RGBA pixels to the native premultiplied
+// color type that the image decoder did before the vectorized kernels.
+static void BM_PremultiplyWithSkia(benchmark::State& state) {
+  SkBitmap src = MakeSourceBitmap();
+  SkBitmap dst = MakeN32PremulBitmap(kSourceSize);
+  while (state.KeepRunning()) {
+    src.pixmap().readPixels(dst.pixmap());
+  }
+}
+BENCHMARK(BM_PremultiplyWithSkia)->Unit(benchmark::kMicrosecond);
+
+// Converts the same pixels with the kernels of the instruction set of the
+// argument.
+static void BM_PremultiplyPixels(benchmark::State& state) {
+  SkBitmap src = MakeSourceBitmap();
+  SkBitmap dst = MakeN32PremulBitmap(kSourceSize);
+  PixelConversion conversion;
+  conversion.swap_red_blue = src.colorType() != dst.colorType();
+  conversion.premultiply = true;
+  const PixelISA isa = static_cast<PixelISA>(state.range(0));
+  while (state.KeepRunning()) {
+    ConvertPixels(static_cast<const uint8_t*>(src.getPixels()), src.rowBytes(),
+                  static_cast<uint8_t*>(dst.getPixels()), dst.rowBytes(),
+                  kSourceSize, kSourceSize, conversion, isa);
+  }
+}
+BENCHMARK(BM_PremultiplyPixels)
+    ->Arg(static_cast<int>(PixelISA::kPortable))
+    ->Arg(static_cast<int>(GetSupportedPixelISA()))
+    ->Unit(benchmark::kMicrosecond);
+
+// The resize of large images that the image decoder did before the
+// vectorized kernels.
+static void BM_DownscaleWithSkia(benchmark::State& state) {
+  SkBitmap src = MakeSourceBitmap();
+  src.setImmutable();
+  sk_sp<SkImage> image = SkImage::MakeFromBitmap(src);
+  SkBitmap dst = MakeN32PremulBitmap(kResizedSize);
+  while (state.KeepRunning()) {
+    image->scalePixels(dst.pixmap(), kLow_SkFilterQuality,
+                       SkImage::kDisallow_CachingHint);
+  }
+}
+BENCHMARK(BM_DownscaleWithSkia)->Unit(benchmark::kMicrosecond);
+
+// Halves the same image with the vectorized box filter before Skia scales it
+// the rest of the way.
+static void BM_DownscaleByHalves(benchmark::State& state) {
+  SkBitmap src = MakeSourceBitmap();
+  SkBitmap dst = MakeN32PremulBitmap(kResizedSize);
+  while (state.KeepRunning()) {
+    SkBitmap halved;
+    DownscalePixmapByHalves(src.pixmap(),
+                            SkISize::Make(kResizedSize, kResizedSize), &halved);
+    halved.setImmutable();
+    SkImage::MakeFromBitmap(halved)->scalePixels(
+        dst.pixmap(), kLow_SkFilterQuality, SkImage::kDisallow_CachingHint);
+  }
+}
+BENCHMARK(BM_DownscaleByHalves)->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -0,0 +1,148 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "flutter/lib/ui/painting/pixel_conversion.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+std::vector<uint8_t> MakeRandomPixels(int width, int height) {
+  std::mt19937 random(width * 31 + height);
+  std::vector<uint8_t> pixels(width * height * 4);
+  for (uint8_t& channel : pixels) {
+    channel = static_cast<uint8_t>(random());
+  }
+  return pixels;
+}
+
+}  // namespace
+
+TEST(PixelConversionTest, PremultipliesAndSwapsRedAndBlue) {
+  // A half transparent orange in RGBA.
+  const uint8_t rgba[] = {255, 128, 0, 128};
+  uint8_t bgra[4];
+  PixelConversion conversion;
+  conversion.swap_red_blue = true;
+  conversion.premultiply = true;
+  ConvertPixels(rgba, 4, bgra, 4, 1, 1, conversion, PixelISA::kPortable);
+  EXPECT_EQ(bgra[0], 0);
+  EXPECT_EQ(bgra[1], 64);
+  EXPECT_EQ(bgra[2], 128);
+  EXPECT_EQ(bgra[3], 128);
+}
+
+TEST(PixelConversionTest, SupportedISAConvertsLikeThePortableOne) {
+  // Widths that leave rows shorter than a vector, and rows with a remainder.
+  for (int width : {1, 7, 16, 37}) {
+    const int height = 3;
+    const std::vector<uint8_t> src = MakeRandomPixels(width, height);
+    for (bool swap_red_blue : {false, true}) {
+      for (bool premultiply : {false, true}) {
+        PixelConversion conversion;
+        conversion.swap_red_blue = swap_red_blue;
+        conversion.premultiply = premultiply;
+        std::vector<uint8_t> expected(src.size());
+        ConvertPixels(src.data(), width * 4, expected.data(), width * 4, width,
+                      height, conversion, PixelISA::kPortable);
+        std::vector<uint8_t> converted(src.size());
+        ConvertPixels(src.data(), width * 4, converted.data(), width * 4,
+                      width, height, conversion);
+        EXPECT_EQ(converted, expected) << "width " << width;
+
+        // Converting the pixels in place.
+        std::vector<uint8_t> in_place = src;
+        ConvertPixels(in_place.data(), width * 4, in_place.data(), width * 4,
+                      width, height, conversion);
+        EXPECT_EQ(in_place, expected) << "width " << width;
+      }
+    }
+  }
+}
+
+TEST(PixelConversionTest, HalvesBlocksOfPixels) {
+  // Two rows of three pixels, the last of which is dropped.
+  const uint8_t src[] = {
+      0,  0,  0,  0,  10, 20, 30, 40,  255, 255, 255, 255,  //
+      20, 40, 60, 80, 30, 60, 90, 120, 255, 255, 255, 255,  //
+  };
+  uint8_t dst[4];
+  HalvePixels(src, 12, 3, 2, dst, 4, PixelISA::kPortable);
+  EXPECT_EQ(dst[0], 15);
+  EXPECT_EQ(dst[1], 30);
+  EXPECT_EQ(dst[2], 45);
+  EXPECT_EQ(dst[3], 60);
+}
+
+TEST(PixelConversionTest, SupportedISAHalvesLikeThePortableOne) {
+  for (int width : {2, 9, 32, 75}) {
+    const int height = 5;
+    const std::vector<uint8_t> src = MakeRandomPixels(width, height);
+    const int dst_width = width / 2;
+    std::vector<uint8_t> expected(dst_width * (height / 2) * 4);
+    HalvePixels(src.data(), width * 4, width, height, expected.data(),
+                dst_width * 4, PixelISA::kPortable);
+    std::vector<uint8_t> halved(expected.size());
+    HalvePixels(src.data(), width * 4, width, height, halved.data(),
+                dst_width * 4);
+    EXPECT_EQ(halved, expected) << "width " << width;
+  }
+}
+
+TEST(PixelConversionTest, ConvertsOnlyPixmapsItHandles) {
+  uint8_t src_pixels[4] = {255, 128, 0, 128};
+  uint8_t dst_pixels[4] = {};
+  const SkImageInfo unpremul_rgba =
+      SkImageInfo::Make(1, 1, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+  const SkImageInfo premul_bgra =
+      SkImageInfo::Make(1, 1, kBGRA_8888_SkColorType, kPremul_SkAlphaType);
+
+  EXPECT_TRUE(ConvertPixmap(SkPixmap(unpremul_rgba, src_pixels, 4),
+                            SkPixmap(premul_bgra, dst_pixels, 4)));
+  EXPECT_EQ(dst_pixels[0], 0);
+  EXPECT_EQ(dst_pixels[2], 128);
+
+  // Unpremultiplying, changing the dimensions and other color types are left
+  // to Skia.
+  EXPECT_FALSE(ConvertPixmap(SkPixmap(premul_bgra, dst_pixels, 4),
+                             SkPixmap(unpremul_rgba, src_pixels, 4)));
+  EXPECT_FALSE(
+      ConvertPixmap(SkPixmap(unpremul_rgba, src_pixels, 4),
+                    SkPixmap(premul_bgra.makeWH(1, 2), dst_pixels, 4)));
+  EXPECT_FALSE(ConvertPixmap(
+      SkPixmap(unpremul_rgba.makeColorType(kAlpha_8_SkColorType), src_pixels,
+               1),
+      SkPixmap(premul_bgra, dst_pixels, 4)));
+}
+
+TEST(PixelConversionTest, DownscalesByHalvesTowardsTheDimensions) {
+  const std::vector<uint8_t> src = MakeRandomPixels(100, 60);
+  const SkPixmap pixmap(
+      SkImageInfo::Make(100, 60, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType),
+      src.data(), 100 * 4);
+
+  SkBitmap halved;
+  ASSERT_TRUE(DownscalePixmapByHalves(pixmap, SkISize::Make(30, 20), &halved));
+  // Halving once more would make the width smaller than 30.
+  EXPECT_EQ(halved.width(), 50);
+  EXPECT_EQ(halved.height(), 30);
+  EXPECT_EQ(halved.info().colorType(), kN32_SkColorType);
+  EXPECT_EQ(halved.info().alphaType(), kPremul_SkAlphaType);
+
+  ASSERT_TRUE(DownscalePixmapByHalves(pixmap, SkISize::Make(25, 15), &halved));
+  EXPECT_EQ(halved.width(), 25);
+  EXPECT_EQ(halved.height(), 15);
+
+  EXPECT_FALSE(
+      DownscalePixmapByHalves(pixmap, SkISize::Make(60, 20), &halved));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -63,7 +63,8 @@ Dart_Handle SingleFrameCodec::getNextFrame(Dart_Handle callback_handle) {
       new fml::RefPtr<SingleFrameCodec>(this);
 
   decoder->Decode(
-      descriptor_, target_width_, target_height_, [raw_codec_ref](auto image) {
+      descriptor_, target_width_, target_height_,
+      [raw_codec_ref, cache = decoder->GetDecodedImageCache()](auto image) {
         std::unique_ptr<fml::RefPtr<SingleFrameCodec>> codec_ref(raw_codec_ref);
         fml::RefPtr<SingleFrameCodec> codec(std::move(*codec_ref));
 
@@ -81,6 +82,7 @@ Dart_Handle SingleFrameCodec::getNextFrame(Dart_Handle callback_handle) {
         if (image.get()) {
           auto canvas_image = fml::MakeRefCounted<CanvasImage>();
           canvas_image->set_image(std::move(image));
+          canvas_image->ReportCacheBytes(cache);
 
           codec->cached_frame_ = fml::MakeRefCounted<FrameInfo>(
               std::move(canvas_image), 0 /* duration */);
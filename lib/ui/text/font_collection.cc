@@ -6,6 +6,7 @@
 
 #include <mutex>
 
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/platform_configuration.h"
@@ -21,6 +22,8 @@
 #include "third_party/tonic/logging/dart_invoke.h"
 #include "third_party/tonic/typed_data/typed_list.h"
 #include "txt/asset_font_manager.h"
+#include "txt/font_fallback_index.h"
+#include "txt/platform.h"
 #include "txt/test_font_manager.h"
 
 namespace flutter {
@@ -72,6 +75,42 @@ void FontCollection::SetupDefaultFontManager() {
   collection_->SetupDefaultFontManager();
 }
 
+std::shared_ptr<txt::FontFallbackIndex> FontCollection::LoadFallbackIndex(
+    const fml::UniqueFD& directory) {
+  TRACE_EVENT0("flutter", "FontCollection::LoadFallbackIndex");
+  std::vector<std::string> font_directories = txt::GetSystemFontDirectories();
+  if (!directory.is_valid() || font_directories.empty()) {
+    return nullptr;
+  }
+  auto index = std::make_shared<txt::FontFallbackIndex>(
+      txt::FontFallbackIndex::ComputeFingerprint(font_directories));
+  index->Load(directory);
+  return index;
+}
+
+void FontCollection::SetFallbackIndex(
+    std::shared_ptr<txt::FontFallbackIndex> index,
+    std::shared_ptr<fml::UniqueFD> directory) {
+  collection_->SetFallbackIndex(std::move(index));
+  fallback_index_directory_ = std::move(directory);
+}
+
+fml::closure FontCollection::TakeFallbackIndexSave() {
+  if (!fallback_index_directory_) {
+    return nullptr;
+  }
+  std::vector<uint8_t> index = collection_->SerializeFallbackIndex();
+  if (index.empty()) {
+    return nullptr;
+  }
+  return [directory = fallback_index_directory_, index = std::move(index)]() {
+    TRACE_EVENT0("flutter", "FontCollection::SaveFallbackIndex");
+    if (!txt::FontFallbackIndex::Write(*directory, index)) {
+      FML_DLOG(WARNING) << "Could not save the font fallback index.";
+    }
+  };
+}
+
 void FontCollection::RegisterFonts(
     std::shared_ptr<AssetManager> asset_manager) {
   std::unique_ptr<fml::Mapping> manifest_mapping =
@@ -9,8 +9,10 @@
 #include <vector>
 
 #include "flutter/assets/asset_manager.h"
+#include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/fml/unique_fd.h"
 #include "txt/font_collection.h"
 
 namespace tonic {
@@ -31,6 +33,23 @@ class FontCollection {
 
   void SetupDefaultFontManager();
 
+  // Loads the index of system font fallback matches saved in |directory|, or
+  // starts an empty one if it is missing or outdated. Returns nullptr if the
+  // platform has no system font directories. This performs file IO and may
+  // be called on any thread. See |txt::FontFallbackIndex|.
+  static std::shared_ptr<txt::FontFallbackIndex> LoadFallbackIndex(
+      const fml::UniqueFD& directory);
+
+  // Resolves fallback fonts with an index returned by |LoadFallbackIndex|,
+  // which is saved to |directory|.
+  void SetFallbackIndex(std::shared_ptr<txt::FontFallbackIndex> index,
+                        std::shared_ptr<fml::UniqueFD> directory);
+
+  // Returns a task that saves the fallback index if fonts were matched since
+  // it was set or this was last called, or nullptr otherwise. The task
+  // performs file IO and may run on any thread.
+  fml::closure TakeFallbackIndexSave();
+
   void RegisterFonts(std::shared_ptr<AssetManager> asset_manager);
 
   void RegisterTestFonts();
@@ -42,6 +61,7 @@ class FontCollection {
  private:
   std::shared_ptr<txt::FontCollection> collection_;
   sk_sp<txt::DynamicFontManager> dynamic_font_manager_;
+  std::shared_ptr<fml::UniqueFD> fallback_index_directory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
@@ -182,6 +182,34 @@ Dart_Handle ToByteData(const std::vector<uint8_t>& buffer) {
   return tonic::DartByteData::Create(buffer.data(), buffer.size());
 }
 
+// Message payloads smaller than this are copied into the Dart heap as that is
+// cheaper than creating and finalizing an external typed data.
+constexpr size_t kMinExternalMessageSize = 1024;
+
+void FinalizeMapping(void* isolate_callback_data,
+                     Dart_WeakPersistentHandle handle,
+                     void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
+// Hands |mapping| over to Dart. Large payloads are not copied but wrapped in an
+// external ByteData that releases the mapping once it is collected.
+Dart_Handle ToByteData(std::unique_ptr<fml::Mapping> mapping) {
+  const size_t size = mapping->GetSize();
+  if (size < kMinExternalMessageSize) {
+    return tonic::DartByteData::Create(mapping->GetMapping(), size);
+  }
+  void* bytes = const_cast<uint8_t*>(mapping->GetMapping());
+  Dart_Handle data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, mapping.get(), size,
+      FinalizeMapping);
+  if (!Dart_IsError(data)) {
+    // Now owned by the finalizer.
+    mapping.release();
+  }
+  return data;
+}
+
 }  // namespace
 
 PlatformConfigurationClient::~PlatformConfigurationClient() {}
@@ -274,7 +302,7 @@ void PlatformConfiguration::DispatchPlatformMessage(
   }
   tonic::DartState::Scope scope(dart_state);
   Dart_Handle data_handle =
-      (message->hasData()) ? ToByteData(message->data()) : Dart_Null();
+      (message->hasData()) ? ToByteData(message->releaseData()) : Dart_Null();
   if (Dart_IsError(data_handle)) {
     FML_DLOG(WARNING)
         << "Dropping platform message because of a Dart error on channel: "
@@ -12,9 +12,16 @@ PlatformMessage::PlatformMessage(std::string channel,
                                  std::vector<uint8_t> data,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
-      data_(std::move(data)),
+      data_(std::make_unique<fml::DataMapping>(std::move(data))),
       hasData_(true),
       response_(std::move(response)) {}
+PlatformMessage::PlatformMessage(std::string channel,
+                                 std::unique_ptr<fml::Mapping> data,
+                                 fml::RefPtr<PlatformMessageResponse> response)
+    : channel_(std::move(channel)),
+      data_(std::move(data)),
+      hasData_(data_ != nullptr),
+      response_(std::move(response)) {}
 PlatformMessage::PlatformMessage(std::string channel,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
@@ -24,4 +31,14 @@ PlatformMessage::PlatformMessage(std::string channel,
 
 PlatformMessage::~PlatformMessage() = default;
 
+const fml::Mapping& PlatformMessage::data() const {
+  static const fml::NonOwnedMapping kEmptyData(nullptr, 0);
+  return data_ ? *data_ : kEmptyData;
+}
+
+std::unique_ptr<fml::Mapping> PlatformMessage::releaseData() {
+  hasData_ = false;
+  return std::move(data_);
+}
+
 }  // namespace flutter
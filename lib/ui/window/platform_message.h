@@ -5,9 +5,11 @@
 #ifndef FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 #define FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/lib/ui/window/platform_message_response.h"
@@ -20,9 +22,16 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
 
  public:
   const std::string& channel() const { return channel_; }
-  const std::vector<uint8_t>& data() const { return data_; }
+  // The payload of the message. Empty if the message has no data or the data
+  // has been released.
+  const fml::Mapping& data() const;
   bool hasData() { return hasData_; }
 
+  // Transfers the ownership of the payload to the caller without copying it.
+  // Returns nullptr if the message has no data. The message has no data
+  // afterwards.
+  std::unique_ptr<fml::Mapping> releaseData();
+
   const fml::RefPtr<PlatformMessageResponse>& response() const {
     return response_;
   }
@@ -31,12 +40,18 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
   PlatformMessage(std::string channel,
                   std::vector<uint8_t> data,
                   fml::RefPtr<PlatformMessageResponse> response);
+  // Used to pass large payloads (e.g. owned by the embedder) without copying
+  // them. The payload may be handed to Dart as an external typed data, so its
+  // memory must be writable.
+  PlatformMessage(std::string channel,
+                  std::unique_ptr<fml::Mapping> data,
+                  fml::RefPtr<PlatformMessageResponse> response);
   PlatformMessage(std::string channel,
                   fml::RefPtr<PlatformMessageResponse> response);
   ~PlatformMessage();
 
   std::string channel_;
-  std::vector<uint8_t> data_;
+  std::unique_ptr<fml::Mapping> data_;
   bool hasData_;
   fml::RefPtr<PlatformMessageResponse> response_;
 };
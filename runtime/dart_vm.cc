@@ -267,7 +267,11 @@ DartVM::DartVM(std::shared_ptr<const DartVMData> vm_data,
       concurrent_message_loop_(fml::ConcurrentMessageLoop::Create()),
       skia_concurrent_executor_(
           [runner = concurrent_message_loop_->GetTaskRunner()](
-              fml::closure work) { runner->PostTask(work); }),
+              fml::closure work) {
+            // Frames wait on the work Skia schedules here (e.g. shader
+            // compilation), so don't queue it behind image decodes.
+            runner->PostTask(work, fml::ConcurrentTaskPriority::kHigh);
+          }),
       vm_data_(vm_data),
       isolate_name_server_(std::move(isolate_name_server)),
       service_protocol_(std::make_shared<ServiceProtocol>()) {
@@ -38,6 +38,10 @@ const std::string_view ServiceProtocol::kGetSkSLsExtensionName =
 const std::string_view
     ServiceProtocol::kEstimateRasterCacheMemoryExtensionName =
         "_flutter.estimateRasterCacheMemory";
+const std::string_view ServiceProtocol::kStartLayerTreeCaptureExtensionName =
+    "_flutter.startLayerTreeCapture";
+const std::string_view ServiceProtocol::kStopLayerTreeCaptureExtensionName =
+    "_flutter.stopLayerTreeCapture";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -57,6 +61,8 @@ ServiceProtocol::ServiceProtocol()
           kGetDisplayRefreshRateExtensionName,
           kGetSkSLsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
+          kStartLayerTreeCaptureExtensionName,
+          kStopLayerTreeCaptureExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
@@ -29,6 +29,8 @@ class ServiceProtocol {
   static const std::string_view kGetDisplayRefreshRateExtensionName;
   static const std::string_view kGetSkSLsExtensionName;
   static const std::string_view kEstimateRasterCacheMemoryExtensionName;
+  static const std::string_view kStartLayerTreeCaptureExtensionName;
+  static const std::string_view kStopLayerTreeCaptureExtensionName;
 
   class Handler {
    public:
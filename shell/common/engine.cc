@@ -21,6 +21,7 @@
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/shell.h"
+#include "flutter/shell/version/version.h"
 #include "rapidjson/document.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -54,6 +55,29 @@ Engine::Engine(
       task_runners_(std::move(task_runners)),
       weak_factory_(this) {
   pointer_data_dispatcher_ = dispatcher_maker(*this);
+  if (settings_.enable_glyph_run_cache) {
+    font_collection_.GetFontCollection()->SetGlyphRunCache(
+        std::make_shared<txt::GlyphRunCache>());
+  }
+  if (settings_.enable_font_fallback_index) {
+    LoadFontFallbackIndex();
+  }
+  if (!settings_.hyphenation_patterns_path.empty()) {
+    font_collection_.GetFontCollection()->SetHyphenationPatterns(
+        std::make_shared<txt::HyphenationPatterns>(
+            fml::OpenDirectory(settings_.hyphenation_patterns_path.c_str(),
+                               false, fml::FilePermission::kRead)));
+  }
+  image_decoder_.SetFrameDecodeAhead(
+      settings_.animated_image_decode_ahead_frame_count,
+      settings_.animated_image_decode_ahead_max_bytes);
+  if (settings_.decoded_image_cache_max_bytes > 0) {
+    // The last engine created sets the budget of the cache shared by all of
+    // them.
+    auto decoded_image_cache = DecodedImageCache::GetProcessCache();
+    decoded_image_cache->SetMaxBytes(settings_.decoded_image_cache_max_bytes);
+    image_decoder_.SetDecodedImageCache(std::move(decoded_image_cache));
+  }
 }
 
 Engine::Engine(Delegate& delegate,
@@ -95,7 +119,9 @@ Engine::Engine(Delegate& delegate,
   );
 }
 
-Engine::~Engine() = default;
+Engine::~Engine() {
+  SaveFontFallbackIndex();
+}
 
 float Engine::GetDisplayRefreshRate() const {
   return animator_->GetDisplayRefreshRate();
@@ -242,6 +268,10 @@ Engine::RunStatus Engine::PrepareAndLaunchIsolate(
 void Engine::BeginFrame(fml::TimePoint frame_time) {
   TRACE_EVENT0("flutter", "Engine::BeginFrame");
   runtime_controller_->BeginFrame(frame_time);
+  if (const auto& glyph_run_cache =
+          font_collection_.GetFontCollection()->GetGlyphRunCache()) {
+    glyph_run_cache->TraceStatsToTimeline();
+  }
 }
 
 void Engine::ReportTimings(std::vector<int64_t> timings) {
@@ -337,13 +367,56 @@ void Engine::DispatchPlatformMessage(fml::RefPtr<PlatformMessage> message) {
   FML_DLOG(WARNING) << "Dropping platform message on channel: " << channel;
 }
 
+void Engine::LoadFontFallbackIndex() {
+  auto io_task_runner = task_runners_.GetIOTaskRunner();
+  if (!io_task_runner) {
+    return;
+  }
+  // Computing the fingerprint of the index walks the system font directories,
+  // which can take a while on devices with many fonts.
+  auto load = [engine = GetWeakPtr(),
+               ui_task_runner = task_runners_.GetUITaskRunner()]() {
+    fml::UniqueFD caches_directory = fml::paths::GetCachesDirectory();
+    if (!caches_directory.is_valid()) {
+      return;
+    }
+    auto directory = std::make_shared<fml::UniqueFD>(
+        fml::CreateDirectory(caches_directory,
+                             {"flutter_engine", GetFlutterEngineVersion(),
+                              "fonts"},
+                             fml::FilePermission::kReadWrite));
+    auto index = FontCollection::LoadFallbackIndex(*directory);
+    if (!index) {
+      return;
+    }
+    ui_task_runner->PostTask([engine, index, directory]() {
+      if (engine) {
+        engine->font_collection_.SetFallbackIndex(index, directory);
+      }
+    });
+  };
+  io_task_runner->PostTask(std::move(load));
+}
+
+void Engine::SaveFontFallbackIndex() {
+  fml::closure save = font_collection_.TakeFallbackIndexSave();
+  auto io_task_runner = task_runners_.GetIOTaskRunner();
+  if (save && io_task_runner) {
+    io_task_runner->PostTask(std::move(save));
+  }
+}
+
 bool Engine::HandleLifecyclePlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string state(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string state(reinterpret_cast<const char*>(data.GetMapping()),
+                    data.GetSize());
   if (state == "AppLifecycleState.paused" ||
       state == "AppLifecycleState.detached") {
     activity_running_ = false;
     StopAnimator();
+    // The app may be killed without further notice once it is in the
+    // background.
+    SaveFontFallbackIndex();
   } else if (state == "AppLifecycleState.resumed" ||
              state == "AppLifecycleState.inactive") {
     activity_running_ = true;
@@ -366,7 +439,8 @@ bool Engine::HandleNavigationPlatformMessage(
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject()) {
     return false;
   }
@@ -384,7 +458,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject()) {
     return false;
   }
@@ -424,7 +499,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
 
 void Engine::HandleSettingsPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string jsonData(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string jsonData(reinterpret_cast<const char*>(data.GetMapping()),
+                       data.GetSize());
   if (runtime_controller_->SetUserSettingsData(std::move(jsonData)) &&
       have_surface_) {
     ScheduleFrame();
@@ -537,8 +613,8 @@ void Engine::HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message) {
     return;
   }
   const auto& data = message->data();
-  std::string asset_name(reinterpret_cast<const char*>(data.data()),
-                         data.size());
+  std::string asset_name(reinterpret_cast<const char*>(data.GetMapping()),
+                         data.GetSize());
 
   if (asset_manager_) {
     std::unique_ptr<fml::Mapping> asset_mapping =
@@ -833,6 +833,13 @@ class Engine final : public RuntimeDelegate,
 
   void StartAnimatorIfPossible();
 
+  // Loads the font fallback index on the IO task runner and hands it to the
+  // font collection once it is ready.
+  void LoadFontFallbackIndex();
+
+  // Saves the font fallback matches made so far on the IO task runner.
+  void SaveFontFallbackIndex();
+
   bool HandleLifecyclePlatformMessage(PlatformMessage* message);
 
   bool HandleNavigationPlatformMessage(fml::RefPtr<PlatformMessage> message);
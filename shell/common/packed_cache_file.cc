@@ -0,0 +1,403 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/packed_cache_file.h"
+
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'L', 'T', 'P', 'A', 'C', 'K', '1'};
+constexpr uint32_t kVersion = 2;
+
+// Records are padded so that each record and its value start at an offset
+// that is a multiple of this. Values (e.g. shader binaries) may be read
+// through typed pointers into the mapped file.
+constexpr size_t kRecordAlignment = alignof(uint32_t);
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct RecordHeader {
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t checksum;
+};
+
+static_assert(sizeof(FileHeader) % kRecordAlignment == 0);
+static_assert(sizeof(RecordHeader) % kRecordAlignment == 0);
+
+// Serializes |Append| and |Compact| within the process.
+std::mutex gFileMutex;
+
+size_t AlignToRecord(size_t size) {
+  return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// The offset of the value from the start of its record.
+size_t GetValueOffset(size_t key_size) {
+  return AlignToRecord(sizeof(RecordHeader) + key_size);
+}
+
+size_t GetRecordSize(size_t key_size, size_t value_size) {
+  return GetValueOffset(key_size) + AlignToRecord(value_size);
+}
+
+// FNV-1a, which is good enough to detect entries that were not completely
+// written.
+uint32_t Checksum(const uint8_t* key,
+                  size_t key_size,
+                  const uint8_t* value,
+                  size_t value_size) {
+  uint32_t hash = 2166136261u;
+  auto update = [&hash](const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= data[i];
+      hash *= 16777619u;
+    }
+  };
+  update(key, key_size);
+  update(value, value_size);
+  return hash;
+}
+
+bool HasValidHeader(const uint8_t* data, size_t size) {
+  if (data == nullptr || size < sizeof(FileHeader)) {
+    return false;
+  }
+  FileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+         header.version == kVersion;
+}
+
+bool IsValidRecord(const uint8_t* record, const RecordHeader& header) {
+  return Checksum(record + sizeof(RecordHeader), header.key_size,
+                  record + GetValueOffset(header.key_size),
+                  header.value_size) == header.checksum;
+}
+
+using RecordVisitor =
+    std::function<void(size_t offset, const RecordHeader& header)>;
+
+// Calls |visitor| (if any) with the offset and header of each complete record
+// in a file with a valid header. Returns the size of the valid part of the
+// file, which is where the next record should be appended.
+//
+// Checking the checksums requires reading the whole file. If |verify_all| is
+// false, only the last record is checked since that is the only one that
+// could have been written partially.
+size_t VisitRecords(const uint8_t* data,
+                    size_t size,
+                    bool verify_all,
+                    const RecordVisitor& visitor) {
+  size_t offset = sizeof(FileHeader);
+  size_t last_offset = offset;
+  RecordHeader last_header = {};
+  while (size - offset >= sizeof(RecordHeader)) {
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof(header));
+    // Keys are never empty, so this is a record whose header was not written.
+    if (header.key_size == 0) {
+      break;
+    }
+    const size_t record_size =
+        GetRecordSize(header.key_size, header.value_size);
+    if (record_size > size - offset) {
+      break;
+    }
+    if (verify_all && !IsValidRecord(data + offset, header)) {
+      break;
+    }
+    if (visitor) {
+      visitor(offset, header);
+    }
+    last_offset = offset;
+    last_header = header;
+    offset += record_size;
+  }
+  if (!verify_all && last_header.key_size != 0 &&
+      !IsValidRecord(data + last_offset, last_header)) {
+    return last_offset;
+  }
+  return offset;
+}
+
+void WriteFileHeader(uint8_t* destination) {
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  std::memcpy(destination, &header, sizeof(header));
+}
+
+void WriteRecord(uint8_t* destination,
+                 const uint8_t* key,
+                 size_t key_size,
+                 const uint8_t* value,
+                 size_t value_size) {
+  RecordHeader header;
+  header.key_size = static_cast<uint32_t>(key_size);
+  header.value_size = static_cast<uint32_t>(value_size);
+  header.checksum = Checksum(key, key_size, value, value_size);
+  // The padding may cover bytes of a record that was not completely written.
+  std::memset(destination, 0, GetRecordSize(key_size, value_size));
+  std::memcpy(destination, &header, sizeof(header));
+  std::memcpy(destination + sizeof(header), key, key_size);
+  if (value_size > 0) {
+    std::memcpy(destination + GetValueOffset(key_size), value, value_size);
+  }
+}
+
+bool CanBeStored(size_t key_size, size_t value_size) {
+  constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+  return key_size > 0 && key_size <= kMaxSize && value_size <= kMaxSize;
+}
+
+}  // namespace
+
+PackedCacheFile::PackedCacheFile(std::shared_ptr<fml::UniqueFD> directory)
+    : directory_(std::move(directory)) {
+  Reload();
+}
+
+PackedCacheFile::~PackedCacheFile() = default;
+
+sk_sp<SkData> PackedCacheFile::Find(const SkData& key) const {
+  const std::string key_string(static_cast<const char*>(key.data()),
+                               key.size());
+  std::scoped_lock lock(contents_mutex_);
+  auto found = contents_.index.find(key_string);
+  if (found == contents_.index.end()) {
+    return nullptr;
+  }
+  return MakeData(contents_, found->second);
+}
+
+std::vector<PackedCacheFile::Entry> PackedCacheFile::GetEntries() const {
+  std::scoped_lock lock(contents_mutex_);
+  std::vector<Entry> entries;
+  entries.reserve(contents_.keys.size());
+  for (const auto& key : contents_.keys) {
+    entries.push_back({SkData::MakeWithCopy(key.data(), key.size()),
+                       MakeData(contents_, contents_.index.at(key))});
+  }
+  return entries;
+}
+
+size_t PackedCacheFile::GetEntryCount() const {
+  std::scoped_lock lock(contents_mutex_);
+  return contents_.keys.size();
+}
+
+void PackedCacheFile::Reload() {
+  Contents contents;
+  if (directory_) {
+    contents = Load(*directory_);
+  }
+  std::scoped_lock lock(contents_mutex_);
+  contents_ = std::move(contents);
+}
+
+PackedCacheFile::Contents PackedCacheFile::Load(
+    const fml::UniqueFD& directory) {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Load");
+  Contents contents;
+  if (!directory.is_valid()) {
+    return contents;
+  }
+  auto file = fml::OpenFileReadOnly(directory, kFileName);
+  if (!file.is_valid()) {
+    return contents;
+  }
+  auto mapping = std::make_shared<fml::FileMapping>(file);
+  if (!mapping->IsValid() ||
+      !HasValidHeader(mapping->GetMapping(), mapping->GetSize())) {
+    FML_LOG(ERROR) << "Ignoring the invalid persistent cache file "
+                   << kFileName << ".";
+    return contents;
+  }
+
+  const uint8_t* data = mapping->GetMapping();
+  VisitRecords(data, mapping->GetSize(), true,
+               [&contents, data](size_t offset, const RecordHeader& header) {
+                 const size_t key_offset = offset + sizeof(RecordHeader);
+                 std::string key(reinterpret_cast<const char*>(data) +
+                                     key_offset,
+                                 header.key_size);
+                 const Location location = {
+                     offset + GetValueOffset(header.key_size),
+                     header.value_size};
+                 auto result = contents.index.insert({key, location});
+                 if (result.second) {
+                   contents.keys.push_back(std::move(key));
+                 } else {
+                   result.first->second = location;
+                 }
+               });
+  contents.mapping = std::move(mapping);
+  return contents;
+}
+
+sk_sp<SkData> PackedCacheFile::MakeData(const Contents& contents,
+                                        const Location& location) {
+  if (location.size == 0) {
+    return SkData::MakeEmpty();
+  }
+  // The data keeps the file mapped for as long as it is alive.
+  auto* mapping = new std::shared_ptr<fml::FileMapping>(contents.mapping);
+  return SkData::MakeWithProc(
+      contents.mapping->GetMapping() + location.offset, location.size,
+      [](const void* ptr, void* context) {
+        delete reinterpret_cast<std::shared_ptr<fml::FileMapping>*>(context);
+      },
+      mapping);
+}
+
+bool PackedCacheFile::Append(const fml::UniqueFD& directory,
+                             const std::vector<Entry>& entries) {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Append");
+  if (!directory.is_valid()) {
+    return false;
+  }
+  size_t records_size = 0;
+  for (const auto& entry : entries) {
+    if (!CanBeStored(entry.first->size(), entry.second->size())) {
+      return false;
+    }
+    records_size += GetRecordSize(entry.first->size(), entry.second->size());
+  }
+  if (records_size == 0) {
+    return true;
+  }
+
+  std::scoped_lock lock(gFileMutex);
+  auto file = fml::OpenFile(directory, kFileName, true,
+                            fml::FilePermission::kReadWrite);
+  if (!file.is_valid()) {
+    return false;
+  }
+
+  // Append after the last valid record. This drops a record that was not
+  // completely written the last time, which is fine since it was never
+  // visible to readers.
+  size_t end = 0;
+  {
+    fml::FileMapping mapping(file);
+    if (!mapping.IsValid()) {
+      return false;
+    }
+    if (HasValidHeader(mapping.GetMapping(), mapping.GetSize())) {
+      end = VisitRecords(mapping.GetMapping(), mapping.GetSize(), false,
+                         nullptr);
+    }
+  }
+
+  const size_t header_size = end == 0 ? sizeof(FileHeader) : 0;
+  const size_t file_size = end + header_size + records_size;
+  if (!fml::TruncateFile(file, file_size)) {
+    return false;
+  }
+
+  fml::FileMapping mapping(file, {fml::FileMapping::Protection::kRead,
+                                  fml::FileMapping::Protection::kWrite});
+  uint8_t* destination = mapping.GetMutableMapping();
+  if (destination == nullptr || mapping.GetSize() != file_size) {
+    return false;
+  }
+  destination += end;
+  if (header_size > 0) {
+    WriteFileHeader(destination);
+    destination += header_size;
+  }
+  for (const auto& entry : entries) {
+    const SkData& key = *entry.first;
+    const SkData& value = *entry.second;
+    WriteRecord(destination, key.bytes(), key.size(), value.bytes(),
+                value.size());
+    destination += GetRecordSize(key.size(), value.size());
+  }
+  return true;
+}
+
+bool PackedCacheFile::Compact(const fml::UniqueFD& directory,
+                              const std::vector<Entry>& legacy_entries) {
+  TRACE_EVENT0("flutter", "PackedCacheFile::Compact");
+  if (!directory.is_valid()) {
+    return false;
+  }
+
+  std::scoped_lock lock(gFileMutex);
+  const Contents contents = Load(directory);
+
+  struct Record {
+    const uint8_t* key;
+    size_t key_size;
+    const uint8_t* value;
+    size_t value_size;
+  };
+  std::vector<Record> records;
+  size_t file_size = sizeof(FileHeader);
+
+  for (const auto& key : contents.keys) {
+    const Location& location = contents.index.at(key);
+    records.push_back({reinterpret_cast<const uint8_t*>(key.data()),
+                       key.size(),
+                       contents.mapping->GetMapping() + location.offset,
+                       location.size});
+    file_size += GetRecordSize(key.size(), location.size);
+  }
+
+  std::unordered_set<std::string> keys(contents.keys.begin(),
+                                       contents.keys.end());
+  for (const auto& entry : legacy_entries) {
+    if (entry.first == nullptr || entry.second == nullptr ||
+        !CanBeStored(entry.first->size(), entry.second->size())) {
+      continue;
+    }
+    const bool inserted =
+        keys.insert(std::string(static_cast<const char*>(entry.first->data()),
+                                entry.first->size()))
+            .second;
+    if (!inserted) {
+      continue;
+    }
+    records.push_back({entry.first->bytes(), entry.first->size(),
+                       entry.second->bytes(), entry.second->size()});
+    file_size += GetRecordSize(entry.first->size(), entry.second->size());
+  }
+
+  if (records.empty()) {
+    if (fml::FileExists(directory, kFileName)) {
+      return fml::UnlinkFile(directory, kFileName);
+    }
+    return true;
+  }
+
+  std::vector<uint8_t> buffer(file_size);
+  uint8_t* destination = buffer.data();
+  WriteFileHeader(destination);
+  destination += sizeof(FileHeader);
+  for (const auto& record : records) {
+    WriteRecord(destination, record.key, record.key_size, record.value,
+                record.value_size);
+    destination += GetRecordSize(record.key_size, record.value_size);
+  }
+
+  return fml::WriteAtomically(directory, kFileName,
+                              fml::DataMapping(std::move(buffer)));
+}
+
+}  // namespace flutter
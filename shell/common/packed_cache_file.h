@@ -0,0 +1,114 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PACKED_CACHE_FILE_H_
+#define FLUTTER_SHELL_COMMON_PACKED_CACHE_FILE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+/// A single file holding all the entries of a directory of the
+/// |PersistentCache|.
+///
+/// Storing one file per entry makes loading a cache with hundreds of shaders
+/// expensive on devices with slow storage. Instead, entries are appended to
+/// one file that is memory mapped when it is loaded, so looking up an entry
+/// does not touch the file system.
+///
+/// The file starts with a header followed by the entries in the order they
+/// were appended. Each entry is a header with the size of its key and value
+/// and a checksum of both, followed by the key and value bytes. The key and
+/// the value are padded to a multiple of 4 bytes, so that values are aligned
+/// for reading 4 byte fields from the mapping. A later entry
+/// replaces an earlier one with the same key. An entry that was not completely
+/// written (e.g. because the process was killed) and everything after it is
+/// ignored. Values are stored in the byte order of the device since caches are
+/// specific to the device that generated them anyway.
+///
+/// Appending never rewrites existing entries, so replaced entries keep using
+/// space until the file is compacted with |Compact|.
+class PackedCacheFile {
+ public:
+  static constexpr char kFileName[] = "cache.pack";
+
+  using Entry = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
+
+  /// Maps the packed file in |directory|. If there is no such file, the
+  /// packed file is empty.
+  explicit PackedCacheFile(std::shared_ptr<fml::UniqueFD> directory);
+
+  ~PackedCacheFile();
+
+  /// Returns the value of the latest entry for |key| or nullptr if there is
+  /// none. The returned data refers to the mapped file instead of copying it.
+  ///
+  /// Entries appended after the file was mapped are only found after a call
+  /// to |Reload|.
+  sk_sp<SkData> Find(const SkData& key) const;
+
+  /// Returns the latest entry of each key in the order they were appended.
+  std::vector<Entry> GetEntries() const;
+
+  size_t GetEntryCount() const;
+
+  /// Maps the packed file again, e.g. after it was compacted or removed.
+  void Reload();
+
+  /// Appends |entries| to the packed file in |directory|, creating the file
+  /// if necessary. Finding the end of the file and mapping it costs time
+  /// proportional to its size, so entries should be appended in batches. This
+  /// performs file IO and should be called on a worker thread.
+  static bool Append(const fml::UniqueFD& directory,
+                     const std::vector<Entry>& entries);
+
+  /// Rewrites the packed file in |directory| so that it only contains the
+  /// latest entry of each key. The |legacy_entries| (e.g. read from the
+  /// files of an older cache layout) are added to the packed file unless it
+  /// already has an entry with the same key.
+  ///
+  /// This reads the whole cache into memory and is meant to be called while
+  /// the cache is not in use (e.g. before the cache is shipped as a read-only
+  /// cache).
+  static bool Compact(const fml::UniqueFD& directory,
+                      const std::vector<Entry>& legacy_entries = {});
+
+ private:
+  struct Location {
+    size_t offset;
+    size_t size;
+  };
+
+  struct Contents {
+    std::shared_ptr<fml::FileMapping> mapping;
+    std::unordered_map<std::string, Location> index;
+    // The keys of |index| in the order they were first appended.
+    std::vector<std::string> keys;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  mutable std::mutex contents_mutex_;
+  Contents contents_;
+
+  static Contents Load(const fml::UniqueFD& directory);
+
+  static sk_sp<SkData> MakeData(const Contents& contents,
+                                const Location& location);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedCacheFile);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PACKED_CACHE_FILE_H_
@@ -0,0 +1,221 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/packed_cache_file.h"
+
+#include <cstdint>
+#include <string>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+sk_sp<SkData> MakeData(const std::string& string) {
+  return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string ToString(const sk_sp<SkData>& data) {
+  if (data == nullptr) {
+    return "<null>";
+  }
+  return std::string(static_cast<const char*>(data->data()), data->size());
+}
+
+bool Append(const fml::UniqueFD& directory,
+            const std::string& key,
+            const std::string& value) {
+  return PackedCacheFile::Append(directory, {{MakeData(key), MakeData(value)}});
+}
+
+}  // namespace
+
+TEST(PackedCacheFileTest, MissingFileIsEmpty) {
+  fml::ScopedTemporaryDirectory dir;
+  auto directory =
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get()));
+  PackedCacheFile packed(directory);
+  EXPECT_EQ(packed.GetEntryCount(), 0u);
+  EXPECT_EQ(packed.Find(*MakeData("key")), nullptr);
+}
+
+TEST(PackedCacheFileTest, AppendedEntriesAreFoundAfterReload) {
+  fml::ScopedTemporaryDirectory dir;
+  auto directory =
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get()));
+  PackedCacheFile packed(directory);
+
+  ASSERT_TRUE(Append(dir.fd(), "a", "first"));
+  ASSERT_TRUE(Append(dir.fd(), "b", "second"));
+  EXPECT_EQ(packed.Find(*MakeData("a")), nullptr);
+
+  packed.Reload();
+  EXPECT_EQ(packed.GetEntryCount(), 2u);
+  EXPECT_EQ(ToString(packed.Find(*MakeData("a"))), "first");
+  EXPECT_EQ(ToString(packed.Find(*MakeData("b"))), "second");
+  EXPECT_EQ(packed.Find(*MakeData("c")), nullptr);
+
+  auto entries = packed.GetEntries();
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(ToString(entries[0].first), "a");
+  EXPECT_EQ(ToString(entries[0].second), "first");
+  EXPECT_EQ(ToString(entries[1].first), "b");
+  EXPECT_EQ(ToString(entries[1].second), "second");
+}
+
+TEST(PackedCacheFileTest, AppendsBatchesOfEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(Append(dir.fd(), "a", "first"));
+  ASSERT_TRUE(PackedCacheFile::Append(
+      dir.fd(), {{MakeData("b"), MakeData("second")},
+                 {MakeData("a"), MakeData("replaced")},
+                 {MakeData("c"), MakeData("")}}));
+  ASSERT_TRUE(PackedCacheFile::Append(dir.fd(), {}));
+
+  PackedCacheFile packed(
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get())));
+  auto entries = packed.GetEntries();
+  ASSERT_EQ(entries.size(), 3u);
+  EXPECT_EQ(ToString(entries[0].first), "a");
+  EXPECT_EQ(ToString(entries[0].second), "replaced");
+  EXPECT_EQ(ToString(entries[1].first), "b");
+  EXPECT_EQ(ToString(entries[1].second), "second");
+  EXPECT_EQ(ToString(entries[2].first), "c");
+  EXPECT_EQ(ToString(entries[2].second), "");
+}
+
+TEST(PackedCacheFileTest, ValuesAreAligned) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(PackedCacheFile::Append(
+      dir.fd(), {{MakeData("a"), MakeData("odd")},
+                 {MakeData("bb"), MakeData("value")},
+                 {MakeData("ccc"), MakeData("12345678")},
+                 {MakeData("dddd"), MakeData("last")}}));
+
+  PackedCacheFile packed(
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get())));
+  auto entries = packed.GetEntries();
+  ASSERT_EQ(entries.size(), 4u);
+  EXPECT_EQ(ToString(entries[0].second), "odd");
+  EXPECT_EQ(ToString(entries[3].second), "last");
+  for (const auto& entry : entries) {
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(entry.second->data()) % alignof(uint32_t),
+        0u);
+  }
+}
+
+TEST(PackedCacheFileTest, LaterEntriesReplaceEarlierOnes) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(Append(dir.fd(), "a", "old"));
+  ASSERT_TRUE(Append(dir.fd(), "a", "new"));
+
+  PackedCacheFile packed(
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get())));
+  EXPECT_EQ(packed.GetEntryCount(), 1u);
+  EXPECT_EQ(ToString(packed.Find(*MakeData("a"))), "new");
+}
+
+TEST(PackedCacheFileTest, DataOutlivesTheFile) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(Append(dir.fd(), "a", "value"));
+
+  sk_sp<SkData> value;
+  {
+    PackedCacheFile packed(
+        std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get())));
+    value = packed.Find(*MakeData("a"));
+  }
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), PackedCacheFile::kFileName));
+  EXPECT_EQ(ToString(value), "value");
+}
+
+TEST(PackedCacheFileTest, PartiallyWrittenEntriesAreIgnored) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(Append(dir.fd(), "a", "first"));
+  ASSERT_TRUE(Append(dir.fd(), "b", "second"));
+
+  // Simulate a process that was killed while writing the last entry.
+  size_t size = 0;
+  {
+    auto file = fml::OpenFile(dir.fd(), PackedCacheFile::kFileName, false,
+                              fml::FilePermission::kReadWrite);
+    fml::FileMapping mapping(file, {fml::FileMapping::Protection::kRead,
+                                    fml::FileMapping::Protection::kWrite});
+    size = mapping.GetSize();
+    // The last byte of "second", which is followed by two bytes of padding.
+    mapping.GetMutableMapping()[size - 3] ^= 0xff;
+  }
+
+  auto directory =
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get()));
+  PackedCacheFile packed(directory);
+  EXPECT_EQ(packed.GetEntryCount(), 1u);
+  EXPECT_EQ(ToString(packed.Find(*MakeData("a"))), "first");
+  EXPECT_EQ(packed.Find(*MakeData("b")), nullptr);
+
+  // The next entry replaces the partially written one.
+  ASSERT_TRUE(Append(dir.fd(), "c", "third"));
+  packed.Reload();
+  EXPECT_EQ(packed.GetEntryCount(), 2u);
+  EXPECT_EQ(ToString(packed.Find(*MakeData("c"))), "third");
+  auto file = fml::OpenFileReadOnly(dir.fd(), PackedCacheFile::kFileName);
+  EXPECT_LT(fml::FileMapping(file).GetSize(), size);
+}
+
+TEST(PackedCacheFileTest, InvalidFileIsIgnoredAndReplaced) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), PackedCacheFile::kFileName,
+                                   fml::DataMapping("not a packed cache")));
+
+  auto directory =
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get()));
+  PackedCacheFile packed(directory);
+  EXPECT_EQ(packed.GetEntryCount(), 0u);
+
+  ASSERT_TRUE(Append(dir.fd(), "a", "value"));
+  packed.Reload();
+  EXPECT_EQ(ToString(packed.Find(*MakeData("a"))), "value");
+}
+
+TEST(PackedCacheFileTest, CompactKeepsLatestEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(Append(dir.fd(), "a", "old"));
+  ASSERT_TRUE(Append(dir.fd(), "b", "value"));
+  ASSERT_TRUE(Append(dir.fd(), "a", "new"));
+
+  // Legacy entries do not replace the packed ones.
+  ASSERT_TRUE(PackedCacheFile::Compact(
+      dir.fd(), {{MakeData("a"), MakeData("legacy")},
+                 {MakeData("c"), MakeData("legacy")}}));
+
+  PackedCacheFile packed(
+      std::make_shared<fml::UniqueFD>(fml::Duplicate(dir.fd().get())));
+  auto entries = packed.GetEntries();
+  ASSERT_EQ(entries.size(), 3u);
+  EXPECT_EQ(ToString(entries[0].first), "a");
+  EXPECT_EQ(ToString(entries[0].second), "new");
+  EXPECT_EQ(ToString(entries[1].first), "b");
+  EXPECT_EQ(ToString(entries[1].second), "value");
+  EXPECT_EQ(ToString(entries[2].first), "c");
+  EXPECT_EQ(ToString(entries[2].second), "legacy");
+}
+
+TEST(PackedCacheFileTest, CompactingAnEmptyCacheRemovesTheFile) {
+  fml::ScopedTemporaryDirectory dir;
+  ASSERT_TRUE(PackedCacheFile::Compact(dir.fd()));
+  EXPECT_FALSE(fml::FileExists(dir.fd(), PackedCacheFile::kFileName));
+
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), PackedCacheFile::kFileName,
+                                   fml::DataMapping("not a packed cache")));
+  ASSERT_TRUE(PackedCacheFile::Compact(dir.fd()));
+  EXPECT_FALSE(fml::FileExists(dir.fd(), PackedCacheFile::kFileName));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -7,7 +7,10 @@
 #include <future>
 #include <memory>
 #include <string>
+#include <set>
+#include <sstream>
 #include <string_view>
+#include <unordered_set>
 
 #include "rapidjson/document.h"
 #include "third_party/skia/include/utils/SkBase64.h"
@@ -86,16 +89,58 @@ bool PersistentCache::Purge() {
   FML_CHECK(GetWorkerTaskRunner());
 
   std::promise<bool> removed;
+  GetWorkerTaskRunner()->PostTask([&removed, cache_directory = cache_directory_,
+                                   packed_cache = packed_cache_]() {
+    if (cache_directory->is_valid()) {
+      FML_LOG(INFO) << "Purge persistent cache.";
+      removed.set_value(RemoveFilesInDirectory(*cache_directory));
+      packed_cache->Reload();
+    } else {
+      removed.set_value(false);
+    }
+  });
+  return removed.get_future().get();
+}
+
+bool PersistentCache::Compact() {
+  if (is_read_only_) {
+    FML_LOG(ERROR) << "Could not compact a read-only persistent cache.";
+    return false;
+  }
+
+  // Like |Purge|, make sure that all the file system modifications happen on
+  // the worker task runner.
+  FML_CHECK(GetWorkerTaskRunner());
+
+  std::promise<bool> compacted;
   GetWorkerTaskRunner()->PostTask(
-      [&removed, cache_directory = cache_directory_]() {
-        if (cache_directory->is_valid()) {
-          FML_LOG(INFO) << "Purge persistent cache.";
-          removed.set_value(RemoveFilesInDirectory(*cache_directory));
-        } else {
-          removed.set_value(false);
+      [&compacted, cache_directory = cache_directory_,
+       sksl_cache_directory = sksl_cache_directory_,
+       packed_cache = packed_cache_]() {
+        if (!cache_directory->is_valid()) {
+          compacted.set_value(false);
+          return;
         }
+        FML_LOG(INFO) << "Compact persistent cache.";
+        bool success = true;
+        for (const auto& directory : {cache_directory, sksl_cache_directory}) {
+          if (!directory->is_valid()) {
+            continue;
+          }
+          std::vector<std::string> file_names;
+          auto legacy_entries = LoadLegacyEntries(*directory, &file_names);
+          if (!PackedCacheFile::Compact(*directory, legacy_entries)) {
+            success = false;
+            continue;
+          }
+          for (const auto& file_name : file_names) {
+            fml::UnlinkFile(*directory, file_name.c_str());
+          }
+        }
+        packed_cache->Reload();
+        compacted.set_value(success);
       });
-  return removed.get_future().get();
+  return compacted.get_future().get();
 }
 
 namespace {
@@ -171,20 +216,38 @@ sk_sp<SkData> ParseBase64(const std::string& input) {
   return SkData::MakeWithCopy(decoder.getData(), decoder.getDataSize());
 }
 
-std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
-  TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
+std::vector<PersistentCache::SkSLCache> PersistentCache::LoadLegacyEntries(
+    const fml::UniqueFD& dir,
+    std::vector<std::string>* file_names) {
   std::vector<PersistentCache::SkSLCache> result;
-  fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
-                                       const std::string& filename) {
+  fml::FileVisitor visitor = [&result, file_names](
+                                 const fml::UniqueFD& directory,
+                                 const std::string& filename) {
+    // Skip the packed cache file, temporary files, SKP dumps and the SkSL
+    // subdirectory. None of those have a Base32 encoded key as their name.
+    if (filename.find('.') != std::string::npos ||
+        fml::IsDirectory(directory, filename.c_str())) {
+      return true;
+    }
     sk_sp<SkData> key = ParseBase32(filename);
     sk_sp<SkData> data = LoadFile(directory, filename);
     if (key != nullptr && data != nullptr) {
       result.push_back({key, data});
+      if (file_names != nullptr) {
+        file_names->push_back(filename);
+      }
     } else {
       FML_LOG(ERROR) << "Failed to load: " << filename;
     }
     return true;
   };
+  fml::VisitFiles(dir, visitor);
+  return result;
+}
+
+std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
+  TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
+  std::vector<PersistentCache::SkSLCache> result;
 
   // Only visit sksl_cache_directory_ if this persistent cache is valid.
   // However, we'd like to continue visit the asset dir even if this persistent
@@ -192,9 +255,24 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   if (IsValid()) {
     // In case `rewinddir` doesn't work reliably, load SkSLs from a freshly
     // opened directory (https://github.com/flutter/flutter/issues/65258).
-    fml::UniqueFD fresh_dir =
-        fml::OpenDirectoryReadOnly(*cache_directory_, kSkSLSubdirName);
-    fml::VisitFiles(fresh_dir, visitor);
+    // This also maps the packed file again so that it includes the SkSLs
+    // stored since the cache was created.
+    auto fresh_dir = std::make_shared<fml::UniqueFD>(
+        fml::OpenDirectoryReadOnly(*cache_directory_, kSkSLSubdirName));
+    result = PackedCacheFile(fresh_dir).GetEntries();
+
+    std::unordered_set<std::string> packed_keys;
+    for (const auto& sksl : result) {
+      packed_keys.insert(std::string(
+          static_cast<const char*>(sksl.first->data()), sksl.first->size()));
+    }
+    for (auto& sksl : LoadLegacyEntries(*fresh_dir)) {
+      std::string key(static_cast<const char*>(sksl.first->data()),
+                      sksl.first->size());
+      if (packed_keys.count(key) == 0) {
+        result.push_back(std::move(sksl));
+      }
+    }
   }
 
   std::unique_ptr<fml::Mapping> mapping = nullptr;
@@ -231,7 +309,9 @@ PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
       cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, true)),
+      packed_cache_(std::make_shared<PackedCacheFile>(cache_directory_)),
+      pending_appends_(std::make_shared<PendingAppends>()) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -263,17 +343,35 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   if (!IsValid()) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
-    return nullptr;
+  RecordStartupShader(key);
+  auto result = packed_cache_->Find(key);
+  if (result == nullptr) {
+    // Fall back to the layout used by older versions.
+    auto file_name = SkKeyToFilePath(key);
+    if (file_name.size() == 0) {
+      return nullptr;
+    }
+    result = PersistentCache::LoadFile(*cache_directory_, file_name);
   }
-  auto result = PersistentCache::LoadFile(*cache_directory_, file_name);
   if (result != nullptr) {
     TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
   }
   return result;
 }
 
+static void PostToWorker(fml::RefPtr<fml::TaskRunner> worker,
+                         fml::closure task) {
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    task();
+  } else {
+    worker->PostTask(std::move(task));
+  }
+}
+
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
                                  std::shared_ptr<fml::UniqueFD> cache_directory,
                                  std::string key,
@@ -292,15 +390,26 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
               << "Could not write cache contents to persistent store.";
         }
       });
+  PostToWorker(std::move(worker), std::move(task));
+}
 
-  if (!worker) {
-    FML_LOG(WARNING)
-        << "The persistent cache has no available workers. Performing the task "
-           "on the current thread. This slow operation is going to occur on a "
-           "frame workload.";
-    task();
-  } else {
-    worker->PostTask(std::move(task));
+void PersistentCache::AppendPending(
+    const std::vector<PendingAppend>& entries) {
+  TRACE_EVENT0("flutter", "PersistentCacheAppend");
+  // Append the entries of each directory together, keeping their order.
+  size_t begin = 0;
+  while (begin < entries.size()) {
+    const auto& directory = entries[begin].first;
+    std::vector<PackedCacheFile::Entry> batch;
+    size_t end = begin;
+    for (; end < entries.size() && entries[end].first == directory; end++) {
+      batch.push_back(entries[end].second);
+    }
+    if (!PackedCacheFile::Append(*directory, batch)) {
+      FML_DLOG(WARNING)
+          << "Could not write cache contents to persistent store.";
+    }
+    begin = end;
   }
 }
 
@@ -316,22 +425,125 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
+  if (key.size() == 0) {
+    return;
+  }
+
+  RecordStartupShader(key);
 
-  if (file_name.size() == 0) {
+  if (data.size() == 0) {
     return;
   }
 
-  auto mapping = std::make_unique<fml::DataMapping>(
-      std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
+  bool is_first_pending = false;
+  {
+    std::scoped_lock lock(pending_appends_->mutex);
+    is_first_pending = pending_appends_->entries.empty();
+    pending_appends_->entries.push_back(
+        {cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
+         {SkData::MakeWithCopy(key.data(), key.size()),
+          SkData::MakeWithCopy(data.data(), data.size())}});
+  }
+
+  // The entries stored until the task runs are appended along with this one.
+  if (is_first_pending) {
+    PostToWorker(GetWorkerTaskRunner(), [pending = pending_appends_]() {
+      std::vector<PendingAppend> entries;
+      {
+        std::scoped_lock lock(pending->mutex);
+        entries.swap(pending->entries);
+      }
+      AppendPending(entries);
+    });
+  }
+}
 
-  if (mapping == nullptr || mapping->GetSize() == 0) {
+void PersistentCache::RecordStartupShader(const SkData& key) {
+  if (is_read_only_) {
     return;
   }
+  std::scoped_lock lock(startup_shaders_mutex_);
+  if (rasterized_frame_count_ < kStartupFrameCount) {
+    auto encoded_key = SkKeyToFilePath(key);
+    if (!encoded_key.empty()) {
+      startup_shader_keys_.insert(std::move(encoded_key));
+    }
+  }
+}
 
-  PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
+// Reads the Base32 encoded keys written by |MarkFrameRasterized|.
+static std::set<std::string> ReadStartupShaderKeys(
+    const fml::UniqueFD& cache_directory) {
+  std::set<std::string> keys;
+  auto mapping = fml::FileMapping::CreateReadOnly(
+      cache_directory, PersistentCache::kStartupShadersFileName);
+  if (!mapping || mapping->GetSize() == 0) {
+    return keys;
+  }
+  std::istringstream stream(
+      std::string(reinterpret_cast<const char*>(mapping->GetMapping()),
+                  mapping->GetSize()));
+  for (std::string key; std::getline(stream, key);) {
+    if (!key.empty()) {
+      keys.insert(std::move(key));
+    }
+  }
+  return keys;
+}
+
+void PersistentCache::MarkFrameRasterized() {
+  std::set<std::string> keys;
+  {
+    std::scoped_lock lock(startup_shaders_mutex_);
+    if (rasterized_frame_count_ >= kStartupFrameCount) {
+      return;
+    }
+    rasterized_frame_count_++;
+    if (rasterized_frame_count_ < kStartupFrameCount ||
+        startup_shader_keys_.empty()) {
+      return;
+    }
+    keys = std::move(startup_shader_keys_);
+    startup_shader_keys_.clear();
+  }
+
+  if (is_read_only_ || !IsValid()) {
+    return;
+  }
+
+  auto task = [cache_directory = cache_directory_,
+               keys = std::move(keys)]() mutable {
+    TRACE_EVENT0("flutter", "PersistentCacheStoreStartupShaders");
+    // Keep the keys of previous runs. Shaders that were precompiled before
+    // the first frame are not looked up during the frame, so they would be
+    // missing otherwise.
+    keys.merge(ReadStartupShaderKeys(*cache_directory));
+    std::string contents;
+    for (const auto& key : keys) {
+      contents += key;
+      contents += '\n';
+    }
+    if (!fml::WriteAtomically(*cache_directory, kStartupShadersFileName,
+                              fml::DataMapping(contents))) {
+      FML_DLOG(WARNING) << "Could not write the startup shaders.";
+    }
+  };
+  PostToWorker(GetWorkerTaskRunner(), std::move(task));
+}
+
+std::unordered_set<std::string> PersistentCache::LoadStartupShaderKeys() {
+  TRACE_EVENT0("flutter", "PersistentCache::LoadStartupShaderKeys");
+  std::unordered_set<std::string> result;
+  if (!IsValid()) {
+    return result;
+  }
+  for (const auto& encoded_key : ReadStartupShaderKeys(*cache_directory_)) {
+    auto decode_result = fml::Base32Decode(encoded_key);
+    if (decode_result.first && !decode_result.second.empty()) {
+      result.insert(std::move(decode_result.second));
+    }
+  }
+  return result;
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
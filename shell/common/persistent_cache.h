@@ -8,11 +8,15 @@
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "flutter/assets/asset_manager.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/packed_cache_file.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
 
 namespace flutter {
@@ -21,13 +25,19 @@ namespace flutter {
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
 /// thread-safe for reading and writing from multiple threads.
+///
+/// Entries are stored in a single |PackedCacheFile| per cache directory.
+/// Caches written by older versions stored one file per entry, named after
+/// the Base32 encoding of the key. Those files are still read and are moved
+/// into the packed file by |Compact|.
 class PersistentCache : public GrContextOptions::PersistentCache {
  public:
   // Mutable static switch that can be set before GetCacheForProcess. If true,
   // we'll only read existing caches but not generate new ones. Some clients
   // (e.g., embedded devices) prefer generating persistent cache files for the
   // specific device beforehand, and ship them as readonly files in OTA
-  // packages.
+  // packages. Such caches should be compacted with |Compact| before they are
+  // shipped so they consist of a single file per cache directory.
   static bool gIsReadOnly;
 
   static PersistentCache* GetCacheForProcess();
@@ -62,9 +72,25 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // Return whether the purge is successful.
   bool Purge();
 
+  // Rewrite the packed cache files so they only contain the latest entry of
+  // each key, and move the entries stored as individual files by older
+  // versions into them. This reads the whole cache into memory and is meant
+  // to be called while no shaders are being compiled.
+  // Return whether the compaction is successful.
+  bool Compact();
+
   // |GrContextOptions::PersistentCache|
   sk_sp<SkData> load(const SkData& key) override;
 
+  // Called by the rasterizer after each frame. The keys of the shaders that
+  // Skia loads or stores during the first |kStartupFrameCount| frames are
+  // remembered, so the shaders can be compiled first during the next startup.
+  void MarkFrameRasterized();
+
+  // Load the keys of the shaders that were remembered by
+  // |MarkFrameRasterized| during previous runs.
+  std::unordered_set<std::string> LoadStartupShaderKeys();
+
   using SkSLCache = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
 
   /// Load all the SkSL shader caches in the right directory.
@@ -80,6 +106,8 @@ class PersistentCache : public GrContextOptions::PersistentCache {
 
   static constexpr char kSkSLSubdirName[] = "sksl";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
+  static constexpr char kStartupShadersFileName[] = "startup_shaders.keys";
+  static constexpr size_t kStartupFrameCount = 3;
 
  private:
   static std::string cache_base_path_;
@@ -102,15 +130,43 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  const std::shared_ptr<PackedCacheFile> packed_cache_;
+
+  // The entries stored since the worker last appended to the packed files.
+  // A single task appends all of them, so shaders compiled in a burst (e.g.
+  // during startup) don't each rewrite the end of the file.
+  using PendingAppend =
+      std::pair<std::shared_ptr<fml::UniqueFD>, PackedCacheFile::Entry>;
+  struct PendingAppends {
+    std::mutex mutex;
+    std::vector<PendingAppend> entries;
+  };
+  const std::shared_ptr<PendingAppends> pending_appends_;
+
+  static void AppendPending(const std::vector<PendingAppend>& entries);
+
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
 
   bool stored_new_shaders_ = false;
   bool is_dumping_skp_ = false;
 
+  std::mutex startup_shaders_mutex_;
+  size_t rasterized_frame_count_ = 0;
+  // The Base32 encoded keys of the shaders used during the first frames.
+  std::set<std::string> startup_shader_keys_;
+
+  void RecordStartupShader(const SkData& key);
+
   static sk_sp<SkData> LoadFile(const fml::UniqueFD& dir,
                                 const std::string& filen_ame);
 
+  // Load the entries stored as one file per key by older versions. The names
+  // of the files are added to |file_names| if it is not null.
+  static std::vector<SkSLCache> LoadLegacyEntries(
+      const fml::UniqueFD& dir,
+      std::vector<std::string>* file_names = nullptr);
+
   bool IsValid() const;
 
   PersistentCache(bool read_only = false);
@@ -12,6 +12,7 @@
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/log_settings.h"
+#include "flutter/fml/thread.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/shell_test.h"
@@ -272,5 +273,83 @@ TEST_F(ShellTest, CanPurgePersistentCache) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, CanCompactPersistentCache) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  auto cache_dir = fml::CreateDirectory(
+      base_dir.fd(),
+      {"flutter_engine", GetFlutterEngineVersion(), "skia", GetSkiaVersion()},
+      fml::FilePermission::kReadWrite);
+  auto sksl_dir = fml::CreateDirectory(cache_dir,
+                                       {PersistentCache::kSkSLSubdirName},
+                                       fml::FilePermission::kReadWrite);
+
+  // Generate caches in the layout of older versions. "IE" is the Base32
+  // encoding of "A" and "II" is the encoding of "B".
+  ASSERT_TRUE(fml::WriteAtomically(cache_dir, "IE", fml::DataMapping("x")));
+  ASSERT_TRUE(fml::WriteAtomically(sksl_dir, "II", fml::DataMapping("y")));
+
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+  auto cache = PersistentCache::GetCacheForProcess();
+  fml::Thread worker("io.flutter.test.persistent_cache");
+  cache->AddWorkerTaskRunner(worker.GetTaskRunner());
+
+  auto key = SkData::MakeWithCopy("A", 1);
+  sk_sp<SkData> value = cache->load(*key);
+  ASSERT_NE(value, nullptr);
+  CheckTextSkData(value, "x");
+
+  ASSERT_TRUE(cache->Compact());
+
+  // The legacy files are moved into the packed files.
+  ASSERT_FALSE(fml::FileExists(cache_dir, "IE"));
+  ASSERT_FALSE(fml::FileExists(sksl_dir, "II"));
+  ASSERT_TRUE(fml::FileExists(cache_dir, PackedCacheFile::kFileName));
+  ASSERT_TRUE(fml::FileExists(sksl_dir, PackedCacheFile::kFileName));
+
+  value = cache->load(*key);
+  ASSERT_NE(value, nullptr);
+  CheckTextSkData(value, "x");
+
+  auto sksls = cache->LoadSkSLs();
+  ASSERT_EQ(sksls.size(), 1u);
+  CheckTextSkData(sksls[0].first, "B");
+  CheckTextSkData(sksls[0].second, "y");
+
+  // Cleanup
+  cache->RemoveWorkerTaskRunner(worker.GetTaskRunner());
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(ShellTest, CanCompactPersistentCacheFromSettings) {
+  fml::ScopedTemporaryDirectory base_dir;
+  ASSERT_TRUE(base_dir.fd().is_valid());
+  auto cache_dir = fml::CreateDirectory(
+      base_dir.fd(),
+      {"flutter_engine", GetFlutterEngineVersion(), "skia", GetSkiaVersion()},
+      fml::FilePermission::kReadWrite);
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  // Generate a cache in the layout of older versions. "IE" is the Base32
+  // encoding of "A".
+  ASSERT_TRUE(fml::WriteAtomically(cache_dir, "IE", fml::DataMapping("x")));
+
+  // Run engine with compact_persistent_cache to pack the legacy file.
+  auto settings = CreateSettingsForFixture();
+  settings.compact_persistent_cache = true;
+  auto config = RunConfiguration::InferFromSettings(settings);
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  RunEngine(shell.get(), std::move(config));
+
+  ASSERT_FALSE(fml::FileExists(cache_dir, "IE"));
+  ASSERT_TRUE(fml::FileExists(cache_dir, PackedCacheFile::kFileName));
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+  DestroyShell(std::move(shell));
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -37,10 +37,29 @@ namespace flutter {
 // used within this interval.
 static constexpr std::chrono::milliseconds kSkiaCleanupExpiration(15000);
 
+// The time spent compiling SkSL shaders in a raster task once the startup
+// shaders are compiled. This keeps the frames drawn in between on time.
+static constexpr fml::TimeDelta kSkSLPrecompileBatchDuration =
+    fml::TimeDelta::FromMilliseconds(4);
+
+// How long the first frame waits for the SkSL shaders to be read from the
+// persistent cache. Drawing it without them compiles its shaders on demand,
+// which is still better than holding it back for a slow disk.
+static constexpr fml::TimeDelta kSkSLStartupLoadTimeout =
+    fml::TimeDelta::FromMilliseconds(100);
+
+static SkSLPrecompiler::CompileCallback MakeSkSLCompiler(
+    GrDirectContext* context) {
+  return [context](const SkData& key, const SkData& sksl) {
+    return context->precompileShader(key, sksl);
+  };
+}
+
 Rasterizer::Rasterizer(Delegate& delegate)
     : delegate_(delegate),
       compositor_context_(std::make_unique<flutter::CompositorContext>(
-          delegate.GetFrameBudget())),
+          delegate.GetFrameBudget(),
+          delegate.GetSettings().raster_cache_max_bytes)),
       user_override_resource_cache_bytes_(false),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
@@ -95,12 +114,22 @@ void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
       }
     });
   }
+  if (tiled_raster_task_runner_) {
+    surface_->EnableTiledRasterization(tiled_raster_task_runner_);
+  }
+  if (sksl_precompiler_) {
+    // The shaders compiled so far belong to the context of the previous
+    // surface.
+    sksl_precompiler_->Reset();
+    PrecompileSkSLs();
+  }
 }
 
 void Rasterizer::Teardown() {
   compositor_context_->OnGrContextDestroyed();
   surface_.reset();
   last_layer_tree_.reset();
+  last_paint_regions_.reset();
 
   if (raster_thread_merger_.get() != nullptr &&
       raster_thread_merger_.get()->IsMerged()) {
@@ -110,6 +139,64 @@ void Rasterizer::Teardown() {
   }
 }
 
+void Rasterizer::SetSkSLPrecompiler(
+    std::shared_ptr<SkSLPrecompiler> precompiler) {
+  sksl_precompiler_ = std::move(precompiler);
+  PrecompileSkSLs();
+}
+
+void Rasterizer::EnableTiledRasterization(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {
+  tiled_raster_task_runner_ = std::move(worker_task_runner);
+  if (surface_) {
+    surface_->EnableTiledRasterization(tiled_raster_task_runner_);
+  }
+}
+
+void Rasterizer::PrecompileSkSLs() {
+  if (sksl_precompile_scheduled_ || !sksl_precompiler_ ||
+      !sksl_precompiler_->IsLoaded() || !surface_) {
+    return;
+  }
+  sksl_precompile_scheduled_ = true;
+  delegate_.GetTaskRunners().GetRasterTaskRunner()->PostTask(
+      [rasterizer = weak_factory_.GetWeakPtr()]() {
+        if (rasterizer) {
+          rasterizer->CompileSkSLBatch();
+        }
+      });
+}
+
+void Rasterizer::CompileSkSLBatch() {
+  sksl_precompile_scheduled_ = false;
+  if (!sksl_precompiler_ || !surface_ || !surface_->GetContext()) {
+    return;
+  }
+  auto context_switch = surface_->MakeRenderContextCurrent();
+  if (!context_switch->GetResult()) {
+    return;
+  }
+  const bool has_pending_shaders = sksl_precompiler_->CompileUntil(
+      MakeSkSLCompiler(surface_->GetContext()),
+      fml::TimePoint::Now() + kSkSLPrecompileBatchDuration);
+  if (has_pending_shaders) {
+    PrecompileSkSLs();
+  }
+}
+
+void Rasterizer::PrecompileStartupSkSLs() {
+  if (!sksl_precompiler_ || !surface_ || !surface_->GetContext() ||
+      !sksl_precompiler_->HasPendingStartupShaders()) {
+    return;
+  }
+  auto context_switch = surface_->MakeRenderContextCurrent();
+  if (!context_switch->GetResult()) {
+    return;
+  }
+  sksl_precompiler_->CompileStartupShaders(
+      MakeSkSLCompiler(surface_->GetContext()), kSkSLStartupLoadTimeout);
+}
+
 void Rasterizer::EnableThreadMergerIfNeeded() {
   if (raster_thread_merger_) {
     raster_thread_merger_->Enable();
@@ -123,6 +210,9 @@ void Rasterizer::DisableThreadMergerIfNeeded() {
 }
 
 void Rasterizer::NotifyLowMemoryWarning() const {
+  // Cached rasterizations of content that is not on screen can be recreated
+  // when it comes back, so drop them before asking Skia to free resources.
+  compositor_context_->raster_cache().EvictUnusedEntries();
   if (!surface_) {
     FML_DLOG(INFO)
         << "Rasterizer::NotifyLowMemoryWarning called with no surface.";
@@ -289,6 +379,12 @@ sk_sp<SkImage> Rasterizer::MakeRasterSnapshot(sk_sp<SkPicture> picture,
                               });
 }
 
+sk_sp<SkImage> Rasterizer::MakeRasterSnapshot(
+    std::function<void(SkCanvas*)> draw_callback,
+    SkISize picture_size) {
+  return DoMakeRasterSnapshot(picture_size, std::move(draw_callback));
+}
+
 sk_sp<SkImage> Rasterizer::ConvertToRasterImage(sk_sp<SkImage> image) {
   TRACE_EVENT0("flutter", __FUNCTION__);
 
@@ -328,6 +424,10 @@ RasterStatus Rasterizer::DoDraw(
   timing.Set(FrameTiming::kBuildFinish, layer_tree->build_finish());
   timing.Set(FrameTiming::kRasterStart, fml::TimePoint::Now());
 
+  // Draw the first frame with the shaders it is likely to need already
+  // compiled instead of compiling them one by one while drawing.
+  PrecompileStartupSkSLs();
+
   PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
   persistent_cache->ResetStoredNewShaders();
 
@@ -346,6 +446,7 @@ RasterStatus Rasterizer::DoDraw(
         ScreenshotLastLayerTree(ScreenshotType::SkiaPicture, false);
     persistent_cache->DumpSkp(*screenshot.data);
   }
+  persistent_cache->MarkFrameRasterized();
 
   // TODO(liyuqian): in Fuchsia, the rasterization doesn't finish when
   // Rasterizer::DoDraw finishes. Future work is needed to adapt the timestamp
@@ -354,6 +455,12 @@ RasterStatus Rasterizer::DoDraw(
   timing.Set(FrameTiming::kRasterFinish, raster_finish_time);
   delegate_.OnFrameRasterized(timing);
 
+  // Captured after the frame timing, which it would otherwise add to.
+  if (layer_tree_capture_ && raster_status == RasterStatus::kSuccess &&
+      layer_tree_capture_->frame_count() < layer_tree_capture_max_frames_) {
+    layer_tree_capture_->WriteLayerTree(*last_layer_tree_);
+  }
+
 // SceneDisplayLag events are disabled on Fuchsia.
 // see: https://github.com/flutter/flutter/issues/56598
 #if !defined(OS_FUCHSIA)
@@ -459,7 +566,18 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
-    RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+    // Only the root surface is tracked, so partial repaint isn't available
+    // when an external view embedder composites the frame.
+    FrameDamage frame_damage;
+    const auto& existing_damage = frame->framebuffer_info().existing_damage;
+    if (existing_damage.has_value() && last_paint_regions_.has_value()) {
+      frame_damage.prior_paint_regions = &last_paint_regions_.value();
+      frame_damage.additional_damage = existing_damage.value();
+    }
+
+    RasterStatus raster_status = compositor_frame->Raster(
+        layer_tree, false,
+        external_view_embedder == nullptr ? &frame_damage : nullptr);
     if (raster_status == RasterStatus::kFailed ||
         raster_status == RasterStatus::kSkipAndRetry) {
       return raster_status;
@@ -468,8 +586,17 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
       FML_DCHECK(!frame->IsSubmitted());
       external_view_embedder->SubmitFrame(surface_->GetContext(),
                                           std::move(frame));
+      last_paint_regions_.reset();
     } else {
-      frame->Submit();
+      frame->set_submit_info(
+          {frame_damage.frame_damage, frame_damage.buffer_damage});
+      // The regions are only kept for frames whose layer tree becomes
+      // |last_layer_tree_|, which keeps the objects they refer to alive.
+      if (frame->Submit() && raster_status == RasterStatus::kSuccess) {
+        last_paint_regions_ = std::move(frame_damage.paint_regions);
+      } else {
+        last_paint_regions_.reset();
+      }
     }
 
     FireNextFrameCallbackIfPresent();
@@ -514,6 +641,27 @@ static sk_sp<SkData> ScreenshotLayerTreeAsPicture(
   return recorder.finishRecordingAsPicture()->serialize(&procs);
 }
 
+void Rasterizer::StartLayerTreeCapture(size_t max_frames) {
+  SkSerialProcs procs = {0};
+#if defined(OS_FUCHSIA)
+  procs.fImageProc = SerializeImageWithoutData;
+#else
+  procs.fTypefaceProc = SerializeTypefaceWithData;
+#endif
+  layer_tree_capture_ = std::make_unique<LayerTreeCaptureWriter>(procs);
+  layer_tree_capture_max_frames_ = max_frames;
+}
+
+sk_sp<SkData> Rasterizer::StopLayerTreeCapture(size_t* frame_count) {
+  if (!layer_tree_capture_) {
+    return nullptr;
+  }
+  *frame_count = layer_tree_capture_->frame_count();
+  sk_sp<SkData> capture = layer_tree_capture_->Finish();
+  layer_tree_capture_.reset();
+  return capture;
+}
+
 static sk_sp<SkSurface> CreateSnapshotSurface(GrDirectContext* surface_context,
                                               const SkISize& size) {
   const auto image_info = SkImageInfo::MakeN32Premul(
@@ -11,6 +11,7 @@
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/layer_tree_capture.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/surface.h"
 #include "flutter/fml/closure.h"
@@ -22,6 +23,7 @@
 #include "flutter/fml/time/time_point.h"
 #include "flutter/lib/ui/snapshot_delegate.h"
 #include "flutter/shell/common/pipeline.h"
+#include "flutter/shell/common/sksl_precompiler.h"
 
 namespace flutter {
 
@@ -71,6 +73,9 @@ class Rasterizer final : public SnapshotDelegate {
     /// Time limit for a smooth frame. See `Engine::GetDisplayRefreshRate`.
     virtual fml::Milliseconds GetFrameBudget() = 0;
 
+    /// The settings of the shell, which configure the raster cache.
+    virtual const Settings& GetSettings() const = 0;
+
     /// Target time for the latest frame. See also `Shell::OnAnimatorBeginFrame`
     /// for when this time gets updated.
     virtual fml::TimePoint GetLatestFrameTargetTime() const = 0;
@@ -153,6 +158,37 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   void NotifyLowMemoryWarning() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the precompiler whose shaders are compiled with the
+  ///             context of the on-screen render surface. The startup shaders
+  ///             are compiled before the next frame is drawn and the others
+  ///             in batches that are posted to the raster task runner.
+  ///
+  /// @param[in]  precompiler  The precompiler. May be `nullptr`.
+  ///
+  void SetSkSLPrecompiler(std::shared_ptr<SkSLPrecompiler> precompiler);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Posts a task that compiles a batch of the pending shaders of
+  ///             the SkSL precompiler. Each batch posts a task for the next
+  ///             one until no shaders are left. This is called when the
+  ///             precompiler finished loading the shaders and does nothing
+  ///             without an on-screen render surface.
+  ///
+  void PrecompileSkSLs();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Lets the on-screen render surface, and the surfaces that
+  ///             replace it later, rasterize their frames in tiles on the
+  ///             workers of the given task runner. Only surfaces that render
+  ///             in software make use of it.
+  ///
+  /// @param[in]  worker_task_runner  The task runner of the concurrent
+  ///                                 workers.
+  ///
+  void EnableTiledRasterization(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner);
+
   //----------------------------------------------------------------------------
   /// @brief      Gets a weak pointer to the rasterizer. The rasterizer may only
   ///             be accessed on the GPU task runner.
@@ -326,6 +362,28 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   Screenshot ScreenshotLastLayerTree(ScreenshotType type, bool base64_encode);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Starts serializing the layer trees of the frames rasterized
+  ///             from now on, so that they can be replayed offline by
+  ///             `flow_replay_benchmarks`. A capture that is already running
+  ///             is discarded.
+  ///
+  /// @param[in]  max_frames  The number of frames after which the capture
+  ///                         stops adding frames.
+  ///
+  void StartLayerTreeCapture(size_t max_frames);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Stops the capture started by `StartLayerTreeCapture`.
+  ///
+  /// @param[out] frame_count  The number of captured frames.
+  ///
+  /// @return     The capture, or `nullptr` if none was started.
+  ///
+  /// @see        `LayerTreeCaptureReader`
+  ///
+  sk_sp<SkData> StopLayerTreeCapture(size_t* frame_count);
+
   //----------------------------------------------------------------------------
   /// @brief      Sets a callback that will be executed when the next layer tree
   ///             in rendered to the on-screen surface. This is used by
@@ -421,6 +479,11 @@ class Rasterizer final : public SnapshotDelegate {
   std::unique_ptr<flutter::CompositorContext> compositor_context_;
   // This is the last successfully rasterized layer tree.
   std::unique_ptr<flutter::LayerTree> last_layer_tree_;
+  // The regions painted by the last frame submitted to the surface. Used to
+  // only repaint what changed on surfaces that retain their contents. This
+  // always describes |last_layer_tree_| which must be kept alive along with it
+  // since the regions may identify content by the address of its objects.
+  std::optional<PaintRegionList> last_paint_regions_;
   // Set when we need attempt to rasterize the layer tree again. This layer_tree
   // has not successfully rasterized. This can happen due to the change in the
   // thread configuration. This will be inserted to the front of the pipeline.
@@ -429,12 +492,26 @@ class Rasterizer final : public SnapshotDelegate {
   bool user_override_resource_cache_bytes_;
   std::optional<size_t> max_cache_bytes_;
   fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
+  std::shared_ptr<SkSLPrecompiler> sksl_precompiler_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> tiled_raster_task_runner_;
+  std::unique_ptr<LayerTreeCaptureWriter> layer_tree_capture_;
+  size_t layer_tree_capture_max_frames_ = 0;
+  bool sksl_precompile_scheduled_ = false;
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
 
+  void CompileSkSLBatch();
+
+  void PrecompileStartupSkSLs();
+
   // |SnapshotDelegate|
   sk_sp<SkImage> MakeRasterSnapshot(sk_sp<SkPicture> picture,
                                     SkISize picture_size) override;
 
+  // |SnapshotDelegate|
+  sk_sp<SkImage> MakeRasterSnapshot(
+      std::function<void(SkCanvas*)> draw_callback,
+      SkISize picture_size) override;
+
   // |SnapshotDelegate|
   sk_sp<SkImage> ConvertToRasterImage(sk_sp<SkImage> image) override;
 
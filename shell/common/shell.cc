@@ -6,6 +6,7 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <cstdlib>
 #include <memory>
 #include <sstream>
 #include <vector>
@@ -30,6 +31,8 @@
 #include "rapidjson/writer.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 #include "third_party/skia/include/core/SkGraphics.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPixmap.h"
 #include "third_party/skia/include/utils/SkBase64.h"
 #include "third_party/tonic/common/log.h"
 
@@ -380,6 +383,16 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kStartLayerTreeCaptureExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolStartLayerTreeCapture, this,
+                    std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kStopLayerTreeCaptureExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolStopLayerTreeCapture, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -574,6 +587,24 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
     PersistentCache::GetCacheForProcess()->Purge();
   }
 
+  if (settings_.compact_persistent_cache) {
+    PersistentCache::GetCacheForProcess()->Compact();
+  }
+
+  PrecompileSkSLs();
+
+  if (settings_.enable_async_raster_cache) {
+    EnableAsyncRasterCache();
+  }
+
+  if (settings_.enable_tiled_software_rendering) {
+    EnableTiledSoftwareRendering();
+  }
+
+  if (settings_.timer_slack.count() > 0) {
+    SetTimerSlack();
+  }
+
   // TODO(gw280): The WeakPtr here asserts that we are derefing it on the
   // same thread as it was created on. Shell is constructed on the platform
   // thread but we need to call into the Engine on the UI thread, so we need
@@ -585,6 +616,101 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   return true;
 }
 
+void Shell::EnableAsyncRasterCache() {
+  // Images rasterized by the workers are uploaded on the IO thread using the
+  // resource context, whose textures are shared with the onscreen context.
+  // Without a resource context (e.g. with software rendering) the CPU backed
+  // images are cached as is.
+  auto upload = [io_manager = io_manager_->GetWeakPtr()](
+                    sk_sp<SkImage> image) -> sk_sp<SkImage> {
+    if (!io_manager || !io_manager->GetResourceContext()) {
+      return image;
+    }
+    SkPixmap pixmap;
+    if (!image->peekPixels(&pixmap)) {
+      return image;
+    }
+    sk_sp<SkImage> result = image;
+    io_manager->GetIsGpuDisabledSyncSwitch()->Execute(
+        fml::SyncSwitch::Handlers().SetIfFalse(
+            [&result, &pixmap, context = io_manager->GetResourceContext()] {
+              sk_sp<SkImage> texture_image =
+                  SkImage::MakeCrossContextFromPixmap(
+                      context.get(),  // context
+                      pixmap,         // pixmap
+                      false,          // buildMips
+                      true            // limitToMaxTextureSize
+                  );
+              if (texture_image) {
+                result = std::move(texture_image);
+              }
+            }));
+    return result;
+  };
+
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetRasterTaskRunner(),
+      [rasterizer = weak_rasterizer_,
+       worker_task_runner = vm_->GetConcurrentWorkerTaskRunner(),
+       io_task_runner = task_runners_.GetIOTaskRunner(), upload]() {
+        if (rasterizer) {
+          rasterizer->compositor_context()
+              ->raster_cache()
+              .EnableAsyncRasterization(worker_task_runner, io_task_runner,
+                                        upload);
+        }
+      });
+}
+
+void Shell::EnableTiledSoftwareRendering() {
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetRasterTaskRunner(),
+      [rasterizer = weak_rasterizer_,
+       worker_task_runner = vm_->GetConcurrentWorkerTaskRunner()]() {
+        if (rasterizer) {
+          rasterizer->EnableTiledRasterization(worker_task_runner);
+        }
+      });
+}
+
+void Shell::SetTimerSlack() {
+  const auto slack =
+      fml::TimeDelta::FromMicroseconds(settings_.timer_slack.count());
+  for (const auto& task_runner :
+       {task_runners_.GetUITaskRunner(), task_runners_.GetIOTaskRunner()}) {
+    fml::TaskRunner::RunNowOrPostTask(task_runner, [slack]() {
+      // Embedders may run the task runners on threads of their own.
+      if (fml::MessageLoop::IsInitializedForCurrentThread()) {
+        fml::MessageLoop::GetCurrent().SetTimerSlack(slack);
+      }
+    });
+  }
+}
+
+void Shell::PrecompileSkSLs() {
+  auto raster_task_runner = task_runners_.GetRasterTaskRunner();
+  sksl_precompiler_ = SkSLPrecompiler::Create(
+      vm_->GetConcurrentWorkerTaskRunner(),
+      [rasterizer = weak_rasterizer_, raster_task_runner]() {
+        raster_task_runner->PostTask([rasterizer]() {
+          if (rasterizer) {
+            rasterizer->PrecompileSkSLs();
+          }
+        });
+      });
+  fml::TaskRunner::RunNowOrPostTask(
+      raster_task_runner,
+      [rasterizer = weak_rasterizer_, precompiler = sksl_precompiler_]() {
+        if (rasterizer) {
+          rasterizer->SetSkSLPrecompiler(precompiler);
+        }
+      });
+}
+
+size_t Shell::GetPendingSkSLPrecompileCount() const {
+  return sksl_precompiler_ ? sksl_precompiler_->GetPendingCount() : 0;
+}
+
 const Settings& Shell::GetSettings() const {
   return settings_;
 }
@@ -1087,7 +1213,8 @@ void Shell::HandleEngineSkiaMessage(fml::RefPtr<PlatformMessage> message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return;
   auto root = document.GetObject();
@@ -1478,6 +1605,60 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+// Service protocol handler
+bool Shell::OnServiceProtocolStartLayerTreeCapture(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+
+  // Ten seconds of frames at 60Hz.
+  size_t max_frames = 600;
+  auto max_frames_param = params.find("maxFrames");
+  if (max_frames_param != params.end()) {
+    const std::string value(max_frames_param->second);
+    char* end = nullptr;
+    max_frames = std::strtoul(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || max_frames == 0) {
+      ServiceProtocolParameterError(
+          response, "'maxFrames' parameter must be a positive integer.");
+      return false;
+    }
+  }
+
+  rasterizer_->StartLayerTreeCapture(max_frames);
+  response->SetObject();
+  response->AddMember("type", "Success", response->GetAllocator());
+  return true;
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolStopLayerTreeCapture(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+  size_t frame_count = 0;
+  sk_sp<SkData> capture = rasterizer_->StopLayerTreeCapture(&frame_count);
+  if (!capture) {
+    ServiceProtocolFailureError(response,
+                                "No layer tree capture was started.");
+    return false;
+  }
+
+  size_t b64_size = SkBase64::Encode(capture->data(), capture->size(), nullptr);
+  sk_sp<SkData> b64_data = SkData::MakeUninitialized(b64_size);
+  SkBase64::Encode(capture->data(), capture->size(), b64_data->writable_data());
+
+  response->SetObject();
+  auto& allocator = response->GetAllocator();
+  response->AddMember("type", "LayerTreeCapture", allocator);
+  response->AddMember<uint64_t>("frameCount", frame_count, allocator);
+  rapidjson::Value capture_value;
+  capture_value.SetString(static_cast<const char*>(b64_data->data()),
+                          b64_data->size(), allocator);
+  response->AddMember("capture", capture_value, allocator);
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -234,7 +234,7 @@ class Shell final : public PlatformView::Delegate,
   //------------------------------------------------------------------------------
   /// @return     The settings used to launch this shell.
   ///
-  const Settings& GetSettings() const;
+  const Settings& GetSettings() const override;
 
   //------------------------------------------------------------------------------
   /// @brief      If callers wish to interact directly with any shell
@@ -369,6 +369,15 @@ class Shell final : public PlatformView::Delegate,
   ///
   DartVM* GetDartVM();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Gets the number of SkSL shaders of the persistent cache that
+  ///             still have to be precompiled. This is zero until the shaders
+  ///             have been loaded and once all of them are compiled.
+  ///
+  /// @return     The number of shaders pending precompilation.
+  ///
+  size_t GetPendingSkSLPrecompileCount() const;
+
  private:
   using ServiceProtocolHandler =
       std::function<bool(const ServiceProtocol::Handler::ServiceProtocolMap&,
@@ -384,6 +393,7 @@ class Shell final : public PlatformView::Delegate,
   std::unique_ptr<Rasterizer> rasterizer_;       // on GPU task runner
   std::unique_ptr<ShellIOManager> io_manager_;   // on IO task runner
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
+  std::shared_ptr<SkSLPrecompiler> sksl_precompiler_;
 
   fml::WeakPtr<Engine> weak_engine_;  // to be shared across threads
   fml::TaskRunnerAffineWeakPtr<Rasterizer>
@@ -444,6 +454,22 @@ class Shell final : public PlatformView::Delegate,
              std::unique_ptr<Rasterizer> rasterizer,
              std::unique_ptr<ShellIOManager> io_manager);
 
+  // Makes the rasterizer's raster cache rasterize pictures on the concurrent
+  // workers. See |Settings::enable_async_raster_cache|.
+  void EnableAsyncRasterCache();
+
+  // Makes software surfaces rasterize their frames in tiles on the concurrent
+  // workers. See |Settings::enable_tiled_software_rendering|.
+  void EnableTiledSoftwareRendering();
+
+  // Lets the message loops of the UI and IO threads coalesce the wakeups of
+  // their timers. See |Settings::timer_slack|.
+  void SetTimerSlack();
+
+  // Loads the SkSLs of the persistent cache on the concurrent workers and
+  // hands them to the rasterizer, which compiles them for its context.
+  void PrecompileSkSLs();
+
   void ReportTimings();
 
   // |PlatformView::Delegate|
@@ -596,6 +622,22 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  //
+  // Accepts an optional "maxFrames" parameter that bounds the number of
+  // captured frames.
+  bool OnServiceProtocolStartLayerTreeCapture(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  //
+  // The returned capture is base64 encoded. Decode it before storing it to a
+  // file for flow_replay_benchmarks.
+  bool OnServiceProtocolStopLayerTreeCapture(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // For accessing the Shell via the raster thread, necessary for various
   // rasterizer callbacks.
   std::unique_ptr<fml::TaskRunnerAffineWeakPtrFactory<Shell>> weak_factory_gpu_;
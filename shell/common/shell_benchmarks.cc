@@ -5,7 +5,11 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/elf_loader.h"
@@ -15,7 +19,8 @@ namespace flutter {
 
 static void StartupAndShutdownShell(benchmark::State& state,
                                     bool measure_startup,
-                                    bool measure_shutdown) {
+                                    bool measure_shutdown,
+                                    size_t* pending_sksl_count = nullptr) {
   auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
                                        fml::FilePermission::kRead);
   std::unique_ptr<Shell> shell;
@@ -78,6 +83,10 @@ static void StartupAndShutdownShell(benchmark::State& state,
     latch.Wait();
   }
 
+  if (pending_sksl_count) {
+    *pending_sksl_count = shell->GetPendingSkSLPrecompileCount();
+  }
+
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_shutdown);
     // Shutdown must occur synchronously on the platform thread.
@@ -103,6 +112,50 @@ static void BM_ShellInitialization(benchmark::State& state) {
 
 BENCHMARK(BM_ShellInitialization);
 
+// Fills the SkSL cache of a new persistent cache in |cache_dir| with |count|
+// synthetic shaders.
+static void PopulateSkSLCache(const fml::ScopedTemporaryDirectory& cache_dir,
+                              int64_t count) {
+  PersistentCache::SetCacheDirectoryPath(cache_dir.path());
+  PersistentCache::SetCacheSkSL(true);
+  PersistentCache::ResetCacheForProcess();
+
+  fml::Thread worker("io.flutter.bench.sksl");
+  auto* persistent_cache = PersistentCache::GetCacheForProcess();
+  persistent_cache->AddWorkerTaskRunner(worker.GetTaskRunner());
+  const std::string sksl(4096, 'x');
+  for (int64_t i = 0; i < count; i++) {
+    const std::string key = "shader" + std::to_string(i);
+    persistent_cache->store(*SkData::MakeWithCopy(key.data(), key.size()),
+                            *SkData::MakeWithCopy(sksl.data(), sksl.size()));
+  }
+  fml::AutoResetWaitableEvent latch;
+  worker.GetTaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+  persistent_cache->RemoveWorkerTaskRunner(worker.GetTaskRunner());
+  PersistentCache::ResetCacheForProcess();
+}
+
+// Loading the SkSLs of the persistent cache should not delay the startup of
+// the shell. The shaders pending precompilation once the shell is set up are
+// reported as a counter.
+static void BM_ShellInitializationWithSkSLCache(benchmark::State& state) {
+  fml::ScopedTemporaryDirectory cache_dir;
+  PopulateSkSLCache(cache_dir, state.range(0));
+
+  size_t pending_sksl_count = 0;
+  while (state.KeepRunning()) {
+    StartupAndShutdownShell(state, true, false, &pending_sksl_count);
+  }
+  state.counters["PendingSkSLs"] = pending_sksl_count;
+
+  PersistentCache::SetCacheSkSL(false);
+  PersistentCache::SetCacheDirectoryPath("");
+  PersistentCache::ResetCacheForProcess();
+}
+
+BENCHMARK(BM_ShellInitializationWithSkSLCache)->Arg(0)->Arg(100)->Arg(1000);
+
 static void BM_ShellShutdown(benchmark::State& state) {
   while (state.KeepRunning()) {
     StartupAndShutdownShell(state, false, true);
@@ -1937,6 +1937,27 @@ static sk_sp<SkPicture> MakeSizedPicture(int width, int height) {
   return recorder.finishRecordingAsPicture();
 }
 
+TEST_F(ShellTest, RasterCacheBudgetComesFromSettings) {
+  Settings settings = CreateSettingsForFixture();
+  settings.raster_cache_max_bytes = 1024 * 1024;
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+
+  size_t max_bytes = 0;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetRasterTaskRunner(), [&]() {
+        max_bytes = shell->GetRasterizer()
+                        ->compositor_context()
+                        ->raster_cache()
+                        .max_bytes();
+        latch.Signal();
+      });
+  latch.Wait();
+  EXPECT_EQ(max_bytes, 1024u * 1024u);
+
+  DestroyShell(std::move(shell));
+}
+
 TEST_F(ShellTest, OnServiceProtocolEstimateRasterCacheMemoryWorks) {
   Settings settings = CreateSettingsForFixture();
   std::unique_ptr<Shell> shell = CreateShell(settings);
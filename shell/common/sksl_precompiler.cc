@@ -0,0 +1,167 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/sksl_precompiler.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+std::shared_ptr<SkSLPrecompiler> SkSLPrecompiler::Create(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    fml::closure on_loaded,
+    Loader loader) {
+  auto precompiler = std::shared_ptr<SkSLPrecompiler>(new SkSLPrecompiler());
+  worker_task_runner->PostTask(
+      [weak_precompiler = std::weak_ptr<SkSLPrecompiler>(precompiler),
+       on_loaded = std::move(on_loaded), loader = std::move(loader)]() {
+        // The shell may already be gone.
+        if (weak_precompiler.expired()) {
+          return;
+        }
+        Shaders shaders = loader();
+        if (auto precompiler = weak_precompiler.lock()) {
+          precompiler->SetShaders(std::move(shaders));
+          if (on_loaded) {
+            on_loaded();
+          }
+        }
+      },
+      fml::ConcurrentTaskPriority::kHigh);
+  return precompiler;
+}
+
+SkSLPrecompiler::SkSLPrecompiler() = default;
+
+SkSLPrecompiler::~SkSLPrecompiler() = default;
+
+SkSLPrecompiler::Shaders SkSLPrecompiler::LoadFromPersistentCache() {
+  TRACE_EVENT0("flutter", "SkSLPrecompiler::LoadFromPersistentCache");
+  PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
+  Shaders shaders;
+  shaders.sksls = persistent_cache->LoadSkSLs();
+
+  const auto startup_keys = persistent_cache->LoadStartupShaderKeys();
+  if (startup_keys.empty()) {
+    shaders.startup_count = shaders.sksls.size();
+    return shaders;
+  }
+  auto startup_end = std::stable_partition(
+      shaders.sksls.begin(), shaders.sksls.end(),
+      [&startup_keys](const PersistentCache::SkSLCache& sksl) {
+        return startup_keys.count(
+                   std::string(static_cast<const char*>(sksl.first->data()),
+                               sksl.first->size())) > 0;
+      });
+  shaders.startup_count = startup_end - shaders.sksls.begin();
+  return shaders;
+}
+
+void SkSLPrecompiler::SetShaders(Shaders shaders) {
+  {
+    std::scoped_lock lock(mutex_);
+    shaders_ = std::move(shaders);
+    shaders_.startup_count =
+        std::min(shaders_.startup_count, shaders_.sksls.size());
+    loaded_ = true;
+  }
+  loaded_condition_.notify_all();
+  TraceStatsToTimeline();
+}
+
+bool SkSLPrecompiler::IsLoaded() const {
+  std::scoped_lock lock(mutex_);
+  return loaded_;
+}
+
+size_t SkSLPrecompiler::GetPendingCount() const {
+  std::scoped_lock lock(mutex_);
+  if (!loaded_) {
+    return 0;
+  }
+  return shaders_.sksls.size() - next_shader_;
+}
+
+bool SkSLPrecompiler::HasPendingStartupShaders() const {
+  std::scoped_lock lock(mutex_);
+  return !loaded_ || next_shader_ < shaders_.startup_count;
+}
+
+bool SkSLPrecompiler::CompileUntil(const CompileCallback& compile,
+                                   fml::TimePoint deadline) {
+  if (!IsLoaded()) {
+    return true;
+  }
+  TRACE_EVENT0("flutter", "SkSLPrecompiler::CompileUntil");
+  while (fml::TimePoint::Now() < deadline &&
+         CompileNext(compile, /*startup_only=*/false)) {
+  }
+  TraceStatsToTimeline();
+  return GetPendingCount() > 0;
+}
+
+bool SkSLPrecompiler::CompileStartupShaders(const CompileCallback& compile,
+                                            fml::TimeDelta load_timeout) {
+  {
+    std::unique_lock lock(mutex_);
+    if (!loaded_ && !load_timed_out_) {
+      TRACE_EVENT0("flutter", "SkSLPrecompiler::WaitForLoad");
+      load_timed_out_ = !loaded_condition_.wait_for(
+          lock, std::chrono::nanoseconds(load_timeout.ToNanoseconds()),
+          [this]() { return loaded_; });
+    }
+    if (!loaded_) {
+      return false;
+    }
+  }
+  TRACE_EVENT0("flutter", "SkSLPrecompiler::CompileStartupShaders");
+  while (CompileNext(compile, /*startup_only=*/true)) {
+  }
+  TraceStatsToTimeline();
+  return true;
+}
+
+void SkSLPrecompiler::Reset() {
+  std::scoped_lock lock(mutex_);
+  next_shader_ = 0;
+  compiled_count_ = 0;
+}
+
+bool SkSLPrecompiler::CompileNext(const CompileCallback& compile,
+                                  bool startup_only) {
+  PersistentCache::SkSLCache sksl;
+  {
+    std::scoped_lock lock(mutex_);
+    const size_t end =
+        startup_only ? shaders_.startup_count : shaders_.sksls.size();
+    if (!loaded_ || next_shader_ >= end) {
+      return false;
+    }
+    sksl = shaders_.sksls[next_shader_++];
+  }
+  // Compiling can take milliseconds, so don't block the other methods.
+  const bool compiled = compile(*sksl.first, *sksl.second);
+  std::scoped_lock lock(mutex_);
+  if (compiled) {
+    compiled_count_++;
+  }
+  if (next_shader_ == shaders_.sksls.size()) {
+    FML_LOG(INFO) << "Found " << shaders_.sksls.size()
+                  << " SkSL shaders; precompiled " << compiled_count_;
+  }
+  return true;
+}
+
+void SkSLPrecompiler::TraceStatsToTimeline() const {
+  FML_TRACE_COUNTER("flutter", "SkSLPrecompiler",
+                    reinterpret_cast<int64_t>(this), "PendingShaders",
+                    GetPendingCount());
+}
+
+}  // namespace flutter
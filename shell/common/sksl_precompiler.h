@@ -0,0 +1,148 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_SKSL_PRECOMPILER_H_
+#define FLUTTER_SHELL_COMMON_SKSL_PRECOMPILER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/shell/common/persistent_cache.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Compiles the SkSL shaders of the |PersistentCache| during startup.
+///
+/// Reading and decoding the shaders happens on a concurrent worker while the
+/// rest of the shell starts up. Compiling them needs the `GrDirectContext`
+/// that renders the frames since Skia caches programs per context, so the
+/// rasterizer compiles them in small batches on the raster thread.
+///
+/// The shaders used during the first frames of previous runs (see
+/// |PersistentCache::MarkFrameRasterized|) are compiled first. Only those
+/// have to be compiled before the first frame is drawn; the others are
+/// compiled in batches between the following frames. Without any record of
+/// previous runs, all shaders are compiled before the first frame.
+///
+/// This class is thread-safe. The compile methods must only be called on the
+/// thread of the context the shaders are compiled for.
+///
+class SkSLPrecompiler {
+ public:
+  struct Shaders {
+    /// The shaders to compile, with the startup shaders first.
+    std::vector<PersistentCache::SkSLCache> sksls;
+    /// The number of shaders at the start of |sksls| that should be compiled
+    /// before the first frame.
+    size_t startup_count = 0;
+  };
+
+  using Loader = std::function<Shaders()>;
+
+  using CompileCallback =
+      std::function<bool(const SkData& key, const SkData& sksl)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a precompiler and starts loading the shaders.
+  ///
+  /// @param[in]  worker_task_runner  The task runner the shaders are loaded on.
+  /// @param[in]  on_loaded           Invoked on the worker once the shaders
+  ///                                 are loaded.
+  /// @param[in]  loader              Loads the shaders to compile.
+  ///
+  static std::shared_ptr<SkSLPrecompiler> Create(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      fml::closure on_loaded,
+      Loader loader = &LoadFromPersistentCache);
+
+  ~SkSLPrecompiler();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Loads the SkSLs of the persistent cache of the process and
+  ///             orders them by |PersistentCache::LoadStartupShaderKeys|.
+  ///
+  static Shaders LoadFromPersistentCache();
+
+  bool IsLoaded() const;
+
+  //----------------------------------------------------------------------------
+  /// @return     The number of loaded shaders that have not been compiled yet.
+  ///             This is zero until the shaders are loaded.
+  ///
+  size_t GetPendingCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @return     Whether compiling the startup shaders has not finished yet.
+  ///             This includes the time the shaders are being loaded.
+  ///
+  bool HasPendingStartupShaders() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Compiles pending shaders until the deadline passes. This does
+  ///             not wait for the shaders to be loaded.
+  ///
+  /// @return     Whether there are shaders left to compile.
+  ///
+  bool CompileUntil(const CompileCallback& compile, fml::TimePoint deadline);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Waits for the shaders to be loaded and compiles the pending
+  ///             startup shaders.
+  ///
+  ///             Once a wait has timed out, later calls do not wait anymore
+  ///             and the startup shaders are compiled by |CompileUntil| or by
+  ///             the first call made after they are loaded.
+  ///
+  /// @param[in]  compile       Compiles a single shader.
+  /// @param[in]  load_timeout  How long to wait for the shaders to be
+  ///                           loaded.
+  ///
+  /// @return     Whether the shaders were loaded in time.
+  ///
+  bool CompileStartupShaders(const CompileCallback& compile,
+                             fml::TimeDelta load_timeout);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Marks all shaders as pending again, e.g. because they have to
+  ///             be compiled for a new context.
+  ///
+  void Reset();
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable loaded_condition_;
+  bool loaded_ = false;
+  bool load_timed_out_ = false;
+  // Only modified by the loader before |loaded_| is set.
+  Shaders shaders_;
+  size_t next_shader_ = 0;
+  size_t compiled_count_ = 0;
+
+  SkSLPrecompiler();
+
+  void SetShaders(Shaders shaders);
+
+  // Compiles the shader at |next_shader_|, without holding |mutex_| while
+  // |compile| runs. Returns false if there is no shader left to compile,
+  // counting only the startup shaders if |startup_only| is true.
+  bool CompileNext(const CompileCallback& compile, bool startup_only);
+
+  void TraceStatsToTimeline() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SkSLPrecompiler);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_SKSL_PRECOMPILER_H_
@@ -0,0 +1,213 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/sksl_precompiler.h"
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr fml::TimeDelta kLoadTimeout = fml::TimeDelta::FromSeconds(10);
+
+sk_sp<SkData> MakeData(const std::string& string) {
+  return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string ToString(const SkData& data) {
+  return std::string(static_cast<const char*>(data.data()), data.size());
+}
+
+SkSLPrecompiler::Loader MakeLoader(const std::vector<std::string>& keys,
+                                   size_t startup_count) {
+  return [keys, startup_count]() {
+    SkSLPrecompiler::Shaders shaders;
+    for (const auto& key : keys) {
+      shaders.sksls.push_back({MakeData(key), MakeData("sksl " + key)});
+    }
+    shaders.startup_count = startup_count;
+    return shaders;
+  };
+}
+
+}  // namespace
+
+TEST(SkSLPrecompilerTest, CompilesStartupShadersFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent loaded;
+  auto precompiler =
+      SkSLPrecompiler::Create(loop->GetTaskRunner(), [&]() { loaded.Signal(); },
+                              MakeLoader({"a", "b", "c"}, 2));
+  loaded.Wait();
+  ASSERT_TRUE(precompiler->IsLoaded());
+  EXPECT_EQ(precompiler->GetPendingCount(), 3u);
+  EXPECT_TRUE(precompiler->HasPendingStartupShaders());
+
+  std::vector<std::string> compiled;
+  auto compile = [&compiled](const SkData& key, const SkData& sksl) {
+    EXPECT_EQ(ToString(sksl), "sksl " + ToString(key));
+    compiled.push_back(ToString(key));
+    return true;
+  };
+  precompiler->CompileStartupShaders(compile, kLoadTimeout);
+  EXPECT_EQ(compiled, std::vector<std::string>({"a", "b"}));
+  EXPECT_EQ(precompiler->GetPendingCount(), 1u);
+  EXPECT_FALSE(precompiler->HasPendingStartupShaders());
+
+  EXPECT_FALSE(precompiler->CompileUntil(
+      compile, fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(10)));
+  EXPECT_EQ(compiled, std::vector<std::string>({"a", "b", "c"}));
+  EXPECT_EQ(precompiler->GetPendingCount(), 0u);
+}
+
+TEST(SkSLPrecompilerTest, CompileUntilStopsAtTheDeadline) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent loaded;
+  auto precompiler =
+      SkSLPrecompiler::Create(loop->GetTaskRunner(), [&]() { loaded.Signal(); },
+                              MakeLoader({"a", "b", "c"}, 0));
+  loaded.Wait();
+
+  size_t compiled = 0;
+  auto compile = [&compiled](const SkData& key, const SkData& sksl) {
+    compiled++;
+    return true;
+  };
+  // A deadline in the past does not compile anything.
+  EXPECT_TRUE(precompiler->CompileUntil(compile, fml::TimePoint::Now()));
+  EXPECT_EQ(compiled, 0u);
+  EXPECT_EQ(precompiler->GetPendingCount(), 3u);
+}
+
+TEST(SkSLPrecompilerTest, CompileUntilDoesNotWaitForTheShaders) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent start_loading;
+  fml::AutoResetWaitableEvent loaded;
+  auto precompiler = SkSLPrecompiler::Create(
+      loop->GetTaskRunner(), [&]() { loaded.Signal(); },
+      [&start_loading, loader = MakeLoader({"a"}, 1)]() {
+        start_loading.Wait();
+        return loader();
+      });
+
+  size_t compiled = 0;
+  auto compile = [&compiled](const SkData& key, const SkData& sksl) {
+    compiled++;
+    return true;
+  };
+  EXPECT_FALSE(precompiler->IsLoaded());
+  EXPECT_EQ(precompiler->GetPendingCount(), 0u);
+  EXPECT_TRUE(precompiler->HasPendingStartupShaders());
+  EXPECT_TRUE(precompiler->CompileUntil(
+      compile, fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(10)));
+  EXPECT_EQ(compiled, 0u);
+
+  start_loading.Signal();
+  loaded.Wait();
+  EXPECT_FALSE(precompiler->CompileUntil(
+      compile, fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(10)));
+  EXPECT_EQ(compiled, 1u);
+}
+
+TEST(SkSLPrecompilerTest, CompileStartupShadersWaitsForTheShaders) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent start_loading;
+  auto precompiler = SkSLPrecompiler::Create(
+      loop->GetTaskRunner(), nullptr,
+      [&start_loading, loader = MakeLoader({"a", "b"}, 1)]() {
+        start_loading.Wait();
+        return loader();
+      });
+
+  std::vector<std::string> compiled;
+  start_loading.Signal();
+  precompiler->CompileStartupShaders(
+      [&compiled](const SkData& key, const SkData& sksl) {
+        compiled.push_back(ToString(key));
+        return true;
+      },
+      kLoadTimeout);
+  EXPECT_EQ(compiled, std::vector<std::string>({"a"}));
+  EXPECT_EQ(precompiler->GetPendingCount(), 1u);
+}
+
+TEST(SkSLPrecompilerTest, CompileStartupShadersStopsWaitingAtTheTimeout) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent start_loading;
+  fml::AutoResetWaitableEvent loaded;
+  auto precompiler = SkSLPrecompiler::Create(
+      loop->GetTaskRunner(), [&]() { loaded.Signal(); },
+      [&start_loading, loader = MakeLoader({"a", "b"}, 1)]() {
+        start_loading.Wait();
+        return loader();
+      });
+
+  size_t compiled = 0;
+  auto compile = [&compiled](const SkData& key, const SkData& sksl) {
+    compiled++;
+    return true;
+  };
+  EXPECT_FALSE(precompiler->CompileStartupShaders(
+      compile, fml::TimeDelta::FromMilliseconds(1)));
+  EXPECT_EQ(compiled, 0u);
+
+  // Once timed out, later calls don't wait for the shaders anymore.
+  auto start = fml::TimePoint::Now();
+  EXPECT_FALSE(precompiler->CompileStartupShaders(compile, kLoadTimeout));
+  EXPECT_LT(fml::TimePoint::Now() - start, kLoadTimeout);
+  EXPECT_TRUE(precompiler->HasPendingStartupShaders());
+
+  start_loading.Signal();
+  loaded.Wait();
+  EXPECT_TRUE(precompiler->CompileStartupShaders(compile, kLoadTimeout));
+  EXPECT_EQ(compiled, 1u);
+  EXPECT_FALSE(precompiler->HasPendingStartupShaders());
+}
+
+TEST(SkSLPrecompilerTest, ResetMarksAllShadersAsPending) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto precompiler = SkSLPrecompiler::Create(loop->GetTaskRunner(), nullptr,
+                                             MakeLoader({"a", "b"}, 2));
+  size_t compiled = 0;
+  auto compile = [&compiled](const SkData& key, const SkData& sksl) {
+    compiled++;
+    return true;
+  };
+  precompiler->CompileStartupShaders(compile, kLoadTimeout);
+  EXPECT_EQ(compiled, 2u);
+  EXPECT_EQ(precompiler->GetPendingCount(), 0u);
+
+  precompiler->Reset();
+  EXPECT_EQ(precompiler->GetPendingCount(), 2u);
+  EXPECT_TRUE(precompiler->HasPendingStartupShaders());
+  precompiler->CompileStartupShaders(compile, kLoadTimeout);
+  EXPECT_EQ(compiled, 4u);
+}
+
+TEST(SkSLPrecompilerTest, DoesNotLoadShadersForADestroyedPrecompiler) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  fml::AutoResetWaitableEvent start;
+  loop->GetTaskRunner()->PostTask([&start]() { start.Wait(); });
+
+  bool loaded = false;
+  fml::AutoResetWaitableEvent done;
+  SkSLPrecompiler::Create(loop->GetTaskRunner(), nullptr,
+                          [&loaded]() {
+                            loaded = true;
+                            return SkSLPrecompiler::Shaders{};
+                          });
+  loop->GetTaskRunner()->PostTask([&done]() { done.Signal(); });
+  start.Signal();
+  done.Wait();
+  EXPECT_FALSE(loaded);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -397,6 +397,72 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.purge_persistent_cache =
       command_line.HasOption(FlagForSwitch(Switch::PurgePersistentCache));
 
+  settings.compact_persistent_cache =
+      command_line.HasOption(FlagForSwitch(Switch::CompactPersistentCache));
+
+  settings.enable_async_raster_cache =
+      command_line.HasOption(FlagForSwitch(Switch::EnableAsyncRasterCache));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::RasterCacheMaxBytes,
+                        &settings.raster_cache_max_bytes)) {
+      FML_LOG(INFO) << "Raster cache budget specified was malformed. Will "
+                       "default to "
+                    << settings.raster_cache_max_bytes;
+    }
+  }
+
+  settings.enable_tiled_software_rendering = command_line.HasOption(
+      FlagForSwitch(Switch::EnableTiledSoftwareRendering));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::TimerSlack))) {
+    int64_t timer_slack_micros = 0;
+    if (GetSwitchValue(command_line, Switch::TimerSlack,
+                       &timer_slack_micros)) {
+      settings.timer_slack = std::chrono::microseconds(timer_slack_micros);
+    } else {
+      FML_LOG(INFO) << "Timer slack specified was malformed. Timers will not "
+                       "be delayed.";
+    }
+  }
+
+  settings.enable_glyph_run_cache =
+      command_line.HasOption(FlagForSwitch(Switch::EnableGlyphRunCache));
+
+  settings.enable_font_fallback_index =
+      command_line.HasOption(FlagForSwitch(Switch::EnableFontFallbackIndex));
+
+  command_line.GetOptionValue(FlagForSwitch(Switch::HyphenationPatternsPath),
+                              &settings.hyphenation_patterns_path);
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageDecodeAheadFrames))) {
+    if (!GetSwitchValue(command_line, Switch::AnimatedImageDecodeAheadFrames,
+                        &settings.animated_image_decode_ahead_frame_count)) {
+      FML_LOG(INFO) << "Animated image decode ahead frame count specified was "
+                       "malformed. Frames will not be decoded ahead of time.";
+    }
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::AnimatedImageDecodeAheadMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::AnimatedImageDecodeAheadMaxBytes,
+                        &settings.animated_image_decode_ahead_max_bytes)) {
+      FML_LOG(INFO) << "Animated image decode ahead byte cap specified was "
+                       "malformed. Will default to "
+                    << settings.animated_image_decode_ahead_max_bytes;
+    }
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::DecodedImageCacheMaxBytes))) {
+    if (!GetSwitchValue(command_line, Switch::DecodedImageCacheMaxBytes,
+                        &settings.decoded_image_cache_max_bytes)) {
+      FML_LOG(INFO) << "Decoded image cache budget specified was malformed. "
+                       "Decoded images will not be cached.";
+    }
+  }
+
   return settings;
 }
 
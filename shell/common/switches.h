@@ -152,6 +152,63 @@ DEF_SWITCH(PurgePersistentCache,
            "purge-persistent-cache",
            "Remove all existing persistent cache. This is mainly for debugging "
            "purposes such as reproducing the shader compilation jank.")
+DEF_SWITCH(CompactPersistentCache,
+           "compact-persistent-cache",
+           "Rewrite the persistent cache at startup so that it only contains "
+           "the latest entry of each key, and move the entries written by "
+           "older versions of the engine into it. This is mainly meant for "
+           "preparing read-only caches that ship with the application, and "
+           "slows down the launch it is passed to.")
+DEF_SWITCH(EnableAsyncRasterCache,
+           "enable-async-raster-cache",
+           "Rasterize the pictures selected for the raster cache on worker "
+           "threads and use the results in a later frame, instead of "
+           "rasterizing them on the raster thread in the frame that selected "
+           "them.")
+DEF_SWITCH(RasterCacheMaxBytes,
+           "raster-cache-max-bytes",
+           "The most bytes of raster cache entries to keep for later frames "
+           "once they are no longer used. Entries used in the last frame are "
+           "always kept. Defaults to 32MB.")
+DEF_SWITCH(EnableTiledSoftwareRendering,
+           "enable-tiled-software-rendering",
+           "When rendering in software, record each frame and rasterize it in "
+           "tiles on worker threads instead of on the raster thread alone.")
+DEF_SWITCH(TimerSlack,
+           "timer-slack",
+           "The number of microseconds by which the UI and IO threads may "
+           "delay waking up for a timer, so that timers due close together "
+           "fire after a single wakeup. This saves power on platforms that "
+           "support it.")
+DEF_SWITCH(EnableGlyphRunCache,
+           "enable-glyph-run-cache",
+           "Share the text blobs of identical runs of glyphs between "
+           "paragraphs and layouts, so that Skia keeps reusing their "
+           "rasterized glyphs across frames.")
+DEF_SWITCH(EnableFontFallbackIndex,
+           "enable-font-fallback-index",
+           "Save the fallback fonts matched from the system fonts to "
+           "characters, and the characters those fonts cover, in the caches "
+           "directory, so that later launches skip matching them again.")
+DEF_SWITCH(HyphenationPatternsPath,
+           "hyphenation-patterns-path",
+           "Path to a directory of hyphenation patterns in the hyb format, "
+           "named like hyph-en-us.hyb. Paragraphs in the languages of the "
+           "patterns are hyphenated when they are broken into lines.")
+DEF_SWITCH(AnimatedImageDecodeAheadFrames,
+           "animated-image-decode-ahead-frames",
+           "The number of frames of animated images to decode on the IO "
+           "thread ahead of the frame shown last, so that they are ready "
+           "when the animation asks for them.")
+DEF_SWITCH(AnimatedImageDecodeAheadMaxBytes,
+           "animated-image-decode-ahead-max-bytes",
+           "The most bytes the frames of an animated image decoded ahead of "
+           "time may take up. Defaults to 16MB.")
+DEF_SWITCH(DecodedImageCacheMaxBytes,
+           "decoded-image-cache-max-bytes",
+           "The most bytes of decoded images to keep, so that images decoded "
+           "again from the same bytes at the same size skip decoding. The "
+           "cache is shared by all engines of the process.")
 DEF_SWITCH(
     TraceSystrace,
     "trace-systrace",
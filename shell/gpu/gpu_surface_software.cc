@@ -6,6 +6,8 @@
 
 #include <memory>
 #include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
 
 namespace flutter {
 
@@ -56,20 +58,66 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  // The frame is recorded with a bounding box hierarchy, so that each tile
+  // only plays back the operations that intersect it.
+  std::shared_ptr<SkPictureRecorder> recorder;
+  if (tiled_rasterizer_) {
+    recorder = std::make_shared<SkPictureRecorder>();
+    SkRTreeFactory rtree_factory;
+    recorder->beginRecording(SkRect::Make(size), &rtree_factory);
+  }
+
   SurfaceFrame::SubmitCallback on_submit =
-      [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
-                                          SkCanvas* canvas) -> bool {
+      [self = weak_factory_.GetWeakPtr(), recorder](
+          const SurfaceFrame& surface_frame, SkCanvas* canvas) -> bool {
     // If the surface itself went away, there is nothing more to do.
-    if (!self || !self->IsValid() || canvas == nullptr) {
+    if (!self || !self->IsValid()) {
       return false;
     }
 
+    // A frame that is dropped may have been partially painted.
+    self->last_presented_backing_store_ = nullptr;
+
+    if (canvas == nullptr) {
+      return false;
+    }
+
+    if (recorder) {
+      sk_sp<SkPicture> picture = recorder->finishRecordingAsPicture();
+      canvas = surface_frame.SkiaSurface()->getCanvas();
+      if (!self->tiled_rasterizer_ ||
+          !self->tiled_rasterizer_->Rasterize(
+              *picture, surface_frame.SkiaSurface().get(),
+              surface_frame.submit_info().buffer_damage)) {
+        canvas->drawPicture(picture);
+      }
+    }
+
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    if (!self->delegate_->PresentBackingStore(surface_frame.SkiaSurface())) {
+      return false;
+    }
+
+    self->last_presented_backing_store_ = surface_frame.SkiaSurface();
+    return true;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  if (recorder) {
+    frame->set_canvas(recorder->getRecordingCanvas());
+  }
+
+  // Delegates usually hand out the same backing store for as long as the size
+  // doesn't change. Its pixels are then those of the last presented frame and
+  // only the parts of the new frame that changed need to be repainted.
+  SurfaceFrame::FramebufferInfo framebuffer_info;
+  if (backing_store == last_presented_backing_store_) {
+    framebuffer_info.existing_damage = SkIRect::MakeEmpty();
+  }
+  frame->set_framebuffer_info(framebuffer_info);
+
+  return frame;
 }
 
 // |Surface|
@@ -92,4 +140,11 @@ flutter::ExternalViewEmbedder* GPUSurfaceSoftware::GetExternalViewEmbedder() {
   return delegate_->GetExternalViewEmbedder();
 }
 
+// |Surface|
+void GPUSurfaceSoftware::EnableTiledRasterization(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) {
+  tiled_rasterizer_ =
+      std::make_unique<TiledRasterizer>(std::move(worker_task_runner));
+}
+
 }  // namespace flutter
@@ -6,6 +6,7 @@
 #define FLUTTER_SHELL_GPU_GPU_SURFACE_SOFTWARE_H_
 
 #include "flutter/flow/surface.h"
+#include "flutter/flow/tiled_rasterizer.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/shell/gpu/gpu_surface_software_delegate.h"
@@ -34,6 +35,10 @@ class GPUSurfaceSoftware : public Surface {
   // |Surface|
   flutter::ExternalViewEmbedder* GetExternalViewEmbedder() override;
 
+  // |Surface|
+  void EnableTiledRasterization(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner) override;
+
  private:
   GPUSurfaceSoftwareDelegate* delegate_;
   // TODO(38466): Refactor GPU surface APIs take into account the fact that an
@@ -41,6 +46,13 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The backing store submitted with the last successfully presented frame.
+  // Holding on to it also guarantees that a new backing store can't be
+  // allocated at the same address.
+  sk_sp<SkSurface> last_presented_backing_store_;
+  // When set, frames are recorded and then rasterized in tiles on the
+  // concurrent workers.
+  std::unique_ptr<TiledRasterizer> tiled_rasterizer_;
   fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
@@ -927,11 +927,11 @@ void PlatformViewAndroidJNIImpl::FlutterViewHandlePlatformMessage(
       fml::jni::StringToJavaString(env, message->channel());
 
   if (message->hasData()) {
+    const fml::Mapping& data = message->data();
     fml::jni::ScopedJavaLocalRef<jbyteArray> message_array(
-        env, env->NewByteArray(message->data().size()));
-    env->SetByteArrayRegion(
-        message_array.obj(), 0, message->data().size(),
-        reinterpret_cast<const jbyte*>(message->data().data()));
+        env, env->NewByteArray(data.GetSize()));
+    env->SetByteArrayRegion(message_array.obj(), 0, data.GetSize(),
+                            reinterpret_cast<const jbyte*>(data.GetMapping()));
     env->CallVoidMethod(java_object.obj(), g_handle_platform_message_method,
                         java_channel.obj(), message_array.obj(), responseId);
   } else {
@@ -20,7 +20,18 @@ std::unique_ptr<fml::Mapping> GetMappingFromNSData(NSData* data) {
 }
 
 NSData* GetNSDataFromMapping(std::unique_ptr<fml::Mapping> mapping) {
-  return [NSData dataWithBytes:mapping->GetMapping() length:mapping->GetSize()];
+  if (mapping == nullptr || mapping->GetSize() == 0) {
+    return [NSData data];
+  }
+  // The data takes over the mapping instead of copying its bytes. Blocks can
+  // not capture move-only types, so the deallocator owns a raw pointer.
+  fml::Mapping* owned_mapping = mapping.release();
+  void* bytes = const_cast<uint8_t*>(owned_mapping->GetMapping());
+  return [[[NSData alloc] initWithBytesNoCopy:bytes
+                                       length:owned_mapping->GetSize()
+                                  deallocator:^(void* bytes, NSUInteger length) {
+                                    delete owned_mapping;
+                                  }] autorelease];
 }
 
 }  // namespace flutter
@@ -7,6 +7,7 @@
 #define FML_USED_ON_EMBEDDER
 #define RAPIDJSON_HAS_STDSTRING 1
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -40,6 +41,7 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
@@ -921,8 +923,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
           const FlutterPlatformMessage incoming_message = {
               sizeof(FlutterPlatformMessage),  // struct_size
               message->channel().c_str(),      // channel
-              message->data().data(),          // message
-              message->data().size(),          // message_size
+              message->data().GetMapping(),    // message
+              message->data().GetSize(),       // message_size
               handle,                          // response_handle
           };
           handle->message = std::move(message);
@@ -1354,9 +1356,15 @@ FlutterEngineResult FlutterEngineSendPointerEvent(
                                   "running Flutter application.");
 }
 
-FlutterEngineResult FlutterEngineSendPlatformMessage(
+// Validates |flutter_message| and sends it to the engine with the payload
+// returned by |make_data|, which is only invoked if the message is valid and
+// not empty.
+static FlutterEngineResult SendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
-    const FlutterPlatformMessage* flutter_message) {
+    const FlutterPlatformMessage* flutter_message,
+    const std::function<std::unique_ptr<fml::Mapping>(const uint8_t* data,
+                                                      size_t size)>&
+        make_data) {
   if (engine == nullptr) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
   }
@@ -1393,8 +1401,7 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
         flutter_message->channel, response);
   } else {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
-        flutter_message->channel,
-        std::vector<uint8_t>(message_data, message_data + message_size),
+        flutter_message->channel, make_data(message_data, message_size),
         response);
   }
 
@@ -1406,6 +1413,47 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
                                   "Flutter application.");
 }
 
+FlutterEngineResult FlutterEngineSendPlatformMessage(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* flutter_message) {
+  return SendPlatformMessage(
+      engine, flutter_message, [](const uint8_t* data, size_t size) {
+        return std::make_unique<fml::DataMapping>(
+            std::vector<uint8_t>(data, data + size));
+      });
+}
+
+FlutterEngineResult FlutterEngineSendPlatformMessageNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* flutter_message,
+    VoidCallback release_callback,
+    void* release_user_data) {
+  if (release_callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid release callback argument.");
+  }
+
+  bool buffer_taken = false;
+  auto result = SendPlatformMessage(
+      engine, flutter_message,
+      [&buffer_taken, release_callback, release_user_data](const uint8_t* data,
+                                                           size_t size) {
+        buffer_taken = true;
+        return std::make_unique<fml::NonOwnedMapping>(
+            data, size,
+            [release_callback, release_user_data](const uint8_t*, size_t) {
+              release_callback(release_user_data);
+            });
+      });
+
+  // Empty messages are sent without their buffer, which can be released right
+  // away.
+  if (!buffer_taken && result != kInvalidArguments) {
+    release_callback(release_user_data);
+  }
+  return result;
+}
+
 FlutterEngineResult FlutterPlatformMessageCreateResponseHandle(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     FlutterDataCallback data_callback,
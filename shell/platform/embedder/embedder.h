@@ -1445,6 +1445,39 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterPlatformMessage* message);
 
+//------------------------------------------------------------------------------
+/// @brief      Sends a platform message to the Flutter application without
+///             copying its payload. This is meant for large payloads (e.g.
+///             camera frames) where the copy made by
+///             `FlutterEngineSendPlatformMessage` would be expensive.
+///
+///             If this call does not fail with `kInvalidArguments`, the engine
+///             takes ownership of the buffer referenced by the message and
+///             invokes the release callback exactly once when it no longer
+///             needs it. This happens even if the message could not be
+///             delivered. Until then, the buffer must remain valid and must
+///             not be modified by the embedder. The release callback may be
+///             invoked on any thread.
+///
+///             The buffer may be handed to the Dart application directly, so
+///             it must be writable memory.
+///
+/// @param[in]  engine             A running engine instance.
+/// @param[in]  message            The message to send.
+/// @param[in]  release_callback   The callback invoked by the engine once it no
+///                                longer needs the message buffer.
+/// @param[in]  release_user_data  The user data passed to the release
+///                                callback.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSendPlatformMessageNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* message,
+    VoidCallback release_callback,
+    void* release_user_data);
+
 //------------------------------------------------------------------------------
 /// @brief     Creates a platform message response handle that allows the
 ///            embedder to set a native callback for a response to a message.
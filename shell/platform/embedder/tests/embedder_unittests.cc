@@ -509,6 +509,105 @@ TEST_F(EmbedderTest, InvalidPlatformMessages) {
   ASSERT_EQ(result, kInvalidArguments);
 }
 
+//------------------------------------------------------------------------------
+/// Tests that a platform message sent without copying its payload is delivered
+/// and that the buffer is released once the engine is done with it.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetDartEntrypoint("platform_messages_no_response");
+
+  // Large enough for the payload to be handed to Dart without a copy.
+  std::vector<uint8_t> message_data(4096, 'a');
+  const std::string expected_message(message_data.begin(),
+                                     message_data.end());
+
+  fml::AutoResetWaitableEvent ready, message;
+  context.AddNativeCallback(
+      "SignalNativeTest",
+      CREATE_NATIVE_ENTRY(
+          [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+  context.AddNativeCallback(
+      "SignalNativeMessage",
+      CREATE_NATIVE_ENTRY(
+          ([&message, &expected_message](Dart_NativeArguments args) {
+            auto received_message = tonic::DartConverter<std::string>::FromDart(
+                Dart_GetNativeArgument(args, 0));
+            ASSERT_EQ(received_message, expected_message);
+            message.Signal();
+          })));
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+  ready.Wait();
+
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message = message_data.data();
+  platform_message.message_size = message_data.size();
+  platform_message.response_handle = nullptr;  // No response needed.
+
+  fml::AutoResetWaitableEvent released;
+  auto result = FlutterEngineSendPlatformMessageNoCopy(
+      engine.get(), &platform_message,
+      [](void* user_data) {
+        reinterpret_cast<fml::AutoResetWaitableEvent*>(user_data)->Signal();
+      },
+      &released);
+  ASSERT_EQ(result, kSuccess);
+  message.Wait();
+
+  // The buffer is released when the Dart heap collects the message, which
+  // happens at the latest when the engine shuts down.
+  engine.reset();
+  released.Wait();
+}
+
+//------------------------------------------------------------------------------
+/// Tests that the buffer of an empty platform message sent without copies is
+/// released right away and that invalid messages leave the buffer with the
+/// caller.
+///
+TEST_F(EmbedderTest, PlatformMessagesWithoutCopiesReleaseTheirBuffer) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  size_t release_count = 0;
+  auto release_callback = [](void* user_data) {
+    ++*reinterpret_cast<size_t*>(user_data);
+  };
+
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message = nullptr;
+  platform_message.message_size = 0;
+  platform_message.response_handle = nullptr;  // No response needed.
+
+  auto result = FlutterEngineSendPlatformMessageNoCopy(
+      engine.get(), &platform_message, release_callback, &release_count);
+  ASSERT_EQ(result, kSuccess);
+  ASSERT_EQ(release_count, 1u);
+
+  platform_message.message_size = 1;
+  result = FlutterEngineSendPlatformMessageNoCopy(
+      engine.get(), &platform_message, release_callback, &release_count);
+  ASSERT_EQ(result, kInvalidArguments);
+  ASSERT_EQ(release_count, 1u);
+
+  result = FlutterEngineSendPlatformMessageNoCopy(
+      engine.get(), &platform_message, nullptr, nullptr);
+  ASSERT_EQ(result, kInvalidArguments);
+}
+
 //------------------------------------------------------------------------------
 /// Asserts behavior of FlutterProjectArgs::shutdown_dart_vm_when_done (which is
 /// set to true by default in these unit-tests).
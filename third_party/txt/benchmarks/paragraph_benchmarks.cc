@@ -17,7 +17,9 @@
 #include <minikin/Layout.h>
 
 #include "flutter/fml/command_line.h"
+#include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
 #include "minikin/LayoutUtils.h"
 #include "third_party/benchmark/include/benchmark/benchmark_api.h"
@@ -29,6 +31,7 @@
 #include "txt/font_skia.h"
 #include "txt/font_style.h"
 #include "txt/font_weight.h"
+#include "txt/hyphenation_patterns.h"
 #include "txt/paragraph.h"
 #include "txt/paragraph_builder_txt.h"
 
@@ -117,6 +120,81 @@ BENCHMARK_F(ParagraphFixture, LongLayout)(benchmark::State& state) {
   }
 }
 
+BENCHMARK_F(ParagraphFixture, RelayoutAtAlternatingWidths)
+(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  // Only the width changes between the layouts, e.g. while a window is
+  // resized, so the text is not shaped again.
+  double width = 300;
+  while (state.KeepRunning()) {
+    width = width == 300 ? 250 : 300;
+    paragraph->Layout(width);
+  }
+}
+
+BENCHMARK_F(ParagraphFixture, TypeIntoLongText)(benchmark::State& state) {
+  std::u16string u16_text;
+  for (int i = 0; i < 100; i++) {
+    u16_text +=
+        u"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+        u"eiusmod tempor incididunt ut labore et dolore magna aliqua.\n";
+  }
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  // Type and delete a character in the middle of the text. Only the lines of
+  // the edited block are broken again and only the edited word is shaped.
+  const size_t offset = u16_text.size() / 2;
+  bool typed = false;
+  while (state.KeepRunning()) {
+    if (typed) {
+      paragraph->ReplaceText(offset, offset + 1, u"", text_style);
+    } else {
+      paragraph->ReplaceText(offset, offset, u"x", text_style);
+    }
+    typed = !typed;
+    paragraph->Layout(300);
+  }
+}
+
 BENCHMARK_F(ParagraphFixture, JustifyLayout)(benchmark::State& state) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
@@ -159,6 +237,85 @@ BENCHMARK_F(ParagraphFixture, JustifyLayout)(benchmark::State& state) {
   }
 }
 
+// Lays out a long article at alternating widths, as when a window with a
+// justified article is resized. Hyphenates with hyph-en-us.hyb of the
+// directory passed as --hyphenation-dir if the argument is 1, or with
+// patterns that split words before each syllable-like consonant and vowel
+// pair if there is no such file.
+BENCHMARK_DEFINE_F(ParagraphFixture, HyphenatedJustifyLayout)
+(benchmark::State& state) {
+  const char16_t* words[] = {
+      u"the",          u"of",           u"and",          u"information",
+      u"a",            u"to",           u"in",           u"development",
+      u"is",           u"that",         u"for",          u"international",
+      u"it",           u"as",           u"with",         u"particularly",
+      u"was",          u"on",           u"be",           u"organization",
+      u"by",           u"this",         u"are",          u"responsibility",
+      u"government",   u"relationship", u"environment",  u"understanding",
+      u"community",    u"significant",  u"performance",  u"characteristic",
+      u"university",   u"experience",   u"considerable", u"administration",
+      u"technology",   u"independent",  u"traditional",  u"investigation",
+      u"particular",   u"conversation", u"temperature",  u"representative",
+      u"population",   u"opportunity",  u"professional", u"approximately",
+  };
+  constexpr size_t kWordCount = 20000;
+  std::u16string text;
+  uint32_t seed = 1;
+  for (size_t i = 0; i < kWordCount; ++i) {
+    seed = seed * 1103515245 + 12345;
+    text += words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+    text += i % 150 == 149 ? u".\n" : i % 15 == 14 ? u". " : u" ";
+  }
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::justify;
+  if (state.range(0)) {
+    paragraph_style.locale = "en-US";
+    std::string hyphenation_dir;
+    GetCommandLineForProcess().GetOptionValue("hyphenation-dir",
+                                              &hyphenation_dir);
+    auto patterns = std::make_shared<HyphenationPatterns>(
+        hyphenation_dir.empty()
+            ? fml::UniqueFD()
+            : fml::OpenDirectory(hyphenation_dir.c_str(), false,
+                                 fml::FilePermission::kRead));
+    if (patterns->GetHyphenator(paragraph_style.locale) == nullptr) {
+      std::vector<std::string> syllables;
+      for (char consonant : std::string("bcdfghjklmnpqrstvwxz")) {
+        for (char vowel : std::string("aeiouy")) {
+          syllables.push_back(std::string("1") + consonant + vowel);
+        }
+      }
+      for (const char* digraph : {"c2h", "c2k", "p2h", "s2h", "t2h", "w2h"}) {
+        syllables.push_back(digraph);
+      }
+      patterns->AddPatterns("en-us", std::make_unique<fml::DataMapping>(
+                                         BuildHyphenationPatterns(syllables)));
+    }
+    font_collection_->SetHyphenationPatterns(patterns);
+  }
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  double width = 300;
+  while (state.KeepRunning()) {
+    width = width == 300 ? 250 : 300;
+    paragraph->Layout(width);
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, HyphenatedJustifyLayout)
+    ->Arg(0)
+    ->Arg(1);
+
 BENCHMARK_F(ParagraphFixture, ManyStylesLayout)(benchmark::State& state) {
   const char* text = "-";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -387,6 +544,47 @@ BENCHMARK_REGISTER_F(ParagraphFixture, MinikinDoLayout)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+// Lays out the same words from several threads at once, which contend for the
+// shared layout cache. This is not a fixture since fixtures are set up on each
+// thread.
+static void BM_MinikinDoLayoutMultithreaded(benchmark::State& state) {
+  static std::shared_ptr<FontCollection> font_collection =
+      GetTestFontCollection();
+  static std::shared_ptr<minikin::FontCollection> collection =
+      font_collection->GetMinikinFontCollectionForFamilies(
+          std::vector<std::string>(1, "Roboto"), "en-US");
+
+  std::vector<uint16_t> text;
+  for (uint16_t i = 0; i < state.range(0); ++i) {
+    text.push_back(i % 5 == 0 ? ' ' : 'a' + i % 26);
+  }
+  minikin::FontStyle font(4, false);
+  minikin::MinikinPaint paint;
+  paint.size = txt::TextStyle().font_size;
+
+  const minikin::LayoutCacheStats before = minikin::Layout::getCacheStats();
+  while (state.KeepRunning()) {
+    minikin::Layout layout;
+    layout.doLayout(text.data(), 0, text.size(), text.size(), 0, font, paint,
+                    collection);
+  }
+  if (state.thread_index == 0) {
+    const minikin::LayoutCacheStats after = minikin::Layout::getCacheStats();
+    const uint64_t lookups =
+        (after.hits - before.hits) + (after.misses - before.misses);
+    if (lookups > 0) {
+      state.SetLabel(
+          "cache hit rate " +
+          std::to_string(100 * (after.hits - before.hits) / lookups) + "%");
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_MinikinDoLayoutMultithreaded)
+    ->Arg(1 << 10)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
 BENCHMARK_DEFINE_F(ParagraphFixture, AddStyleRun)(benchmark::State& state) {
   std::vector<uint16_t> text;
   for (uint16_t i = 0; i < 16000 * 2; ++i) {
@@ -112,6 +112,18 @@ FontFamily::FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts)
   computeCoverage();
 }
 
+FontFamily::FontFamily(std::vector<Font>&& fonts,
+                       SparseBitSet&& coverage,
+                       bool hasVSTable)
+    : mLangId(FontLanguageListCache::kEmptyListId),
+      mVariant(0),
+      mFonts(std::move(fonts)),
+      mCoverage(std::move(coverage)),
+      mHasVSTable(hasVSTable) {
+  std::scoped_lock _l(gMinikinLock);
+  computeSupportedAxesLocked();
+}
+
 bool FontFamily::analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
                               int* weight,
                               bool* italic) {
@@ -186,7 +198,10 @@ void FontFamily::computeCoverage() {
   }
   mCoverage = CmapCoverage::getCoverage(cmapTable.get(), cmapTable.size(),
                                         &mHasVSTable);
+  computeSupportedAxesLocked();
+}
 
+void FontFamily::computeSupportedAxesLocked() {
   for (size_t i = 0; i < mFonts.size(); ++i) {
     std::unordered_set<AxisTag> supportedAxes =
         mFonts[i].getSupportedAxesLocked();
@@ -135,6 +135,11 @@ class FontFamily {
   explicit FontFamily(std::vector<Font>&& fonts);
   FontFamily(int variant, std::vector<Font>&& fonts);
   FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts);
+  // Uses a coverage returned by getCoverage() for the same fonts, e.g. in an
+  // earlier run of the process, instead of reading their cmap table.
+  FontFamily(std::vector<Font>&& fonts,
+             SparseBitSet&& coverage,
+             bool hasVSTable);
 
   // TODO: Good to expose FontUtil.h.
   static bool analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
@@ -175,6 +180,7 @@ class FontFamily {
 
  private:
   void computeCoverage();
+  void computeSupportedAxesLocked();
 
   uint32_t mLangId;
   int mVariant;
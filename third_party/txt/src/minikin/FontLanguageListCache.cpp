@@ -120,6 +120,7 @@ static std::vector<FontLanguage> parseLanguageList(const std::string& input) {
 
 // static
 uint32_t FontLanguageListCache::getId(const std::string& languages) {
+  std::scoped_lock _l(gMinikinLock);
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
   std::unordered_map<std::string, uint32_t>::const_iterator it =
       inst->mLanguageListLookupTable.find(languages);
@@ -141,6 +142,7 @@ uint32_t FontLanguageListCache::getId(const std::string& languages) {
 
 // static
 const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
+  std::scoped_lock _l(gMinikinLock);
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
   LOG_ALWAYS_FATAL_IF(id >= inst->mLanguageLists.size(),
                       "Lookup by unknown language list ID.");
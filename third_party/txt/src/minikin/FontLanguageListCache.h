@@ -17,6 +17,7 @@
 #ifndef MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 #define MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 
+#include <deque>
 #include <unordered_map>
 
 #include <minikin/FontFamily.h>
@@ -32,10 +33,12 @@ class FontLanguageListCache {
   const static uint32_t kEmptyListId = 0;
 
   // Returns language list ID for the given string representation of
-  // FontLanguages. Caller should acquire a lock before calling the method.
+  // FontLanguages.
   static uint32_t getId(const std::string& languages);
 
-  // Caller should acquire a lock before calling the method.
+  // libtxt: Both methods acquire gMinikinLock, so that the language lists can
+  // be read while shaping without holding it. The returned reference stays
+  // valid after the lock is released.
   static const FontLanguages& getById(uint32_t id);
 
  private:
@@ -45,7 +48,8 @@ class FontLanguageListCache {
   // Caller should acquire a lock before calling the method.
   static FontLanguageListCache* getInstance();
 
-  std::vector<FontLanguages> mLanguageLists;
+  // A deque, so that adding a list does not move the others.
+  std::deque<FontLanguages> mLanguageLists;
 
   // A map from string representation of the font language list to the ID.
   std::unordered_map<std::string, uint32_t> mLanguageListLookupTable;
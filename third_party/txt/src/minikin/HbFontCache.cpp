@@ -18,6 +18,8 @@
 
 #include "HbFontCache.h"
 
+#include <mutex>
+
 #include <log/log.h>
 #include <utils/LruCache.h>
 
@@ -48,47 +50,46 @@ class HbFontCache : private android::OnEntryRemoved<int32_t, hb_font_t*> {
 
   void remove(int32_t fontId) { mCache.remove(fontId); }
 
+  // libtxt: guards the cache, so that fonts can be looked up while shaping
+  // without holding gMinikinLock.
+  std::mutex mMutex;
+
  private:
   static const size_t kMaxEntries = 100;
 
   android::LruCache<int32_t, hb_font_t*> mCache;
 };
 
-HbFontCache* getFontCacheLocked() {
-  assertMinikinLocked();
-  static HbFontCache* cache = nullptr;
-  if (cache == nullptr) {
-    cache = new HbFontCache();
-  }
+HbFontCache* getFontCache() {
+  static HbFontCache* cache = new HbFontCache();
   return cache;
 }
 
 void purgeHbFontCacheLocked() {
-  assertMinikinLocked();
-  getFontCacheLocked()->clear();
+  HbFontCache* fontCache = getFontCache();
+  std::scoped_lock _l(fontCache->mMutex);
+  fontCache->clear();
 }
 
 void purgeHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
   const int32_t fontId = minikinFont->GetUniqueId();
-  getFontCacheLocked()->remove(fontId);
+  HbFontCache* fontCache = getFontCache();
+  std::scoped_lock _l(fontCache->mMutex);
+  fontCache->remove(fontId);
 }
 
 // Returns a new reference to a hb_font_t object, caller is
 // responsible for calling hb_font_destroy() on it.
 hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
   // TODO: get rid of nullFaceFont
-  static hb_font_t* nullFaceFont = nullptr;
+  static hb_font_t* nullFaceFont = hb_font_create(nullptr);
   if (minikinFont == nullptr) {
-    if (nullFaceFont == nullptr) {
-      nullFaceFont = hb_font_create(nullptr);
-    }
     return hb_font_reference(nullFaceFont);
   }
 
-  HbFontCache* fontCache = getFontCacheLocked();
+  HbFontCache* fontCache = getFontCache();
   const int32_t fontId = minikinFont->GetUniqueId();
+  std::scoped_lock _l(fontCache->mMutex);
   hb_font_t* font = fontCache->get(fontId);
   if (font != nullptr) {
     return hb_font_reference(font);
@@ -108,6 +109,7 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
     variations.push_back({variation.axisTag, variation.value});
   }
   hb_font_set_variations(font, variations.data(), variations.size());
+  hb_font_make_immutable(font);
   hb_font_destroy(parent_font);
   hb_face_destroy(face);
   fontCache->put(fontId, font);
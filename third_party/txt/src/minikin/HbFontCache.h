@@ -22,6 +22,10 @@ struct hb_font_t;
 namespace minikin {
 class MinikinFont;
 
+// libtxt: The cache has a lock of its own, so these can be called without
+// holding gMinikinLock. The fonts returned by getHbFontLocked() are shared
+// between threads and must not be modified; use hb_font_create_sub_font() to
+// get a font that can be.
 void purgeHbFontCacheLocked();
 void purgeHbFontLocked(const MinikinFont* minikinFont);
 hb_font_t* getHbFontLocked(const MinikinFont* minikinFont);
@@ -38,6 +38,9 @@ static const uint16_t CHAR_SOFT_HYPHEN = 0x00AD;
 static const uint16_t CHAR_MIDDLE_DOT = 0x00B7;
 static const uint16_t CHAR_HYPHEN = 0x2010;
 
+// The magic number at the start of hyb files, see doc/hyb_file_format.md.
+static const uint32_t HYPHENATION_MAGIC = 0x62ad7968;
+
 // The following are structs that correspond to tables inside the hyb file
 // format
 
@@ -122,10 +125,80 @@ Hyphenator* Hyphenator::loadBinary(const uint8_t* patternData,
   return result;
 }
 
+bool Hyphenator::isValidBinary(const uint8_t* patternData, size_t size) {
+  if (patternData == nullptr || size < sizeof(Header)) {
+    return false;
+  }
+  const Header* header = reinterpret_cast<const Header*>(patternData);
+  return header->magic == HYPHENATION_MAGIC && header->file_size <= size &&
+         header->alphabet_offset < header->file_size &&
+         header->trie_offset < header->file_size &&
+         header->pattern_offset < header->file_size;
+}
+
+size_t Hyphenator::getMemoSize() {
+  std::lock_guard<std::mutex> lock(mMemoMutex);
+  return mMemo.size();
+}
+
 void Hyphenator::hyphenate(vector<HyphenationType>* result,
                            const uint16_t* word,
                            size_t len,
                            const icu::Locale& locale) {
+  if (len > MAX_HYPHENATED_SIZE) {
+    hyphenateUncached(result, word, len, locale);
+    return;
+  }
+  hyphenateWithMemo(result, word, len, locale);
+}
+
+void Hyphenator::hyphenateWithMemo(vector<HyphenationType>* result,
+                                   const uint16_t* word,
+                                   size_t len,
+                                   const icu::Locale& locale) {
+  std::u16string key(reinterpret_cast<const char16_t*>(word), len);
+  {
+    std::lock_guard<std::mutex> lock(mMemoMutex);
+    if (!mMemoHasLocale) {
+      mMemoLocale = locale;
+      mMemoHasLocale = true;
+    }
+    if (locale != mMemoLocale) {
+      // Not remembered, see the comment on mMemo.
+      key.clear();
+    } else {
+      auto found = mMemo.find(key);
+      if (found != mMemo.end()) {
+        mMemoLru.splice(mMemoLru.begin(), mMemoLru, found->second.lruPosition);
+        *result = found->second.result;
+        return;
+      }
+    }
+  }
+
+  // Hyphenate outside of the lock, the patterns are immutable.
+  hyphenateUncached(result, word, len, locale);
+  if (key.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mMemoMutex);
+  if (mMemo.count(key) != 0) {
+    // Another layout hyphenated the word meanwhile.
+    return;
+  }
+  if (mMemo.size() >= MEMO_CAPACITY) {
+    mMemo.erase(mMemoLru.back());
+    mMemoLru.pop_back();
+  }
+  mMemoLru.push_front(key);
+  mMemo.emplace(std::move(key), MemoEntry{*result, mMemoLru.begin()});
+}
+
+void Hyphenator::hyphenateUncached(vector<HyphenationType>* result,
+                                   const uint16_t* word,
+                                   size_t len,
+                                   const icu::Locale& locale) {
   result->clear();
   result->resize(len);
   const size_t paddedLen = len + 2;  // start and stop code each count for 1
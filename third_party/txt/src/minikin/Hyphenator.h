@@ -22,7 +22,10 @@
 #define U_USING_ICU_NAMESPACE 0
 #endif  //  U_USING_ICU_NAMESPACE
 
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "unicode/locid.h"
@@ -156,6 +159,17 @@ class Hyphenator {
                                 size_t minPrefix,
                                 size_t minSuffix);
 
+  // libtxt: Returns true if the data starts with a hyb header that is
+  // consistent with its size, so that it can be passed to loadBinary.
+  static bool isValidBinary(const uint8_t* patternData, size_t size);
+
+  // libtxt: The number of recently hyphenated words whose hyphenation is
+  // remembered at most.
+  static constexpr size_t MEMO_CAPACITY = 4096;
+
+  // libtxt: The number of words whose hyphenation is remembered.
+  size_t getMemoSize();
+
  private:
   // apply various hyphenation rules including hard and soft hyphens, ignoring
   // patterns
@@ -185,9 +199,38 @@ class Hyphenator {
   // is a slightly different use case. It measures UTF-16 code units.
   static const size_t MAX_HYPHENATED_SIZE = 64;
 
+  // libtxt: look up the hyphenation of a word in the memo, or compute and
+  // remember it
+  void hyphenateWithMemo(std::vector<HyphenationType>* result,
+                         const uint16_t* word,
+                         size_t len,
+                         const icu::Locale& locale);
+
+  void hyphenateUncached(std::vector<HyphenationType>* result,
+                         const uint16_t* word,
+                         size_t len,
+                         const icu::Locale& locale);
+
   const uint8_t* patternData;
   size_t minPrefix, minSuffix;
 
+  // libtxt: The same words are hyphenated again in every paragraph that has
+  // them and whenever a paragraph is broken into lines at a different width,
+  // so the hyphenations of recently hyphenated words are kept in an LRU memo
+  // of MEMO_CAPACITY words. The hyphenation of words without patterns depends
+  // on the language, so only the words of the locale the memo was first used
+  // with are remembered. Paragraphs are laid out concurrently, hence the lock.
+  struct MemoEntry {
+    std::vector<HyphenationType> result;
+    std::list<std::u16string>::iterator lruPosition;
+  };
+  std::mutex mMemoMutex;
+  bool mMemoHasLocale = false;
+  icu::Locale mMemoLocale;
+  // Most recently used first.
+  std::list<std::u16string> mMemoLru;
+  std::unordered_map<std::u16string, MemoEntry> mMemo;
+
   // accessors for binary data
   const Header* getHeader() const {
     return reinterpret_cast<const Header*>(patternData);
@@ -26,8 +26,6 @@
 #include <vector>
 
 #include <log/log.h>
-#include <utils/JenkinsHash.h>
-#include <utils/LruCache.h>
 #include <utils/WindowsUtils.h>
 
 #include <hb-icu.h>
@@ -38,6 +36,7 @@
 #include "FontLanguage.h"
 #include "FontLanguageListCache.h"
 #include "HbFontCache.h"
+#include "LayoutCache.h"
 #include "LayoutUtils.h"
 #include "MinikinInternal.h"
 
@@ -49,6 +48,8 @@ struct LayoutContext {
   MinikinPaint paint;
   FontStyle style;
   std::vector<hb_font_t*> hbFonts;  // parallel to mFaces
+  // libtxt extension: Collects the laid out words when not null.
+  std::vector<LayoutPiece>* pieces = nullptr;
 
   void clearHbFonts() {
     for (size_t i = 0; i < hbFonts.size(); i++) {
@@ -59,123 +60,22 @@ struct LayoutContext {
   }
 };
 
-// Layout cache datatypes
-
-class LayoutCacheKey {
- public:
-  LayoutCacheKey(const std::shared_ptr<FontCollection>& collection,
-                 const MinikinPaint& paint,
-                 FontStyle style,
-                 const uint16_t* chars,
-                 size_t start,
-                 size_t count,
-                 size_t nchars,
-                 bool dir)
-      : mChars(chars),
-        mNchars(nchars),
-        mStart(start),
-        mCount(count),
-        mId(collection->getId()),
-        mStyle(style),
-        mSize(paint.size),
-        mScaleX(paint.scaleX),
-        mSkewX(paint.skewX),
-        mLetterSpacing(paint.letterSpacing),
-        mPaintFlags(paint.paintFlags),
-        mHyphenEdit(paint.hyphenEdit),
-        mIsRtl(dir),
-        mHash(computeHash()) {}
-  bool operator==(const LayoutCacheKey& other) const;
-
-  android::hash_t hash() const { return mHash; }
-
-  void copyText() {
-    uint16_t* charsCopy = new uint16_t[mNchars];
-    memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
-    mChars = charsCopy;
-  }
-  void freeText() {
-    delete[] mChars;
-    mChars = NULL;
-  }
-
-  void doLayout(Layout* layout,
-                LayoutContext* ctx,
-                const std::shared_ptr<FontCollection>& collection) const {
-    layout->mAdvances.resize(mCount, 0);
-    ctx->clearHbFonts();
-    layout->doLayoutRun(mChars, mStart, mCount, mNchars, mIsRtl, ctx,
-                        collection);
-  }
-
- private:
-  const uint16_t* mChars;
-  size_t mNchars;
-  size_t mStart;
-  size_t mCount;
-  uint32_t mId;  // for the font collection
-  FontStyle mStyle;
-  float mSize;
-  float mScaleX;
-  float mSkewX;
-  float mLetterSpacing;
-  int32_t mPaintFlags;
-  HyphenEdit mHyphenEdit;
-  bool mIsRtl;
-  // Note: any fields added to MinikinPaint must also be reflected here.
-  // TODO: language matching (possibly integrate into style)
-  android::hash_t mHash;
-
-  android::hash_t computeHash() const;
-};
-
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
- public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
-  }
-
-  void clear() { mCache.clear(); }
-
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
-    }
-    return layout;
-  }
-
- private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
-  }
-
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
-
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
-
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
-};
+void LayoutCacheKey::doLayout(
+    Layout* layout,
+    LayoutContext* ctx,
+    const std::shared_ptr<FontCollection>& collection) const {
+  layout->mAdvances.resize(mCount, 0);
+  ctx->clearHbFonts();
+  layout->doLayoutRun(mChars, mStart, mCount, mNchars, mIsRtl, ctx, collection);
+}
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
+    hb_unicode_funcs_make_immutable(unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
@@ -183,37 +83,21 @@ class LayoutEngine {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
   }
-};
-
-bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
-  return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
-         mStyle == other.mStyle && mSize == other.mSize &&
-         mScaleX == other.mScaleX && mSkewX == other.mSkewX &&
-         mLetterSpacing == other.mLetterSpacing &&
-         mPaintFlags == other.mPaintFlags && mHyphenEdit == other.mHyphenEdit &&
-         mIsRtl == other.mIsRtl && mNchars == other.mNchars &&
-         !memcmp(mChars, other.mChars, mNchars * sizeof(uint16_t));
-}
-
-android::hash_t LayoutCacheKey::computeHash() const {
-  uint32_t hash = android::JenkinsHashMix(0, mId);
-  hash = android::JenkinsHashMix(hash, mStart);
-  hash = android::JenkinsHashMix(hash, mCount);
-  hash = android::JenkinsHashMix(hash, hash_type(mStyle));
-  hash = android::JenkinsHashMix(hash, hash_type(mSize));
-  hash = android::JenkinsHashMix(hash, hash_type(mScaleX));
-  hash = android::JenkinsHashMix(hash, hash_type(mSkewX));
-  hash = android::JenkinsHashMix(hash, hash_type(mLetterSpacing));
-  hash = android::JenkinsHashMix(hash, hash_type(mPaintFlags));
-  hash = android::JenkinsHashMix(hash, hash_type(mHyphenEdit.getHyphen()));
-  hash = android::JenkinsHashMix(hash, hash_type(mIsRtl));
-  hash = android::JenkinsHashMixShorts(hash, mChars, mNchars);
-  return android::JenkinsHashWhiten(hash);
-}
 
-android::hash_t hash_type(const LayoutCacheKey& key) {
-  return key.hash();
-}
+  // libtxt: Each thread shapes into a buffer of its own, so that paragraphs
+  // can be laid out concurrently.
+  static hb_buffer_t* getHbBuffer() {
+    struct ThreadBuffer {
+      ThreadBuffer() : buffer(hb_buffer_create()) {
+        hb_buffer_set_unicode_funcs(buffer, getInstance().unicodeFunctions);
+      }
+      ~ThreadBuffer() { hb_buffer_destroy(buffer); }
+      hb_buffer_t* buffer;
+    };
+    thread_local ThreadBuffer threadBuffer;
+    return threadBuffer.buffer;
+  }
+};
 
 void MinikinRect::join(const MinikinRect& r) {
   if (isEmpty()) {
@@ -254,34 +138,32 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  // Initialized once, as the functions are shared by all threads.
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(false);
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(true);
+  return forColorBitmapFont ? hbFuncsForColorBitmap : hbFuncs;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -316,7 +198,11 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    // The cached font is shared with other threads, so the paint is set on a
+    // font of this context.
+    hb_font_t* parent = getHbFontLocked(face.font);
+    hb_font_t* font = hb_font_create_sub_font(parent);
+    hb_font_destroy(parent);
     hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
                       &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
@@ -325,10 +211,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +471,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -599,8 +480,6 @@ void Layout::doLayout(const uint16_t* buf,
 
   doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, start, collection,
                     this, NULL);
-
-  ctx.clearHbFonts();
 }
 
 float Layout::measureText(const uint16_t* buf,
@@ -612,17 +491,52 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
+  LayoutContext ctx;
+  ctx.style = style;
+  ctx.paint = paint;
+
+  return doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0,
+                           collection, NULL, advances);
+}
 
+void Layout::getLayoutPieces(const uint16_t* buf,
+                             size_t start,
+                             size_t count,
+                             size_t bufSize,
+                             bool isRtl,
+                             const FontStyle& style,
+                             const MinikinPaint& paint,
+                             const std::shared_ptr<FontCollection>& collection,
+                             std::vector<LayoutPiece>* pieces) {
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
+  ctx.pieces = pieces;
 
-  float advance = doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0,
-                                    collection, NULL, advances);
+  pieces->clear();
+  doLayoutRunCached(buf, start, count, bufSize, isRtl, &ctx, 0, collection,
+                    NULL, NULL);
+}
 
-  ctx.clearHbFonts();
-  return advance;
+bool Layout::doLayoutFromPieces(const std::vector<LayoutPiece>& pieces,
+                                size_t start,
+                                size_t count) {
+  reset();
+  mAdvances.resize(count, 0);
+
+  // The pieces inside the range are consecutive, and in the order in which
+  // doLayout would append them.
+  size_t appendedCount = 0;
+  for (const LayoutPiece& piece : pieces) {
+    if (piece.start >= start && piece.start + piece.count <= start + count) {
+      appendLayout(piece.layout.get(), piece.start - start,
+                   piece.extraAdvance);
+      appendedCount += piece.count;
+    } else if (appendedCount > 0) {
+      break;
+    }
+  }
+  return appendedCount == count;
 }
 
 float Layout::doLayoutRunCached(
@@ -708,27 +622,32 @@ float Layout::doLayoutWord(const uint16_t* buf,
   float wordSpacing =
       count == 1 && isWordSpace(buf[start]) ? ctx->paint.wordSpacing : 0;
 
-  float advance;
-  if (ctx->paint.skipCache()) {
-    Layout layoutForWord;
-    key.doLayout(&layoutForWord, ctx, collection);
-    if (layout) {
-      layout->appendLayout(&layoutForWord, bufStart, wordSpacing);
-    }
-    if (advances) {
-      layoutForWord.getAdvances(advances);
-    }
-    advance = layoutForWord.getAdvance();
-  } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
-    if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
-    }
-    if (advances) {
-      layoutForWord->getAdvances(advances);
+  std::shared_ptr<const Layout> layoutForWord;
+  if (!ctx->paint.skipCache()) {
+    layoutForWord = cache.find(key);
+  }
+  if (layoutForWord == nullptr) {
+    auto newLayout = std::make_shared<Layout>();
+    // Only the itemization takes gMinikinLock, so words can be shaped
+    // concurrently.
+    key.doLayout(newLayout.get(), ctx, collection);
+    ctx->clearHbFonts();
+    if (ctx->paint.skipCache()) {
+      layoutForWord = std::move(newLayout);
+    } else {
+      layoutForWord = cache.put(key, std::move(newLayout));
     }
-    advance = layoutForWord->getAdvance();
   }
+  if (layout) {
+    layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
+  }
+  if (ctx->pieces) {
+    ctx->pieces->push_back({bufStart, count, wordSpacing, layoutForWord});
+  }
+  if (advances) {
+    layoutForWord->getAdvances(advances);
+  }
+  float advance = layoutForWord->getAdvance();
 
   if (wordSpacing != 0) {
     advance += wordSpacing;
@@ -748,7 +667,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,9 +838,13 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getHbBuffer();
   std::vector<FontCollection::Run> items;
-  collection->itemize(buf + start, count, ctx->style, &items);
+  {
+    // The font collection and its fallback font provider are shared.
+    std::scoped_lock _l(gMinikinLock);
+    collection->itemize(buf + start, count, ctx->style, &items);
+  }
 
   std::vector<hb_feature_t> features;
   // Disable default-on non-required ligature features if letter-spacing
@@ -1105,7 +1028,9 @@ void Layout::doLayoutRun(const uint16_t* buf,
   mAdvance = x;
 }
 
-void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
+void Layout::appendLayout(const Layout* src,
+                          size_t start,
+                          float extraAdvance) {
   int fontMapStack[16];
   int* fontMap;
   if (src->mFaces.size() < sizeof(fontMapStack) / sizeof(fontMapStack[0])) {
@@ -1121,7 +1046,7 @@ void Layout::appendLayout(Layout* src, size_t start, float extraAdvance) {
   // jitter.
   float x0 = mAdvance;
   for (size_t i = 0; i < src->mGlyphs.size(); i++) {
-    LayoutGlyph& srcGlyph = src->mGlyphs[i];
+    const LayoutGlyph& srcGlyph = src->mGlyphs[i];
     int font_ix = fontMap[srcGlyph.font_ix];
     unsigned int glyph_id = srcGlyph.glyph_id;
     float x = x0 + srcGlyph.x;
@@ -1184,7 +1109,7 @@ float Layout::getAdvance() const {
   return mAdvance;
 }
 
-void Layout::getAdvances(float* advances) {
+void Layout::getAdvances(float* advances) const {
   memcpy(advances, &mAdvances[0], mAdvances.size() * sizeof(float));
 }
 
@@ -1192,11 +1117,19 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
 void Layout::purgeCaches() {
-  std::scoped_lock _l(gMinikinLock);
-  LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
-  layoutCache.clear();
+  LayoutEngine::getInstance().layoutCache.clear();
   purgeHbFontCacheLocked();
 }
 
+LayoutCacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
+}
+
 }  // namespace minikin
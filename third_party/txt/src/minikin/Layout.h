@@ -57,9 +57,23 @@ enum {
   kBidi_Mask = 0x7
 };
 
+// Statistics of the cache of word layouts that is shared by all layouts.
+struct LayoutCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  size_t entryCount = 0;
+  // The estimated memory footprint of the entries.
+  size_t bytes = 0;
+};
+
+// libtxt extension: A word of a run laid out by Layout::getLayoutPieces.
+struct LayoutPiece;
+
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
-// may not mutate it at the same time.
+// may not mutate it at the same time. Different layouts may be computed on
+// several threads at once. They share a thread-safe cache of the layouts of
+// words, but shaping the words that are not cached is serialized.
 class Layout {
  public:
   Layout() : mGlyphs(), mAdvances(), mFaces(), mAdvance(0), mBounds() {
@@ -93,6 +107,29 @@ class Layout {
                            const std::shared_ptr<FontCollection>& collection,
                            float* advances);
 
+  // libtxt extension: Lays out the words of a run like doLayout and stores
+  // them in |pieces| in the order in which doLayout appends them, so that the
+  // layout of any part of the run that starts and ends at word boundaries can
+  // be assembled by doLayoutFromPieces later without shaping the text again.
+  // The hyphen edit of |paint| must be empty.
+  static void getLayoutPieces(const uint16_t* buf,
+                              size_t start,
+                              size_t count,
+                              size_t bufSize,
+                              bool isRtl,
+                              const FontStyle& style,
+                              const MinikinPaint& paint,
+                              const std::shared_ptr<FontCollection>& collection,
+                              std::vector<LayoutPiece>* pieces);
+
+  // libtxt extension: Sets this layout to the result of doLayout for
+  // [start, start + count) of the run the pieces were computed for. Returns
+  // false if the range splits one of the pieces, in which case the caller has
+  // to use doLayout instead.
+  bool doLayoutFromPieces(const std::vector<LayoutPiece>& pieces,
+                          size_t start,
+                          size_t count);
+
   // public accessors
   size_t nGlyphs() const;
   const MinikinFont* getFont(int i) const;
@@ -106,7 +143,7 @@ class Layout {
 
   // Get advances, copying into caller-provided buffer. The size of this
   // buffer must match the length of the string (count arg to doLayout).
-  void getAdvances(float* advances);
+  void getAdvances(float* advances) const;
 
   // The i parameter is an offset within the buf relative to start, it is <
   // count, where start and count are the parameters to doLayout
@@ -114,9 +151,14 @@ class Layout {
 
   void getBounds(MinikinRect* rect) const;
 
+  // The estimated memory footprint of this layout.
+  size_t getMemoryUsage() const;
+
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  static LayoutCacheStats getCacheStats();
+
  private:
   friend class LayoutCacheKey;
 
@@ -163,7 +205,7 @@ class Layout {
                    const std::shared_ptr<FontCollection>& collection);
 
   // Append another layout (for example, cached value) into this one
-  void appendLayout(Layout* src, size_t start, float extraAdvance);
+  void appendLayout(const Layout* src, size_t start, float extraAdvance);
 
   std::vector<LayoutGlyph> mGlyphs;
   std::vector<float> mAdvances;
@@ -173,6 +215,15 @@ class Layout {
   MinikinRect mBounds;
 };
 
+struct LayoutPiece {
+  // The range of the run covered by the word.
+  size_t start;
+  size_t count;
+  // Added to the advance of the word, e.g. for word spacing.
+  float extraAdvance;
+  std::shared_ptr<const Layout> layout;
+};
+
 }  // namespace minikin
 
 #endif  // MINIKIN_LAYOUT_H
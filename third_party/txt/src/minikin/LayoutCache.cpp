@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LayoutCache.h"
+
+#include <utils/JenkinsHash.h>
+
+namespace minikin {
+
+bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
+  return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
+         mStyle == other.mStyle && mSize == other.mSize &&
+         mScaleX == other.mScaleX && mSkewX == other.mSkewX &&
+         mLetterSpacing == other.mLetterSpacing &&
+         mPaintFlags == other.mPaintFlags && mHyphenEdit == other.mHyphenEdit &&
+         mIsRtl == other.mIsRtl && mNchars == other.mNchars &&
+         !memcmp(mChars, other.mChars, mNchars * sizeof(uint16_t));
+}
+
+android::hash_t LayoutCacheKey::computeHash() const {
+  uint32_t hash = android::JenkinsHashMix(0, mId);
+  hash = android::JenkinsHashMix(hash, mStart);
+  hash = android::JenkinsHashMix(hash, mCount);
+  hash = android::JenkinsHashMix(hash, hash_type(mStyle));
+  hash = android::JenkinsHashMix(hash, hash_type(mSize));
+  hash = android::JenkinsHashMix(hash, hash_type(mScaleX));
+  hash = android::JenkinsHashMix(hash, hash_type(mSkewX));
+  hash = android::JenkinsHashMix(hash, hash_type(mLetterSpacing));
+  hash = android::JenkinsHashMix(hash, hash_type(mPaintFlags));
+  hash = android::JenkinsHashMix(hash, hash_type(mHyphenEdit.getHyphen()));
+  hash = android::JenkinsHashMix(hash, hash_type(mIsRtl));
+  hash = android::JenkinsHashMixShorts(hash, mChars, mNchars);
+  return android::JenkinsHashWhiten(hash);
+}
+
+android::hash_t hash_type(const LayoutCacheKey& key) {
+  return key.hash();
+}
+
+LayoutCache::Shard::Shard()
+    : mCache(android::LruCache<LayoutCacheKey, Entry>::kUnlimitedCapacity) {
+  mCache.setOnEntryRemovedListener(this);
+}
+
+void LayoutCache::Shard::operator()(LayoutCacheKey& key, Entry& value) {
+  mBytes -= getEntrySize(key, *value);
+  key.freeText();
+}
+
+LayoutCache::LayoutCache(size_t maxBytes)
+    : mMaxBytesPerShard(maxBytes / kShardCount) {}
+
+LayoutCache::~LayoutCache() {
+  clear();
+}
+
+std::shared_ptr<const Layout> LayoutCache::find(const LayoutCacheKey& key) {
+  Shard& shard = getShard(key);
+  std::scoped_lock _l(shard.mMutex);
+  const Entry& entry = shard.mCache.get(key);
+  if (entry == nullptr) {
+    shard.mMisses++;
+  } else {
+    shard.mHits++;
+  }
+  return entry;
+}
+
+std::shared_ptr<const Layout> LayoutCache::put(
+    const LayoutCacheKey& key,
+    std::shared_ptr<const Layout> layout) {
+  const size_t bytes = getEntrySize(key, *layout);
+
+  // Copy the text before taking the lock. It is freed again if the key turns
+  // out to be in the cache already.
+  LayoutCacheKey keyCopy = key;
+  keyCopy.copyText();
+
+  Shard& shard = getShard(key);
+  std::scoped_lock _l(shard.mMutex);
+  if (!shard.mCache.put(keyCopy, layout)) {
+    keyCopy.freeText();
+    return shard.mCache.get(key);
+  }
+  shard.mBytes += bytes;
+  // Always keep the new entry, even if it exceeds the budget on its own.
+  while (shard.mBytes > mMaxBytesPerShard && shard.mCache.size() > 1) {
+    shard.mCache.removeOldest();
+  }
+  return layout;
+}
+
+void LayoutCache::clear() {
+  for (Shard& shard : mShards) {
+    std::scoped_lock _l(shard.mMutex);
+    shard.mCache.clear();
+  }
+}
+
+LayoutCacheStats LayoutCache::getStats() const {
+  LayoutCacheStats stats;
+  for (const Shard& shard : mShards) {
+    std::scoped_lock _l(shard.mMutex);
+    stats.hits += shard.mHits;
+    stats.misses += shard.mMisses;
+    stats.entryCount += shard.mCache.size();
+    stats.bytes += shard.mBytes;
+  }
+  return stats;
+}
+
+}  // namespace minikin
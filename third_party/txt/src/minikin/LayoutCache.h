@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINIKIN_LAYOUT_CACHE_H
+#define MINIKIN_LAYOUT_CACHE_H
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include <utils/LruCache.h>
+
+#include <minikin/Layout.h>
+
+namespace minikin {
+
+class LayoutCacheKey {
+ public:
+  LayoutCacheKey(const std::shared_ptr<FontCollection>& collection,
+                 const MinikinPaint& paint,
+                 FontStyle style,
+                 const uint16_t* chars,
+                 size_t start,
+                 size_t count,
+                 size_t nchars,
+                 bool dir)
+      : mChars(chars),
+        mNchars(nchars),
+        mStart(start),
+        mCount(count),
+        mId(collection->getId()),
+        mStyle(style),
+        mSize(paint.size),
+        mScaleX(paint.scaleX),
+        mSkewX(paint.skewX),
+        mLetterSpacing(paint.letterSpacing),
+        mPaintFlags(paint.paintFlags),
+        mHyphenEdit(paint.hyphenEdit),
+        mIsRtl(dir),
+        mHash(computeHash()) {}
+  bool operator==(const LayoutCacheKey& other) const;
+
+  android::hash_t hash() const { return mHash; }
+
+  void copyText() {
+    uint16_t* charsCopy = new uint16_t[mNchars];
+    memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
+    mChars = charsCopy;
+  }
+  void freeText() {
+    delete[] mChars;
+    mChars = NULL;
+  }
+
+  // The memory used by a copy of this key in the cache, including its text.
+  size_t getMemoryUsage() const {
+    return sizeof(*this) + mNchars * sizeof(uint16_t);
+  }
+
+  // Defined in Layout.cpp. This takes gMinikinLock only to itemize the text.
+  void doLayout(Layout* layout,
+                LayoutContext* ctx,
+                const std::shared_ptr<FontCollection>& collection) const;
+
+ private:
+  const uint16_t* mChars;
+  size_t mNchars;
+  size_t mStart;
+  size_t mCount;
+  uint32_t mId;  // for the font collection
+  FontStyle mStyle;
+  float mSize;
+  float mScaleX;
+  float mSkewX;
+  float mLetterSpacing;
+  int32_t mPaintFlags;
+  HyphenEdit mHyphenEdit;
+  bool mIsRtl;
+  // Note: any fields added to MinikinPaint must also be reflected here.
+  // TODO: language matching (possibly integrate into style)
+  android::hash_t mHash;
+
+  android::hash_t computeHash() const;
+};
+
+android::hash_t hash_type(const LayoutCacheKey& key);
+
+// A cache of the layouts of words that may be used from several threads at
+// the same time.
+//
+// The entries are spread over a number of shards by the hash of their key.
+// Each shard is an LRU cache with its own lock, so threads laying out
+// different words rarely wait for each other. A shard evicts its least
+// recently used entries once their estimated memory footprint exceeds its
+// share of the budget of the cache.
+//
+// The cached layouts are immutable and shared with the callers, so an entry
+// may be evicted while another thread still copies from its layout.
+class LayoutCache {
+ public:
+  static const size_t kShardCount = 16;
+  // The default budget, which roughly matches the 5000 words the cache used
+  // to be limited to.
+  static const size_t kDefaultMaxBytes = 2 * 1024 * 1024;
+
+  explicit LayoutCache(size_t maxBytes = kDefaultMaxBytes);
+  ~LayoutCache();
+
+  // Returns the cached layout for the key or nullptr if there is none.
+  std::shared_ptr<const Layout> find(const LayoutCacheKey& key);
+
+  // Adds the layout for the key, which must refer to the text of the caller.
+  // If another thread added a layout for the same key in the meantime, that
+  // layout is kept and returned instead.
+  std::shared_ptr<const Layout> put(const LayoutCacheKey& key,
+                                    std::shared_ptr<const Layout> layout);
+
+  void clear();
+
+  LayoutCacheStats getStats() const;
+
+ private:
+  using Entry = std::shared_ptr<const Layout>;
+
+  class Shard : private android::OnEntryRemoved<LayoutCacheKey, Entry> {
+   public:
+    Shard();
+
+    mutable std::mutex mMutex;
+    android::LruCache<LayoutCacheKey, Entry> mCache;
+    // The sum of |getEntrySize| of the entries.
+    size_t mBytes = 0;
+    uint64_t mHits = 0;
+    uint64_t mMisses = 0;
+
+   private:
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key, Entry& value) override;
+  };
+
+  // Layouts are not modified once they are cached, so this does not change
+  // while the entry is cached.
+  static size_t getEntrySize(const LayoutCacheKey& key, const Layout& layout) {
+    return key.getMemoryUsage() + layout.getMemoryUsage();
+  }
+
+  Shard& getShard(const LayoutCacheKey& key) {
+    return mShards[key.hash() % kShardCount];
+  }
+
+  const size_t mMaxBytesPerShard;
+  Shard mShards[kShardCount];
+
+  // Forbid copying and assignment.
+  LayoutCache(const LayoutCache&) = delete;
+  void operator=(const LayoutCache&) = delete;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_LAYOUT_CACHE_H
@@ -145,6 +145,19 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt extension: Like addStyleRun, but copies the widths of the
+  // characters from |charWidths| instead of measuring the text. The widths
+  // must have been read from getCharWidths after an addStyleRun call for the
+  // same text and paint, so that they only have to be measured once when the
+  // same paragraph is broken at several widths.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl,
+                           const float* charWidths);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -160,6 +173,10 @@ class LineBreaker {
 
   const float* getWidths() const { return mWidths.data(); }
 
+  // libtxt extension: The width of each character of the text, as measured by
+  // addStyleRun.
+  const float* getCharWidths() const { return mCharWidths.data(); }
+
   const int* getFlags() const { return mFlags.data(); }
 
   void finish();
@@ -188,6 +205,15 @@ class LineBreaker {
     HyphenationType hyphenType;
   };
 
+  // Finds the candidate breaks in a style run whose character widths are
+  // already in mCharWidths.
+  void addCandidatesForStyleRun(MinikinPaint* paint,
+                                const std::shared_ptr<FontCollection>& typeface,
+                                FontStyle style,
+                                size_t start,
+                                size_t end,
+                                bool isRtl);
+
   float currentLineWidth() const;
 
   void addWordBreak(size_t offset,
@@ -16,12 +16,10 @@
 
 #include <minikin/MinikinFont.h>
 #include "HbFontCache.h"
-#include "MinikinInternal.h"
 
 namespace minikin {
 
 MinikinFont::~MinikinFont() {
-  std::scoped_lock _l(gMinikinLock);
   purgeHbFontLocked(this);
 }
 
@@ -206,4 +206,12 @@ Paragraph::Range<size_t> ParagraphSkia::GetWordBoundary(size_t offset) {
   return Paragraph::Range<size_t>(range.start, range.end);
 }
 
+bool ParagraphSkia::ReplaceText(size_t start,
+                                size_t end,
+                                const std::u16string& text,
+                                const TextStyle& style) {
+  // SkParagraph can not be edited once it has been built.
+  return false;
+}
+
 }  // namespace txt
@@ -67,6 +67,11 @@ class ParagraphSkia : public Paragraph {
 
   Range<size_t> GetWordBoundary(size_t offset) override;
 
+  bool ReplaceText(size_t start,
+                   size_t end,
+                   const std::u16string& text,
+                   const TextStyle& style) override;
+
  private:
   std::unique_ptr<skia::textlayout::Paragraph> paragraph_;
   std::optional<std::vector<LineMetrics>> line_metrics_;
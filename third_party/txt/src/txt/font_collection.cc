@@ -23,10 +23,12 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "flutter/fml/logging.h"
 #include "flutter/fml/trace_event.h"
 #include "font_skia.h"
+#include "minikin/MinikinInternal.h"
 #include "txt/platform.h"
 #include "txt/text_style.h"
 
@@ -89,22 +91,27 @@ size_t FontCollection::GetFontManagersCount() const {
 }
 
 void FontCollection::SetupDefaultFontManager() {
+  std::scoped_lock lock(minikin::gMinikinLock);
   default_font_manager_ = GetDefaultFontManager();
 }
 
 void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::scoped_lock lock(minikin::gMinikinLock);
   default_font_manager_ = font_manager;
 }
 
 void FontCollection::SetAssetFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::scoped_lock lock(minikin::gMinikinLock);
   asset_font_manager_ = font_manager;
 }
 
 void FontCollection::SetDynamicFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::scoped_lock lock(minikin::gMinikinLock);
   dynamic_font_manager_ = font_manager;
 }
 
 void FontCollection::SetTestFontManager(sk_sp<SkFontMgr> font_manager) {
+  std::scoped_lock lock(minikin::gMinikinLock);
   test_font_manager_ = font_manager;
 }
 
@@ -123,6 +130,7 @@ std::vector<sk_sp<SkFontMgr>> FontCollection::GetFontManagerOrder() const {
 }
 
 void FontCollection::DisableFontFallback() {
+  std::scoped_lock lock(minikin::gMinikinLock);
   enable_font_fallback_ = false;
 }
 
@@ -130,6 +138,7 @@ std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamilies(
     const std::vector<std::string>& font_families,
     const std::string& locale) {
+  std::scoped_lock lock(minikin::gMinikinLock);
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
   auto cached = font_collections_cache_.find(family_key);
@@ -241,7 +250,8 @@ void FontCollection::SortSkTypefaces(
 
 std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
     const sk_sp<SkFontMgr>& manager,
-    const std::string& family_name) {
+    const std::string& family_name,
+    bool use_fallback_index) {
   TRACE_EVENT1("flutter", "FontCollection::CreateMinikinFontFamily",
                "family_name", family_name.c_str());
   sk_sp<SkFontStyleSet> font_style_set(
@@ -272,12 +282,29 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
                            skia_typeface->isItalic()});
   }
 
+  if (use_fallback_index) {
+    minikin::SparseBitSet coverage;
+    bool has_vs_table;
+    if (fallback_index_->LookupCoverage(family_name, &coverage,
+                                        &has_vs_table)) {
+      return std::make_shared<minikin::FontFamily>(
+          std::move(minikin_fonts), std::move(coverage), has_vs_table);
+    }
+    auto minikin_family =
+        std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
+    fallback_index_->AddCoverage(family_name, minikin_family->getCoverage(),
+                                 minikin_family->hasVSTable());
+    return minikin_family;
+  }
+
   return std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
 }
 
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  // Usually already held, as minikin matches fallback fonts while itemizing.
+  std::scoped_lock lock(minikin::gMinikinLock);
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
@@ -295,18 +322,20 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
     uint32_t ch,
     std::string locale) {
   for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
-    std::vector<const char*> bcp47;
-    if (!locale.empty())
-      bcp47.push_back(locale.c_str());
-    sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
-        0, SkFontStyle(), bcp47.data(), bcp47.size(), ch));
-    if (!typeface)
+    std::string family_name;
+    // Only the system fonts are indexed. The other font managers hold the
+    // fonts of the application, which are few and may change between runs.
+    if (fallback_index_ && manager == default_font_manager_) {
+      if (!fallback_index_->LookupMatch(locale, ch, &family_name)) {
+        family_name = MatchFallbackFamilyName(manager, ch, locale);
+        fallback_index_->AddMatch(locale, ch, family_name);
+      }
+    } else {
+      family_name = MatchFallbackFamilyName(manager, ch, locale);
+    }
+    if (family_name.empty())
       continue;
 
-    SkString sk_family_name;
-    typeface->getFamilyName(&sk_family_name);
-    std::string family_name(sk_family_name.c_str());
-
     if (std::find(fallback_fonts_for_locale_[locale].begin(),
                   fallback_fonts_for_locale_[locale].end(),
                   family_name) == fallback_fonts_for_locale_[locale].end())
@@ -317,6 +346,24 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
   return g_null_family;
 }
 
+std::string FontCollection::MatchFallbackFamilyName(
+    const sk_sp<SkFontMgr>& manager,
+    uint32_t ch,
+    const std::string& locale) {
+  TRACE_EVENT0("flutter", "FontCollection::MatchFallbackFamilyName");
+  std::vector<const char*> bcp47;
+  if (!locale.empty())
+    bcp47.push_back(locale.c_str());
+  sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
+      0, SkFontStyle(), bcp47.data(), bcp47.size(), ch));
+  if (!typeface)
+    return std::string();
+
+  SkString sk_family_name;
+  typeface->getFamilyName(&sk_family_name);
+  return std::string(sk_family_name.c_str());
+}
+
 const std::shared_ptr<minikin::FontFamily>&
 FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
                                       const std::string& family_name) {
@@ -326,8 +373,9 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
     return fallback_it->second;
   }
 
-  std::shared_ptr<minikin::FontFamily> minikin_family =
-      CreateMinikinFontFamily(manager, family_name);
+  std::shared_ptr<minikin::FontFamily> minikin_family = CreateMinikinFontFamily(
+      manager, family_name,
+      fallback_index_ != nullptr && manager == default_font_manager_);
   if (!minikin_family)
     return g_null_family;
 
@@ -342,9 +390,47 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 }
 
 void FontCollection::ClearFontFamilyCache() {
+  std::scoped_lock lock(minikin::gMinikinLock);
   font_collections_cache_.clear();
 }
 
+void FontCollection::SetGlyphRunCache(std::shared_ptr<GlyphRunCache> cache) {
+  glyph_run_cache_ = std::move(cache);
+}
+
+const std::shared_ptr<GlyphRunCache>& FontCollection::GetGlyphRunCache()
+    const {
+  return glyph_run_cache_;
+}
+
+void FontCollection::SetFallbackIndex(
+    std::shared_ptr<FontFallbackIndex> index) {
+  fallback_index_ = std::move(index);
+}
+
+const std::shared_ptr<FontFallbackIndex>& FontCollection::GetFallbackIndex()
+    const {
+  return fallback_index_;
+}
+
+std::vector<uint8_t> FontCollection::SerializeFallbackIndex() {
+  std::scoped_lock lock(minikin::gMinikinLock);
+  if (!fallback_index_ || !fallback_index_->HasChanges()) {
+    return {};
+  }
+  return fallback_index_->Serialize();
+}
+
+void FontCollection::SetHyphenationPatterns(
+    std::shared_ptr<HyphenationPatterns> patterns) {
+  hyphenation_patterns_ = std::move(patterns);
+}
+
+const std::shared_ptr<HyphenationPatterns>&
+FontCollection::GetHyphenationPatterns() const {
+  return hyphenation_patterns_;
+}
+
 #if FLUTTER_ENABLE_SKSHAPER
 
 sk_sp<skia::textlayout::FontCollection>
@@ -21,6 +21,7 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "flutter/fml/macros.h"
 #include "minikin/FontCollection.h"
 #include "minikin/FontFamily.h"
@@ -28,6 +29,9 @@
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "txt/asset_font_manager.h"
+#include "txt/font_fallback_index.h"
+#include "txt/glyph_run_cache.h"
+#include "txt/hyphenation_patterns.h"
 #include "txt/text_style.h"
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -36,6 +40,11 @@
 
 namespace txt {
 
+// The font managers and the caches of the collection are guarded by minikin's
+// global lock, which minikin also holds while it matches fallback fonts. This
+// lets paragraphs using the collection be laid out on other threads, see
+// |ParagraphLayoutQueue|. The glyph run cache and the fallback index must be
+// set before that.
 class FontCollection : public std::enable_shared_from_this<FontCollection> {
  public:
   FontCollection();
@@ -67,6 +76,31 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   // Remove all entries in the font family cache.
   void ClearFontFamilyCache();
 
+  // Shares identical runs of glyphs between the paragraphs laid out with this
+  // collection. There is no glyph run cache by default.
+  void SetGlyphRunCache(std::shared_ptr<GlyphRunCache> cache);
+
+  const std::shared_ptr<GlyphRunCache>& GetGlyphRunCache() const;
+
+  // Resolves the fallback fonts of the default font manager with the index,
+  // and records new matches and the coverage of new families in it. There is
+  // no fallback index by default.
+  void SetFallbackIndex(std::shared_ptr<FontFallbackIndex> index);
+
+  const std::shared_ptr<FontFallbackIndex>& GetFallbackIndex() const;
+
+  // Serializes the fallback index if fonts were matched since it was loaded
+  // or last serialized, for |FontFallbackIndex::Write|. Returns an empty
+  // vector if there are no new matches.
+  std::vector<uint8_t> SerializeFallbackIndex();
+
+  // Hyphenates the paragraphs laid out with this collection in the language
+  // of their locale, if there are patterns for it. Paragraphs are not
+  // hyphenated by default.
+  void SetHyphenationPatterns(std::shared_ptr<HyphenationPatterns> patterns);
+
+  const std::shared_ptr<HyphenationPatterns>& GetHyphenationPatterns() const;
+
 #if FLUTTER_ENABLE_SKSHAPER
 
   // Construct a Skia text layout FontCollection based on this collection.
@@ -106,6 +140,9 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   std::unordered_map<std::string, std::vector<std::string>>
       fallback_fonts_for_locale_;
   bool enable_font_fallback_;
+  std::shared_ptr<GlyphRunCache> glyph_run_cache_;
+  std::shared_ptr<FontFallbackIndex> fallback_index_;
+  std::shared_ptr<HyphenationPatterns> hyphenation_patterns_;
 
 #if FLUTTER_ENABLE_SKSHAPER
   // An equivalent font collection usable by the Skia text shaper library.
@@ -123,9 +160,18 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   std::shared_ptr<minikin::FontFamily> FindFontFamilyInManagers(
       const std::string& family_name);
 
+  // Takes the coverage of the family from the fallback index, or adds it to
+  // the index, if |use_fallback_index| is true.
   std::shared_ptr<minikin::FontFamily> CreateMinikinFontFamily(
       const sk_sp<SkFontMgr>& manager,
-      const std::string& family_name);
+      const std::string& family_name,
+      bool use_fallback_index = false);
+
+  // Returns the name of the family of the font that |manager| matches to the
+  // character, or an empty string if there is none.
+  static std::string MatchFallbackFamilyName(const sk_sp<SkFontMgr>& manager,
+                                             uint32_t ch,
+                                             const std::string& locale);
 
   // Sorts in-place a group of SkTypeface from an SkTypefaceSet into a
   // reasonable order for future queries.
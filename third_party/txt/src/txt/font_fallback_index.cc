@@ -0,0 +1,477 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "font_fallback_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'X', 'T', 'F', 'A', 'L', 'L', '1'};
+constexpr uint32_t kVersion = 1;
+
+// The family index of characters that no font has.
+constexpr uint32_t kNoFamily = 0xFFFFFFFF;
+
+// One past the largest Unicode code point.
+constexpr uint32_t kMaxCodePoint = 0x110000;
+
+// The file starts with this header, followed by sections of 32-bit words
+// stored in the byte order of the device:
+// - The names of the locales and families, each a byte size followed by the
+//   bytes padded to a word.
+// - For each locale, the index of its name and the number of its matches,
+//   followed by pairs of a code point and the index of the family name (or
+//   kNoFamily), sorted by code point.
+// - For each family, the index of its name, whether it has a variation
+//   sequence table and the number of ranges, followed by the ranges.
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t name_count;
+  uint64_t fingerprint;
+  uint32_t locale_count;
+  uint32_t coverage_count;
+};
+
+// Reads the words of a file without copying them.
+class WordReader {
+ public:
+  WordReader(const uint8_t* data, size_t size)
+      : words_(reinterpret_cast<const uint32_t*>(data)),
+        count_(size / sizeof(uint32_t)) {}
+
+  // Returns nullptr if the file is too short.
+  const uint32_t* Read(size_t count) {
+    if (count > count_ - position_) {
+      return nullptr;
+    }
+    const uint32_t* words = words_ + position_;
+    position_ += count;
+    return words;
+  }
+
+  bool ReadWord(uint32_t* word) {
+    const uint32_t* words = Read(1);
+    if (words == nullptr) {
+      return false;
+    }
+    *word = *words;
+    return true;
+  }
+
+  bool ReadString(std::string* string) {
+    uint32_t size;
+    if (!ReadWord(&size)) {
+      return false;
+    }
+    const uint32_t* words = Read((static_cast<size_t>(size) + 3) / 4);
+    if (words == nullptr) {
+      return false;
+    }
+    string->assign(reinterpret_cast<const char*>(words), size);
+    return true;
+  }
+
+ private:
+  const uint32_t* words_;
+  size_t count_;
+  size_t position_ = 0;
+};
+
+void AppendWord(std::vector<uint32_t>* words, uint32_t word) {
+  words->push_back(word);
+}
+
+void AppendString(std::vector<uint32_t>* words, const std::string& string) {
+  AppendWord(words, string.size());
+  const size_t start = words->size();
+  words->resize(start + (string.size() + 3) / 4, 0);
+  std::memcpy(words->data() + start, string.data(), string.size());
+}
+
+bool IsValidCoverage(const uint32_t* ranges, size_t range_count) {
+  uint32_t previous_end = 0;
+  for (size_t i = 0; i < range_count; ++i) {
+    uint32_t start = ranges[i * 2];
+    uint32_t end = ranges[i * 2 + 1];
+    if (start < previous_end || start >= end || end > kMaxCodePoint) {
+      return false;
+    }
+    previous_end = end;
+  }
+  return true;
+}
+
+}  // namespace
+
+uint64_t FontFallbackIndex::ComputeFingerprint(
+    const std::vector<std::string>& font_directories) {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::ComputeFingerprint");
+  // FNV-1a, which is stable across runs unlike std::hash.
+  uint64_t hash = 14695981039346656037ull;
+  auto update = [&hash](const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  };
+
+  // Adding or removing a font changes the names listed in the directory
+  // holding it. Listing the directories is needed to find the subdirectories
+  // anyway, and works the same on all platforms.
+  std::vector<std::string> pending(font_directories.rbegin(),
+                                   font_directories.rend());
+  while (!pending.empty()) {
+    std::string path = std::move(pending.back());
+    pending.pop_back();
+    fml::UniqueFD directory =
+        fml::OpenDirectory(path.c_str(), false, fml::FilePermission::kRead);
+    if (!directory.is_valid() || !fml::IsDirectory(directory)) {
+      continue;
+    }
+    update(path.data(), path.size());
+
+    std::vector<std::string> filenames;
+    std::vector<std::string> subdirectories;
+    fml::VisitFiles(directory, [&filenames, &subdirectories, &path](
+                                   const fml::UniqueFD& directory,
+                                   const std::string& filename) {
+      filenames.push_back(filename);
+      if (fml::IsDirectory(directory, filename.c_str())) {
+        subdirectories.push_back(path + "/" + filename);
+      }
+      return true;
+    });
+    // Hash and visit the entries in the same order every time.
+    std::sort(filenames.begin(), filenames.end());
+    for (const std::string& filename : filenames) {
+      // Include the terminator so that the names can't run into each other.
+      update(filename.c_str(), filename.size() + 1);
+    }
+    std::sort(subdirectories.rbegin(), subdirectories.rend());
+    pending.insert(pending.end(), subdirectories.begin(),
+                   subdirectories.end());
+  }
+  return hash;
+}
+
+FontFallbackIndex::FontFallbackIndex(uint64_t fingerprint)
+    : fingerprint_(fingerprint) {}
+
+FontFallbackIndex::~FontFallbackIndex() = default;
+
+bool FontFallbackIndex::Load(const fml::UniqueFD& directory) {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Load");
+  ClearMapped();
+  if (!directory.is_valid() || !fml::FileExists(directory, kFileName)) {
+    return false;
+  }
+  auto mapping = fml::FileMapping::CreateReadOnly(directory, kFileName);
+  if (mapping == nullptr ||
+      !Parse(mapping->GetMapping(), mapping->GetSize())) {
+    ClearMapped();
+    return false;
+  }
+  mapping_ = std::move(mapping);
+  return true;
+}
+
+bool FontFallbackIndex::Parse(const uint8_t* data, size_t size) {
+  if (data == nullptr || size < sizeof(FileHeader) ||
+      reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0) {
+    return false;
+  }
+  FileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.fingerprint != fingerprint_) {
+    return false;
+  }
+
+  WordReader reader(data + sizeof(FileHeader), size - sizeof(FileHeader));
+  for (uint32_t i = 0; i < header.name_count; ++i) {
+    std::string name;
+    if (!reader.ReadString(&name)) {
+      return false;
+    }
+    mapped_names_.push_back(std::move(name));
+  }
+
+  for (uint32_t i = 0; i < header.locale_count; ++i) {
+    uint32_t name_index;
+    uint32_t match_count;
+    if (!reader.ReadWord(&name_index) || !reader.ReadWord(&match_count) ||
+        name_index >= mapped_names_.size()) {
+      return false;
+    }
+    const uint32_t* records = reader.Read(static_cast<size_t>(match_count) * 2);
+    if (records == nullptr) {
+      return false;
+    }
+    MappedMatches& matches = mapped_matches_[mapped_names_[name_index]];
+    matches.records = reinterpret_cast<const MatchRecord*>(records);
+    matches.count = match_count;
+  }
+
+  for (uint32_t i = 0; i < header.coverage_count; ++i) {
+    uint32_t name_index;
+    uint32_t has_vs_table;
+    uint32_t range_count;
+    if (!reader.ReadWord(&name_index) || !reader.ReadWord(&has_vs_table) ||
+        !reader.ReadWord(&range_count) || name_index >= mapped_names_.size()) {
+      return false;
+    }
+    const uint32_t* ranges = reader.Read(static_cast<size_t>(range_count) * 2);
+    // The ranges are checked once here since a SparseBitSet built from
+    // invalid ranges writes out of bounds.
+    if (ranges == nullptr || !IsValidCoverage(ranges, range_count)) {
+      return false;
+    }
+    MappedCoverage& coverage = mapped_coverage_[mapped_names_[name_index]];
+    coverage.ranges = ranges;
+    coverage.range_count = range_count;
+    coverage.has_vs_table = has_vs_table != 0;
+  }
+  return true;
+}
+
+void FontFallbackIndex::ClearMapped() {
+  mapping_.reset();
+  mapped_names_.clear();
+  mapped_matches_.clear();
+  mapped_coverage_.clear();
+}
+
+bool FontFallbackIndex::Save(const fml::UniqueFD& directory) {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Save");
+  if (!directory.is_valid()) {
+    return false;
+  }
+  if (!Write(directory, Serialize())) {
+    has_changes_ = true;
+    return false;
+  }
+
+  // Search the saved file in place again instead of the copies in memory.
+  if (Load(directory)) {
+    added_matches_.clear();
+    added_coverage_.clear();
+  }
+  return true;
+}
+
+std::vector<uint8_t> FontFallbackIndex::Serialize() {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Serialize");
+  // Move the mapped entries into memory, since a mapped file can not be
+  // replaced on all platforms. The added entries replace them.
+  for (const auto& [locale, mapped] : mapped_matches_) {
+    std::map<uint32_t, std::string>& matches = added_matches_[locale];
+    for (size_t i = 0; i < mapped.count; ++i) {
+      const MatchRecord& record = mapped.records[i];
+      if (record.family_index == kNoFamily) {
+        matches.emplace(record.code_point, std::string());
+      } else if (record.family_index < mapped_names_.size()) {
+        matches.emplace(record.code_point,
+                        mapped_names_[record.family_index]);
+      }
+    }
+  }
+  for (const auto& [family_name, mapped] : mapped_coverage_) {
+    if (added_coverage_.count(family_name) == 0) {
+      Coverage& coverage = added_coverage_[family_name];
+      coverage.ranges.assign(mapped.ranges,
+                             mapped.ranges + mapped.range_count * 2);
+      coverage.has_vs_table = mapped.has_vs_table;
+    }
+  }
+  ClearMapped();
+
+  std::vector<std::string> names;
+  std::unordered_map<std::string, uint32_t> name_indexes;
+  auto name_index = [&names, &name_indexes](const std::string& name) {
+    auto found = name_indexes.find(name);
+    if (found != name_indexes.end()) {
+      return found->second;
+    }
+    uint32_t index = names.size();
+    names.push_back(name);
+    name_indexes.emplace(name, index);
+    return index;
+  };
+
+  std::vector<uint32_t> locale_words;
+  for (const auto& [locale, matches] : added_matches_) {
+    AppendWord(&locale_words, name_index(locale));
+    AppendWord(&locale_words, matches.size());
+    for (const auto& [code_point, family_name] : matches) {
+      AppendWord(&locale_words, code_point);
+      AppendWord(&locale_words,
+                 family_name.empty() ? kNoFamily : name_index(family_name));
+    }
+  }
+  std::vector<uint32_t> coverage_words;
+  for (const auto& [family_name, coverage] : added_coverage_) {
+    AppendWord(&coverage_words, name_index(family_name));
+    AppendWord(&coverage_words, coverage.has_vs_table ? 1 : 0);
+    AppendWord(&coverage_words, coverage.ranges.size() / 2);
+    coverage_words.insert(coverage_words.end(), coverage.ranges.begin(),
+                          coverage.ranges.end());
+  }
+  std::vector<uint32_t> name_words;
+  for (const std::string& name : names) {
+    AppendString(&name_words, name);
+  }
+
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.name_count = names.size();
+  header.fingerprint = fingerprint_;
+  header.locale_count = added_matches_.size();
+  header.coverage_count = added_coverage_.size();
+
+  std::vector<uint8_t> file(sizeof(header));
+  std::memcpy(file.data(), &header, sizeof(header));
+  for (const std::vector<uint32_t>* words :
+       {&name_words, &locale_words, &coverage_words}) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(words->data());
+    file.insert(file.end(), bytes, bytes + words->size() * sizeof(uint32_t));
+  }
+  has_changes_ = false;
+  return file;
+}
+
+bool FontFallbackIndex::Write(const fml::UniqueFD& directory,
+                              std::vector<uint8_t> data) {
+  TRACE_EVENT0("flutter", "FontFallbackIndex::Write");
+  if (!directory.is_valid() || data.empty()) {
+    return false;
+  }
+  // fml::WriteAtomically uses the same temporary file for every write of a
+  // file name, so write a name unique to this write and rename it instead.
+  // Other processes of the app may write to the same directory, so the name
+  // is random rather than counted.
+  std::random_device random;
+  const std::string temp_file_name = std::string(kFileName) + "." +
+                                     std::to_string(random()) + "." +
+                                     std::to_string(random());
+  if (!fml::WriteAtomically(directory, temp_file_name.c_str(),
+                            fml::DataMapping(std::move(data))) ||
+      !fml::RenameFile(directory, temp_file_name.c_str(), kFileName)) {
+    FML_LOG(ERROR) << "Could not save the font fallback index.";
+    if (fml::FileExists(directory, temp_file_name.c_str())) {
+      fml::UnlinkFile(directory, temp_file_name.c_str());
+    }
+    return false;
+  }
+  return true;
+}
+
+bool FontFallbackIndex::LookupMatch(const std::string& locale,
+                                    uint32_t ch,
+                                    std::string* family_name) const {
+  auto added = added_matches_.find(locale);
+  if (added != added_matches_.end()) {
+    auto match = added->second.find(ch);
+    if (match != added->second.end()) {
+      *family_name = match->second;
+      return true;
+    }
+  }
+
+  auto mapped = mapped_matches_.find(locale);
+  if (mapped == mapped_matches_.end()) {
+    return false;
+  }
+  const MatchRecord* begin = mapped->second.records;
+  const MatchRecord* end = begin + mapped->second.count;
+  const MatchRecord* record = std::lower_bound(
+      begin, end, ch, [](const MatchRecord& record, uint32_t ch) {
+        return record.code_point < ch;
+      });
+  if (record == end || record->code_point != ch) {
+    return false;
+  }
+  if (record->family_index == kNoFamily) {
+    family_name->clear();
+    return true;
+  }
+  if (record->family_index >= mapped_names_.size()) {
+    return false;
+  }
+  *family_name = mapped_names_[record->family_index];
+  return true;
+}
+
+void FontFallbackIndex::AddMatch(const std::string& locale,
+                                 uint32_t ch,
+                                 const std::string& family_name) {
+  added_matches_[locale][ch] = family_name;
+  has_changes_ = true;
+}
+
+bool FontFallbackIndex::LookupCoverage(const std::string& family_name,
+                                       minikin::SparseBitSet* coverage,
+                                       bool* has_vs_table) const {
+  auto added = added_coverage_.find(family_name);
+  if (added != added_coverage_.end()) {
+    *coverage = minikin::SparseBitSet(added->second.ranges.data(),
+                                      added->second.ranges.size() / 2);
+    *has_vs_table = added->second.has_vs_table;
+    return true;
+  }
+
+  auto mapped = mapped_coverage_.find(family_name);
+  if (mapped == mapped_coverage_.end()) {
+    return false;
+  }
+  *coverage =
+      minikin::SparseBitSet(mapped->second.ranges, mapped->second.range_count);
+  *has_vs_table = mapped->second.has_vs_table;
+  return true;
+}
+
+void FontFallbackIndex::AddCoverage(const std::string& family_name,
+                                    const minikin::SparseBitSet& coverage,
+                                    bool has_vs_table) {
+  Coverage& added = added_coverage_[family_name];
+  added.ranges.clear();
+  added.has_vs_table = has_vs_table;
+  uint32_t start = coverage.nextSetBit(0);
+  while (start != minikin::SparseBitSet::kNotFound) {
+    uint32_t end = start + 1;
+    while (end < coverage.length() && coverage.get(end)) {
+      end++;
+    }
+    added.ranges.push_back(start);
+    added.ranges.push_back(end);
+    start = coverage.nextSetBit(end);
+  }
+  has_changes_ = true;
+}
+
+}  // namespace txt
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_FONT_FALLBACK_INDEX_H_
+#define LIB_TXT_SRC_FONT_FALLBACK_INDEX_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "minikin/SparseBitSet.h"
+
+namespace txt {
+
+// A persistent record of the fallback fonts that the system font manager
+// matched to characters, and of the characters that those fonts cover.
+//
+// Matching a fallback font makes the font manager probe the system fonts, and
+// creating the matched family parses its cmap table. Both stall the first
+// frame that shows an emoji or a CJK character. Saving the results lets later
+// runs resolve those characters with a lookup instead.
+//
+// A saved index is memory mapped when it is loaded and searched in place.
+// It is only used while its fingerprint matches the one computed from the
+// listings of the system font directories. Entries added after loading are
+// kept in memory until the index is saved again.
+//
+// Like the FontCollection using it, the index is not thread safe.
+class FontFallbackIndex {
+ public:
+  static constexpr char kFileName[] = "font_fallback.index";
+
+  // Returns a fingerprint of the directories and their subdirectories, which
+  // changes whenever fonts are added to or removed from them.
+  static uint64_t ComputeFingerprint(
+      const std::vector<std::string>& font_directories);
+
+  explicit FontFallbackIndex(uint64_t fingerprint);
+
+  ~FontFallbackIndex();
+
+  // Maps the index saved in |directory|. Returns false if there is none or it
+  // was saved with another fingerprint.
+  bool Load(const fml::UniqueFD& directory);
+
+  // Writes the loaded and the added entries to |directory|. This performs
+  // file IO.
+  bool Save(const fml::UniqueFD& directory);
+
+  // Returns the loaded and the added entries in the format of a saved index,
+  // so that |Write| can save them on another thread. This does not perform
+  // file IO, but keeps the loaded entries in memory from now on.
+  std::vector<uint8_t> Serialize();
+
+  // Writes an index returned by |Serialize| to |directory|. The index is
+  // written to a temporary file first and renamed, so indexes written at the
+  // same time by several collections never mix. This performs file IO and
+  // may be called on any thread.
+  static bool Write(const fml::UniqueFD& directory, std::vector<uint8_t> data);
+
+  // Whether entries were added since the index was loaded or saved.
+  bool HasChanges() const { return has_changes_; }
+
+  // Looks up the family that was matched to the character for the locale. An
+  // empty family name means that no font has the character. Returns false if
+  // the character was not matched before.
+  bool LookupMatch(const std::string& locale,
+                   uint32_t ch,
+                   std::string* family_name) const;
+
+  void AddMatch(const std::string& locale,
+                uint32_t ch,
+                const std::string& family_name);
+
+  // Looks up the coverage of the family, as returned by
+  // |minikin::FontFamily::getCoverage|. Returns false if there is none.
+  bool LookupCoverage(const std::string& family_name,
+                      minikin::SparseBitSet* coverage,
+                      bool* has_vs_table) const;
+
+  void AddCoverage(const std::string& family_name,
+                   const minikin::SparseBitSet& coverage,
+                   bool has_vs_table);
+
+ private:
+  struct MatchRecord {
+    uint32_t code_point;
+    uint32_t family_index;
+  };
+
+  // The matches of a locale in the mapped file, sorted by code point.
+  struct MappedMatches {
+    const MatchRecord* records = nullptr;
+    size_t count = 0;
+  };
+
+  // The ranges of covered code points, as pairs of the first and one past the
+  // last code point, of a family in the mapped file.
+  struct MappedCoverage {
+    const uint32_t* ranges = nullptr;
+    size_t range_count = 0;
+    bool has_vs_table = false;
+  };
+
+  struct Coverage {
+    std::vector<uint32_t> ranges;
+    bool has_vs_table = false;
+  };
+
+  const uint64_t fingerprint_;
+  std::unique_ptr<fml::FileMapping> mapping_;
+  // The family names of the mapped file.
+  std::vector<std::string> mapped_names_;
+  std::unordered_map<std::string, MappedMatches> mapped_matches_;
+  std::unordered_map<std::string, MappedCoverage> mapped_coverage_;
+
+  std::map<std::string, std::map<uint32_t, std::string>> added_matches_;
+  std::map<std::string, Coverage> added_coverage_;
+  bool has_changes_ = false;
+
+  bool Parse(const uint8_t* data, size_t size);
+
+  void ClearMapped();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FontFallbackIndex);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_FONT_FALLBACK_INDEX_H_
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glyph_run_cache.h"
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+
+namespace txt {
+
+GlyphRunCache::Key::Key(const SkFont& font,
+                        const SkGlyphID* glyphs,
+                        const SkScalar* positions,
+                        size_t glyph_count)
+    : typeface_id(font.getTypefaceOrDefault()->uniqueID()),
+      size(font.getSize()),
+      scale_x(font.getScaleX()),
+      skew_x(font.getSkewX()),
+      flags(static_cast<uint32_t>(font.getEdging()) |
+            static_cast<uint32_t>(font.getHinting()) << 2 |
+            font.isSubpixel() << 4 | font.isLinearMetrics() << 5 |
+            font.isEmbolden() << 6 | font.isForceAutoHinting() << 7 |
+            font.isEmbeddedBitmaps() << 8 | font.isBaselineSnap() << 9),
+      glyphs(glyphs, glyphs + glyph_count),
+      positions(positions, positions + glyph_count * 2) {
+  hash = fml::HashCombine(typeface_id, size, scale_x, skew_x, flags);
+  for (SkGlyphID glyph : this->glyphs) {
+    fml::HashCombineSeed(hash, glyph);
+  }
+  for (SkScalar position : this->positions) {
+    fml::HashCombineSeed(hash, position);
+  }
+}
+
+bool GlyphRunCache::Key::operator==(const Key& other) const {
+  return hash == other.hash && typeface_id == other.typeface_id &&
+         size == other.size && scale_x == other.scale_x &&
+         skew_x == other.skew_x && flags == other.flags &&
+         glyphs == other.glyphs && positions == other.positions;
+}
+
+GlyphRunCache::GlyphRunCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+GlyphRunCache::~GlyphRunCache() = default;
+
+sk_sp<SkTextBlob> GlyphRunCache::MakeTextBlob(SkTextBlobBuilder* builder,
+                                              const SkFont& font,
+                                              const SkGlyphID* glyphs,
+                                              const SkScalar* positions,
+                                              size_t glyph_count) {
+  // The builder has to be reset even if the blob turns out to be cached.
+  Key key(font, glyphs, positions, glyph_count);
+  sk_sp<SkTextBlob> blob = builder->make();
+
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(&key);
+  if (found != index_.end()) {
+    hit_count_++;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->blob;
+  }
+  miss_count_++;
+  if (blob == nullptr) {
+    return nullptr;
+  }
+
+  // The glyphs and positions are held by both the key and the blob.
+  const size_t bytes =
+      sizeof(Entry) + sizeof(SkTextBlob) +
+      2 * glyph_count * (sizeof(SkGlyphID) + 2 * sizeof(SkScalar));
+  entries_.push_front({std::move(key), blob, bytes});
+  index_.emplace(&entries_.front().key, entries_.begin());
+  bytes_ += bytes;
+
+  // Always keep the new entry, even if it exceeds the budget on its own.
+  while (bytes_ > max_bytes_ && entries_.size() > 1) {
+    const Entry& oldest = entries_.back();
+    bytes_ -= oldest.bytes;
+    index_.erase(&oldest.key);
+    entries_.pop_back();
+  }
+  return blob;
+}
+
+void GlyphRunCache::Clear() {
+  std::scoped_lock lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+GlyphRunCache::Stats GlyphRunCache::GetStats() const {
+  std::scoped_lock lock(mutex_);
+  Stats stats;
+  stats.hit_count = hit_count_;
+  stats.miss_count = miss_count_;
+  stats.entry_count = entries_.size();
+  stats.bytes = bytes_;
+  return stats;
+}
+
+void GlyphRunCache::TraceStatsToTimeline() {
+  constexpr double kMegaBytes = (1 << 20);
+  std::scoped_lock lock(mutex_);
+  FML_TRACE_COUNTER("flutter", "GlyphRunCache", reinterpret_cast<int64_t>(this),
+                    "RunCount", entries_.size(), "RunMBytes",
+                    bytes_ / kMegaBytes);
+  FML_TRACE_COUNTER("flutter", "GlyphRunCacheAccesses",
+                    reinterpret_cast<int64_t>(this), "Hits",
+                    hit_count_ - last_traced_hit_count_, "Misses",
+                    miss_count_ - last_traced_miss_count_);
+  last_traced_hit_count_ = hit_count_;
+  last_traced_miss_count_ = miss_count_;
+}
+
+}  // namespace txt
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_GLYPH_RUN_CACHE_H_
+#define LIB_TXT_SRC_GLYPH_RUN_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace txt {
+
+// Shares the text blobs of identical runs of glyphs between layouts and
+// paragraphs.
+//
+// Skia rasterizes the glyphs of a text blob into its glyph atlas and caches
+// the atlas draws of the blob by the unique ID of the blob, the paint and the
+// subpixel position it is drawn at. Every layout builds new blobs though, so
+// a label that is laid out again, or that is repeated in other paragraphs,
+// misses that cache. Handing out the same blob for the same glyphs, positions
+// and font keeps the rasterized runs in use across frames.
+//
+// The least recently used blobs are evicted once their estimated size
+// exceeds the budget. The cache may be used from several threads.
+class GlyphRunCache {
+ public:
+  struct Stats {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t entry_count = 0;
+    size_t bytes = 0;
+  };
+
+  static constexpr size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  explicit GlyphRunCache(size_t max_bytes = kDefaultMaxBytes);
+
+  ~GlyphRunCache();
+
+  // Makes the blob of the single run of glyphs being built by |builder|, or
+  // returns the cached blob of the same glyphs at the same positions in the
+  // same font instead. |positions| holds an x and y coordinate per glyph.
+  sk_sp<SkTextBlob> MakeTextBlob(SkTextBlobBuilder* builder,
+                                 const SkFont& font,
+                                 const SkGlyphID* glyphs,
+                                 const SkScalar* positions,
+                                 size_t glyph_count);
+
+  void Clear();
+
+  Stats GetStats() const;
+
+  // Reports the size of the cache, and its hits and misses since the last
+  // call, as counters on the timeline.
+  void TraceStatsToTimeline();
+
+ private:
+  struct Key {
+    Key(const SkFont& font,
+        const SkGlyphID* glyphs,
+        const SkScalar* positions,
+        size_t glyph_count);
+
+    uint32_t typeface_id;
+    SkScalar size;
+    SkScalar scale_x;
+    SkScalar skew_x;
+    uint32_t flags;
+    std::vector<SkGlyphID> glyphs;
+    std::vector<SkScalar> positions;
+    size_t hash;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyPointerHash {
+    size_t operator()(const Key* key) const { return key->hash; }
+  };
+
+  struct KeyPointerEqual {
+    bool operator()(const Key* a, const Key* b) const { return *a == *b; }
+  };
+
+  struct Entry {
+    Key key;
+    sk_sp<SkTextBlob> blob;
+    size_t bytes;
+  };
+
+  // The entries, the most recently used first.
+  using EntryList = std::list<Entry>;
+
+  const size_t max_bytes_;
+  mutable std::mutex mutex_;
+  EntryList entries_;
+  std::unordered_map<const Key*,
+                     EntryList::iterator,
+                     KeyPointerHash,
+                     KeyPointerEqual>
+      index_;
+  size_t bytes_ = 0;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+  size_t last_traced_hit_count_ = 0;
+  size_t last_traced_miss_count_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(GlyphRunCache);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_GLYPH_RUN_CACHE_H_
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hyphenation_patterns.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+namespace {
+
+// Converts a locale such as "en_US" to a lowercase language tag like "en-us".
+std::string GetLanguageTag(const std::string& locale) {
+  std::string tag = locale;
+  std::transform(tag.begin(), tag.end(), tag.begin(), [](char c) {
+    return c == '_' ? '-' : std::tolower(static_cast<unsigned char>(c));
+  });
+  return tag;
+}
+
+}  // namespace
+
+HyphenationPatterns::HyphenationPatterns(fml::UniqueFD directory)
+    : directory_(std::move(directory)) {}
+
+HyphenationPatterns::~HyphenationPatterns() = default;
+
+bool HyphenationPatterns::AddPatterns(const std::string& language,
+                                      std::unique_ptr<fml::Mapping> mapping) {
+  if (!mapping) {
+    return false;
+  }
+  std::unique_ptr<minikin::Hyphenator> hyphenator =
+      CreateHyphenator(language, *mapping);
+  if (!hyphenator) {
+    return false;
+  }
+  std::scoped_lock lock(mutex_);
+  patterns_[language] = {std::move(mapping), std::move(hyphenator)};
+  return true;
+}
+
+minikin::Hyphenator* HyphenationPatterns::GetHyphenator(
+    const std::string& locale) {
+  if (locale.empty()) {
+    return nullptr;
+  }
+  const std::string tag = GetLanguageTag(locale);
+  std::scoped_lock lock(mutex_);
+  minikin::Hyphenator* hyphenator = GetHyphenatorForLanguageLocked(tag);
+  if (hyphenator == nullptr) {
+    size_t separator = tag.find('-');
+    if (separator != std::string::npos) {
+      hyphenator = GetHyphenatorForLanguageLocked(tag.substr(0, separator));
+    }
+  }
+  return hyphenator;
+}
+
+minikin::Hyphenator* HyphenationPatterns::GetHyphenatorForLanguageLocked(
+    const std::string& language) {
+  auto found = patterns_.find(language);
+  if (found != patterns_.end()) {
+    return found->second.hyphenator.get();
+  }
+
+  Patterns& patterns = patterns_[language];
+  const std::string file_name = "hyph-" + language + ".hyb";
+  if (!directory_.is_valid() ||
+      !fml::FileExists(directory_, file_name.c_str())) {
+    return nullptr;
+  }
+  TRACE_EVENT0("flutter", "HyphenationPatterns::MapPatterns");
+  std::unique_ptr<fml::Mapping> mapping =
+      fml::FileMapping::CreateReadOnly(directory_, file_name);
+  if (!mapping) {
+    return nullptr;
+  }
+  patterns.hyphenator = CreateHyphenator(language, *mapping);
+  if (!patterns.hyphenator) {
+    FML_LOG(ERROR) << "Invalid hyphenation patterns in " << file_name;
+    return nullptr;
+  }
+  patterns.mapping = std::move(mapping);
+  return patterns.hyphenator.get();
+}
+
+std::unique_ptr<minikin::Hyphenator> HyphenationPatterns::CreateHyphenator(
+    const std::string& language,
+    const fml::Mapping& mapping) {
+  if (!minikin::Hyphenator::isValidBinary(mapping.GetMapping(),
+                                          mapping.GetSize())) {
+    return nullptr;
+  }
+  // The shortest prefix and suffix left on a line by a hyphen, as in the
+  // Android framework, which is more conservative for English.
+  const bool is_english = language == "en" || language.rfind("en-", 0) == 0;
+  const size_t min_prefix = 2;
+  const size_t min_suffix = is_english ? 3 : 2;
+  return std::unique_ptr<minikin::Hyphenator>(minikin::Hyphenator::loadBinary(
+      mapping.GetMapping(), min_prefix, min_suffix));
+}
+
+}  // namespace txt
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+#define LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "minikin/Hyphenator.h"
+
+namespace txt {
+
+// The hyphenation patterns of the languages that paragraphs are hyphenated
+// in, and a hyphenator for each of them.
+//
+// The patterns are files in minikin's hyb format named after the language
+// they hyphenate, such as "hyph-en-us.hyb" or "hyph-de.hyb". They are mapped
+// into memory when a paragraph in their language is first broken into lines
+// and the hyphenators read them in place, so loading them costs neither a
+// copy nor a parse. Each hyphenator remembers the hyphenation of the words it
+// hyphenated recently.
+//
+// Hyphenators may be looked up and used from several threads.
+class HyphenationPatterns {
+ public:
+  // |directory| holds the pattern files. It may be invalid, in which case
+  // only the patterns added with AddPatterns are used.
+  explicit HyphenationPatterns(fml::UniqueFD directory);
+
+  ~HyphenationPatterns();
+
+  // Hyphenates |language| with the patterns in |mapping|, which are kept
+  // mapped for the lifetime of this object. |language| is a lowercase BCP 47
+  // tag such as "en-us" or "en". Returns false if the mapping does not hold
+  // hyb patterns.
+  bool AddPatterns(const std::string& language,
+                   std::unique_ptr<fml::Mapping> mapping);
+
+  // Returns the hyphenator of |locale|, which is a locale such as "en-US" or
+  // "en_US". The patterns of the language and region are preferred over those
+  // of the language alone. Returns nullptr if there are no patterns for the
+  // locale. The hyphenator lives as long as this object.
+  minikin::Hyphenator* GetHyphenator(const std::string& locale);
+
+ private:
+  struct Patterns {
+    std::unique_ptr<fml::Mapping> mapping;
+    std::unique_ptr<minikin::Hyphenator> hyphenator;
+  };
+
+  // Maps the pattern file of |language| unless that was tried before.
+  // Returns nullptr if there is no such file.
+  minikin::Hyphenator* GetHyphenatorForLanguageLocked(
+      const std::string& language);
+
+  static std::unique_ptr<minikin::Hyphenator> CreateHyphenator(
+      const std::string& language,
+      const fml::Mapping& mapping);
+
+  fml::UniqueFD directory_;
+  std::mutex mutex_;
+  // Keyed by language. Languages without patterns have no hyphenator.
+  std::unordered_map<std::string, Patterns> patterns_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(HyphenationPatterns);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
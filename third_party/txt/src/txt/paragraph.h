@@ -175,6 +175,16 @@ class Paragraph {
   virtual Range<size_t> GetWordBoundary(size_t offset) = 0;
 
   virtual std::vector<LineMetrics>& GetLineMetrics() = 0;
+
+  // Replaces the code units in [start, end) with text drawn in the given
+  // style. A range is restyled by replacing it with the same text. The next
+  // call to Layout() only measures, shapes and breaks into lines the text
+  // around the edit again. Returns false if the paragraph cannot be edited,
+  // in which case it has to be built again.
+  virtual bool ReplaceText(size_t start,
+                           size_t end,
+                           const std::u16string& text,
+                           const TextStyle& style) = 0;
 };
 
 }  // namespace txt
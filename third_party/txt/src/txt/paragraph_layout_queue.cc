@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "paragraph_layout_queue.h"
+
+#include <utility>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+ParagraphLayoutQueue::ParagraphLayoutQueue(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    fml::RefPtr<fml::TaskRunner> ui_task_runner)
+    : worker_task_runner_(std::move(worker_task_runner)),
+      ui_task_runner_(std::move(ui_task_runner)),
+      pending_count_(std::make_shared<std::atomic_size_t>(0)) {
+  FML_DCHECK(worker_task_runner_);
+  FML_DCHECK(ui_task_runner_);
+}
+
+ParagraphLayoutQueue::~ParagraphLayoutQueue() = default;
+
+void ParagraphLayoutQueue::Layout(std::unique_ptr<Paragraph> paragraph,
+                                  double width,
+                                  LayoutCallback callback) {
+  FML_DCHECK(ui_task_runner_->RunsTasksOnCurrentThread());
+  FML_DCHECK(paragraph);
+  TRACE_EVENT0("flutter", "ParagraphLayoutQueue::Layout");
+  (*pending_count_)++;
+
+  const uint64_t flow_id = reinterpret_cast<uint64_t>(paragraph.get());
+  TRACE_FLOW_BEGIN("flutter", "ParagraphLayout", flow_id);
+  worker_task_runner_->PostTask(fml::MakeCopyable(
+      [paragraph = std::move(paragraph), width, callback = std::move(callback),
+       ui_task_runner = ui_task_runner_, pending_count = pending_count_,
+       flow_id]() mutable {
+        {
+          TRACE_EVENT0("flutter", "ParagraphLayoutQueue::LayoutOnWorker");
+          TRACE_FLOW_STEP("flutter", "ParagraphLayout", flow_id);
+          paragraph->Layout(width);
+        }
+        ui_task_runner->PostTask(fml::MakeCopyable(
+            [paragraph = std::move(paragraph), callback = std::move(callback),
+             pending_count = std::move(pending_count), flow_id]() mutable {
+              TRACE_EVENT0("flutter", "ParagraphLayoutQueue::OnLaidOut");
+              TRACE_FLOW_END("flutter", "ParagraphLayout", flow_id);
+              (*pending_count)--;
+              callback(std::move(paragraph));
+            }));
+      }));
+}
+
+size_t ParagraphLayoutQueue::GetPendingCount() const {
+  return *pending_count_;
+}
+
+}  // namespace txt
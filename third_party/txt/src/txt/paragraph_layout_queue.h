@@ -0,0 +1,75 @@
+/*
+ * Copyright 2020 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIB_TXT_SRC_PARAGRAPH_LAYOUT_QUEUE_H_
+#define LIB_TXT_SRC_PARAGRAPH_LAYOUT_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "paragraph.h"
+
+namespace txt {
+
+// Shapes and breaks paragraphs into lines on the workers of a concurrent
+// message loop, so that long documents can be laid out ahead of time without
+// blocking the UI thread.
+//
+// A queued paragraph belongs to the worker laying it out until it is handed
+// back on the UI task runner. Paragraphs are laid out concurrently, even if
+// they share a FontCollection: shaping does not hold minikin's global lock,
+// only matching the fonts of the text does. The font managers of the
+// collection must not be changed while layouts are pending.
+//
+// The queue must be used on the UI task runner.
+class ParagraphLayoutQueue {
+ public:
+  // Receives the laid out paragraph on the UI task runner.
+  using LayoutCallback = std::function<void(std::unique_ptr<Paragraph>)>;
+
+  ParagraphLayoutQueue(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      fml::RefPtr<fml::TaskRunner> ui_task_runner);
+
+  ~ParagraphLayoutQueue();
+
+  // Lays out the paragraph for |width| on a worker and invokes |callback| with
+  // it on the UI task runner. The callback is invoked even if the queue has
+  // been destroyed by then.
+  void Layout(std::unique_ptr<Paragraph> paragraph,
+              double width,
+              LayoutCallback callback);
+
+  // The number of paragraphs whose callbacks have not been invoked yet.
+  size_t GetPendingCount() const;
+
+ private:
+  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+  // Shared with the pending layouts, which may outlive the queue.
+  std::shared_ptr<std::atomic_size_t> pending_count_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ParagraphLayoutQueue);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_PARAGRAPH_LAYOUT_QUEUE_H_
@@ -186,6 +186,63 @@ void FindWords(const std::vector<uint16_t>& text,
     words->emplace_back(word_start, end);
 }
 
+// An edit after which the words in [dirty_start, old_dirty_end) of the old
+// text, which are in [dirty_start, new_dirty_end) of the new text, have to be
+// measured and shaped again.
+struct TextEdit {
+  size_t dirty_start;
+  size_t old_dirty_end;
+  size_t new_dirty_end;
+
+  // Maps an index of the old text at or after old_dirty_end to the new text.
+  size_t MoveIndex(size_t index) const {
+    return index - old_dirty_end + new_dirty_end;
+  }
+};
+
+// Updates the ranges of cached runs of the text for an edit. The runs after
+// the edit are moved. A run containing the edit gets a stale range that
+// covers the edit and its previous stale range, and |splice| replaces the
+// contents of the run for the old stale range, relative to the start of the
+// run, with the new one. Runs that only partially overlap the edit are
+// dropped.
+template <typename Run, typename Splice>
+void MoveCachedRuns(const TextEdit& edit,
+                    std::vector<Run>* runs,
+                    Splice splice) {
+  std::vector<Run> moved_runs;
+  moved_runs.reserve(runs->size());
+  for (Run& run : *runs) {
+    if (run.end <= edit.dirty_start) {
+      // The run is before the edit.
+    } else if (run.start >= edit.old_dirty_end) {
+      run.start = edit.MoveIndex(run.start);
+      run.end = edit.MoveIndex(run.end);
+      if (run.stale_range.width() > 0) {
+        run.stale_range.start = edit.MoveIndex(run.stale_range.start);
+        run.stale_range.end = edit.MoveIndex(run.stale_range.end);
+      }
+    } else if (run.start <= edit.dirty_start &&
+               run.end >= edit.old_dirty_end) {
+      size_t stale_start = edit.dirty_start;
+      size_t old_stale_end = edit.old_dirty_end;
+      if (run.stale_range.width() > 0) {
+        stale_start = std::min(stale_start, run.stale_range.start);
+        old_stale_end = std::max(old_stale_end, run.stale_range.end);
+      }
+      size_t new_stale_end = edit.MoveIndex(old_stale_end);
+      splice(&run, stale_start - run.start, old_stale_end - run.start,
+             new_stale_end - run.start);
+      run.end = edit.MoveIndex(run.end);
+      run.stale_range = Paragraph::Range<size_t>(stale_start, new_stale_end);
+    } else {
+      continue;
+    }
+    moved_runs.push_back(std::move(run));
+  }
+  runs->swap(moved_runs);
+}
+
 }  // namespace
 
 static const float kDoubleDecorationSpacing = 3.0f;
@@ -251,36 +308,200 @@ void ParagraphTxt::SetInlinePlaceholders(
   obj_replacement_char_indexes_ = std::move(obj_replacement_char_indexes);
 }
 
+void ParagraphTxt::FindBlocks(size_t start,
+                              size_t end,
+                              std::vector<Block>* blocks) const {
+  size_t block_start = start;
+  for (size_t i = start; i < end; ++i) {
+    ULineBreak ulb = static_cast<ULineBreak>(
+        u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
+    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK) {
+      blocks->emplace_back(block_start, i);
+      block_start = i + 1;
+    }
+  }
+  blocks->emplace_back(block_start, end);
+}
+
+void ParagraphTxt::AddBlockLines(const Block& block) {
+  for (size_t i = 0; i < block.breaks.size(); ++i) {
+    size_t break_start = (i > 0) ? block.breaks[i - 1] : 0;
+    size_t line_start = break_start + block.start;
+    size_t line_end = block.breaks[i] + block.start;
+    bool hard_break = i == block.breaks.size() - 1;
+    size_t line_end_including_newline =
+        (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
+    size_t line_end_excluding_whitespace = line_end;
+    while (line_end_excluding_whitespace > line_start &&
+           minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
+      line_end_excluding_whitespace--;
+    }
+    line_metrics_.emplace_back(line_start, line_end,
+                               line_end_excluding_whitespace,
+                               line_end_including_newline, hard_break);
+    line_widths_.push_back(block.line_widths[i]);
+    line_hyphen_edits_.push_back(block.hyphen_edits[i]);
+  }
+}
+
+bool ParagraphTxt::ReplaceText(size_t start,
+                               size_t end,
+                               const std::u16string& text,
+                               const TextStyle& style) {
+  // The inline placeholders are tied to the indexes of their characters.
+  if (start > end || end > text_.size() || !inline_placeholders_.empty())
+    return false;
+
+  text_.erase(text_.begin() + start, text_.begin() + end);
+  text_.insert(text_.begin() + start, text.begin(), text.end());
+  runs_.ReplaceRange(start, end, text.size(), runs_.FindOrAddStyle(style));
+  text_edited_ = true;
+  if (needs_layout_)
+    return true;
+
+  // Words are measured and shaped with the text up to the next word break on
+  // each side as context, so the words next to the edit change as well.
+  const size_t new_end = start + text.size();
+  TextEdit edit;
+  edit.dirty_start =
+      minikin::getPrevWordBreakForCache(text_.data(), start, text_.size());
+  edit.new_dirty_end =
+      minikin::getNextWordBreakForCache(text_.data(), new_end, text_.size());
+  edit.old_dirty_end = edit.new_dirty_end - new_end + end;
+
+  // Find the blocks of the edited text again. The other blocks keep their
+  // line breaks.
+  if (!blocks_.empty()) {
+    size_t first = 0;
+    while (first + 1 < blocks_.size() && blocks_[first].end < start)
+      first++;
+    size_t last = first;
+    while (last + 1 < blocks_.size() && blocks_[last + 1].start <= end)
+      last++;
+    std::vector<Block> edited_blocks;
+    FindBlocks(blocks_[first].start, blocks_[last].end - end + new_end,
+               &edited_blocks);
+    for (size_t i = last + 1; i < blocks_.size(); ++i) {
+      blocks_[i].start = blocks_[i].start - end + new_end;
+      blocks_[i].end = blocks_[i].end - end + new_end;
+    }
+    blocks_.erase(blocks_.begin() + first, blocks_.begin() + last + 1);
+    blocks_.insert(blocks_.begin() + first, edited_blocks.begin(),
+                   edited_blocks.end());
+  }
+
+  MoveCachedRuns(edit, &measured_runs_,
+                 [](MeasuredRun* run, size_t stale_start, size_t old_stale_end,
+                    size_t new_stale_end) {
+                   std::vector<float>& widths = run->char_widths;
+                   widths.erase(widths.begin() + stale_start,
+                                widths.begin() + old_stale_end);
+                   widths.insert(widths.begin() + stale_start,
+                                 new_stale_end - stale_start, 0.0f);
+                 });
+
+  // The bidi runs refer to the styles, which may have moved, and are computed
+  // again by the next layout. Their shaped words are kept until then.
+  for (size_t i = 0; i < bidi_runs_.size(); ++i) {
+    const BidiRun& bidi_run = bidi_runs_[i];
+    std::vector<minikin::LayoutPiece>& pieces = bidi_run_pieces_[i];
+    if (pieces.empty())
+      continue;
+    for (minikin::LayoutPiece& piece : pieces)
+      piece.start -= bidi_run.start();
+    edited_shaped_runs_.push_back({bidi_run.start(), bidi_run.end(),
+                                   bidi_run.direction(), std::move(pieces),
+                                   Range<size_t>()});
+  }
+  std::sort(edited_shaped_runs_.begin(), edited_shaped_runs_.end(),
+            [](const ShapedRun& a, const ShapedRun& b) {
+              return a.start < b.start;
+            });
+  bidi_runs_.clear();
+  bidi_run_pieces_.clear();
+
+  MoveCachedRuns(edit, &edited_shaped_runs_,
+                 [](ShapedRun* run, size_t stale_start, size_t old_stale_end,
+                    size_t new_stale_end) {
+                   std::vector<minikin::LayoutPiece> pieces;
+                   for (minikin::LayoutPiece& piece : run->pieces) {
+                     if (piece.start + piece.count <= stale_start) {
+                       pieces.push_back(std::move(piece));
+                     } else if (piece.start >= old_stale_end) {
+                       piece.start =
+                           piece.start - old_stale_end + new_stale_end;
+                       pieces.push_back(std::move(piece));
+                     }
+                   }
+                   run->pieces = std::move(pieces);
+                 });
+  return true;
+}
+
+void ParagraphTxt::UpdateHyphenator() {
+  const std::shared_ptr<HyphenationPatterns>& patterns =
+      font_collection_->GetHyphenationPatterns();
+  minikin::Hyphenator* hyphenator =
+      patterns ? patterns->GetHyphenator(paragraph_style_.locale) : nullptr;
+  if (hyphenator == hyphenator_)
+    return;
+  hyphenator_ = hyphenator;
+  // The locale also selects the word boundaries of the breaker, which keeps
+  // the default locale unless the paragraph is hyphenated.
+  breaker_.setLocale(hyphenator ? icu::Locale(paragraph_style_.locale.c_str())
+                                : icu::Locale(),
+                     hyphenator);
+  for (Block& block : blocks_)
+    block.has_breaks = false;
+}
+
 bool ParagraphTxt::ComputeLineBreaks() {
   line_metrics_.clear();
   line_widths_.clear();
+  line_hyphen_edits_.clear();
   max_intrinsic_width_ = 0;
+  UpdateHyphenator();
 
-  std::vector<size_t> newline_positions;
-  // Discover and add all hard breaks.
-  for (size_t i = 0; i < text_.size(); ++i) {
-    ULineBreak ulb = static_cast<ULineBreak>(
-        u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
-    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
-      newline_positions.push_back(i);
-  }
-  // Break at the end of the paragraph.
-  newline_positions.push_back(text_.size());
+  // Discover all hard breaks.
+  if (blocks_.empty())
+    FindBlocks(0, text_.size(), &blocks_);
+
+  // The measured runs that are still used, and the next one of the previous
+  // layout to look at.
+  std::vector<MeasuredRun> measured_runs;
+  size_t measured_run_index = 0;
 
   // Calculate and add any breaks due to a line being too long.
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
-  for (size_t newline_index = 0; newline_index < newline_positions.size();
-       ++newline_index) {
-    size_t block_start =
-        (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
-    size_t block_end = newline_positions[newline_index];
+  for (Block& block : blocks_) {
+    size_t block_start = block.start;
+    size_t block_end = block.end;
     size_t block_size = block_end - block_start;
 
     if (block_size == 0) {
       line_metrics_.emplace_back(block_start, block_end, block_end,
                                  block_end + 1, true);
       line_widths_.push_back(0);
+      line_hyphen_edits_.push_back(minikin::HyphenEdit::NO_EDIT);
+      continue;
+    }
+
+    // The line breaks of a block that was not edited stay the same until the
+    // width changes.
+    if (block.has_breaks && block.breaks_width == width_) {
+      for (; measured_run_index < measured_runs_.size() &&
+             measured_runs_[measured_run_index].start < block_end;
+           ++measured_run_index) {
+        if (measured_runs_[measured_run_index].start >= block_start) {
+          measured_runs.push_back(
+              std::move(measured_runs_[measured_run_index]));
+        }
+      }
+      max_intrinsic_width_ =
+          std::max(max_intrinsic_width_, block.intrinsic_width);
+      inline_placeholder_index += block.placeholder_count;
+      AddBlockLines(block);
       continue;
     }
 
@@ -297,6 +518,7 @@ bool ParagraphTxt::ComputeLineBreaks() {
 
     // Add the runs that include this line to the LineBreaker.
     double block_total_width = 0;
+    size_t block_placeholder_start = inline_placeholder_index;
     while (run_index < runs_.size()) {
       StyledRuns::Run run = runs_.GetRun(run_index);
       if (run.start >= block_end)
@@ -317,6 +539,8 @@ bool ParagraphTxt::ComputeLineBreaks() {
                               ? ""
                               : run.style.font_families[0])
                       << "\".";
+        // Some of the measured runs have been moved already.
+        measured_runs_.clear();
         return false;
       }
       size_t run_start = std::max(run.start, block_start) - block_start;
@@ -344,10 +568,54 @@ bool ParagraphTxt::ComputeLineBreaks() {
                              isRtl);
         inline_placeholder_index++;
       } else {
-        // Is a regular text run.
-        double run_width = breaker_.addStyleRun(&paint, collection, font,
-                                                run_start, run_end, isRtl);
-        block_total_width += run_width;
+        // Is a regular text run. Look for the measurement of the same range
+        // by an earlier layout.
+        size_t text_run_start = run_start + block_start;
+        size_t text_run_end = run_end + block_start;
+        while (measured_run_index < measured_runs_.size() &&
+               (measured_runs_[measured_run_index].start < text_run_start ||
+                (measured_runs_[measured_run_index].start == text_run_start &&
+                 measured_runs_[measured_run_index].end < text_run_end))) {
+          measured_run_index++;
+        }
+        MeasuredRun* measured_run = nullptr;
+        if (measured_run_index < measured_runs_.size() &&
+            measured_runs_[measured_run_index].start == text_run_start &&
+            measured_runs_[measured_run_index].end == text_run_end) {
+          measured_run = &measured_runs_[measured_run_index++];
+        }
+
+        if (measured_run == nullptr) {
+          double run_width = breaker_.addStyleRun(&paint, collection, font,
+                                                  run_start, run_end, isRtl);
+          const float* char_widths = breaker_.getCharWidths();
+          measured_runs.push_back(
+              {text_run_start, text_run_end, run_width,
+               std::vector<float>(char_widths + run_start,
+                                  char_widths + run_end),
+               Range<size_t>()});
+        } else {
+          Range<size_t>& stale = measured_run->stale_range;
+          if (stale.width() > 0) {
+            // Only measure the edited words again. The width of the run is
+            // now the sum of the widths of its characters, which may differ
+            // slightly from the width measured for the whole run.
+            minikin::Layout::measureText(
+                breaker_.buffer(), stale.start - block_start, stale.width(),
+                block_size, isRtl, font, paint, collection,
+                measured_run->char_widths.data() + stale.start -
+                    text_run_start);
+            measured_run->width =
+                std::accumulate(measured_run->char_widths.begin(),
+                                measured_run->char_widths.end(), 0.0);
+            stale = Range<size_t>();
+          }
+          breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                       run_end, isRtl,
+                                       measured_run->char_widths.data());
+          measured_runs.push_back(std::move(*measured_run));
+        }
+        block_total_width += measured_runs.back().width;
       }
 
       if (run.end > block_end)
@@ -358,27 +626,26 @@ bool ParagraphTxt::ComputeLineBreaks() {
 
     size_t breaks_count = breaker_.computeBreaks();
     const int* breaks = breaker_.getBreaks();
+    const float* widths = breaker_.getWidths();
+    block.breaks.assign(breaks, breaks + breaks_count);
+    block.line_widths.assign(widths, widths + breaks_count);
+    const int* flags = breaker_.getFlags();
+    block.hyphen_edits.resize(breaks_count);
     for (size_t i = 0; i < breaks_count; ++i) {
-      size_t break_start = (i > 0) ? breaks[i - 1] : 0;
-      size_t line_start = break_start + block_start;
-      size_t line_end = breaks[i] + block_start;
-      bool hard_break = i == breaks_count - 1;
-      size_t line_end_including_newline =
-          (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
-      size_t line_end_excluding_whitespace = line_end;
-      while (
-          line_end_excluding_whitespace > line_start &&
-          minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
-        line_end_excluding_whitespace--;
-      }
-      line_metrics_.emplace_back(line_start, line_end,
-                                 line_end_excluding_whitespace,
-                                 line_end_including_newline, hard_break);
-      line_widths_.push_back(breaker_.getWidths()[i]);
+      block.hyphen_edits[i] =
+          flags[i] & (minikin::HyphenEdit::MASK_END_OF_LINE |
+                      minikin::HyphenEdit::MASK_START_OF_LINE);
     }
+    block.has_breaks = true;
+    block.breaks_width = width_;
+    block.intrinsic_width = block_total_width;
+    block.placeholder_count =
+        inline_placeholder_index - block_placeholder_start;
+    AddBlockLines(block);
 
     breaker_.finish();
   }
+  measured_runs_ = std::move(measured_runs);
 
   return true;
 }
@@ -660,13 +927,24 @@ void ParagraphTxt::ComputePlaceholder(PlaceholderRun* placeholder_run,
 void ParagraphTxt::Layout(double width) {
   double rounded_width = floor(width);
   // Do not allow calling layout multiple times without changing anything.
-  if (!needs_layout_ && rounded_width == width_) {
+  if (!needs_layout_ && !text_edited_ && rounded_width == width_) {
     return;
   }
 
   width_ = rounded_width;
 
+  // Only the width or parts of the text changed if the paragraph does not
+  // need a layout, so the measurements and shaped runs of the previous layout
+  // can be reused.
+  if (needs_layout_) {
+    measured_runs_.clear();
+    blocks_.clear();
+    bidi_runs_.clear();
+    bidi_run_pieces_.clear();
+    edited_shaped_runs_.clear();
+  }
   needs_layout_ = false;
+  text_edited_ = false;
 
   records_.clear();
   glyph_lines_.clear();
@@ -679,9 +957,15 @@ void ParagraphTxt::Layout(double width) {
   if (!ComputeLineBreaks())
     return;
 
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
-    return;
+  if (bidi_runs_.empty()) {
+    if (!ComputeBidiRuns(&bidi_runs_)) {
+      bidi_runs_.clear();
+      edited_shaped_runs_.clear();
+      return;
+    }
+    bidi_run_pieces_.resize(bidi_runs_.size());
+    ReuseEditedShapedRuns();
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -690,6 +974,7 @@ void ParagraphTxt::Layout(double width) {
 
   minikin::Layout layout;
   SkTextBlobBuilder builder;
+  GlyphRunCache* glyph_run_cache = font_collection_->GetGlyphRunCache().get();
   double y_offset = 0;
   double prev_max_descent = 0;
   double max_word_width = 0;
@@ -732,7 +1017,10 @@ void ParagraphTxt::Layout(double width) {
 
     // Find the runs comprising this line.
     std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
+    // The index in bidi_runs_ of each of the line_runs.
+    std::vector<size_t> line_run_bidi_indexes;
+    for (size_t bidi_index = 0; bidi_index < bidi_runs_.size(); ++bidi_index) {
+      const BidiRun& bidi_run = bidi_runs_[bidi_index];
       // A "ghost" run is a run that does not impact the layout, breaking,
       // alignment, width, etc but is still "visible" through getRectsForRange.
       // For example, trailing whitespace on centered text can be scrolled
@@ -755,6 +1043,7 @@ void ParagraphTxt::Layout(double width) {
       // Include the ghost run before normal run if RTL
       if (bidi_run.direction() == TextDirection::rtl && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_bidi_indexes.push_back(bidi_index);
       }
       // Emplace a normal line run.
       if (bidi_run.start() < line_end_index &&
@@ -775,10 +1064,12 @@ void ParagraphTxt::Layout(double width) {
               std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
               bidi_run.style());
         }
+        line_run_bidi_indexes.push_back(bidi_index);
       }
       // Include the ghost run after normal run if LTR
       if (bidi_run.direction() == TextDirection::ltr && ghost_run != nullptr) {
         line_runs.push_back(*ghost_run);
+        line_run_bidi_indexes.push_back(bidi_index);
       }
     }
     bool line_runs_all_rtl =
@@ -863,8 +1154,24 @@ void ParagraphTxt::Layout(double width) {
         }
       }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
-                      minikin_font, minikin_paint, minikin_font_collection);
+      if (ellipsized_text.empty()) {
+        // Add the hyphen of a line that was broken within a word to the run
+        // that ends the line, or that starts the next line in some languages.
+        uint32_t hyphen_edit = line_hyphen_edits_[line_number];
+        if (run.end() != line_metrics.end_excluding_whitespace)
+          hyphen_edit &= ~minikin::HyphenEdit::MASK_END_OF_LINE;
+        if (run.start() != line_metrics.start_index)
+          hyphen_edit &= ~minikin::HyphenEdit::MASK_START_OF_LINE;
+        minikin_paint.hyphenEdit = hyphen_edit;
+        LayoutBidiRunRange(
+            line_run_bidi_indexes[line_run_it - line_runs.begin()], run.start(),
+            run.end(), minikin_font, minikin_paint, minikin_font_collection,
+            &layout);
+      } else {
+        layout.doLayout(text_ptr, text_start, text_count, text_size,
+                        run.is_rtl(), minikin_font, minikin_paint,
+                        minikin_font_collection);
+      }
 
       if (layout.nGlyphs() == 0)
         continue;
@@ -1019,17 +1326,24 @@ void ParagraphTxt::Layout(double width) {
         Range<double> record_x_pos(
             glyph_positions.front().x_pos.start - run_x_offset,
             glyph_positions.back().x_pos.end - run_x_offset);
+        sk_sp<SkTextBlob> text_blob =
+            glyph_run_cache == nullptr
+                ? builder.make()
+                : glyph_run_cache->MakeTextBlob(&builder, font,
+                                                blob_buffer.glyphs,
+                                                blob_buffer.pos,
+                                                glyph_blob.width());
         if (run.is_placeholder_run()) {
           paint_records.emplace_back(
               run.style(), SkPoint::Make(run_x_offset + justify_x_offset, 0),
-              builder.make(), *metrics, line_number, record_x_pos.start,
+              std::move(text_blob), *metrics, line_number, record_x_pos.start,
               record_x_pos.start + run.placeholder_run()->width, run.is_ghost(),
               run.placeholder_run());
           run_x_offset += run.placeholder_run()->width;
         } else {
           paint_records.emplace_back(
               run.style(), SkPoint::Make(run_x_offset + justify_x_offset, 0),
-              builder.make(), *metrics, line_number, record_x_pos.start,
+              std::move(text_blob), *metrics, line_number, record_x_pos.start,
               record_x_pos.end, run.is_ghost());
         }
         justify_x_offset += justify_x_offset_delta;
@@ -1337,6 +1651,85 @@ double ParagraphTxt::GetLongestLine() {
   return longest_line_;
 }
 
+void ParagraphTxt::ReuseEditedShapedRuns() {
+  for (size_t i = 0; i < bidi_runs_.size() && !edited_shaped_runs_.empty();
+       ++i) {
+    const BidiRun& bidi_run = bidi_runs_[i];
+    auto shaped_run = std::lower_bound(
+        edited_shaped_runs_.begin(), edited_shaped_runs_.end(),
+        bidi_run.start(), [](const ShapedRun& run, size_t start) {
+          return run.start < start;
+        });
+    if (shaped_run == edited_shaped_runs_.end() ||
+        shaped_run->start != bidi_run.start() ||
+        shaped_run->end != bidi_run.end() ||
+        shaped_run->direction != bidi_run.direction()) {
+      continue;
+    }
+
+    std::vector<minikin::LayoutPiece> pieces = std::move(shaped_run->pieces);
+    for (minikin::LayoutPiece& piece : pieces)
+      piece.start += bidi_run.start();
+
+    const Range<size_t>& stale = shaped_run->stale_range;
+    if (stale.width() > 0) {
+      minikin::FontStyle font;
+      minikin::MinikinPaint paint;
+      GetFontAndMinikinPaint(bidi_run.style(), &font, &paint);
+      std::shared_ptr<minikin::FontCollection> collection =
+          GetMinikinFontCollectionForStyle(bidi_run.style());
+      if (collection == nullptr)
+        continue;
+
+      // Shape the edited words, and insert them where doLayout would append
+      // them.
+      std::vector<minikin::LayoutPiece> stale_pieces;
+      minikin::Layout::getLayoutPieces(text_.data(), stale.start, stale.width(),
+                                       text_.size(), bidi_run.is_rtl(), font,
+                                       paint, collection, &stale_pieces);
+      auto insert_position = std::find_if(
+          pieces.begin(), pieces.end(),
+          [&stale, &bidi_run](const minikin::LayoutPiece& piece) {
+            return bidi_run.is_rtl() ? piece.start < stale.start
+                                     : piece.start >= stale.end;
+          });
+      pieces.insert(insert_position, stale_pieces.begin(), stale_pieces.end());
+    }
+    bidi_run_pieces_[i] = std::move(pieces);
+  }
+  edited_shaped_runs_.clear();
+}
+
+void ParagraphTxt::LayoutBidiRunRange(
+    size_t bidi_run_index,
+    size_t start,
+    size_t end,
+    const minikin::FontStyle& font,
+    const minikin::MinikinPaint& paint,
+    const std::shared_ptr<minikin::FontCollection>& font_collection,
+    minikin::Layout* layout) {
+  const BidiRun& bidi_run = bidi_runs_[bidi_run_index];
+  if (paint.hyphenEdit.getHyphen() != minikin::HyphenEdit::NO_EDIT) {
+    // The words were shaped without the hyphen.
+    layout->doLayout(text_.data(), start, end - start, text_.size(),
+                     bidi_run.is_rtl(), font, paint, font_collection);
+    return;
+  }
+  std::vector<minikin::LayoutPiece>& pieces = bidi_run_pieces_[bidi_run_index];
+  if (pieces.empty()) {
+    minikin::Layout::getLayoutPieces(text_.data(), bidi_run.start(),
+                                     bidi_run.size(), text_.size(),
+                                     bidi_run.is_rtl(), font, paint,
+                                     font_collection, &pieces);
+  }
+  if (!layout->doLayoutFromPieces(pieces, start, end - start)) {
+    // The range splits a word, e.g. at a desperate break within a word that
+    // is wider than the line.
+    layout->doLayout(text_.data(), start, end - start, text_.size(),
+                     bidi_run.is_rtl(), font, paint, font_collection);
+  }
+}
+
 void ParagraphTxt::SetParagraphStyle(const ParagraphStyle& style) {
   needs_layout_ = true;
   paragraph_style_ = style;
@@ -2010,7 +2403,7 @@ void ParagraphTxt::SetDirty(bool dirty) {
 }
 
 std::vector<LineMetrics>& ParagraphTxt::GetLineMetrics() {
-  FML_DCHECK(!needs_layout_) << "only valid after layout";
+  FML_DCHECK(!needs_layout_ && !text_edited_) << "only valid after layout";
   return line_metrics_;
 }
 
@@ -25,6 +25,7 @@
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "line_metrics.h"
+#include "minikin/Layout.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
 #include "paragraph.h"
@@ -121,6 +122,11 @@ class ParagraphTxt : public Paragraph {
   // line in the final layout.
   std::vector<LineMetrics>& GetLineMetrics() override;
 
+  bool ReplaceText(size_t start,
+                   size_t end,
+                   const std::u16string& text,
+                   const TextStyle& style) override;
+
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
   // be performed when this is set to true. Can also be used to prevent a new
   // Layout from being calculated by setting to false.
@@ -164,6 +170,10 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, RelayoutAtNewWidthMatchesFreshLayout);
+  FRIEND_TEST(ParagraphTest, ReplaceTextMatchesFreshLayout);
+  FRIEND_TEST(ParagraphTest, ReplaceTextMergesRunsOfTheSameStyle);
+  FRIEND_TEST(ParagraphTest, ParagraphsShareGlyphRunsWithACache);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -184,11 +194,16 @@ class ParagraphTxt : public Paragraph {
   std::shared_ptr<FontCollection> font_collection_;
 
   minikin::LineBreaker breaker_;
+  // The hyphenator of breaker_, for the locale of paragraph_style_.
+  minikin::Hyphenator* hyphenator_ = nullptr;
   mutable std::unique_ptr<icu::BreakIterator> word_breaker_;
 
   std::vector<LineMetrics> line_metrics_;
   size_t final_line_count_;
   std::vector<double> line_widths_;
+  // The minikin::HyphenEdit of each line, which is not empty if the line or
+  // the previous line was broken within a word.
+  std::vector<uint32_t> line_hyphen_edits_;
 
   // Stores the result of Layout().
   std::vector<PaintRecord> records_;
@@ -315,6 +330,66 @@ class ParagraphTxt : public Paragraph {
   // Holds the positions of the inline placeholders.
   std::vector<CodeUnitRun> inline_placeholder_code_unit_runs_;
 
+  // The results of the parts of Layout() that only depend on the text and its
+  // styles. They are kept when the paragraph is laid out again at a different
+  // width, and outside of the edited text after ReplaceText(), so that only
+  // the line breaks and positions have to be computed again. They are
+  // discarded once needs_layout_ is set.
+  //
+  // The runs below keep the range of the text they were computed for, and a
+  // stale range of edited words that have to be measured or shaped again.
+
+  // The widths of the characters of a styled run within a block, as measured
+  // by breaker_.
+  struct MeasuredRun {
+    size_t start;
+    size_t end;
+    double width;
+    std::vector<float> char_widths;
+    Range<size_t> stale_range;
+  };
+  // Sorted by start.
+  std::vector<MeasuredRun> measured_runs_;
+
+  // A block of text between two hard line breaks, which is broken into lines
+  // independently of the other blocks.
+  struct Block {
+    size_t start;
+    size_t end;
+    // Whether the line breaks below were computed for the current text.
+    bool has_breaks = false;
+    double breaks_width = 0;
+    // The ends of the lines, relative to start.
+    std::vector<size_t> breaks;
+    std::vector<double> line_widths;
+    std::vector<uint32_t> hyphen_edits;
+    double intrinsic_width = 0;
+    size_t placeholder_count = 0;
+
+    Block(size_t s, size_t e) : start(s), end(e) {}
+  };
+  std::vector<Block> blocks_;
+
+  std::vector<BidiRun> bidi_runs_;
+  // The shaped words of each of bidi_runs_, computed when the run is first
+  // laid out.
+  std::vector<std::vector<minikin::LayoutPiece>> bidi_run_pieces_;
+
+  // The shaped words of a bidi run, kept after an edit until the bidi runs
+  // have been computed again. The pieces are relative to start.
+  struct ShapedRun {
+    size_t start;
+    size_t end;
+    TextDirection direction;
+    std::vector<minikin::LayoutPiece> pieces;
+    Range<size_t> stale_range;
+  };
+  // Sorted by start.
+  std::vector<ShapedRun> edited_shaped_runs_;
+
+  // Set by ReplaceText(). Unlike needs_layout_, the results above are kept.
+  bool text_edited_ = false;
+
   // The max width of the paragraph as provided in the most recent Layout()
   // call.
   double width_ = -1.0f;
@@ -348,12 +423,38 @@ class ParagraphTxt : public Paragraph {
       std::vector<PlaceholderRun> inline_placeholders,
       std::unordered_set<size_t> obj_replacement_char_indexes);
 
+  // Appends the blocks of text between the hard line breaks in [start, end).
+  void FindBlocks(size_t start, size_t end, std::vector<Block>* blocks) const;
+
+  // Adds the lines of a block whose line breaks have been computed to
+  // line_metrics_.
+  void AddBlockLines(const Block& block);
+
+  // Sets up breaker_ to hyphenate in the language of the paragraph, if the
+  // font collection has patterns for it.
+  void UpdateHyphenator();
+
   // Break the text into lines.
   bool ComputeLineBreaks();
 
+  // Moves the words that were shaped before the last edit into
+  // bidi_run_pieces_, for the new bidi runs that match the old ones.
+  void ReuseEditedShapedRuns();
+
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
+  // Lays out [start, end) of the bidi run at |bidi_run_index| of bidi_runs_,
+  // reusing the words that were shaped for the run by earlier layouts.
+  void LayoutBidiRunRange(size_t bidi_run_index,
+                          size_t start,
+                          size_t end,
+                          const minikin::FontStyle& font,
+                          const minikin::MinikinPaint& paint,
+                          const std::shared_ptr<minikin::FontCollection>&
+                              font_collection,
+                          minikin::Layout* layout);
+
   // Calculates and populates strut based on paragraph_style_ strut info.
   void ComputeStrut(StrutMetrics* strut, SkFont& font);
 
@@ -18,6 +18,10 @@ std::vector<std::string> GetDefaultFontFamilies();
 
 sk_sp<SkFontMgr> GetDefaultFontManager();
 
+// The directories holding the fonts of the default font manager. Empty if the
+// fonts are not read from the file system.
+std::vector<std::string> GetSystemFontDirectories();
+
 }  // namespace txt
 
 #endif  // TXT_PLATFORM_H_
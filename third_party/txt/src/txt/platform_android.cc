@@ -14,4 +14,8 @@ sk_sp<SkFontMgr> GetDefaultFontManager() {
   return SkFontMgr::RefDefault();
 }
 
+std::vector<std::string> GetSystemFontDirectories() {
+  return {"/system/fonts", "/product/fonts"};
+}
+
 }  // namespace txt
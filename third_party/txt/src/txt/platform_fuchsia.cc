@@ -14,4 +14,9 @@ sk_sp<SkFontMgr> GetDefaultFontManager() {
   return SkFontMgr::RefDefault();
 }
 
+std::vector<std::string> GetSystemFontDirectories() {
+  // The fonts are provided by the font service.
+  return {};
+}
+
 }  // namespace txt
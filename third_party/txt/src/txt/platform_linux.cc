@@ -24,4 +24,12 @@ sk_sp<SkFontMgr> GetDefaultFontManager() {
 #endif
 }
 
+std::vector<std::string> GetSystemFontDirectories() {
+#ifdef FLUTTER_USE_FONTCONFIG
+  return {"/usr/share/fonts", "/usr/local/share/fonts"};
+#else
+  return {"/usr/share/fonts"};
+#endif
+}
+
 }  // namespace txt
@@ -28,4 +28,12 @@ sk_sp<SkFontMgr> GetDefaultFontManager() {
   return SkFontMgr::RefDefault();
 }
 
+std::vector<std::string> GetSystemFontDirectories() {
+#if TARGET_OS_EMBEDDED || TARGET_OS_SIMULATOR
+  return {"/System/Library/Fonts"};
+#else   // TARGET_OS_EMBEDDED
+  return {"/System/Library/Fonts", "/Library/Fonts"};
+#endif  // TARGET_OS_EMBEDDED
+}
+
 }  // namespace txt
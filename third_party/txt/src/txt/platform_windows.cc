@@ -15,4 +15,8 @@ sk_sp<SkFontMgr> GetDefaultFontManager() {
   return SkFontMgr_New_DirectWrite();
 }
 
+std::vector<std::string> GetSystemFontDirectories() {
+  return {"C:\\Windows\\Fonts"};
+}
+
 }  // namespace txt
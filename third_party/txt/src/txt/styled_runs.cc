@@ -16,6 +16,8 @@
 
 #include "styled_runs.h"
 
+#include <algorithm>
+
 #include "flutter/fml/logging.h"
 #include "utils/WindowsUtils.h"
 
@@ -68,6 +70,45 @@ void StyledRuns::EndRunIfNeeded(size_t end) {
   }
 }
 
+size_t StyledRuns::FindOrAddStyle(const TextStyle& style) {
+  for (size_t style_index = 0; style_index < styles_.size(); ++style_index) {
+    if (styles_[style_index].equals(style))
+      return style_index;
+  }
+  return AddStyle(style);
+}
+
+void StyledRuns::ReplaceRange(size_t start,
+                              size_t end,
+                              size_t length,
+                              size_t style_index) {
+  std::vector<IndexedRun> old_runs;
+  old_runs.swap(runs_);
+  for (const IndexedRun& run : old_runs) {
+    if (run.start < start)
+      AppendRun(run.style_index, run.start, std::min(run.end, start));
+  }
+  const size_t new_end = start + length;
+  AppendRun(style_index, start, new_end);
+  for (const IndexedRun& run : old_runs) {
+    if (run.end > end) {
+      AppendRun(run.style_index, std::max(run.start, end) - end + new_end,
+                run.end - end + new_end);
+    }
+  }
+}
+
+void StyledRuns::AppendRun(size_t style_index, size_t start, size_t end) {
+  if (start == end)
+    return;
+  if (!runs_.empty() && runs_.back().style_index == style_index &&
+      runs_.back().end == start) {
+    runs_.back().end = end;
+    return;
+  }
+  runs_.emplace_back(style_index, start, end);
+}
+
 StyledRuns::Run StyledRuns::GetRun(size_t index) const {
   const IndexedRun& run = runs_[index];
   return Run{styles_[run.style_index], run.start, run.end};
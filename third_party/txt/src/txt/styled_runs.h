@@ -56,6 +56,18 @@ class StyledRuns {
 
   void EndRunIfNeeded(size_t end);
 
+  // Returns the index of a style equal to the given one, adding it if there
+  // is none.
+  size_t FindOrAddStyle(const TextStyle& style);
+
+  // Replaces the runs in [start, end) of the text with a run of |length| code
+  // units in the style at |style_index|, and moves the runs after it. The new
+  // run is merged with adjacent runs of the same style.
+  void ReplaceRange(size_t start,
+                    size_t end,
+                    size_t length,
+                    size_t style_index);
+
   size_t size() const { return runs_.size(); }
 
   Run GetRun(size_t index) const;
@@ -83,6 +95,9 @@ class StyledRuns {
   FRIEND_TEST(ParagraphTest, SimpleShadow);
   FRIEND_TEST(ParagraphTest, ComplexShadow);
   FRIEND_TEST(ParagraphTest, FontFallbackParagraph);
+  FRIEND_TEST(ParagraphTest, ReplaceTextMergesRunsOfTheSameStyle);
+
+  void AppendRun(size_t style_index, size_t start, size_t end);
 
   struct IndexedRun {
     size_t style_index = 0;
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2020 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "minikin/LayoutCache.h"
+#include "txt_test_utils.h"
+
+namespace minikin {
+
+class LayoutCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    font_collection_ = txt::GetTestFontCollection();
+    collection_ = font_collection_->GetMinikinFontCollectionForFamilies(
+        std::vector<std::string>(1, "Roboto"), "en-US");
+  }
+
+  LayoutCacheKey MakeKey(const std::u16string& text) {
+    return LayoutCacheKey(
+        collection_, paint_, FontStyle(),
+        reinterpret_cast<const uint16_t*>(text.data()), 0, text.size(),
+        text.size(), false);
+  }
+
+  std::shared_ptr<txt::FontCollection> font_collection_;
+  std::shared_ptr<FontCollection> collection_;
+  MinikinPaint paint_;
+};
+
+TEST_F(LayoutCacheTest, CountsHitsAndMisses) {
+  LayoutCache cache;
+  std::u16string text = u"hello";
+  EXPECT_EQ(cache.find(MakeKey(text)), nullptr);
+
+  auto layout = std::make_shared<Layout>();
+  EXPECT_EQ(cache.put(MakeKey(text), layout), layout);
+
+  // The cache keeps its own copy of the text.
+  std::u16string same_text = u"hello";
+  text = u"world";
+  EXPECT_EQ(cache.find(MakeKey(same_text)), layout);
+  EXPECT_EQ(cache.find(MakeKey(text)), nullptr);
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.entryCount, 1u);
+  EXPECT_GT(stats.bytes, layout->getMemoryUsage());
+}
+
+TEST_F(LayoutCacheTest, KeepsTheFirstLayoutForAKey) {
+  LayoutCache cache;
+  const std::u16string text = u"hello";
+  auto first = std::make_shared<Layout>();
+  auto second = std::make_shared<Layout>();
+  EXPECT_EQ(cache.put(MakeKey(text), first), first);
+  EXPECT_EQ(cache.put(MakeKey(text), second), first);
+  EXPECT_EQ(cache.getStats().entryCount, 1u);
+}
+
+TEST_F(LayoutCacheTest, EvictsByMemoryFootprint) {
+  const size_t kMaxBytes = 64 * 1024;
+  LayoutCache cache(kMaxBytes);
+  std::vector<std::u16string> texts;
+  for (int i = 0; i < 2000; i++) {
+    texts.push_back(u"word" + std::u16string(i % 50, u'x') +
+                    static_cast<char16_t>(u'a' + i % 26) +
+                    static_cast<char16_t>(0x100 + i));
+  }
+  for (const auto& text : texts) {
+    cache.put(MakeKey(text), std::make_shared<Layout>());
+  }
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_LE(stats.bytes, kMaxBytes);
+  EXPECT_GT(stats.entryCount, 0u);
+  EXPECT_LT(stats.entryCount, texts.size());
+
+  // The most recently added word is still cached.
+  EXPECT_NE(cache.find(MakeKey(texts.back())), nullptr);
+
+  cache.clear();
+  stats = cache.getStats();
+  EXPECT_EQ(stats.entryCount, 0u);
+  EXPECT_EQ(stats.bytes, 0u);
+}
+
+TEST_F(LayoutCacheTest, CanBeUsedFromSeveralThreads) {
+  LayoutCache cache(16 * 1024);
+  std::vector<std::u16string> texts;
+  for (int i = 0; i < 500; i++) {
+    texts.push_back(u"word" + static_cast<char16_t>(0x100 + i));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      for (int round = 0; round < 10; round++) {
+        for (const auto& text : texts) {
+          auto layout = cache.find(MakeKey(text));
+          if (layout == nullptr) {
+            layout = cache.put(MakeKey(text), std::make_shared<Layout>());
+          }
+          EXPECT_NE(layout, nullptr);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  LayoutCacheStats stats = cache.getStats();
+  EXPECT_EQ(stats.hits + stats.misses, 4u * 10u * texts.size());
+  EXPECT_LE(stats.bytes, 16u * 1024u);
+}
+
+TEST_F(LayoutCacheTest, LayoutUsesTheSharedCache) {
+  const std::u16string text = u"The quick brown fox";
+  const auto* buf = reinterpret_cast<const uint16_t*>(text.data());
+  paint_.size = 14;
+
+  Layout first;
+  first.doLayout(buf, 0, text.size(), text.size(), false, FontStyle(), paint_,
+                 collection_);
+  const LayoutCacheStats before = Layout::getCacheStats();
+
+  Layout second;
+  second.doLayout(buf, 0, text.size(), text.size(), false, FontStyle(), paint_,
+                  collection_);
+  const LayoutCacheStats after = Layout::getCacheStats();
+
+  // Each of the 7 words and spaces is found in the cache.
+  EXPECT_EQ(after.hits - before.hits, 7u);
+  EXPECT_EQ(after.misses, before.misses);
+  EXPECT_EQ(first.nGlyphs(), second.nGlyphs());
+  EXPECT_EQ(first.getAdvance(), second.getAdvance());
+}
+
+}  // namespace minikin
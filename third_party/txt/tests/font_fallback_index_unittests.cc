@@ -0,0 +1,188 @@
+/*
+ * Copyright 2020 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "gtest/gtest.h"
+#include "txt/font_fallback_index.h"
+
+namespace txt {
+
+namespace {
+
+constexpr uint64_t kFingerprint = 42;
+
+// Saves an index with a few matches and the coverage of a family.
+void SaveIndex(const fml::UniqueFD& directory) {
+  FontFallbackIndex index(kFingerprint);
+  ASSERT_FALSE(index.Load(directory));
+  index.AddMatch("en", 0x1F600, "Noto Color Emoji");
+  index.AddMatch("en", 0x4E00, "Noto Sans CJK");
+  index.AddMatch("ja", 0x4E00, "Noto Sans CJK JP");
+  index.AddMatch("en", 0xE000, "");
+  const uint32_t ranges[] = {0x20, 0x7F, 0x4E00, 0x9FFF};
+  index.AddCoverage("Noto Sans CJK", minikin::SparseBitSet(ranges, 2), true);
+  ASSERT_TRUE(index.HasChanges());
+  ASSERT_TRUE(index.Save(directory));
+  ASSERT_FALSE(index.HasChanges());
+}
+
+}  // namespace
+
+TEST(FontFallbackIndexTest, LooksUpSavedMatches) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  FontFallbackIndex index(kFingerprint);
+  ASSERT_TRUE(index.Load(directory.fd()));
+  EXPECT_FALSE(index.HasChanges());
+  std::string family_name;
+  ASSERT_TRUE(index.LookupMatch("en", 0x1F600, &family_name));
+  EXPECT_EQ(family_name, "Noto Color Emoji");
+  ASSERT_TRUE(index.LookupMatch("en", 0x4E00, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK");
+  ASSERT_TRUE(index.LookupMatch("ja", 0x4E00, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK JP");
+  // A character that no font has.
+  ASSERT_TRUE(index.LookupMatch("en", 0xE000, &family_name));
+  EXPECT_TRUE(family_name.empty());
+
+  EXPECT_FALSE(index.LookupMatch("en", 0x4E01, &family_name));
+  EXPECT_FALSE(index.LookupMatch("fr", 0x4E00, &family_name));
+}
+
+TEST(FontFallbackIndexTest, LooksUpSavedCoverage) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  FontFallbackIndex index(kFingerprint);
+  ASSERT_TRUE(index.Load(directory.fd()));
+  minikin::SparseBitSet coverage;
+  bool has_vs_table = false;
+  ASSERT_TRUE(index.LookupCoverage("Noto Sans CJK", &coverage, &has_vs_table));
+  EXPECT_TRUE(has_vs_table);
+  EXPECT_FALSE(coverage.get(0x1F));
+  EXPECT_TRUE(coverage.get(0x20));
+  EXPECT_TRUE(coverage.get(0x7E));
+  EXPECT_FALSE(coverage.get(0x7F));
+  EXPECT_TRUE(coverage.get(0x4E00));
+  EXPECT_TRUE(coverage.get(0x9FFE));
+  EXPECT_FALSE(coverage.get(0x9FFF));
+
+  EXPECT_FALSE(index.LookupCoverage("Roboto", &coverage, &has_vs_table));
+}
+
+TEST(FontFallbackIndexTest, SavingKeepsTheLoadedEntries) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  FontFallbackIndex index(kFingerprint);
+  ASSERT_TRUE(index.Load(directory.fd()));
+  index.AddMatch("en", 0x4E01, "Noto Sans CJK");
+  // Entries added after loading take precedence over the loaded ones.
+  index.AddMatch("en", 0x1F600, "Emoji One");
+  ASSERT_TRUE(index.HasChanges());
+  ASSERT_TRUE(index.Save(directory.fd()));
+
+  FontFallbackIndex saved_index(kFingerprint);
+  ASSERT_TRUE(saved_index.Load(directory.fd()));
+  std::string family_name;
+  ASSERT_TRUE(saved_index.LookupMatch("en", 0x4E01, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK");
+  ASSERT_TRUE(saved_index.LookupMatch("en", 0x1F600, &family_name));
+  EXPECT_EQ(family_name, "Emoji One");
+  ASSERT_TRUE(saved_index.LookupMatch("ja", 0x4E00, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK JP");
+  minikin::SparseBitSet coverage;
+  bool has_vs_table;
+  EXPECT_TRUE(
+      saved_index.LookupCoverage("Noto Sans CJK", &coverage, &has_vs_table));
+}
+
+TEST(FontFallbackIndexTest, WritesSerializedIndexes) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  FontFallbackIndex index(kFingerprint);
+  ASSERT_TRUE(index.Load(directory.fd()));
+  index.AddMatch("en", 0x4E01, "Noto Sans CJK");
+  std::vector<uint8_t> data = index.Serialize();
+  EXPECT_FALSE(index.HasChanges());
+  // The loaded entries are still found after serializing.
+  std::string family_name;
+  ASSERT_TRUE(index.LookupMatch("ja", 0x4E00, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK JP");
+
+  ASSERT_TRUE(FontFallbackIndex::Write(directory.fd(), std::move(data)));
+  FontFallbackIndex saved_index(kFingerprint);
+  ASSERT_TRUE(saved_index.Load(directory.fd()));
+  ASSERT_TRUE(saved_index.LookupMatch("en", 0x4E01, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK");
+  ASSERT_TRUE(saved_index.LookupMatch("ja", 0x4E00, &family_name));
+  EXPECT_EQ(family_name, "Noto Sans CJK JP");
+
+  // The temporary file is renamed to the index.
+  size_t file_count = 0;
+  fml::VisitFiles(directory.fd(),
+                  [&file_count](const fml::UniqueFD&, const std::string&) {
+                    file_count++;
+                    return true;
+                  });
+  EXPECT_EQ(file_count, 1u);
+}
+
+TEST(FontFallbackIndexTest, IgnoresOutdatedIndexes) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  FontFallbackIndex index(kFingerprint + 1);
+  EXPECT_FALSE(index.Load(directory.fd()));
+  std::string family_name;
+  EXPECT_FALSE(index.LookupMatch("en", 0x1F600, &family_name));
+}
+
+TEST(FontFallbackIndexTest, IgnoresTruncatedIndexes) {
+  fml::ScopedTemporaryDirectory directory;
+  SaveIndex(directory.fd());
+
+  fml::UniqueFD file =
+      fml::OpenFile(directory.fd(), FontFallbackIndex::kFileName, false,
+                    fml::FilePermission::kReadWrite);
+  ASSERT_TRUE(fml::TruncateFile(file, 50));
+  FontFallbackIndex index(kFingerprint);
+  EXPECT_FALSE(index.Load(directory.fd()));
+}
+
+TEST(FontFallbackIndexTest, FingerprintChangesWithTheFontDirectories) {
+  fml::ScopedTemporaryDirectory directory;
+  const uint64_t fingerprint =
+      FontFallbackIndex::ComputeFingerprint({directory.path()});
+  EXPECT_EQ(FontFallbackIndex::ComputeFingerprint({directory.path()}),
+            fingerprint);
+
+  ASSERT_TRUE(fml::CreateDirectory(directory.fd(), {"fonts"},
+                                   fml::FilePermission::kReadWrite)
+                  .is_valid());
+  EXPECT_NE(FontFallbackIndex::ComputeFingerprint({directory.path()}),
+            fingerprint);
+
+  EXPECT_EQ(FontFallbackIndex::ComputeFingerprint({"/nonexistent"}),
+            FontFallbackIndex::ComputeFingerprint({}));
+}
+
+}  // namespace txt
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "txt/glyph_run_cache.h"
+
+namespace txt {
+
+namespace {
+
+// Builds a run of the glyphs spaced |advance| apart through the cache.
+sk_sp<SkTextBlob> MakeTextBlob(GlyphRunCache* cache,
+                               const SkFont& font,
+                               const std::vector<SkGlyphID>& glyphs,
+                               SkScalar advance = 10) {
+  SkTextBlobBuilder builder;
+  const SkTextBlobBuilder::RunBuffer& buffer =
+      builder.allocRunPos(font, glyphs.size());
+  for (size_t i = 0; i < glyphs.size(); ++i) {
+    buffer.glyphs[i] = glyphs[i];
+    buffer.pos[i * 2] = i * advance;
+    buffer.pos[i * 2 + 1] = 0;
+  }
+  return cache->MakeTextBlob(&builder, font, buffer.glyphs, buffer.pos,
+                             glyphs.size());
+}
+
+}  // namespace
+
+TEST(GlyphRunCacheTest, SharesTheBlobsOfIdenticalRuns) {
+  GlyphRunCache cache;
+  SkFont font;
+  sk_sp<SkTextBlob> first = MakeTextBlob(&cache, font, {1, 2, 3});
+  sk_sp<SkTextBlob> second = MakeTextBlob(&cache, font, {1, 2, 3});
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first, second);
+
+  GlyphRunCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hit_count, 1u);
+  EXPECT_EQ(stats.miss_count, 1u);
+  EXPECT_EQ(stats.entry_count, 1u);
+  EXPECT_GT(stats.bytes, 0u);
+}
+
+TEST(GlyphRunCacheTest, DistinguishesGlyphsPositionsAndFonts) {
+  GlyphRunCache cache;
+  SkFont font;
+  sk_sp<SkTextBlob> blob = MakeTextBlob(&cache, font, {1, 2, 3});
+  EXPECT_NE(MakeTextBlob(&cache, font, {1, 2, 4}), blob);
+  EXPECT_NE(MakeTextBlob(&cache, font, {1, 2, 3}, 11), blob);
+
+  SkFont larger_font = font;
+  larger_font.setSize(font.getSize() * 2);
+  EXPECT_NE(MakeTextBlob(&cache, larger_font, {1, 2, 3}), blob);
+
+  SkFont subpixel_font = font;
+  subpixel_font.setSubpixel(!font.isSubpixel());
+  EXPECT_NE(MakeTextBlob(&cache, subpixel_font, {1, 2, 3}), blob);
+
+  EXPECT_EQ(cache.GetStats().entry_count, 5u);
+}
+
+TEST(GlyphRunCacheTest, EvictsTheLeastRecentlyUsedRuns) {
+  SkFont font;
+  GlyphRunCache unlimited_cache;
+  MakeTextBlob(&unlimited_cache, font, {1});
+  const size_t entry_bytes = unlimited_cache.GetStats().bytes;
+
+  // Room for two runs of a single glyph.
+  GlyphRunCache cache(entry_bytes * 2);
+  sk_sp<SkTextBlob> first = MakeTextBlob(&cache, font, {1});
+  MakeTextBlob(&cache, font, {2});
+  // Use the first run again, so that the second one is evicted.
+  EXPECT_EQ(MakeTextBlob(&cache, font, {1}), first);
+  MakeTextBlob(&cache, font, {3});
+
+  GlyphRunCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.entry_count, 2u);
+  EXPECT_LE(stats.bytes, entry_bytes * 2);
+  EXPECT_EQ(MakeTextBlob(&cache, font, {1}), first);
+  EXPECT_EQ(cache.GetStats().miss_count, 3u);
+
+  cache.Clear();
+  stats = cache.GetStats();
+  EXPECT_EQ(stats.entry_count, 0u);
+  EXPECT_EQ(stats.bytes, 0u);
+}
+
+}  // namespace txt
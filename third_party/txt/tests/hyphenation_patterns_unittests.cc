@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "gtest/gtest.h"
+#include "txt/hyphenation_patterns.h"
+#include "txt_test_utils.h"
+
+namespace txt {
+
+namespace {
+
+using minikin::HyphenationType;
+
+std::vector<HyphenationType> Hyphenate(minikin::Hyphenator* hyphenator,
+                                       const std::u16string& word,
+                                       const char* locale = "en_US") {
+  std::vector<HyphenationType> result;
+  hyphenator->hyphenate(&result, reinterpret_cast<const uint16_t*>(word.data()),
+                        word.size(), icu::Locale(locale));
+  return result;
+}
+
+std::vector<size_t> GetBreaks(const std::vector<HyphenationType>& result) {
+  std::vector<size_t> breaks;
+  for (size_t i = 0; i < result.size(); i++) {
+    if (result[i] != HyphenationType::DONT_BREAK) {
+      breaks.push_back(i);
+    }
+  }
+  return breaks;
+}
+
+}  // namespace
+
+TEST(HyphenationPatternsTest, MapsThePatternsOfTheLocale) {
+  fml::ScopedTemporaryDirectory directory;
+  ASSERT_TRUE(fml::WriteAtomically(
+      directory.fd(), "hyph-en.hyb",
+      fml::DataMapping(BuildHyphenationPatterns({"y1p", "n1a"}))));
+  ASSERT_TRUE(fml::WriteAtomically(
+      directory.fd(), "hyph-en-gb.hyb",
+      fml::DataMapping(BuildHyphenationPatterns({"n1a"}))));
+  HyphenationPatterns patterns(fml::OpenDirectory(
+      directory.path().c_str(), false, fml::FilePermission::kRead));
+
+  minikin::Hyphenator* english = patterns.GetHyphenator("en");
+  ASSERT_NE(english, nullptr);
+  EXPECT_EQ(patterns.GetHyphenator("en-US"), english);
+  EXPECT_EQ(patterns.GetHyphenator("en_US"), english);
+  minikin::Hyphenator* british = patterns.GetHyphenator("en_GB");
+  ASSERT_NE(british, nullptr);
+  EXPECT_NE(british, english);
+  EXPECT_EQ(patterns.GetHyphenator("fr"), nullptr);
+  EXPECT_EQ(patterns.GetHyphenator(""), nullptr);
+
+  EXPECT_EQ(GetBreaks(Hyphenate(english, u"hyphenation")),
+            std::vector<size_t>({2, 6}));
+  EXPECT_EQ(GetBreaks(Hyphenate(english, u"Hyphenation")),
+            std::vector<size_t>({2, 6}));
+  EXPECT_EQ(GetBreaks(Hyphenate(british, u"hyphenation", "en_GB")),
+            std::vector<size_t>({6}));
+  // English words keep at least three letters after the hyphen.
+  EXPECT_EQ(GetBreaks(Hyphenate(english, u"typed")), std::vector<size_t>({2}));
+  EXPECT_TRUE(GetBreaks(Hyphenate(english, u"typo")).empty());
+}
+
+TEST(HyphenationPatternsTest, RejectsInvalidPatterns) {
+  fml::ScopedTemporaryDirectory directory;
+  ASSERT_TRUE(fml::WriteAtomically(directory.fd(), "hyph-de.hyb",
+                                   fml::DataMapping("not hyphenation data")));
+  HyphenationPatterns patterns(fml::OpenDirectory(
+      directory.path().c_str(), false, fml::FilePermission::kRead));
+  EXPECT_EQ(patterns.GetHyphenator("de"), nullptr);
+
+  EXPECT_FALSE(patterns.AddPatterns(
+      "fr", std::make_unique<fml::DataMapping>(std::vector<uint8_t>(8, 0))));
+  EXPECT_EQ(patterns.GetHyphenator("fr"), nullptr);
+  EXPECT_TRUE(patterns.AddPatterns(
+      "fr", std::make_unique<fml::DataMapping>(
+                BuildHyphenationPatterns({"n1a"}))));
+  EXPECT_NE(patterns.GetHyphenator("fr"), nullptr);
+}
+
+TEST(HyphenationPatternsTest, RemembersRecentlyHyphenatedWords) {
+  HyphenationPatterns patterns{fml::UniqueFD()};
+  ASSERT_TRUE(patterns.AddPatterns(
+      "en", std::make_unique<fml::DataMapping>(
+                BuildHyphenationPatterns({"y1p", "n1a"}))));
+  minikin::Hyphenator* hyphenator = patterns.GetHyphenator("en");
+  ASSERT_NE(hyphenator, nullptr);
+
+  std::vector<HyphenationType> result = Hyphenate(hyphenator, u"hyphenation");
+  EXPECT_EQ(hyphenator->getMemoSize(), 1u);
+  EXPECT_EQ(Hyphenate(hyphenator, u"hyphenation"), result);
+  EXPECT_EQ(hyphenator->getMemoSize(), 1u);
+  // Soft hyphens take precedence over the patterns.
+  EXPECT_EQ(GetBreaks(Hyphenate(hyphenator, u"hyphen\u00ADation")),
+            std::vector<size_t>({7}));
+  EXPECT_EQ(hyphenator->getMemoSize(), 2u);
+
+  // Words of other locales are hyphenated, but not remembered.
+  EXPECT_EQ(GetBreaks(Hyphenate(hyphenator, u"hyphenation", "fr")),
+            std::vector<size_t>({2, 6}));
+  EXPECT_EQ(hyphenator->getMemoSize(), 2u);
+
+  // The least recently hyphenated words are evicted.
+  for (size_t i = 0; i < minikin::Hyphenator::MEMO_CAPACITY; i++) {
+    Hyphenate(hyphenator, u"word" + std::u16string(1, u'a' + i % 26) +
+                              std::u16string(1, u'a' + i / 26 % 26) +
+                              std::u16string(1, u'a' + i / 676));
+  }
+  EXPECT_EQ(hyphenator->getMemoSize(), minikin::Hyphenator::MEMO_CAPACITY);
+  EXPECT_EQ(GetBreaks(Hyphenate(hyphenator, u"hyphenation")),
+            std::vector<size_t>({2, 6}));
+}
+
+}  // namespace txt
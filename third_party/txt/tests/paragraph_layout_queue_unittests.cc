@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020 Google, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/thread.h"
+#include "gtest/gtest.h"
+#include "third_party/icu/source/common/unicode/unistr.h"
+#include "txt/paragraph_builder_txt.h"
+#include "txt/paragraph_layout_queue.h"
+#include "txt/paragraph_txt.h"
+#include "txt_test_utils.h"
+
+namespace txt {
+
+namespace {
+
+constexpr double kLayoutWidth = 300;
+
+std::unique_ptr<Paragraph> MakeParagraph(size_t index) {
+  // Latin and Arabic text, so that the layouts both shape words with several
+  // fonts and run the bidi algorithm.
+  std::string text;
+  for (size_t i = 0; i <= index % 5; i++) {
+    text += "The quick brown fox " + std::to_string(index) +
+            " jumps over the lazy dog. الخط العربي. ";
+  }
+  icu::UnicodeString icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  ParagraphStyle paragraph_style;
+  ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  TextStyle text_style;
+  text_style.font_families = {"Roboto", "Noto Naskh Arabic"};
+  text_style.font_size = 10 + index % 7;
+  text_style.letter_spacing = index % 3;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  return builder.Build();
+}
+
+}  // namespace
+
+TEST(ParagraphLayoutQueueTest, LaysOutLikeTheUIThread) {
+  constexpr size_t kParagraphCount = 40;
+  std::vector<std::unique_ptr<Paragraph>> expected;
+  for (size_t i = 0; i < kParagraphCount; i++) {
+    expected.push_back(MakeParagraph(i));
+    expected.back()->Layout(kLayoutWidth);
+  }
+
+  auto worker_loop = fml::ConcurrentMessageLoop::Create(4);
+  fml::Thread ui_thread("ui");
+  fml::RefPtr<fml::TaskRunner> ui_task_runner = ui_thread.GetTaskRunner();
+  std::vector<std::unique_ptr<Paragraph>> laid_out(kParagraphCount);
+  fml::CountDownLatch latch(kParagraphCount);
+  std::unique_ptr<ParagraphLayoutQueue> queue;
+  ui_task_runner->PostTask([&]() {
+    queue = std::make_unique<ParagraphLayoutQueue>(worker_loop->GetTaskRunner(),
+                                                   ui_task_runner);
+    for (size_t i = 0; i < kParagraphCount; i++) {
+      queue->Layout(MakeParagraph(i), kLayoutWidth,
+                    [&, i](std::unique_ptr<Paragraph> paragraph) {
+                      EXPECT_TRUE(ui_task_runner->RunsTasksOnCurrentThread());
+                      laid_out[i] = std::move(paragraph);
+                      latch.CountDown();
+                    });
+    }
+    // The callbacks cannot run before this task returns.
+    EXPECT_EQ(queue->GetPendingCount(), kParagraphCount);
+  });
+  latch.Wait();
+
+  for (size_t i = 0; i < kParagraphCount; i++) {
+    ASSERT_NE(laid_out[i], nullptr);
+    EXPECT_EQ(laid_out[i]->GetHeight(), expected[i]->GetHeight());
+    EXPECT_EQ(laid_out[i]->GetLongestLine(), expected[i]->GetLongestLine());
+    EXPECT_EQ(laid_out[i]->GetLineMetrics().size(),
+              expected[i]->GetLineMetrics().size());
+    std::vector<Paragraph::TextBox> boxes = laid_out[i]->GetRectsForRange(
+        0, 1000, Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    std::vector<Paragraph::TextBox> expected_boxes =
+        expected[i]->GetRectsForRange(0, 1000,
+                                      Paragraph::RectHeightStyle::kTight,
+                                      Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(boxes.size(), expected_boxes.size());
+    for (size_t j = 0; j < boxes.size(); j++) {
+      EXPECT_EQ(boxes[j].rect, expected_boxes[j].rect);
+      EXPECT_EQ(boxes[j].direction, expected_boxes[j].direction);
+    }
+  }
+
+  ui_task_runner->PostTask([&]() {
+    EXPECT_EQ(queue->GetPendingCount(), 0u);
+    queue.reset();
+  });
+  ui_thread.Join();
+}
+
+}  // namespace txt
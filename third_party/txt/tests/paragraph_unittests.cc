@@ -23,6 +23,7 @@
 #include "third_party/skia/include/core/SkPath.h"
 #include "txt/font_style.h"
 #include "txt/font_weight.h"
+#include "txt/glyph_run_cache.h"
 #include "txt/paragraph_builder_txt.h"
 #include "txt/paragraph_txt.h"
 #include "txt/placeholder_run.h"
@@ -5029,6 +5030,223 @@ TEST_F(ParagraphTest, LongWordParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, RelayoutAtNewWidthMatchesFreshLayout) {
+  const char* text =
+      "This is a sentence with a "
+      "veryverylongwordtoseewherethiswillwraporifitwillatall in it. "
+      "Here is some more text in a different style.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  auto build_paragraph = [&]() {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+    txt::TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.font_size = 26;
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(0, 40));
+    text_style.font_size = 20;
+    text_style.word_spacing = 5;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text.substr(40));
+    builder.Pop();
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  // The second paragraph is only laid out again at a new width, which reuses
+  // the words shaped by the first layout.
+  auto fresh_paragraph = build_paragraph();
+  auto relaid_paragraph = build_paragraph();
+  relaid_paragraph->Layout(GetTestCanvasWidth());
+  const double canvas_width = GetTestCanvasWidth();
+  for (double width : {canvas_width / 4, canvas_width / 2.5}) {
+    fresh_paragraph->SetDirty();
+    fresh_paragraph->Layout(width);
+    relaid_paragraph->Layout(width);
+
+    ASSERT_EQ(relaid_paragraph->GetLineCount(),
+              fresh_paragraph->GetLineCount());
+    EXPECT_EQ(relaid_paragraph->GetLongestLine(),
+              fresh_paragraph->GetLongestLine());
+    EXPECT_EQ(relaid_paragraph->GetHeight(), fresh_paragraph->GetHeight());
+    EXPECT_EQ(relaid_paragraph->GetMaxIntrinsicWidth(),
+              fresh_paragraph->GetMaxIntrinsicWidth());
+
+    std::vector<txt::Paragraph::TextBox> fresh_boxes =
+        fresh_paragraph->GetRectsForRange(
+            0, u16_text.length(), txt::Paragraph::RectHeightStyle::kMax,
+            txt::Paragraph::RectWidthStyle::kTight);
+    std::vector<txt::Paragraph::TextBox> relaid_boxes =
+        relaid_paragraph->GetRectsForRange(
+            0, u16_text.length(), txt::Paragraph::RectHeightStyle::kMax,
+            txt::Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(relaid_boxes.size(), fresh_boxes.size());
+    for (size_t i = 0; i < fresh_boxes.size(); i++) {
+      EXPECT_EQ(relaid_boxes[i].rect, fresh_boxes[i].rect);
+    }
+
+    ASSERT_EQ(relaid_paragraph->records_.size(),
+              fresh_paragraph->records_.size());
+    for (size_t i = 0; i < fresh_paragraph->records_.size(); i++) {
+      EXPECT_EQ(relaid_paragraph->records_[i].offset(),
+                fresh_paragraph->records_[i].offset());
+      EXPECT_EQ(relaid_paragraph->records_[i].GetRunWidth(),
+                fresh_paragraph->records_[i].GetRunWidth());
+    }
+  }
+}
+
+TEST_F(ParagraphTest, ReplaceTextMatchesFreshLayout) {
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 26;
+  text_style.color = SK_ColorBLACK;
+
+  auto build_paragraph = [&](const std::u16string& text) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+    builder.PushStyle(text_style);
+    builder.AddText(text);
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  std::u16string text =
+      u"The first block of text is long enough to be broken into lines.\n"
+      u"The second block is edited.\n"
+      u"The third block of text is long enough to be broken into lines.";
+  auto paragraph = build_paragraph(text);
+  const double width = GetTestCanvasWidth() / 3;
+  paragraph->Layout(width);
+
+  struct Edit {
+    size_t start;
+    size_t end;
+    std::u16string text;
+  };
+  const std::vector<Edit> edits = {
+      // Type a word into the second block.
+      {81, 81, u"quickly "},
+      {91, 91, u"x"},
+      // Delete a character.
+      {91, 92, u""},
+      // Join the first two blocks, and split them again.
+      {63, 64, u" "},
+      {63, 64, u"\n"},
+      // Append a line.
+      {163, 163, u"\nAn appended line."},
+  };
+  for (const Edit& edit : edits) {
+    ASSERT_TRUE(
+        paragraph->ReplaceText(edit.start, edit.end, edit.text, text_style));
+    text.replace(edit.start, edit.end - edit.start, edit.text);
+    paragraph->Layout(width);
+
+    auto fresh_paragraph = build_paragraph(text);
+    fresh_paragraph->Layout(width);
+
+    ASSERT_EQ(paragraph->text_.size(), text.size());
+    ASSERT_EQ(paragraph->runs_.size(), 1u);
+    ASSERT_EQ(paragraph->GetLineCount(), fresh_paragraph->GetLineCount());
+    for (size_t i = 0; i < fresh_paragraph->GetLineCount(); i++) {
+      EXPECT_EQ(paragraph->GetLineMetrics()[i].start_index,
+                fresh_paragraph->GetLineMetrics()[i].start_index);
+      EXPECT_EQ(paragraph->GetLineMetrics()[i].end_index,
+                fresh_paragraph->GetLineMetrics()[i].end_index);
+    }
+    EXPECT_EQ(paragraph->GetLongestLine(), fresh_paragraph->GetLongestLine());
+    EXPECT_EQ(paragraph->GetHeight(), fresh_paragraph->GetHeight());
+    // The width of an edited run is the sum of the widths of its characters.
+    EXPECT_NEAR(paragraph->GetMaxIntrinsicWidth(),
+                fresh_paragraph->GetMaxIntrinsicWidth(), 0.01);
+
+    ASSERT_EQ(paragraph->records_.size(), fresh_paragraph->records_.size());
+    for (size_t i = 0; i < fresh_paragraph->records_.size(); i++) {
+      EXPECT_EQ(paragraph->records_[i].offset(),
+                fresh_paragraph->records_[i].offset());
+      EXPECT_EQ(paragraph->records_[i].GetRunWidth(),
+                fresh_paragraph->records_[i].GetRunWidth());
+    }
+  }
+}
+
+TEST_F(ParagraphTest, ReplaceTextMergesRunsOfTheSameStyle) {
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u"Hello World");
+  builder.Pop();
+
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(GetTestCanvasWidth());
+
+  ASSERT_TRUE(paragraph->ReplaceText(5, 5, u",", text_style));
+  ASSERT_EQ(paragraph->runs_.runs_.size(), 1ull);
+
+  txt::TextStyle red_style = text_style;
+  red_style.color = SK_ColorRED;
+  ASSERT_TRUE(paragraph->ReplaceText(7, 12, u"World", red_style));
+  ASSERT_EQ(paragraph->runs_.runs_.size(), 2ull);
+  ASSERT_EQ(paragraph->runs_.runs_[1].start, 7ull);
+  ASSERT_EQ(paragraph->runs_.runs_[1].end, 12ull);
+
+  ASSERT_TRUE(paragraph->ReplaceText(12, 12, u"!", red_style));
+  ASSERT_EQ(paragraph->runs_.runs_.size(), 2ull);
+  ASSERT_EQ(paragraph->runs_.runs_[1].end, 13ull);
+
+  paragraph->Layout(GetTestCanvasWidth());
+  ASSERT_EQ(paragraph->records_.size(), 2ull);
+  ASSERT_EQ(paragraph->records_[1].style().color, SK_ColorRED);
+
+  // Ranges outside of the text can not be replaced.
+  EXPECT_FALSE(paragraph->ReplaceText(20, 21, u"", text_style));
+}
+
+TEST_F(ParagraphTest, ParagraphsShareGlyphRunsWithACache) {
+  auto font_collection = GetTestFontCollection();
+  auto glyph_run_cache = std::make_shared<txt::GlyphRunCache>();
+  font_collection->SetGlyphRunCache(glyph_run_cache);
+
+  auto build_paragraph = [&font_collection](const std::u16string& text) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+    txt::TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.color = SK_ColorBLACK;
+    builder.PushStyle(text_style);
+    builder.AddText(text);
+    builder.Pop();
+    return BuildParagraph(builder);
+  };
+
+  auto first = build_paragraph(u"A repeated label");
+  first->Layout(GetTestCanvasWidth());
+  auto second = build_paragraph(u"A repeated label");
+  second->Layout(GetTestCanvasWidth());
+  auto other = build_paragraph(u"Another label");
+  other->Layout(GetTestCanvasWidth());
+  font_collection->SetGlyphRunCache(nullptr);
+
+  ASSERT_EQ(first->records_.size(), 1ull);
+  ASSERT_EQ(second->records_.size(), 1ull);
+  ASSERT_EQ(other->records_.size(), 1ull);
+  EXPECT_EQ(first->records_[0].text(), second->records_[0].text());
+  EXPECT_NE(first->records_[0].text(), other->records_[0].text());
+
+  txt::GlyphRunCache::Stats stats = glyph_run_cache->GetStats();
+  EXPECT_EQ(stats.hit_count, 1u);
+  EXPECT_EQ(stats.miss_count, 2u);
+}
+
 TEST_F(ParagraphTest, LINUX_ONLY(KernScaleParagraph)) {
   float scale = 3.0f;
 
@@ -16,6 +16,8 @@
 
 #include "txt_test_utils.h"
 
+#include <cctype>
+#include <cstring>
 #include <sstream>
 
 #include "third_party/skia/include/core/SkTypeface.h"
@@ -127,4 +129,93 @@ std::unique_ptr<ParagraphTxt> BuildParagraph(
       static_cast<txt::ParagraphTxt*>(builder.Build().release()));
 }
 
+std::vector<uint8_t> BuildHyphenationPatterns(
+    const std::vector<std::string>& liang_patterns) {
+  // The letters are coded 1 to 26, and 0 marks the start and end of words.
+  constexpr uint32_t kCodeCount = 27;
+  constexpr uint32_t kCharMask = 0x1f;
+  constexpr uint32_t kLinkShift = 5;
+  constexpr uint32_t kLinkMask = 0xffff << kLinkShift;
+  constexpr uint32_t kPatternShift = 21;
+
+  // A trie node is a row of kCodeCount entries. The first entry of a row
+  // holds the pattern that ends at the node.
+  std::vector<uint32_t> trie(kCodeCount, 0);
+  std::vector<uint32_t> pattern_entries = {0};
+  std::vector<uint8_t> pattern_values;
+  for (const std::string& liang_pattern : liang_patterns) {
+    std::vector<uint32_t> codes;
+    std::vector<uint8_t> values(1, 0);
+    for (char c : liang_pattern) {
+      if (std::isdigit(c)) {
+        values.back() = c - '0';
+      } else {
+        codes.push_back(c == '.' ? 0 : std::tolower(c) - 'a' + 1);
+        values.push_back(0);
+      }
+    }
+    uint32_t node = 0;
+    for (uint32_t code : codes) {
+      uint32_t& entry = trie[node + code];
+      if ((entry & kLinkMask) == 0) {
+        entry |= code | (static_cast<uint32_t>(trie.size()) << kLinkShift);
+        trie.resize(trie.size() + kCodeCount, 0);
+      }
+      node = (trie[node + code] & kLinkMask) >> kLinkShift;
+    }
+    size_t shift = 0;
+    while (values.size() > 1 && values.back() == 0) {
+      values.pop_back();
+      shift++;
+    }
+    trie[node] |= pattern_entries.size() << kPatternShift;
+    pattern_entries.push_back(values.size() << 26 | shift << 20 |
+                              pattern_values.size());
+    pattern_values.insert(pattern_values.end(), values.begin(), values.end());
+  }
+
+  std::vector<uint32_t> words = {
+      0x62ad7968,  // Magic.
+      0,           // Version.
+      0,           // Offset of the alphabet.
+      0,           // Offset of the trie.
+      0,           // Offset of the patterns.
+      0,           // Size.
+  };
+  words[2] = words.size() * 4;
+  // The alphabet maps the letters from 'A' to 'z' to their codes.
+  words.insert(words.end(), {0, 'A', 'z' + 1});
+  std::vector<uint8_t> alphabet('z' + 1 - 'A', 0);
+  for (char c = 'a'; c <= 'z'; c++) {
+    alphabet[c - 'A'] = c - 'a' + 1;
+    alphabet[std::toupper(c) - 'A'] = c - 'a' + 1;
+  }
+  alphabet.resize((alphabet.size() + 3) / 4 * 4, 0);
+  size_t alphabet_start = words.size();
+  words.resize(words.size() + alphabet.size() / 4);
+  memcpy(&words[alphabet_start], alphabet.data(), alphabet.size());
+
+  words[3] = words.size() * 4;
+  words.insert(words.end(), {0, kCharMask, kLinkShift, kLinkMask,
+                             kPatternShift,
+                             static_cast<uint32_t>(trie.size())});
+  words.insert(words.end(), trie.begin(), trie.end());
+
+  words[4] = words.size() * 4;
+  words.insert(words.end(),
+               {0, static_cast<uint32_t>(pattern_entries.size()),
+                static_cast<uint32_t>(16 + pattern_entries.size() * 4),
+                static_cast<uint32_t>(pattern_values.size())});
+  words.insert(words.end(), pattern_entries.begin(), pattern_entries.end());
+  pattern_values.resize((pattern_values.size() + 3) / 4 * 4, 0);
+  size_t values_start = words.size();
+  words.resize(words.size() + pattern_values.size() / 4);
+  memcpy(&words[values_start], pattern_values.data(), pattern_values.size());
+
+  words[5] = words.size() * 4;
+  std::vector<uint8_t> data(words.size() * 4);
+  memcpy(data.data(), words.data(), data.size());
+  return data;
+}
+
 }  // namespace txt
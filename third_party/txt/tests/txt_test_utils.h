@@ -15,6 +15,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "flutter/fml/command_line.h"
 #include "txt/font_collection.h"
@@ -35,4 +36,9 @@ std::shared_ptr<FontCollection> GetTestFontCollection();
 
 std::unique_ptr<ParagraphTxt> BuildParagraph(ParagraphBuilderTxt& builder);
 
+// Builds hyphenation patterns in minikin's hyb format from Liang patterns of
+// ASCII letters, such as "hy3ph" or ".ex5". Letters hyphenate in either case.
+std::vector<uint8_t> BuildHyphenationPatterns(
+    const std::vector<std::string>& liang_patterns);
+
 }  // namespace txt